@@ -27,6 +27,8 @@
 #include <vle/utils/Path.hpp>
 #include <vle/utils/Package.hpp>
 #include <vle/utils/i18n.hpp>
+#include <vle/value/ColumnMatrix.hpp>
+#include <vle/value/Matrix.hpp>
 #include <vle/version.hpp>
 #include <vle/vle.hpp>
 
@@ -237,12 +239,14 @@ private:
     vle::manager::Simulation m_simulator;
     vle::utils::ModuleManager m_modules;
     VpzPtr m_vpz;
+    vle::vpz::Conditions m_overlay; // empty: the columns update m_vpz.
     Columns m_columns;
 
     void simulate(std::ostream &os)
     {
         vle::manager::Error error;
-        MapPtr result(m_simulator.run(new vle::vpz::Vpz(*m_vpz.get()),
+        MapPtr result(m_simulator.run(*m_vpz.get(), m_overlay,
+                                      m_vpz->project().experiment().name(),
                                       m_modules, &error));
 
         if (error.code) {
@@ -257,7 +261,9 @@ private:
             for (vle::value::Map::const_iterator it = result->begin(),
                  et = result->end(); it != et; ++it) {
                 if (it->second && it->second->isMatrix()) {
-                    os << vle::value::toMatrixValue(it->second);
+                    os << vle::value::toMatrixValue(*it->second);
+                } else if (it->second && it->second->isColumnMatrix()) {
+                    os << vle::value::toColumnMatrixValue(*it->second);
                 }
             }
         }
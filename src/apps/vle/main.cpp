@@ -34,10 +34,13 @@
 #include <vle/utils/Preferences.hpp>
 #include <vle/utils/RemoteManager.hpp>
 #include <vle/utils/i18n.hpp>
+#include <vle/vpz/Partitioner.hpp>
+#include <vle/vpz/Vpz.hpp>
 #include <vle/vle.hpp>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <boost/program_options.hpp>
 
 #ifndef NDEBUG
@@ -193,10 +196,12 @@ static vle::manager::LogOptions convert_log_mode()
 }
 
 static int run_manager(CmdArgs::const_iterator it, CmdArgs::const_iterator end,
-        int processor, vle::utils::Package& pkg)
+        int processor, int rank, int world, bool spawn, bool checkpoint,
+        vle::utils::Package& pkg)
 {
     vle::manager::Manager man(convert_log_mode(),
-                              vle::manager::SIMULATION_NONE |
+                              (spawn ? vle::manager::SIMULATION_SPAWN_PROCESS
+                               : vle::manager::SIMULATION_NONE) |
                               vle::manager::SIMULATION_NO_RETURN,
                               &std::cout);
     vle::utils::ModuleManager modules;
@@ -204,18 +209,43 @@ static int run_manager(CmdArgs::const_iterator it, CmdArgs::const_iterator end,
 
     for (; it != end; ++it) {
         vle::manager::Error error;
-        vle::value::Matrix *res = man.run(new vle::vpz::Vpz(
-                                               search_vpz(*it, pkg)),
-                modules,
-                processor,
-                0,
-                1,
-                &error);
+
+        if (checkpoint)
+            man.setCheckpoint((vle::fmt("%1%_%2%_%3%.results") %
+                               vle::utils::Path::basename(*it) % rank %
+                               world).str());
+
+        vle::value::Matrix *res = 0;
+        try {
+            std::auto_ptr < vle::vpz::Vpz > file(
+                new vle::vpz::Vpz(search_vpz(*it, pkg)));
+
+            res = man.run(file.release(),
+                          modules,
+                          processor,
+                          rank,
+                          world,
+                          &error);
+        } catch (const std::exception &e) {
+            std::cerr << vle::fmt(_("Experimental frames `%1%' throws error"
+                                    " %2%\n")) % (*it) % e.what();
+
+            success = EXIT_FAILURE;
+            continue;
+        }
 
         if (error.code) {
             std::cerr << vle::fmt(_("Experimental frames `%s' throws error %s"))
                 % (*it) % error.message.c_str();
 
+            for (std::size_t i = 0; i < error.combinations.size(); ++i) {
+                std::cerr << vle::fmt(_("\n - combination %1% (%2% s): %3%"))
+                    % error.combinations[i].index
+                    % error.combinations[i].elapsed
+                    % error.combinations[i].message;
+            }
+            std::cerr << '\n';
+
             success = EXIT_FAILURE;
         }
 
@@ -254,6 +284,54 @@ static int run_simulation(CmdArgs::const_iterator it,
     return success;
 }
 
+static int run_partition(CmdArgs::const_iterator it,
+        CmdArgs::const_iterator end, int parts, const std::string &traffic,
+        vle::utils::Package& pkg)
+{
+    int success = EXIT_SUCCESS;
+
+    for (; it != end; ++it) {
+        try {
+            vle::vpz::Vpz file(search_vpz(*it, pkg));
+            vle::vpz::Partitioner partitioner(
+                file.project().model().model());
+
+            if (not traffic.empty()) {
+                std::ifstream in(traffic.c_str());
+                if (not in) {
+                    throw vle::utils::FileError(vle::fmt(
+                            _("Cannot open the traffic file `%1%'")) %
+                        traffic);
+                }
+                partitioner.readTraffic(in);
+            }
+
+            vle::vpz::Partitioner::Partition partition(
+                partitioner.partition(parts));
+            std::vector < double > weights(
+                partitioner.weights(partition, parts));
+
+            std::cout << vle::fmt("# %1%: %2% models, %3% parts, cut %4%\n"
+                                  "# weights") % (*it) %
+                partitioner.models().size() % parts %
+                partitioner.cut(partition);
+            for (std::size_t i = 0; i < weights.size(); ++i) {
+                std::cout << ' ' << weights[i];
+            }
+            std::cout << '\n';
+
+            partitioner.write(std::cout, partition);
+        } catch (const std::exception &e) {
+            std::cerr << vle::fmt(_("Partition of `%1%' throws error %2%\n"))
+                % (*it) % e.what();
+
+            success = EXIT_FAILURE;
+        }
+    }
+
+    return success;
+}
+
 static bool init_package(vle::utils::Package& pkg, const CmdArgs &args)
 {
     if (not pkg.existsBinary()) {
@@ -271,7 +349,10 @@ static bool init_package(vle::utils::Package& pkg, const CmdArgs &args)
 }
 
 static int manage_package_mode(const std::string &packagename, bool manager,
-                               int processor, const CmdArgs &args)
+                               int processor, int rank, int world,
+                               bool spawn, bool checkpoint, int parts,
+                               const std::string &traffic,
+                               const CmdArgs &args)
 {
     CmdArgs::const_iterator it = args.begin();
     CmdArgs::const_iterator end = args.end();
@@ -339,8 +420,11 @@ static int manage_package_mode(const std::string &packagename, bool manager,
     if (stop)
         ret = EXIT_FAILURE;
     else if (it != end) {
-        if (manager)
-            ret = run_manager(it, end, processor, pkg);
+        if (parts > 0)
+            ret = run_partition(it, end, parts, traffic, pkg);
+        else if (manager)
+            ret = run_manager(it, end, processor, rank, world, spawn,
+                              checkpoint, pkg);
         else
             ret = run_simulation(it, end, pkg);
     }
@@ -535,13 +619,19 @@ enum ProgramOptionsCode
 
 struct ProgramOptions
 {
-    ProgramOptions(int *verbose, int *trace, int *processor,
-            bool *manager_mode, std::string *packagename,
-            std::string *remotecmd, std::string *configvar, CmdArgs *args)
+    ProgramOptions(int *verbose, int *trace, int *processor, int *rank,
+            int *world, int *parts,
+            bool *manager_mode, bool *spawn, bool *checkpoint,
+            std::string *packagename,
+            std::string *remotecmd, std::string *configvar,
+            std::string *traffic, CmdArgs *args)
         : generic(_("Allowed options")), hidden(_("Hidden options")),
-        verbose(verbose), trace(trace), processor(processor),
-        manager_mode(manager_mode), packagename(packagename),
-        remotecmd(remotecmd), configvar(configvar), args(args)
+        verbose(verbose), trace(trace), processor(processor), rank(rank),
+        world(world), parts(parts), manager_mode(manager_mode),
+        spawn(spawn), checkpoint(checkpoint),
+        packagename(packagename),
+        remotecmd(remotecmd), configvar(configvar), traffic(traffic),
+        args(args)
     {
         generic.add_options()
             ("help,h", _("Produce help message"))
@@ -556,6 +646,27 @@ struct ProgramOptions
             ("manager,m", _("Use the manager mode to run experimental frames"))
             ("processor,o", po::value < int >(processor)->default_value(1),
              _("Select number of processor in manager mode [>= 0]"))
+            ("spawn", _("Run the simulations of the manager mode in"
+                        " processes instead of threads"))
+            ("rank", po::value < int >(rank)->default_value(0),
+             _("Select the part of the experimental frames to run in manager"
+               " mode [0, world)"))
+            ("world", po::value < int >(world)->default_value(1),
+             _("Select the number of parts of the experimental frames in"
+               " manager mode [>= 1]"))
+            ("checkpoint", _("Save the results of the combinations of the"
+                             " manager mode in the file"
+                             " `name_rank_world.results' of the current"
+                             " directory and skip the combinations already"
+                             " saved by a previous run"))
+            ("partition", po::value < int >(parts)->default_value(0),
+             _("Split the atomic models of the VPZ files of the package into"
+               " the number of parts which minimize the connections between"
+               " the parts and write the parts instead of running the"
+               " simulations"))
+            ("traffic", po::value < std::string >(traffic),
+             _("Weight the partition with the events between the models:"
+               " a file of `source<TAB>target<TAB>events' lines"))
             ("verbose,V", po::value < int >(verbose)->default_value(0),
              ("Verbose mode 0 - 3. [default 0]\n"
               "0 no trace and no long exception\n"
@@ -616,6 +727,12 @@ struct ProgramOptions
             if (vm.count("manager"))
                 *manager_mode = true;
 
+            if (vm.count("spawn"))
+                *spawn = true;
+
+            if (vm.count("checkpoint"))
+                *checkpoint = true;
+
             if (vm.count("input"))
                 *args = vm["input"].as < CmdArgs >();
 
@@ -662,9 +779,9 @@ struct ProgramOptions
 
     po::options_description desc, generic, hidden;
     po::variables_map vm;
-    int *verbose, *trace, *processor;
-    bool *manager_mode;
-    std::string *packagename, *remotecmd, *configvar;
+    int *verbose, *trace, *processor, *rank, *world, *parts;
+    bool *manager_mode, *spawn, *checkpoint;
+    std::string *packagename, *remotecmd, *configvar, *traffic;
     CmdArgs *args;
 };
 
@@ -673,14 +790,22 @@ int main(int argc, char *argv[])
     int ret;
     int verbose = 0;
     int processor = 1;
+    int rank = 0;
+    int world = 1;
+    int parts = 0;
     int trace = -1; /* < 0 = stderr, 0 = file and > 0 = stdout */
     bool manager_mode = false;
-    std::string packagename, remotecmd, configvar;
+    bool spawn = false;
+    bool checkpoint = false;
+    std::string packagename, remotecmd, configvar, traffic;
     CmdArgs args;
 
     {
-        ProgramOptions prgs(&verbose, &trace, &processor, &manager_mode,
-                &packagename, &remotecmd, &configvar, &args);
+        ProgramOptions prgs(&verbose, &trace, &processor, &rank, &world,
+                &parts,
+                &manager_mode, &spawn, &checkpoint, &packagename,
+                &remotecmd, &configvar,
+                &traffic, &args);
 
         ret = prgs.run(argc, argv);
 
@@ -697,7 +822,7 @@ int main(int argc, char *argv[])
     switch (ret) {
     case PROGRAM_OPTIONS_PACKAGE:
         return manage_package_mode(packagename, manager_mode, processor,
-                args);
+                rank, world, spawn, checkpoint, parts, traffic, args);
     case PROGRAM_OPTIONS_REMOTE:
         return manage_remote_mode(remotecmd, args);
     case PROGRAM_OPTIONS_CONFIG:
@@ -0,0 +1,269 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/devs/Aggregation.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Tuple.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+} // anonymous namespace
+
+namespace vle { namespace devs {
+
+void TDigest::add(double value)
+{
+    m_buffer.push_back(value);
+
+    if (m_buffer.size() >= 5 * m_compression) {
+        merge();
+    }
+}
+
+double TDigest::quantile(double q) const
+{
+    merge();
+
+    if (m_centroids.empty()) {
+        return std::numeric_limits < double >::quiet_NaN();
+    }
+
+    if (m_centroids.size() == 1) {
+        return m_centroids.front().first;
+    }
+
+    // The weight of a centroid is spread around its mean: the estimation
+    // interpolates between the centers of two centroids and, at the ends,
+    // between the extreme values and the first and last centroids.
+    double target = std::min(std::max(q, 0.0), 1.0) * m_total;
+    double first = m_centroids.front().second / 2.0;
+
+    if (target < first) {
+        return m_min + (m_centroids.front().first - m_min) * target / first;
+    }
+
+    double center = first;
+    for (std::size_t i = 1; i < m_centroids.size(); ++i) {
+        double next = center + (m_centroids[i - 1].second +
+                                m_centroids[i].second) / 2.0;
+
+        if (target < next) {
+            return m_centroids[i - 1].first +
+                (m_centroids[i].first - m_centroids[i - 1].first) *
+                (target - center) / (next - center);
+        }
+        center = next;
+    }
+
+    double last = m_total - center;
+    return m_centroids.back().first + (m_max - m_centroids.back().first) *
+        std::min((target - center) / last, 1.0);
+}
+
+std::size_t TDigest::centroids() const
+{
+    merge();
+
+    return m_centroids.size();
+}
+
+void TDigest::clear()
+{
+    m_centroids.clear();
+    m_buffer.clear();
+    m_total = 0.0;
+    m_min = 0.0;
+    m_max = 0.0;
+}
+
+double TDigest::scale(double q) const
+{
+    return m_compression * std::asin(std::min(2.0 * q - 1.0, 1.0)) /
+        (2.0 * pi);
+}
+
+void TDigest::merge() const
+{
+    if (m_buffer.empty()) {
+        return;
+    }
+
+    std::sort(m_buffer.begin(), m_buffer.end());
+
+    if (m_total == 0.0) {
+        m_min = m_buffer.front();
+        m_max = m_buffer.back();
+    } else {
+        m_min = std::min(m_min, m_buffer.front());
+        m_max = std::max(m_max, m_buffer.back());
+    }
+
+    std::vector < Centroid > sorted;
+    sorted.reserve(m_centroids.size() + m_buffer.size());
+    {
+        std::vector < Centroid >::const_iterator it = m_centroids.begin();
+        std::vector < double >::const_iterator jt = m_buffer.begin();
+
+        while (it != m_centroids.end() or jt != m_buffer.end()) {
+            if (jt == m_buffer.end() or
+                (it != m_centroids.end() and it->first <= *jt)) {
+                sorted.push_back(*it++);
+            } else {
+                sorted.push_back(Centroid(*jt++, 1.0));
+            }
+        }
+    }
+
+    double total = m_total + m_buffer.size();
+    double cumulated = 0.0;
+
+    m_centroids.clear();
+    m_centroids.push_back(sorted.front());
+
+    // A centroid grows while it covers at most one unit of the scale
+    // k(q) = compression * asin(2q - 1) / (2 pi): the centroids are small
+    // near the extreme quantiles and their number is bounded by the
+    // compression.
+    double start = scale(0.0);
+    for (std::size_t i = 1; i < sorted.size(); ++i) {
+        Centroid& current(m_centroids.back());
+        double weight = current.second + sorted[i].second;
+
+        if (scale((cumulated + weight) / total) - start <= 1.0) {
+            current.first += (sorted[i].first - current.first) *
+                sorted[i].second / weight;
+            current.second = weight;
+        } else {
+            cumulated += current.second;
+            start = scale(cumulated / total);
+            m_centroids.push_back(sorted[i]);
+        }
+    }
+
+    m_total = total;
+    m_buffer.clear();
+}
+
+void Accumulator::add(double value, utils::Rand& rand)
+{
+    if (m_count == 0) {
+        m_min = value;
+        m_max = value;
+    } else {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    ++m_count;
+    m_sum += value;
+
+    switch (m_aggregation) {
+    case vpz::View::AGGREGATE_SAMPLE:
+        // Algorithm R: the n-th observation replaces a sample with the
+        // probability samples / n.
+        if (m_reservoir.size() < m_samples) {
+            m_reservoir.push_back(value);
+        } else {
+            unsigned long index = static_cast < unsigned long >(
+                rand.getDouble() * m_count);
+
+            if (index < m_samples) {
+                m_reservoir[index] = value;
+            }
+        }
+        break;
+    case vpz::View::AGGREGATE_QUANTILE:
+        m_digest.add(value);
+        break;
+    default:
+        break;
+    }
+}
+
+double Accumulator::scalar() const
+{
+    if (m_aggregation == vpz::View::AGGREGATE_COUNT) {
+        return m_count;
+    }
+
+    if (m_count == 0) {
+        return std::numeric_limits < double >::quiet_NaN();
+    }
+
+    switch (m_aggregation) {
+    case vpz::View::AGGREGATE_MEAN:
+        return m_sum / m_count;
+    case vpz::View::AGGREGATE_MIN:
+        return m_min;
+    case vpz::View::AGGREGATE_MAX:
+        return m_max;
+    case vpz::View::AGGREGATE_SUM:
+        return m_sum;
+    case vpz::View::AGGREGATE_QUANTILE:
+        return m_digest.quantile(m_quantile);
+    default:
+        return std::numeric_limits < double >::quiet_NaN();
+    }
+}
+
+value::Value* Accumulator::value() const
+{
+    switch (m_aggregation) {
+    case vpz::View::AGGREGATE_COUNT:
+        return new value::Integer(static_cast < int32_t >(m_count));
+    case vpz::View::AGGREGATE_SAMPLE:
+        if (m_count == 0) {
+            return 0;
+        } else {
+            value::Tuple* samples = new value::Tuple();
+            samples->value().assign(m_reservoir.begin(), m_reservoir.end());
+            return samples;
+        }
+    default:
+        if (m_count == 0) {
+            return 0;
+        }
+        return new value::Double(scalar());
+    }
+}
+
+void Accumulator::clear()
+{
+    m_count = 0;
+    m_sum = 0.0;
+    m_reservoir.clear();
+    m_digest.clear();
+}
+
+}} // namespace vle devs
@@ -0,0 +1,190 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_DEVS_AGGREGATION_HPP
+#define VLE_DEVS_AGGREGATION_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/utils/Rand.hpp>
+#include <vle/value/Value.hpp>
+#include <vle/vpz/View.hpp>
+#include <vector>
+#include <utility>
+
+namespace vle { namespace devs {
+
+/**
+ * @brief A merging t-digest: an estimation of the quantiles of a stream of
+ * real with a bounded memory. The values are summarized by centroids, the
+ * centroids near the extreme quantiles are smaller and the estimation
+ * near 0 and 1 is more accurate than near the median.
+ *
+ * @code
+ * vle::devs::TDigest digest;
+ * for (int i = 0; i < 100000; ++i) {
+ *     digest.add(i);
+ * }
+ * digest.quantile(0.99); // ~ 99000
+ * @endcode
+ */
+class VLE_API TDigest
+{
+public:
+    /**
+     * @brief Build an empty t-digest.
+     * @param compression The number of centroids is at most near the
+     * compression.
+     */
+    TDigest(double compression = 100.0)
+        : m_compression(compression), m_total(0.0), m_min(0.0), m_max(0.0)
+    {}
+
+    /**
+     * @brief Add a value to the t-digest.
+     * @param value The value to add.
+     */
+    void add(double value);
+
+    /**
+     * @brief Estimate a quantile of the values.
+     * @param q The quantile in [0, 1].
+     * @return The estimation, NaN if the t-digest is empty.
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Get the number of values added to the t-digest.
+     * @return The number of values.
+     */
+    double size() const
+    { return m_total + m_buffer.size(); }
+
+    /**
+     * @brief Get the number of centroids after the merge of the values
+     * not yet merged.
+     * @return The number of centroids.
+     */
+    std::size_t centroids() const;
+
+    /**
+     * @brief Remove all the values.
+     */
+    void clear();
+
+private:
+    typedef std::pair < double, double > Centroid; ///< mean and weight.
+
+    /**
+     * The scale function of the size of the centroids.
+     */
+    double scale(double q) const;
+
+    /**
+     * Merge the buffered values into the centroids.
+     */
+    void merge() const;
+
+    double m_compression;
+    mutable std::vector < Centroid > m_centroids; ///< sorted by mean.
+    mutable std::vector < double > m_buffer; ///< values to merge.
+    mutable double m_total; ///< the weight of the centroids.
+    mutable double m_min;
+    mutable double m_max;
+};
+
+/**
+ * @brief The aggregate of the observations of a port during a window of a
+ * View: the mean, the minimum, the maximum, the sum, the number of the
+ * observations, a reservoir sampling or a quantile.
+ */
+class VLE_API Accumulator
+{
+public:
+    /**
+     * @brief Build an empty Accumulator.
+     * @param aggregation The aggregation computed by the Accumulator.
+     * @param samples The size of the reservoir of AGGREGATE_SAMPLE.
+     * @param quantile The quantile of AGGREGATE_QUANTILE.
+     */
+    Accumulator(vpz::View::Aggregation aggregation, unsigned int samples,
+                double quantile)
+        : m_aggregation(aggregation), m_samples(samples),
+        m_quantile(quantile), m_count(0), m_sum(0.0), m_min(0.0),
+        m_max(0.0)
+    {}
+
+    /**
+     * @brief Add an observation to the window.
+     * @param value The observation.
+     * @param rand The generator of the reservoir sampling.
+     */
+    void add(double value, utils::Rand& rand);
+
+    /**
+     * @brief Get the aggregate as a real.
+     * @return The aggregate, the number of observations for
+     * AGGREGATE_COUNT, NaN if the window is empty or for AGGREGATE_SAMPLE.
+     */
+    double scalar() const;
+
+    /**
+     * @brief Build the aggregate: a value::Integer for AGGREGATE_COUNT, a
+     * value::Tuple of the samples for AGGREGATE_SAMPLE, a value::Double
+     * otherwise.
+     * @return The aggregate, NULL if the window is empty, except for
+     * AGGREGATE_COUNT.
+     */
+    value::Value* value() const;
+
+    /**
+     * @brief Get the number of observations of the window.
+     * @return The number of observations.
+     */
+    unsigned long count() const
+    { return m_count; }
+
+    /**
+     * @brief Start a new window.
+     */
+    void clear();
+
+private:
+    vpz::View::Aggregation m_aggregation;
+    unsigned int           m_samples;
+    double                 m_quantile;
+    unsigned long          m_count;
+    double                 m_sum;
+    double                 m_min;
+    double                 m_max;
+    std::vector < double > m_reservoir;
+    TDigest                m_digest;
+};
+
+}} // namespace vle devs
+
+#endif
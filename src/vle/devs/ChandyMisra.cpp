@@ -0,0 +1,445 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/devs/ChandyMisra.hpp>
+#include <vle/devs/details/LogicalProcess.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <algorithm>
+
+namespace vle { namespace devs {
+
+namespace {
+
+using details::VTime;
+using details::Schedule;
+
+/*
+ * A message between logical processes: an event for a model or, for a
+ * null message, the promise of the process that it will not send events
+ * before a time.
+ */
+struct Message : details::Message
+{
+    Message()
+        : null(false), promise(0.0)
+    {}
+
+    bool null;
+    Time promise;
+};
+
+} // anonymous namespace
+
+/*
+ * The devs::ChandyMisra::Pimpl source: the simulators shared by the
+ * logical processes, their inboxes and the lookahead of the models.
+ */
+
+class ChandyMisra::Pimpl : public details::Engine < Message >
+{
+public:
+    class LogicalProcess;
+
+    Pimpl(const vpz::AtomicModelVector& models,
+          const DynamicsFactory& factory)
+        : details::Engine < Message >("ChandyMisra", models, factory)
+    {}
+
+    std::vector < Time > m_lookaheads;
+};
+
+/*
+ * A logical process: the promises received from the processes connected to
+ * it and the promises it sends.
+ */
+
+class ChandyMisra::Pimpl::LogicalProcess
+    : public details::LogicalProcess < Pimpl >
+{
+public:
+    LogicalProcess(Pimpl& engine, std::size_t index, std::size_t processes,
+                   const Time& begin)
+        : details::LogicalProcess < Pimpl >(engine, index),
+        m_inputs(processes, false), m_promises(processes, begin),
+        m_sent(processes, begin), m_boundaries(processes),
+        m_done(engine.m_simulators.size(), false), m_outputsSent(false),
+        m_remote(false)
+    {}
+
+    /**
+     * Declare that a model of this process sends events to the process.
+     */
+    void addBoundary(std::size_t model, std::size_t process)
+    {
+        std::vector < std::size_t >& models(m_boundaries[process]);
+
+        if (std::find(models.begin(), models.end(), model) == models.end()) {
+            models.push_back(model);
+        }
+    }
+
+    /**
+     * Declare that the process sends events to this process.
+     */
+    void addInput(std::size_t process)
+    {
+        m_inputs[process] = true;
+    }
+
+    /**
+     * The thread function: run the dates below the promises of the input
+     * processes and wait for new promises until the end of the simulation.
+     */
+    void simulate()
+    {
+        try {
+            bool wait = false;
+
+            while (not m_engine.failed()) {
+                drain(wait);
+
+                Time bound = inputBound();
+                Time time = nextDate().time;
+
+                /* The events of the other processes are received in a
+                 * bag after the first, the outputs of the first bag can
+                 * be sent as soon as no event is received before. */
+                if (time < m_engine.m_end and not (bound < time) and
+                    not m_outputsSent) {
+                    sendOutputs(time);
+                    m_outputsSent = true;
+                }
+
+                if (time < bound and time < m_engine.m_end) {
+                    sendPromises(time);
+
+                    while (nextDate().time == time) {
+                        step(nextDate());
+                    }
+
+                    for (std::size_t i = 0; i < m_sentModels.size(); ++i) {
+                        m_done[m_sentModels[i]] = false;
+                    }
+                    m_sentModels.clear();
+                    m_outputsSent = false;
+                    wait = false;
+                } else {
+                    sendPromises(std::min(time, bound));
+
+                    if (not (time < m_engine.m_end) and
+                        not (bound < m_engine.m_end)) {
+                        break;
+                    }
+                    m_statistics.blocks++;
+                    wait = true;
+                }
+            }
+        } catch (const std::exception& e) {
+            m_engine.fail(e.what());
+        }
+    }
+
+    ChandyMisra::Statistics m_statistics;
+
+private:
+    std::vector < bool >       m_inputs;
+    std::vector < Time >       m_promises;
+    std::vector < Time >       m_sent;
+    std::vector < std::vector < std::size_t > > m_boundaries;
+    std::vector < bool >       m_done;
+    std::vector < std::size_t > m_sentModels;
+    bool                       m_outputsSent;
+    bool                       m_remote;
+    std::vector < Message >    m_received;
+    std::vector < Message >    m_processed;
+
+    /**
+     * The time before which no event can be received.
+     */
+    Time inputBound() const
+    {
+        Time result = infinity;
+
+        for (std::size_t i = 0; i < m_inputs.size(); ++i) {
+            if (m_inputs[i] and m_promises[i] < result) {
+                result = m_promises[i];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Receive the messages and the promises of the other processes.
+     */
+    void drain(bool wait)
+    {
+        m_received.clear();
+        m_engine.receive(m_index, m_received, wait);
+
+        for (std::vector < Message >::iterator it = m_received.begin();
+             it != m_received.end(); ++it) {
+            if (it->null) {
+                if (m_promises[it->process] < it->promise) {
+                    m_promises[it->process] = it->promise;
+                }
+            } else if (it->key.date.time < m_promises[it->process]) {
+                std::string name(
+                    m_engine.m_simulators[it->key.sender]->getName());
+                for (std::vector < Message >::iterator jt = it;
+                     jt != m_received.end(); ++jt) {
+                    delete jt->event;
+                }
+                m_received.clear();
+                throw utils::ModellingError(fmt(
+                        _("ChandyMisra: the model '%1%' sends an event "
+                          "sooner than its lookahead")) % name);
+            } else {
+                m_pending.insert(std::make_pair(it->key, *it));
+            }
+        }
+        m_received.clear();
+    }
+
+    /**
+     * Send the outputs at the time of the imminent models connected to
+     * other processes: their state cannot change before their output.
+     */
+    void sendOutputs(const Time& time)
+    {
+        VTime date(time, 0);
+
+        for (Schedule::const_iterator it = m_schedule.begin();
+             it != m_schedule.end() and it->first == date; ++it) {
+            std::size_t model = it->second;
+
+            if (not isInfinity(m_engine.m_lookaheads[model])) {
+                m_outputs.clear();
+                m_engine.m_simulators[model]->output(time, m_outputs);
+                m_remote = true;
+                route(model, date);
+                m_done[model] = true;
+                m_sentModels.push_back(model);
+            }
+        }
+    }
+
+    /**
+     * Send to each output process the time before which the process will
+     * not send events, if it increases: @e base is the time before which
+     * this process does not receive or run events.
+     */
+    void sendPromises(const Time& base)
+    {
+        for (std::size_t p = 0; p < m_boundaries.size(); ++p) {
+            const std::vector < std::size_t >& models(m_boundaries[p]);
+            if (models.empty()) {
+                continue;
+            }
+
+            Time promise = infinity;
+            for (std::size_t i = 0; i < models.size(); ++i) {
+                std::size_t model = models[i];
+                Time next = base + m_engine.m_lookaheads[model];
+
+                if (not m_done[model] and
+                    m_engine.m_next[model].time < next) {
+                    next = m_engine.m_next[model].time;
+                }
+                promise = std::min(promise, next);
+            }
+
+            if (m_sent[p] < promise) {
+                Message msg;
+                msg.process = m_index;
+                msg.null = true;
+                msg.promise = promise;
+                m_engine.post(p, msg);
+                m_sent[p] = promise;
+                m_statistics.nulls++;
+            }
+        }
+    }
+
+    /**
+     * Run the bag of the date: the outputs of the models connected to
+     * other processes are already sent by sendOutputs().
+     */
+    void step(const VTime& date)
+    {
+        m_processed.clear();
+        collect(date, m_processed);
+
+        std::vector < Message >::const_iterator msg = m_processed.begin();
+
+        for (std::vector < std::size_t >::const_iterator it =
+             m_affected.begin(); it != m_affected.end(); ++it) {
+            std::size_t model = *it;
+            bool internal = m_engine.m_next[model] == date;
+
+            externals(model, msg, m_processed.end());
+
+            if (internal and not m_done[model]) {
+                m_outputs.clear();
+                m_engine.m_simulators[model]->output(date.time, m_outputs);
+                m_remote = false;
+                route(model, date);
+            }
+
+            transition(model, date, internal);
+            m_statistics.transitions++;
+        }
+
+        for (std::vector < Message >::iterator it = m_processed.begin();
+             it != m_processed.end(); ++it) {
+            delete it->event;
+        }
+        m_processed.clear();
+    }
+
+    /**
+     * Post the events for the other processes: only the outputs sent by
+     * sendOutputs() may reach them, the others are sooner than the
+     * lookahead.
+     */
+    void send(std::size_t process, const Message& msg)
+    {
+        if (process == m_index) {
+            return;
+        }
+
+        if (not m_remote) {
+            delete msg.event;
+            throw utils::ModellingError(fmt(
+                    _("ChandyMisra: the model '%1%' sends an event "
+                      "sooner than its lookahead")) %
+                m_engine.m_simulators[msg.key.sender]->getName());
+        }
+        m_engine.post(process, msg);
+        m_statistics.messages++;
+    }
+};
+
+/*
+ * The devs::ChandyMisra source.
+ */
+
+ChandyMisra::ChandyMisra(vpz::CoupledModel* top,
+                         const DynamicsFactory& factory,
+                         std::size_t processes)
+    : mImpl(0), m_processes(processes)
+{
+    if (processes == 0) {
+        throw utils::ArgError(_("ChandyMisra: at least one process"));
+    }
+
+    vpz::BaseModel::getAtomicModelList(top, m_models);
+    mImpl = new Pimpl(m_models, factory);
+    details::defaultPartition(m_models.size(), processes, m_partition);
+}
+
+ChandyMisra::~ChandyMisra()
+{
+    delete mImpl;
+}
+
+void ChandyMisra::setPartition(const std::vector < std::size_t >& partition)
+{
+    details::checkPartition("ChandyMisra", m_models, partition, m_processes);
+    m_partition = partition;
+}
+
+Dynamics* ChandyMisra::dynamics(const vpz::AtomicModel* model) const
+{
+    return mImpl->dynamics(model);
+}
+
+void ChandyMisra::run(const Time& begin, const Time& duration)
+{
+    typedef Pimpl::LogicalProcess LogicalProcess;
+
+    Pimpl& engine(*mImpl);
+    details::Processes < Pimpl, LogicalProcess > processes(engine);
+
+    engine.reset(m_partition, begin + duration);
+    engine.m_lookaheads.assign(m_models.size(), infinity);
+    engine.openInboxes(m_processes);
+    m_statistics = Statistics();
+
+    for (std::size_t i = 0; i < m_processes; ++i) {
+        processes.push_back(new LogicalProcess(engine, i, m_processes,
+                                               begin));
+    }
+
+    /* The models connected to another process are the boundaries of their
+     * process, their lookahead is infinity for the others. */
+    for (std::size_t i = 0, e = m_models.size(); i != e; ++i) {
+        Simulator* sim = engine.m_simulators[i];
+        std::size_t process = m_partition[i];
+
+        for (Simulator::size_type p = 0; p < sim->outputPortNumber(); ++p) {
+            std::pair < Simulator::const_iterator,
+                Simulator::const_iterator > targets =
+                    sim->targets(p, engine.m_map);
+
+            for (Simulator::const_iterator it = targets.first;
+                 it != targets.second; ++it) {
+                std::size_t target = m_partition[it->first->id()];
+                if (target == process) {
+                    continue;
+                }
+
+                Time lookahead = engine.m_dynamics[i]->lookahead();
+                if (not (lookahead > 0.0)) {
+                    throw utils::ModellingError(fmt(
+                            _("ChandyMisra: the model '%1%' is connected "
+                              "to another process without a positive "
+                              "lookahead")) % sim->getName());
+                }
+                engine.m_lookaheads[i] = lookahead;
+                processes[process]->addBoundary(i, target);
+                processes[target]->addInput(process);
+            }
+        }
+    }
+
+    engine.init(begin, processes);
+    engine.simulate(processes);
+
+    for (std::size_t i = 0; i < m_processes; ++i) {
+        const Statistics& stats(processes[i]->m_statistics);
+        m_statistics.transitions += stats.transitions;
+        m_statistics.messages += stats.messages;
+        m_statistics.nulls += stats.nulls;
+        m_statistics.blocks += stats.blocks;
+    }
+
+    engine.finish();
+}
+
+}} // namespace vle devs
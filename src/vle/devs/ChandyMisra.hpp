@@ -0,0 +1,172 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_CHANDYMISRA_HPP
+#define VLE_DEVS_CHANDYMISRA_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/Time.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <boost/function.hpp>
+#include <vector>
+
+namespace vle { namespace devs {
+
+class Dynamics;
+
+/**
+ * @brief A conservative (Chandy-Misra-Bryant) simulation engine. The
+ * atomic models of a coupled model are split into logical processes, each
+ * one runs in its own thread with its own event list. A process only runs
+ * the dates below the promises of the processes connected to it: no
+ * rollback is needed.
+ *
+ * The promise of a process is derived from the lookahead of its models
+ * connected to other processes (Dynamics::lookahead): such a model does
+ * not send an output sooner than its lookahead after an event. The
+ * promises are sent with null messages when the process is blocked or
+ * after each date. The outputs of these models at a date are sent before
+ * the date is processed, so the processes can run the same date in
+ * parallel.
+ *
+ * The engine produces the same transitions as the devs::Coordinator. The
+ * external events of a bag are ordered by sender, not in the order of the
+ * Coordinator: the models must not depend on the order of the events of a
+ * bag. Executives and views are not supported.
+ *
+ * @code
+ * vle::devs::ChandyMisra engine(top, factory, 4);
+ * engine.setPartition(partitioner.partition(4));
+ * engine.run(0.0, 100.0);
+ * @endcode
+ */
+class VLE_API ChandyMisra
+{
+public:
+    /**
+     * @brief Build the Dynamics of an atomic model. The Dynamics must be
+     * thread-safe.
+     */
+    typedef boost::function < Dynamics* (const vpz::AtomicModel&) >
+        DynamicsFactory;
+
+    /**
+     * @brief Counters of the last run().
+     */
+    struct Statistics
+    {
+        Statistics()
+            : transitions(0), messages(0), nulls(0), blocks(0)
+        {}
+
+        unsigned long transitions; /**< number of transitions. */
+        unsigned long messages; /**< events sent to other processes. */
+        unsigned long nulls; /**< null messages sent. */
+        unsigned long blocks; /**< waits of a process for a promise. */
+    };
+
+    /**
+     * @brief Build the simulators of all the atomic models of the coupled
+     * model. The models are split into @e processes blocks of consecutive
+     * models in the order of vpz::BaseModel::getAtomicModelList.
+     * @param top The coupled model to simulate.
+     * @param factory The builder of the Dynamics.
+     * @param processes The number of logical processes.
+     * @throw utils::ArgError if processes is 0.
+     */
+    ChandyMisra(vpz::CoupledModel* top, const DynamicsFactory& factory,
+                std::size_t processes);
+
+    /**
+     * @brief Delete the simulators and the Dynamics.
+     */
+    ~ChandyMisra();
+
+    /**
+     * @brief Get the atomic models in the order used by the partition.
+     * @return The list of the atomic models.
+     */
+    const vpz::AtomicModelVector& models() const
+    { return m_models; }
+
+    /**
+     * @brief Assign the logical process of each atomic model, for example
+     * a partition of the vpz::Partitioner.
+     * @param partition The process of each model of models().
+     * @throw utils::ArgError if the size of partition is not the number
+     * of models or if a process is greater than the number of processes.
+     */
+    void setPartition(const std::vector < std::size_t >& partition);
+
+    /**
+     * @brief Get the logical process of each atomic model.
+     * @return The process of each model of models().
+     */
+    const std::vector < std::size_t >& partition() const
+    { return m_partition; }
+
+    /**
+     * @brief Initialize the models at the date @e begin and run all the
+     * bags before @e begin + @e duration.
+     * @param begin The date of the beginning of the simulation.
+     * @param duration The duration of the simulation.
+     * @throw utils::ModellingError if a model fails, if a model connected
+     * to another process has no positive lookahead or sends an event
+     * sooner than its lookahead.
+     */
+    void run(const Time& begin, const Time& duration);
+
+    /**
+     * @brief Get the Dynamics of an atomic model, for example to read the
+     * final state of the model after run().
+     * @param model The atomic model.
+     * @return The Dynamics or 0 if the model is unknown.
+     */
+    Dynamics* dynamics(const vpz::AtomicModel* model) const;
+
+    /**
+     * @brief Get the counters of the last run().
+     * @return The counters.
+     */
+    const Statistics& statistics() const
+    { return m_statistics; }
+
+private:
+    ChandyMisra(const ChandyMisra& other);
+    ChandyMisra& operator=(const ChandyMisra& other);
+
+    class Pimpl;
+    Pimpl*                      mImpl;
+    vpz::AtomicModelVector      m_models;
+    std::vector < std::size_t > m_partition;
+    std::size_t                 m_processes;
+    Statistics                  m_statistics;
+};
+
+}} // namespace vle devs
+
+#endif
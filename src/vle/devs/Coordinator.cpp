@@ -36,7 +36,11 @@
 #include <vle/vpz/BaseModel.hpp>
 #include <vle/vpz/AtomicModel.hpp>
 #include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Experiment.hpp>
 #include <vle/utils/Trace.hpp>
+#include <vle/utils/ThreadPool.hpp>
+#include <vle/utils/Exception.hpp>
+#include <fstream>
 #include <functional>
 #include <boost/bind.hpp>
 
@@ -47,23 +51,190 @@ using std::pair;
 
 namespace vle { namespace devs {
 
+namespace {
+
+/*
+ * An unused counter of the traffic table.
+ */
+const size_t NO_TRAFFIC = static_cast < size_t >(-1);
+
+/*
+ * Copy the exception being handled. boost::current_exception() slices the
+ * classes derived from the standard exceptions: the vle errors are copied
+ * with their type.
+ */
+boost::exception_ptr currentError()
+{
+    try {
+        throw;
+    } catch (const utils::FileError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::ParseError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::ArgError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::CastError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::InternalError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::ModellingError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::NotYetImplemented& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::DevsGraphError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::VpzError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::SaxParserError& e) {
+        return boost::copy_exception(e);
+    } catch (const utils::BaseError& e) {
+        return boost::copy_exception(e);
+    } catch (...) {
+        return boost::current_exception();
+    }
+}
+
+}
+
+Coordinator::Coordinator(const utils::ModuleManager& modulemgr,
+                         const vpz::Dynamics& dyn,
+                         const vpz::Classes& cls,
+                         const vpz::Experiment& experiment,
+                         RootCoordinator& root)
+    : m_currentTime(0.0), m_pool(0),
+      m_modelFactory(modulemgr, dyn, cls, experiment, root),
+      m_toDelete(0), m_modulemgr(modulemgr), m_isStarted(false),
+      m_trafficSize(0), m_nbParallelBags(0)
+{
+    initSettings(experiment);
+}
+
 Coordinator::Coordinator(const utils::ModuleManager& modulemgr,
                          const vpz::Dynamics& dyn,
                          const vpz::Classes& cls,
                          const vpz::Experiment& experiment,
+                         const vpz::Conditions& overlay,
+                         const std::string& name,
                          RootCoordinator& root)
-    : m_currentTime(0.0), m_modelFactory(modulemgr, dyn, cls, experiment, root),
-      m_modulemgr(modulemgr), m_isStarted(false)
+    : m_currentTime(0.0), m_pool(0),
+      m_modelFactory(modulemgr, dyn, cls, experiment, overlay, name, root),
+      m_toDelete(0), m_modulemgr(modulemgr), m_isStarted(false),
+      m_trafficSize(0), m_nbParallelBags(0)
+{
+    initSettings(m_modelFactory.engine());
+}
+
+void Coordinator::initSettings(const vpz::Experiment& experiment)
+{
+    std::string scheduler = experiment.scheduler();
+
+    if (not scheduler.empty()) {
+        m_eventTable.setSchedulerType(schedulerTypeFromName(scheduler));
+    }
+
+    if (experiment.threads() > 1) {
+        m_pool = new utils::ThreadPool(experiment.threads());
+    }
+
+    m_trafficFile = experiment.traffic();
+}
+
+void Coordinator::countTraffic(size_t source, size_t target)
+{
+    if (m_trafficSize * 2 >= m_traffic.size()) {
+        TrafficTable table;
+        TrafficCounter empty = { NO_TRAFFIC, NO_TRAFFIC, 0 };
+
+        table.swap(m_traffic);
+        m_traffic.assign(std::max < TrafficTable::size_type >(
+                64, table.size() * 2), empty);
+        m_trafficSize = 0;
+
+        for (TrafficTable::const_iterator it = table.begin();
+             it != table.end(); ++it) {
+            if (it->source != NO_TRAFFIC) {
+                trafficCounter(it->source, it->target).events = it->events;
+            }
+        }
+    }
+
+    ++trafficCounter(source, target).events;
+}
+
+Coordinator::TrafficCounter& Coordinator::trafficCounter(size_t source,
+                                                         size_t target)
+{
+    TrafficTable::size_type mask = m_traffic.size() - 1;
+    uint64_t hash = (static_cast < uint64_t >(source) << 32 ^ target) *
+        0x9e3779b97f4a7c15ULL;
+    TrafficTable::size_type i = static_cast < TrafficTable::size_type >(
+        hash ^ hash >> 32) & mask;
+
+    while (m_traffic[i].source != NO_TRAFFIC and
+           (m_traffic[i].source != source or
+            m_traffic[i].target != target)) {
+        i = (i + 1) & mask;
+    }
+
+    if (m_traffic[i].source == NO_TRAFFIC) {
+        m_traffic[i].source = source;
+        m_traffic[i].target = target;
+        ++m_trafficSize;
+    }
+
+    return m_traffic[i];
+}
+
+void Coordinator::flushTraffic()
+{
+    for (TrafficTable::const_iterator it = m_traffic.begin();
+         it != m_traffic.end(); ++it) {
+        if (it->source == NO_TRAFFIC or not m_simulators[it->source] or
+            not m_simulators[it->target] or
+            not m_simulators[it->source]->getStructure() or
+            not m_simulators[it->target]->getStructure()) {
+            continue;
+        }
+        m_trafficNames[std::make_pair(
+                m_simulators[it->source]->getStructure()->getCompleteName(),
+                m_simulators[it->target]->getStructure()->getCompleteName())]
+            += it->events;
+    }
+    m_traffic.clear();
+    m_trafficSize = 0;
+}
+
+void Coordinator::writeTraffic()
 {
+    flushTraffic();
+
+    std::ofstream file(m_trafficFile.c_str());
+    if (not file) {
+        throw utils::FileError(fmt(
+                _("Coordinator: cannot open traffic file '%1%'")) %
+            m_trafficFile);
+    }
+
+    for (TrafficNameMap::const_iterator it = m_trafficNames.begin();
+         it != m_trafficNames.end(); ++it) {
+        file << it->first.first << '\t' << it->first.second << '\t'
+             << it->second << '\n';
+    }
+
+    if (not file) {
+        throw utils::FileError(fmt(
+                _("Coordinator: cannot write traffic file '%1%'")) %
+            m_trafficFile);
+    }
 }
 
 Coordinator::~Coordinator()
 {
-    std::for_each(m_modelList.begin(),
-                  m_modelList.end(),
-                  boost::bind(
-                      boost::checked_deleter < Simulator >(),
-                      boost::bind(&SimulatorMap::value_type::second, _1)));
+    delete m_pool;
+
+    std::for_each(m_simulators.begin(),
+                  m_simulators.end(),
+                  boost::checked_deleter < Simulator >());
 
     std::for_each(m_viewList.begin(),
                   m_viewList.end(),
@@ -85,11 +256,20 @@ void Coordinator::init(const vpz::Model& mdls, const Time& current,
 
 const Time& Coordinator::getNextTime()
 {
-    return m_eventTable.topEvent();
+    const Time& next = m_eventTable.topEvent();
+
+    return m_clock.nextTime() < next ? m_clock.nextTime() : next;
 }
 
 void Coordinator::run()
 {
+    // The observations of a date follow the transitions of this date.
+    if (m_clock.nextTime() < m_eventTable.topEvent()) {
+        updateCurrentTime(m_clock.nextTime());
+        m_clock.run(m_currentTime);
+        return;
+    }
+
     DTraceDevs(_("-------- BAG --------"));
     SimulatorList::size_type oldToDelete(m_toDelete);
 
@@ -99,24 +279,33 @@ void Coordinator::run()
     }
 
     while (not bags.emptyBag()) {
-        std::map < Simulator*, EventBagModel >::value_type& bag(bags.topBag());
-        if (not bag.second.emptyInternal()) {
-            if (not bag.second.emptyExternal()) {
-                processConflictEvents(bag.first, bag.second);
-            } else {
-                processInternalEvent(bag.first, bag.second);
-            }
+        EventBagModel& bag(bags.topBag());
+
+        if (m_pool and not bag.simulator()->dynamics()->isExecutive()) {
+            addParallelBag(bag);
         } else {
-            if (not bag.second.emptyExternal()) {
-                processExternalEvents(bag.first, bag.second);
+            // The executives are the last bags and can modify the graph:
+            // the bags of the models are processed before.
+            if (m_nbParallelBags) {
+                processParallelBags();
             }
+            processBag(bag);
         }
     }
 
+    if (m_nbParallelBags) {
+        processParallelBags();
+    }
+
     if (oldToDelete > 0) {
+        if (m_trafficSize > 0) {
+            flushTraffic();
+        }
+
         for (SimulatorList::iterator it = m_deletedSimulator.begin();
              it != m_deletedSimulator.begin() + oldToDelete; ++it) {
             m_eventTable.delModelEvents(*it);
+            m_freeIds.push_back((*it)->id());
             delete *it;
             *it = 0;
         }
@@ -127,39 +316,27 @@ void Coordinator::run()
         m_toDelete = m_deletedSimulator.size();
     }
 
-    if (not bags.emptyStates()) {
-        if (getNextTime() == bags.topObservationEvent()->getTime()) {
-            m_obsEventBuffer.insert(bags.states().begin(),
-                                    bags.states().end());
-            bags.states().clear();
-        } else {
-            processViewEvents(bags.states());
-            processViewEvents(m_obsEventBuffer);
-            bags.states().erase();
-            m_obsEventBuffer.erase();
-        }
-    } else if (not m_obsEventBuffer.empty()) {
-        if (getNextTime() != m_obsEventBuffer.front()->getTime()) {
-            processViewEvents(m_obsEventBuffer);
-            m_obsEventBuffer.erase();
-        }
-    }
-
     bags.clear();
 }
 
 void Coordinator::finish()
 {
-    std::for_each(m_modelList.begin(), m_modelList.end(),
-                  boost::bind(
-                      &Simulator::finish,
-                      boost::bind(&SimulatorMap::value_type::second, _1)));
+    for (SimulatorList::iterator it = m_simulators.begin();
+         it != m_simulators.end(); ++it) {
+        if (*it) {
+            (*it)->finish();
+        }
+    }
 
     std::for_each(m_viewList.begin(), m_viewList.end(),
                   boost::bind(
                       &View::finish,
                       boost::bind(&ViewList::value_type::second, _1),
                       m_currentTime));
+
+    if (not m_trafficFile.empty()) {
+        writeTraffic();
+    }
 }
 
 //
@@ -320,6 +497,15 @@ void Coordinator::addModel(vpz::AtomicModel* model, Simulator* simulator)
                     "The Atomic model node '%1% have already a simulator"))
             % model->getName());
     }
+
+    if (m_freeIds.empty()) {
+        simulator->setId(m_simulators.size());
+        m_simulators.push_back(simulator);
+    } else {
+        simulator->setId(m_freeIds.back());
+        m_freeIds.pop_back();
+        m_simulators[simulator->id()] = simulator;
+    }
 }
 
 Simulator* Coordinator::getModel(const vpz::AtomicModel* model) const
@@ -331,12 +517,11 @@ Simulator* Coordinator::getModel(const vpz::AtomicModel* model) const
 
 Simulator* Coordinator::getModel(const std::string& name) const
 {
-    SimulatorMap::const_iterator it = m_modelList.begin();
-    while (it != m_modelList.end()) {
-        if ((*it).first->getName() == name) {
-            return (*it).second;
+    for (SimulatorList::const_iterator it = m_simulators.begin();
+         it != m_simulators.end(); ++it) {
+        if (*it and (*it)->getName() == name) {
+            return *it;
         }
-        ++it;
     }
     return 0;
 }
@@ -365,7 +550,11 @@ void Coordinator::delAtomicModel(vpz::AtomicModel* atom)
     }
 
     Simulator* satom = (*it).second;
+    if (m_trafficSize > 0) {
+        flushTraffic();
+    }
     m_modelList.erase(it);
+    m_simulators[satom->id()] = 0;
 
     std::map < std::string , View* >::iterator it2;
     for (it2 = m_viewList.begin(); it2 != m_viewList.end();
@@ -377,8 +566,6 @@ void Coordinator::delAtomicModel(vpz::AtomicModel* atom)
     satom->clear();
     m_deletedSimulator.push_back(satom);
 
-    m_obsEventBuffer.remove(satom);
-
     ++m_toDelete;
 }
 
@@ -410,15 +597,18 @@ void Coordinator::dispatchExternalEvent(ExternalEventList& eventList,
     for (ExternalEventList::iterator it = eventList.begin(); it !=
          eventList.end(); ++it) {
 
-        std::pair < Simulator::iterator, Simulator::iterator > x;
-        x = sim->targets((*it)->getPortName(), m_modelList);
+        std::pair < Simulator::const_iterator, Simulator::const_iterator > x;
+        x = sim->targets(**it, m_modelList);
 
-        if (x.first != x.second and x.first->second.first) {
-            for (Simulator::iterator jt = x.first; jt != x.second; ++jt) {
-                m_eventTable.putExternalEvent(
-                    new ExternalEvent(*(*it),
-                                      jt->second.first,
-                                      jt->second.second));
+        for (Simulator::const_iterator jt = x.first; jt != x.second; ++jt) {
+            m_eventTable.putExternalEvent(
+                new ExternalEvent(*(*it), jt->first, jt->second));
+        }
+
+        if (not m_trafficFile.empty()) {
+            for (Simulator::const_iterator jt = x.first; jt != x.second;
+                 ++jt) {
+                countTraffic(sim->id(), jt->first->id());
             }
         }
 
@@ -429,8 +619,9 @@ void Coordinator::dispatchExternalEvent(ExternalEventList& eventList,
 
 void Coordinator::buildViews()
 {
-    const vpz::Outputs& outs(m_modelFactory.outputs());
-    const vpz::Views& views(m_modelFactory.views());
+    const ModelFactory& factory(m_modelFactory); // do not copy the views.
+    const vpz::Outputs& outs(factory.outputs());
+    const vpz::Views& views(factory.views());
     const vpz::ViewList& viewlist(views.viewlist());
 
     for (vpz::ViewList::const_iterator it = viewlist.begin();
@@ -445,8 +636,7 @@ void Coordinator::buildViews()
                                          it->second.timestep());
             m_timedViewList[it->second.name()] = v;
             obs = v;
-            m_eventTable.putObservationEvent(
-                new ViewEvent(obs, m_currentTime));
+            m_clock.add(v, m_currentTime);
         } else if (it->second.type() == vpz::View::EVENT) {
             EventView* v = new EventView(it->second.name(), stream);
             m_eventViewList[it->second.name()] = v;
@@ -455,9 +645,10 @@ void Coordinator::buildViews()
             FinishView* v = new devs::FinishView(it->second.name(), stream);
             m_finishViewList[it->second.name()] = v;
             obs = v;
-            m_eventTable.putObservationEvent(
-                new ViewEvent(obs, m_durationTime));
+            m_clock.add(v, m_durationTime);
         }
+        obs->setCache(&m_cache);
+        obs->setAggregation(it->second);
         m_viewList[it->second.name()] = obs;
         stream->setView(obs);
     }
@@ -468,13 +659,20 @@ StreamWriter* Coordinator::buildOutput(const vpz::View& view,
 {
     StreamWriter* stream = new StreamWriter(m_modulemgr);
 
-    std::string file((fmt("%1%_%2%") %
-                      m_modelFactory.experiment().name() %
+    const ModelFactory& factory(m_modelFactory);
+    std::string file((fmt("%1%_%2%") % factory.name() %
                       view.name()).str());
 
     stream->open(output.plugin(), output.package(), output.location(), file,
                  (output.data()) ? output.data()->clone() : 0, m_currentTime);
 
+    try {
+        stream->setQueue(factory.engine().observationQueue());
+    } catch (...) {
+        delete stream;
+        throw;
+    }
+
     return stream;
 }
 
@@ -484,11 +682,8 @@ void Coordinator::processInternalEvent(
 {
     const InternalEvent* ev = modelbag.internal();
 
-    {
-        ExternalEventList result;
-        sim->output(m_currentTime, result);
-        dispatchExternalEvent(result, sim);
-    }
+    sim->output(m_currentTime, m_outputs);
+    dispatchExternalEvent(m_outputs, sim);
 
     {
         InternalEvent* internal(sim->internalTransition(*ev));
@@ -520,11 +715,8 @@ void Coordinator::processConflictEvents(
     Simulator* sim,
     const EventBagModel& modelbag)
 {
-    {
-        ExternalEventList result;
-        sim->output(m_currentTime, result);
-        dispatchExternalEvent(result, sim);
-    }
+    sim->output(m_currentTime, m_outputs);
+    dispatchExternalEvent(m_outputs, sim);
 
     InternalEvent* internal = sim->confluentTransitions(
         *modelbag.internal(), modelbag.externals());
@@ -536,25 +728,131 @@ void Coordinator::processConflictEvents(
     }
 }
 
-void Coordinator::processEventView(Simulator* model)
+void Coordinator::processBag(EventBagModel& bag)
+{
+    if (not bag.emptyInternal()) {
+        if (not bag.emptyExternal()) {
+            processConflictEvents(bag.simulator(), bag);
+        } else {
+            processInternalEvent(bag.simulator(), bag);
+        }
+    } else {
+        if (not bag.emptyExternal()) {
+            processExternalEvents(bag.simulator(), bag);
+        }
+    }
+}
+
+void Coordinator::addParallelBag(EventBagModel& bag)
 {
-    for (EventViewList::iterator it = m_eventViewList.begin(); it !=
-         m_eventViewList.end(); ++it) {
+    if (m_nbParallelBags == m_parallelBags.size()) {
+        m_parallelBags.push_back(ParallelBag());
+    }
+
+    ParallelBag& job = m_parallelBags[m_nbParallelBags++];
+    Simulator* sim = bag.simulator();
+
+    job.bag = &bag;
+    job.internal = 0;
+    job.error = boost::exception_ptr();
+
+    // An event view observes the models of the view between two
+    // transitions: the observed models keep the serial order.
+    job.parallel = sim->dynamics()->isThreadSafe() and
+        sim->eventViews().empty();
+}
+
+void Coordinator::runParallelBag(std::size_t index)
+{
+    ParallelBag& job = *m_parallelJobs[index];
+    const EventBagModel& bag = *job.bag;
+    Simulator* sim = bag.simulator();
+
+    try {
+        if (not bag.emptyInternal()) {
+            sim->output(m_currentTime, job.outputs);
+
+            if (not bag.emptyExternal()) {
+                job.internal = sim->confluentTransitions(*bag.internal(),
+                                                         bag.externals());
+            } else {
+                job.internal = sim->internalTransition(*bag.internal());
+            }
+        } else if (not bag.emptyExternal()) {
+            job.internal = sim->externalTransition(bag.externals(),
+                                                   m_currentTime);
+        }
+    } catch (...) {
+        job.error = currentError();
+    }
+}
+
+void Coordinator::releaseParallelBags(
+    std::vector < ParallelBag >::size_type first,
+    std::vector < ParallelBag >::size_type last)
+{
+    for (std::vector < ParallelBag >::size_type i = first; i < last; ++i) {
+        ParallelBag& job = m_parallelBags[i];
+
+        for (ExternalEventList::iterator it = job.outputs.begin();
+             it != job.outputs.end(); ++it) {
+            delete *it;
+        }
+        job.outputs.clear();
+        delete job.internal;
+        job.internal = 0;
+        job.error = boost::exception_ptr();
+    }
+}
 
-        if (it->second->exist(model)) {
-            it->second->run(m_currentTime);
+void Coordinator::processParallelBags()
+{
+    m_parallelJobs.clear();
+    for (std::vector < ParallelBag >::size_type i = 0; i < m_nbParallelBags;
+         ++i) {
+        if (m_parallelBags[i].parallel) {
+            m_parallelJobs.push_back(&m_parallelBags[i]);
+        }
+    }
+
+    m_pool->run(boost::bind(&Coordinator::runParallelBag, this, _1),
+                m_parallelJobs.size());
+
+    // Merge the results in the order of the bags, as the serial loop does.
+    std::vector < ParallelBag >::size_type nb = m_nbParallelBags;
+    m_nbParallelBags = 0;
+
+    for (std::vector < ParallelBag >::size_type i = 0; i < nb; ++i) {
+        ParallelBag& job = m_parallelBags[i];
+
+        if (job.parallel) {
+            if (job.error) {
+                // The bags already merged belong to the EventTable, the
+                // others are released before the exception of the model.
+                boost::exception_ptr error(job.error);
+                releaseParallelBags(i, nb);
+                boost::rethrow_exception(error);
+            }
+
+            m_cache.invalidate(job.bag->simulator());
+            dispatchExternalEvent(job.outputs, job.bag->simulator());
+            if (job.internal) {
+                m_eventTable.putInternalEvent(job.internal);
+            }
+        } else {
+            processBag(*job.bag);
         }
     }
 }
 
-void Coordinator::processViewEvents(ViewEventList& bag)
+void Coordinator::processEventView(Simulator* model)
 {
-    for (ViewEventList::iterator it = bag.begin(); it != bag.end(); ++it) {
-        (*it)->run(m_currentTime);
-        (*it)->update(m_currentTime);
+    m_cache.invalidate(model);
+
+    const std::vector < View* >& views(model->eventViews());
 
-        m_eventTable.putObservationEvent(
-            new ViewEvent((*it)->getView(), (*it)->getTime()));
+    for (std::vector < View* >::size_type i = 0; i < views.size(); ++i) {
+        views[i]->run(m_currentTime);
     }
 }
 
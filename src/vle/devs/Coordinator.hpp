@@ -31,9 +31,18 @@
 #include <vle/DllDefines.hpp>
 #include <vle/devs/Simulator.hpp>
 #include <vle/devs/EventTable.hpp>
+#include <vle/devs/ObservationCache.hpp>
+#include <vle/devs/ObservationClock.hpp>
 #include <vle/devs/View.hpp>
 #include <vle/devs/Time.hpp>
 #include <vle/devs/ModelFactory.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace vle { namespace utils {
+
+class ThreadPool;
+
+}} // namespace vle utils
 
 namespace vle { namespace devs {
 
@@ -57,6 +66,19 @@ public:
                 const vpz::Experiment& experiment,
                 RootCoordinator& root);
 
+    /**
+     * @brief Build a Coordinator which shares the dynamics, the classes
+     * and the experiment of a combination of an experimental frame, see
+     * ModelFactory.
+     */
+    Coordinator(const utils::ModuleManager& modulemgr,
+                const vpz::Dynamics& dyn,
+                const vpz::Classes& cls,
+                const vpz::Experiment& experiment,
+                const vpz::Conditions& overlay,
+                const std::string& name,
+                RootCoordinator& root);
+
     ~Coordinator();
 
     /**
@@ -86,7 +108,9 @@ public:
 
     /**
      * @brief Delete all devs::Simulator and all devs::View of this
-     * simulator.
+     * simulator. If the simulation engine condition defines a traffic
+     * file, write the number of events sent through each connection.
+     * @throw utils::FileError if the traffic file cannot be written.
      */
     void finish();
 
@@ -190,7 +214,8 @@ public:
 
     /**
      * @brief Attach the specified simulator to the vpz::AtomicModel and
-     * install it on bus.
+     * install it on bus. The simulator receives the first free index of
+     * the dense list of simulators.
      * @param model
      * @param simulator
      */
@@ -238,6 +263,14 @@ public:
     inline const SimulatorMap& modellist() const
     { return m_modelList; }
 
+    /**
+     * @brief Get the simulators indexed by devs::Simulator::id(). The
+     * indexes of the deleted simulators are NULL until reused.
+     * @return A constant reference to the dense list of simulators.
+     */
+    inline const SimulatorList& simulators() const
+    { return m_simulators; }
+
     /**
      * @brief Get a constant reference to the list of vpz::Dynamics objects.
      * @return A constant reference to the list of vpz::Dynamics objects.
@@ -266,6 +299,14 @@ public:
     vpz::Conditions& conditions()
     { return m_modelFactory.conditions(); }
 
+    /**
+     * @brief Get the experiment which gives the settings of the simulation
+     * engine, with the ports of the overlay of the combination.
+     * @return A constant reference to the vpz::Experiment.
+     */
+    const vpz::Experiment& engine() const
+    { return m_modelFactory.engine(); }
+
     /**
      * @brief Get a constant reference to the list of vpz::Observables
      * objects.
@@ -292,7 +333,12 @@ private:
     Time                        m_currentTime;
     Time                        m_durationTime;
     SimulatorMap                m_modelList;
+    SimulatorList               m_simulators; ///< simulators by index.
+    std::vector < size_t >      m_freeIds; ///< indexes to reuse.
     EventTable                  m_eventTable;
+    ExternalEventList           m_outputs; ///< reused output() buffer.
+    utils::ThreadPool*          m_pool; ///< null if the bags are serial.
+    ObservationCache            m_cache; ///< shared by the views.
     ViewList                    m_viewList;
     EventViewList               m_eventViewList;
     TimedViewList               m_timedViewList;
@@ -301,9 +347,88 @@ private:
     SimulatorList               m_deletedSimulator;
     SimulatorList::size_type    m_toDelete;
     const utils::ModuleManager& m_modulemgr;
-    ViewEventList               m_obsEventBuffer;
+    ObservationClock            m_clock; ///< timed and finish views.
     bool                        m_isStarted;
 
+    /**
+     * @brief The number of events sent by a model to another one, counted
+     * only if m_trafficFile is not empty, in an open addressing table
+     * indexed by the identifiers of the simulators. The counters of the
+     * deleted simulators are kept by the complete names of the models.
+     */
+    struct TrafficCounter
+    {
+        size_t        source;
+        size_t        target;
+        unsigned long events;
+    };
+
+    typedef std::vector < TrafficCounter > TrafficTable;
+    typedef std::map < std::pair < std::string, std::string >,
+            unsigned long > TrafficNameMap;
+
+    std::string                 m_trafficFile;
+    TrafficTable                m_traffic;
+    TrafficTable::size_type     m_trafficSize; ///< the used counters.
+    TrafficNameMap              m_trafficNames;
+
+    /**
+     * @brief A non executive bag of the current step when the thread pool
+     * is used. The outputs and the new internal event of a thread-safe
+     * model are computed by the pool then merged in the order of the bags
+     * to produce the same EventTable as the serial run. The exception
+     * thrown by a model is kept to be rethrown by the Coordinator.
+     */
+    struct ParallelBag
+    {
+        ParallelBag()
+            : bag(0), internal(0), parallel(false)
+        {}
+
+        EventBagModel*        bag;
+        ExternalEventList     outputs;
+        InternalEvent*        internal;
+        boost::exception_ptr  error;
+        bool                  parallel;
+    };
+
+    std::vector < ParallelBag > m_parallelBags; ///< reused storage.
+    std::vector < ParallelBag >::size_type m_nbParallelBags;
+    std::vector < ParallelBag* > m_parallelJobs; ///< bags for the pool.
+
+    /**
+     * @brief Assign the scheduler, the thread pool and the traffic file of
+     * the experiment.
+     */
+    void initSettings(const vpz::Experiment& experiment);
+
+    /**
+     * @brief Count an event sent by a simulator to another one.
+     * @param source The identifier of the source simulator.
+     * @param target The identifier of the target simulator.
+     */
+    void countTraffic(size_t source, size_t target);
+
+    /**
+     * @brief Find or add the counter of a couple of simulators in the
+     * traffic table, which must have a free counter.
+     */
+    TrafficCounter& trafficCounter(size_t source, size_t target);
+
+    /**
+     * @brief Move the counters of the traffic to the complete names of the
+     * models, before the deletion of a simulator.
+     */
+    void flushTraffic();
+
+    /**
+     * @brief Write the traffic file: one line per couple of models with
+     * the complete names of the source and the target and the number of
+     * events, separated by tabs (see vpz::Partitioner::readTraffic).
+     * @throw utils::FileError if the file cannot be written.
+     */
+    void writeTraffic();
+
     /**
      * @brief Build, for each vpz::View a StreamWriter and View.
      * @throw utils::ArgError if the output or the view does not exist.
@@ -329,14 +454,42 @@ private:
                                const EventBagModel& modelbag);
 
     /**
-     * @brief Process for each ObservationEvent in the bag and observation
-     * for the specified model. All ObservationEvent are destroyed by this
-     * function and the bag is cleared.
-     *
-     * @param bag The ObservationEventList to process and clear.
-     * @param time The current time of the simulation.
+     * @brief Process the internal and the external events of a bag.
+     * @param bag The bag to process.
+     */
+    void processBag(EventBagModel& bag);
+
+    /**
+     * @brief Store a non executive bag of the current step to process it
+     * with the thread pool.
+     * @param bag The bag to add.
      */
-    void processViewEvents(ViewEventList& bag);
+    void addParallelBag(EventBagModel& bag);
+
+    /**
+     * @brief Run the output function and the transition of the thread-safe
+     * models of the parallel bags with the thread pool, then dispatch their
+     * outputs and process the other bags in the order of the bags.
+     * @throw the exception thrown by the first failed model of the pool,
+     * in the order of the bags.
+     */
+    void processParallelBags();
+
+    /**
+     * @brief Run by the thread pool: compute the outputs and the new
+     * internal event of a parallel bag.
+     * @param job The index of the bag in the parallel jobs.
+     */
+    void runParallelBag(std::size_t job);
+
+    /**
+     * @brief Delete the outputs and the internal events of the parallel
+     * bags which are not merged into the EventTable.
+     * @param first The first bag to release.
+     * @param last The end of the bags to release.
+     */
+    void releaseParallelBags(std::vector < ParallelBag >::size_type first,
+                             std::vector < ParallelBag >::size_type last);
 
     /**
      * @brief build the simulator from the vpz::BaseModel stock.
@@ -377,8 +530,11 @@ private:
      */
     void delCoupledModel(vpz::CoupledModel* mdl);
 
-
-
+    /**
+     * @brief Invalidate the cached observations of a model after a
+     * transition and run the event views which observe it.
+     * @param model The model after a transition.
+     */
     void processEventView(Simulator* model);
 
     /**
@@ -193,6 +193,36 @@ namespace vle { namespace devs {
 	    const vle::devs::ObservationEvent& /* event */) const
         { return 0; }
 
+        /**
+         * @brief The type of the observations of a port.
+         */
+        enum ObservationType { OBSERVATION_VALUE, OBSERVATION_DOUBLE,
+            OBSERVATION_INTEGER };
+
+        /**
+         * @brief Get the type of the observations of a port. A numeric port
+         * (double or integer) is observed by numericObservation(): the
+         * views write its observations into a row of numbers without
+         * allocation for the output plug-ins which accept rows
+         * (oov::Plugin::acceptValues), into a value::Double or a
+         * value::Integer for the others.
+         * @param port the name of the port.
+         * @return OBSERVATION_VALUE by default, the port is observed by
+         * observation().
+         */
+        virtual ObservationType observationType(
+            const std::string& /* port */) const
+        { return OBSERVATION_VALUE; }
+
+        /**
+         * @brief Process an observation event of a numeric port.
+         * @param event the state event with of the port
+         * @return the value of state variable
+         */
+        virtual double numericObservation(
+            const vle::devs::ObservationEvent& /* event */) const
+        { return 0.0; }
+
         /**
          * @brief When the simulation of the atomic model is finished, the
          * finish method is invoked.
@@ -200,6 +230,33 @@ namespace vle { namespace devs {
         virtual void finish()
         { }
 
+        /**
+         * @brief Save the state of the model. The optimistic engine
+         * (devs::TimeWarp) saves the state before each transition and
+         * restores it with restoreState() to roll back the transitions.
+         * @return A new value, owned by the caller, or 0 if the model does
+         * not support the state saving.
+         */
+        virtual vle::value::Value* saveState() const
+        { return 0; }
+
+        /**
+         * @brief Restore a state of the model built by saveState().
+         * @param state The state to restore.
+         */
+        virtual void restoreState(const vle::value::Value& /* state */)
+        { }
+
+        /**
+         * @brief Get the lookahead of the model: the minimal delay between
+         * an event received or sent by the model and its next output. The
+         * conservative engine (devs::ChandyMisra) needs a positive
+         * lookahead for the models connected to other processes.
+         * @return The lookahead, 0 by default.
+         */
+        virtual vle::devs::Time lookahead() const
+        { return 0.0; }
+
 	/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
@@ -222,6 +279,17 @@ namespace vle { namespace devs {
         inline virtual bool isWrapper() const
         { return false; }
 
+        /**
+         * @brief If this function return true, the output function and the
+         * transitions of the model can run in a thread of the Coordinator,
+         * in parallel with the other models of the bag, when the
+         * simulation engine condition defines more than one thread. The
+         * model must only modify its own state in these functions.
+         * @return false if Dynamics is not thread-safe.
+         */
+        inline virtual bool isThreadSafe() const
+        { return false; }
+
 	/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 	 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
@@ -118,6 +118,21 @@ vle::value::Value* DynamicsDbg::observation(
     return mDynamics->observation(event);
 }
 
+Dynamics::ObservationType DynamicsDbg::observationType(
+    const std::string& port) const
+{
+    return mDynamics->observationType(port);
+}
+
+double DynamicsDbg::numericObservation(const ObservationEvent& event) const
+{
+    TraceDevs(fmt(_("%1$20.10g %2% [DEVS] numeric observation: [from: '%3%'"
+                    " port: '%4%']")) % event.getTime() % mName
+              % event.getViewName() % event.getPortName());
+
+    return mDynamics->numericObservation(event);
+}
+
 void DynamicsDbg::finish()
 {
     TraceDevs(fmt(_("                     %1% [DEVS] finish")) % mName);
@@ -125,5 +140,30 @@ void DynamicsDbg::finish()
     mDynamics->finish();
 }
 
+vle::value::Value* DynamicsDbg::saveState() const
+{
+    TraceDevs(fmt(_("                     %1% [DEVS] save state")) % mName);
+
+    return mDynamics->saveState();
+}
+
+void DynamicsDbg::restoreState(const vle::value::Value& state)
+{
+    TraceDevs(fmt(_("                     %1% [DEVS] restore state"))
+              % mName);
+
+    mDynamics->restoreState(state);
+}
+
+vle::devs::Time DynamicsDbg::lookahead() const
+{
+    return mDynamics->lookahead();
+}
+
+bool DynamicsDbg::isThreadSafe() const
+{
+    return mDynamics->isThreadSafe();
+}
+
 }} // namespace vle devs
 
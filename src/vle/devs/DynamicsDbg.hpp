@@ -149,12 +149,53 @@ namespace vle { namespace devs {
         virtual vle::value::Value*
             observation(const ObservationEvent& event) const;
 
+        /**
+         * @brief Get the type of the observations of a port.
+         * @param port the name of the port.
+         * @return the type of the port.
+         */
+        virtual ObservationType observationType(const std::string& port) const;
+
+        /**
+         * @brief Process an observation event of a numeric port.
+         * @param event the state event with of the port
+         * @return the value of state variable
+         */
+        virtual double numericObservation(const ObservationEvent& event) const;
+
         /**
          * @brief When the simulation of the atomic model is finished, the
          * finish method is invoked.
          */
         virtual void finish();
 
+        /**
+         * @brief Save the state of the attached Dynamics.
+         * @return A new value, owned by the caller, or 0 if the model does
+         * not support the state saving.
+         */
+        virtual vle::value::Value* saveState() const;
+
+        /**
+         * @brief Restore a state of the attached Dynamics built by
+         * saveState().
+         * @param state The state to restore.
+         */
+        virtual void restoreState(const vle::value::Value& state);
+
+        /**
+         * @brief Get the lookahead of the attached Dynamics.
+         * @return The lookahead of the model.
+         */
+        virtual vle::devs::Time lookahead() const;
+
+        /**
+         * @brief The attached Dynamics decides if it can run in a thread:
+         * the traces are written under the lock of the utils::Trace.
+         * @return true if the attached Dynamics is thread-safe.
+         */
+        virtual bool isThreadSafe() const;
+
     private:
         Dynamics* mDynamics;
         std::string mName;
@@ -29,80 +29,81 @@
 #include <vle/devs/InternalEvent.hpp>
 #include <vle/devs/ExternalEvent.hpp>
 #include <vle/vpz/CoupledModel.hpp>
+#include <algorithm>
 
 namespace {
 
-/** Compute the depth of the hierarchy.
+/** Compute the depth of the model in the hierarchy.
  *
- * @return @e depth returns 0 if executive is in the top model otherwise a
- * internet less than 0.
+ * @return @e depth returns 0 if the model is the top model otherwise the
+ * number of its parents.
  */
-inline unsigned depth(const vle::devs::Dynamics *mdl) throw()
+inline unsigned depth(const vle::devs::Simulator *sim) throw()
 {
     unsigned ret = 0;
 
-    const vle::vpz::CoupledModel *parent = mdl->getModel().getParent();
+    const vle::vpz::CoupledModel *parent = sim->getStructure()->getParent();
     while (parent != NULL) {
         parent = parent->getParent();
-        --ret;
+        ++ret;
     }
 
     return ret;
 }
 
-/** A functor to sort executive internal events from the @e
- * CompleteEventBagModel according to the depth of the executive in the model.
- *
- */
-struct ExecutiveSort {
-    typedef std::map<vle::devs::Simulator*,
-                     vle::devs::EventBagModel>::value_type param;
+} // anonymous namespace
 
-    inline bool operator()(const param* lhs, const param *rhs) const throw()
-    {
-        return ::depth(lhs->first->dynamics()) <
-            ::depth(rhs->first->dynamics());
+namespace vle { namespace devs {
+
+CompleteEventBagModel::~CompleteEventBagModel()
+{
+    for (std::vector < EventBagModel >::size_type i = 0; i < _size; ++i) {
+        _bags[i].clear();
     }
-};
+}
 
-} // anonymous namespace
+EventBagModel& CompleteEventBagModel::newBag(Simulator* m)
+{
+    if (_size == _bags.size()) {
+        _bags.push_back(EventBagModel());
+    }
 
-namespace vle { namespace devs {
+    EventBagModel& bag = _bags[_size];
+    bag.setSimulator(m);
+    ++_size;
+    m->setBag(_size);
+
+    if (m->dynamics()->isExecutive()) {
+        // The executive lane is sorted by decreasing depth of the models in
+        // the hierarchy. The executives with the same depth stay in the order
+        // of the bags.
+        unsigned d = ::depth(m);
+        std::vector < std::vector < EventBagModel >::size_type >::iterator it;
+
+        for (it = _exec.end(); it != _exec.begin(); --it) {
+            if (::depth(_bags[*(it - 1)].simulator()) >= d) {
+                break;
+            }
+        }
 
-std::map < Simulator*, EventBagModel >::value_type&
-    CompleteEventBagModel::topBag()
+        _exec.insert(it, _size - 1);
+    }
+
+    return bag;
+}
+
+EventBagModel& CompleteEventBagModel::topBag()
 {
-    while (_itbags != _bags.end()) {
-        if ((*_itbags).first->dynamics()->isExecutive()) {
-            _exec.push_back(&(*_itbags));
-            _itexec = _exec.begin();
-            _itbags++;
-
-            // If the latest element in the bag is an executive internal event,
-            // we sort all executive events according to the DEVS hierarchy of
-            // the structure.
-            if (_itbags == _bags.end())
-                std::sort(_exec.begin(), _exec.end(), ::ExecutiveSort());
-
-        } else {
-            std::map < Simulator*, EventBagModel >::iterator r = _itbags;
-            ++_itbags;
-
-            // If the latest element in the bag is an dynamics internal event,
-            // we sort all executive events according to the DEVS hierarchy of
-            // the structure.
-            if (_itbags == _bags.end())
-                std::sort(_exec.begin(), _exec.end(), ::ExecutiveSort());
-
-            return *r;
+    while (_itbags != _size) {
+        EventBagModel& bag = _bags[_itbags++];
+
+        if (bag.simulator() and not bag.simulator()->dynamics()->isExecutive()) {
+            return bag;
         }
     }
 
-    while (_itexec != _exec.end()) {
-        std::vector < std::map < Simulator*, EventBagModel >::value_type*
-            >::iterator r = _itexec;
-        ++_itexec;
-        return **r;
+    if (_itexec != _exec.size()) {
+        return _bags[_exec[_itexec++]];
     }
 
     throw utils::InternalError(_("Top bag problem"));
@@ -110,87 +111,84 @@ std::map < Simulator*, EventBagModel >::value_type&
 
 void CompleteEventBagModel::delModel(Simulator* mdl)
 {
-    assert(_itbags == _bags.end()); // Normally, _itbags equals _bags.end since
-                                    // all dynamics are already executed. Now,
-                                    // it's time to Executive.
+    assert(_itbags == _size); // Normally, _itbags equals _size since all
+                              // dynamics are already executed. Now, it's
+                              // time to Executive.
 
-    _states.remove(mdl);
+    if (mdl->bag()) {
+        std::vector < EventBagModel >::size_type index = mdl->bag() - 1;
+        std::vector < std::vector < EventBagModel >::size_type >::iterator it;
+
+        it = std::find(_exec.begin() + _itexec, _exec.end(), index);
+        if (it != _exec.end()) {
+            _exec.erase(it);
+        }
+
+        _bags[index].setSimulator(0);
+        mdl->setBag(0);
+    }
 }
 
-EventTable::EventTable(size_t sz)
+void CompleteEventBagModel::clear()
 {
-    mInternalEventList.reserve(sz);
+    for (std::vector < EventBagModel >::size_type i = 0; i < _size; ++i) {
+        if (_bags[i].simulator()) {
+            _bags[i].simulator()->setBag(0);
+            _bags[i].setSimulator(0);
+        }
+        _bags[i].clear();
+    }
+
+    _size = 0;
+    _exec.clear();
+    init();
 }
 
-EventTable::~EventTable()
+EventTable::EventTable(size_t sz)
+    : mScheduler(Scheduler::create(defaultSchedulerType(), sz))
 {
-    std::for_each(mInternalEventList.begin(),
-                  mInternalEventList.end(),
-                  boost::checked_deleter < InternalEvent >());
+}
 
-    std::for_each(mObservationEventList.begin(),
-                  mObservationEventList.end(),
-                  boost::checked_deleter < ViewEvent >());
+EventTable::EventTable(SchedulerType type, size_t sz)
+    : mScheduler(Scheduler::create(type, sz))
+{
+}
 
-    {
-	for (ExternalEventModel::iterator it = mExternalEventModel.begin();
-	     it != mExternalEventModel.end(); ++it) {
+EventTable::~EventTable()
+{
+    delete mScheduler;
 
-            std::for_each((*it).second.begin(),
-                          (*it).second.end(),
-                          boost::checked_deleter < ExternalEvent >());
-	}
-    }
+    std::for_each(mExternalEventList.begin(),
+                  mExternalEventList.end(),
+                  boost::checked_deleter < ExternalEvent >());
 }
 
-size_t EventTable::getEventNumber() const
+void EventTable::setSchedulerType(SchedulerType type)
 {
-    size_t sum = mObservationEventList.size() + mInternalEventList.size();
+    if (mScheduler->type() != type) {
+        if (mScheduler->size() > 0) {
+            throw utils::InternalError(
+                _("EventTable: cannot change the scheduler of a non empty"
+                  " event table"));
+        }
 
-    for (ExternalEventModel::const_iterator it = mExternalEventModel.begin();
-	     it != mExternalEventModel.end(); ++it) {
-	sum += (*it).second.size();
+        Scheduler* scheduler = Scheduler::create(type, 4096);
+        delete mScheduler;
+        mScheduler = scheduler;
     }
-
-    return sum;
 }
 
-void EventTable::cleanInternalEventList()
+size_t EventTable::getEventNumber() const
 {
-    while (not mInternalEventList.empty() and
-	   not mInternalEventList[0]->isValid()) {
-	delete mInternalEventList[0];
-        std::pop_heap(mInternalEventList.begin(), mInternalEventList.end(),
-                      internalLessThan);
-        mInternalEventList.pop_back();
-    }
-
+    return mScheduler->size() + mExternalEventList.size();
 }
 
 const Time& EventTable::topEvent()
 {
-    if (not mExternalEventModel.empty()) {
+    if (not mExternalEventList.empty()) {
         return mCurrentTime;
     } else {
-        cleanInternalEventList();
-        if (not mInternalEventList.empty()) {
-            if (not mObservationEventList.empty()) {
-                if (mInternalEventList[0]->getTime() <=
-                    mObservationEventList.front()->getTime()) {
-                    return mInternalEventList[0]->getTime();
-                } else {
-                    return mObservationEventList.front()->getTime();
-                }
-            } else {
-                return mInternalEventList[0]->getTime();
-            }
-        } else {
-            if (not mObservationEventList.empty()) {
-                return mObservationEventList.front()->getTime();
-            } else {
-                return infinity;
-            }
-        }
+        return mScheduler->topTime();
     }
 }
 
@@ -199,29 +197,20 @@ CompleteEventBagModel& EventTable::popEvent()
     mCurrentTime = topEvent();
 
     if (mCurrentTime != infinity) {
-	while (not mInternalEventList.empty() and
-               mInternalEventList[0]->getTime() == mCurrentTime) {
-            if (mInternalEventList[0]->isValid()) {
-                Simulator* mdl = mInternalEventList[0]->getModel();
-                EventBagModel& bagmodel = mCompleteEventBagModel.getBag(mdl);
-                bagmodel.addInternal(mInternalEventList[0]);
-            }
-            popInternalEvent();
+	while (mScheduler->topTime() == mCurrentTime) {
+            InternalEvent* evt = mScheduler->pop();
+            EventBagModel& bagmodel =
+                mCompleteEventBagModel.getBag(evt->getModel());
+            bagmodel.addInternal(evt);
 	}
 
-        while (not mExternalEventModel.empty()) {
-            Simulator* mdl = (*mExternalEventModel.begin()).first;
-            EventBagModel& bagmodel = mCompleteEventBagModel.getBag(mdl);
-            bagmodel.addExternal((*mExternalEventModel.begin()).second);
-	    mExternalEventModel.erase(mExternalEventModel.begin());
+        for (ExternalEventList::iterator it = mExternalEventList.begin();
+             it != mExternalEventList.end(); ++it) {
+            EventBagModel& bagmodel =
+                mCompleteEventBagModel.getBag((*it)->getTarget());
+            bagmodel.addExternal(*it);
 	}
-
-	if (mCompleteEventBagModel.emptyBag())
-	  while (not mObservationEventList.empty() and
-		 mObservationEventList.front()->getTime() == mCurrentTime) {
-	    mCompleteEventBagModel.addState(mObservationEventList.front());
-	    popObservationEvent();
-	  }
+        mExternalEventList.clear();
     }
     mCompleteEventBagModel.init();
     return mCompleteEventBagModel;
@@ -229,24 +218,7 @@ CompleteEventBagModel& EventTable::popEvent()
 
 bool EventTable::putInternalEvent(InternalEvent* event)
 {
-    mInternalEventList.push_back(event);
-    std::push_heap(mInternalEventList.begin(), mInternalEventList.end(),
-                   internalLessThan);
-
-    // Try to insert a new InternalEventModel into the InternalEventList
-    // (beginning of the simulation the EventTable is empty or after an infinity
-    // time advance).
-    std::pair <InternalEventModel::iterator, bool> r =
-        mInternalEventModel.insert(
-            std::pair <Simulator*, InternalEvent*>(event->getModel(), NULL));
-
-    // If a InternalEventModel exist, we invalidate the associated internal
-    // events.
-    if (r.first->second)
-        r.first->second->invalidate();
-
-    // We assign the newly InternalEvent.
-    r.first->second = event;
+    mScheduler->put(event);
 
     return true;
 }
@@ -256,75 +228,32 @@ bool EventTable::putExternalEvent(ExternalEvent* event)
     Simulator* mdl = event->getTarget();
     assert(mdl);
 
-    mExternalEventModel[mdl].push_back(event);
-    InternalEventModel::iterator it = mInternalEventModel.find(mdl);
-    if (it != mInternalEventModel.end() and (*it).second and
-        (*it).second->getTime() > getCurrentTime()) {
-	(*it).second->invalidate();
-	(*it).second = 0;
-    }
-    return true;
-}
+    mExternalEventList.push_back(event);
 
-bool EventTable::putObservationEvent(ViewEvent* event)
-{
-    mObservationEventList.add(event);
-    std::push_heap(mObservationEventList.begin(), mObservationEventList.end(),
-                   viewEventLessThan);
-
-    return true;
-}
-
-void EventTable::popInternalEvent()
-{
-    if (not mInternalEventList.empty()) {
-        InternalEvent* evt = mInternalEventList[0];
-        std::pop_heap(mInternalEventList.begin(), mInternalEventList.end(),
-                      internalLessThan);
-        mInternalEventList.pop_back();
-	if (evt->isValid()) {
-	    mInternalEventModel[evt->getModel()] = 0;
-	} else {
-	    delete evt;
-	}
-    }
-}
-
-void EventTable::popObservationEvent()
-{
-    if (not mObservationEventList.empty()) {
-        std::pop_heap(mObservationEventList.begin(),
-                      mObservationEventList.end(),
-                      viewEventLessThan);
-        mObservationEventList.pop();
+    const InternalEvent* internal = mScheduler->find(mdl);
+    if (internal and internal->getTime() > getCurrentTime()) {
+        mScheduler->erase(mdl);
     }
+    return true;
 }
 
 void EventTable::delModelEvents(Simulator* mdl)
 {
-    {
-        InternalEventModel::iterator it = mInternalEventModel.find(mdl);
-        if (it != mInternalEventModel.end()) {
-            if ((*it).second)
-                (*it).second->invalidate();
-
-            mInternalEventModel.erase(it);
-        }
-    }
+    mScheduler->erase(mdl);
 
     {
-        ExternalEventModel::iterator it = mExternalEventModel.find(mdl);
-        if (it != mExternalEventModel.end()) {
-            std::for_each((*it).second.begin(),
-                          (*it).second.end(),
-                          boost::checked_deleter < ExternalEvent >());
-
-            (*it).second.clear();
-            mExternalEventModel.erase(it);
+        ExternalEventList::iterator jt = mExternalEventList.begin();
+        for (ExternalEventList::iterator it = mExternalEventList.begin();
+             it != mExternalEventList.end(); ++it) {
+            if ((*it)->getTarget() == mdl) {
+                delete *it;
+            } else {
+                *jt++ = *it;
+            }
         }
+        mExternalEventList.erase(jt, mExternalEventList.end());
     }
 
-    mObservationEventList.remove(mdl);
     mCompleteEventBagModel.delModel(mdl);
 }
 
@@ -31,49 +31,32 @@
 #include <vle/DllDefines.hpp>
 #include <vle/devs/InternalEvent.hpp>
 #include <vle/devs/ExternalEvent.hpp>
-#include <vle/devs/ViewEvent.hpp>
 #include <vle/devs/Simulator.hpp>
+#include <vle/devs/Scheduler.hpp>
 #include <list>
 #include <set>
+#include <vector>
 
 namespace vle { namespace devs {
 
-    /**
-     * Compare two internals events with devs::Time like comparator.
-     *
-     * @param e1 first event to compare.
-     * @param e2 second event to compare.
-     * @return true if devs::Time e1 is more recent than devs::Time e2.
-     */
-    inline bool internalLessThan(const InternalEvent* e1,
-                                 const InternalEvent* e2)
-    { return (e1->getTime() > e2->getTime()); }
-
-    /**
-     * Compare two states events with devs::Time like comparator.
-     *
-     * @param e1 first event to compare.
-     * @param e2 second event to compare.
-     * @return true if devs::Time e1 is more recent than devs::Time e2.
-     */
-    inline bool viewEventLessThan(const ViewEvent* e1,
-                                  const ViewEvent* e2)
-    { return (e1->getTime() > e2->getTime()); }
-
-    ///////////////////////////////////////////////////////////////////////////
-
     /**
      * @e EventBagModel represents a bag or a set of internal and
-     * external events for a specific model.
+     * external events for a specific model. The bag does not delete its
+     * events when it is destroyed: the @e CompleteEventBagModel reuses the
+     * bags from a step to another and calls the clear function.
      */
     class VLE_API EventBagModel
     {
     public:
 	inline EventBagModel() :
-	    _intev(0)
+	    _sim(0), _intev(0)
 	{}
 
-        inline ~EventBagModel() { clear(); }
+        inline Simulator* simulator() const
+        { return _sim; }
+
+        inline void setSimulator(Simulator* sim)
+        { _sim = sim; }
 
         inline void addInternal(InternalEvent* ev)
         { _intev = ev; }
@@ -88,8 +71,11 @@ namespace vle { namespace devs {
         { _intev = 0; }
 
 
+        inline void addExternal(ExternalEvent* ev)
+        { _extev.push_back(ev); }
+
         inline void addExternal(const ExternalEventList& evs)
-        { _extev = evs; }
+        { _extev.insert(_extev.end(), evs.begin(), evs.end()); }
 
         inline ExternalEventList& externals()
         { return _extev; }
@@ -110,6 +96,10 @@ namespace vle { namespace devs {
         inline bool emptyExternal() const
         { return _extev.empty(); }
 
+        /**
+         * Delete the internal and external events. The memory of the list of
+         * external events is kept for the next steps.
+         */
         inline void clear()
         {
             delete _intev;
@@ -129,6 +119,7 @@ namespace vle { namespace devs {
 	}
 
     private:
+        Simulator*              _sim;
 	InternalEvent*          _intev;
 	ExternalEventList       _extev;
     };
@@ -138,15 +129,25 @@ namespace vle { namespace devs {
     /**
      * @brief Represent a set of event bags for all model.
      *
+     * The bags are stored in a dense vector reused from a step to another:
+     * the bags of a step are the first elements of the vector and each
+     * Simulator stores the position of its bag. The bags of the Executive
+     * models are also stored in an executive lane, sorted according to the
+     * depth of the models in the hierarchy, and are returned after the bags
+     * of the other models. In steady state, no memory is allocated.
      */
     class VLE_API CompleteEventBagModel
     {
     public:
 	CompleteEventBagModel()
+            : _size(0)
         { init(); }
 
-        ~CompleteEventBagModel()
-        { clear(); }
+        /**
+         * @brief Delete the events of the bags without access to the
+         * simulators which can be already deleted.
+         */
+        ~CompleteEventBagModel();
 
 	/**
 	 * Return the bag for a specified model.
@@ -154,7 +155,7 @@ namespace vle { namespace devs {
 	 * @return a reference to the a bag or a new bag.
 	 */
         inline EventBagModel& getBag(Simulator* m)
-        { return _bags[m]; }
+        { return m->bag() ? _bags[m->bag() - 1] : newBag(m); }
 
         /**
          * @brief Return true if the Simulator already exist in the bag.
@@ -162,7 +163,7 @@ namespace vle { namespace devs {
          * @return True if Simulator was find, false otherwise.
          */
         inline bool exist(Simulator* m) const
-        { return _bags.find(m) != _bags.end(); }
+        { return m->bag() != 0; }
 
         inline void addInternal(Simulator* m, InternalEvent* ev)
         { getBag(m).addInternal(ev); }
@@ -170,19 +171,11 @@ namespace vle { namespace devs {
         inline void addExternal(Simulator* m, const ExternalEventList& lst)
         { getBag(m).addExternal(lst); }
 
-
-        inline void addState(ViewEvent* ev)
-        { _states.add(ev); }
-
-
         inline bool empty()
-        { return (_bags.empty() and _states.empty()); }
+        { return _size == 0; }
 
         inline bool emptyBag()
-        { return _itbags == _bags.end() and _itexec == _exec.end(); }
-
-        inline bool emptyStates()
-        { return _states.empty(); }
+        { return _itbags == _size and _itexec == _exec.size(); }
 
         /**
          * @brief Return a bag with the priority to the Executive model ie. the
@@ -191,54 +184,48 @@ namespace vle { namespace devs {
          * Excutive, all executive are send.
          * @return A reference to the Bag of a simulator.
          */
-        std::map < Simulator*, EventBagModel >::value_type& topBag();
-
-        inline ViewEvent* topObservationEvent()
-        { return _states.front(); }
-
-        inline ViewEventList& states()
-        { return _states; }
-
-
-        inline void popBag()
-        { _bags.erase(_bags.begin()); }
-
-        inline void clearStates()
-        { _states.clear(); }
-
-        inline void deleteStates()
-        { _states.erase(); }
+        EventBagModel& topBag();
 
         void delModel(Simulator*);
 
-        void clear()
-        { _bags.clear(); _itbags = _bags.end(); _exec.clear(); _itexec =
-            _exec.end(); }
+        /**
+         * @brief Delete the events of the bags and detach the bags from the
+         * simulators. The bags are kept for the next steps.
+         */
+        void clear();
 
         inline void init()
-        { _itbags = _bags.begin(); _itexec = _exec.end(); }
+        { _itbags = 0; _itexec = 0; }
 
         friend std::ostream& operator<<(std::ostream& o,
                                         const CompleteEventBagModel& c)
         {
-            o << "Nb bags: " << c._bags.size() << " Nb states: "
-                << c._states.size();
+            o << "Nb bags: " << c._size;
             return o;
         }
 
     private:
-        std::map < Simulator*, EventBagModel >              _bags;
-        std::map < Simulator*, EventBagModel >::iterator    _itbags;
-        std::vector < std::map < Simulator*, EventBagModel >::value_type* > _exec;
-        std::vector < std::map < Simulator*, EventBagModel >::value_type* >::iterator _itexec;
-
-        ViewEventList _states;
+        /**
+         * @brief Assign the first unused bag to the simulator and add it to
+         * the executive lane if the simulator is an Executive.
+         * @param m the simulator without bag.
+         * @return a reference to the new bag.
+         */
+        EventBagModel& newBag(Simulator* m);
+
+        std::vector < EventBagModel > _bags; ///< storage of the bags.
+        std::vector < EventBagModel >::size_type _size; ///< bags in use.
+        std::vector < EventBagModel >::size_type _itbags;
+        std::vector < std::vector < EventBagModel >::size_type > _exec;
+        std::vector < std::vector < EventBagModel >::size_type >::size_type
+            _itexec;
     };
 
     ///////////////////////////////////////////////////////////////////////////
 
     /**
-     * @brief Scheduller class to manage internal, external and state events.
+     * @brief Scheduller class to manage internal and external events: the
+     * observations are scheduled by the ObservationClock.
      *
      */
     class VLE_API EventTable
@@ -253,7 +240,16 @@ namespace vle { namespace devs {
         EventTable(size_t sz = 4096);
 
         /**
-         * Delete all existing events in vectors internal, external, state
+         * Initialisation of events vectors with the specified scheduler of
+         * internal events.
+         *
+         * @param type the implementation of the scheduler.
+         * @param sz minimum size to initialise vectors (Default size if 4096).
+         */
+        EventTable(SchedulerType type, size_t sz = 4096);
+
+        /**
+         * Delete all existing events in vectors internal, external
          * and init. Be carreful, don't delete Event that you have put.
          */
         ~EventTable();
@@ -298,13 +294,6 @@ namespace vle { namespace devs {
          */
         bool putExternalEvent(ExternalEvent* event);
 
-        /**
-         * Put a state event into vector heap.
-         *
-         * @param event state event to push into vector heap.
-         */
-        bool putObservationEvent(ViewEvent* event);
-
         /**
          * Return the current simulation Time ie. during the latest popEvent.
          *
@@ -313,6 +302,23 @@ namespace vle { namespace devs {
         inline const Time& getCurrentTime() const
         { return mCurrentTime; }
 
+        /**
+         * @brief Get the implementation of the scheduler of internal events.
+         *
+         * @return the type of the scheduler.
+         */
+        inline SchedulerType getSchedulerType() const
+        { return mScheduler->type(); }
+
+        /**
+         * @brief Replace the scheduler of internal events.
+         *
+         * @param type the implementation of the new scheduler.
+         * @throw utils::InternalError if internal events are already
+         * scheduled.
+         */
+        void setSchedulerType(SchedulerType type);
+
         /**
          * @brief Delete all event from Simulator.
          *
@@ -321,37 +327,14 @@ namespace vle { namespace devs {
         void delModelEvents(Simulator* mdl);
 
     private:
-        typedef std::map < Simulator*, InternalEvent* > InternalEventModel;
-        typedef std::map < Simulator*, ExternalEventList > ExternalEventModel;
-
-	/**
-	 * Delete the first event in Internal heap.
-	 *
-	 */
-	void popInternalEvent();
-
-	/**
-	 * Delete the first event in State heap.
-	 *
-	 */
-	void popObservationEvent();
-
-        /**
-         * @brief delete the first invalid InternalEvent from InternalEventList.
-         */
-        void cleanInternalEventList();
+        EventTable(const EventTable& other);
+        EventTable& operator=(const EventTable& other);
 
 	/// scheduller for internal event.
-	InternalEventList mInternalEventList;
-
-	/// scheduller for state events.
-	ViewEventList mObservationEventList;
-
-	/// table to quick found event.
-	InternalEventModel mInternalEventModel;
+	Scheduler* mScheduler;
 
-	/// table to conserve external event.
-	ExternalEventModel mExternalEventModel;
+	/// external events to dispatch in the next bag.
+	ExternalEventList mExternalEventList;
 
 	/// the bag to send with popEvent function.
         CompleteEventBagModel mCompleteEventBagModel;
@@ -230,6 +230,10 @@ void Executive::addOutputPort(const std::string& modelName,
     }
 
     mdl->addOutputPort(portName);
+
+    if (mdl->isAtomic()) {
+        m_coordinator.addSimulatorTargetPort(mdl->toAtomic(), portName);
+    }
 }
 
 void Executive::removeInputPort(const std::string& modelName,
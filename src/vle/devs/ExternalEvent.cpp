@@ -26,9 +26,74 @@
 
 
 #include <vle/devs/ExternalEvent.hpp>
+#include <vle/utils/Pool.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <map>
 
 namespace vle { namespace devs {
 
+namespace {
+
+/*
+ * The pool and the table of port names are never released: events can be
+ * deleted during the destruction of static objects.
+ */
+
+utils::Pool& externalEventPool()
+{
+    static utils::Pool* pool = new utils::Pool(sizeof(ExternalEvent));
+
+    return *pool;
+}
+
+/*
+ * The interned ports: the deque keeps the address of the ports and their
+ * identifier is their position.
+ */
+struct PortNames
+{
+    std::deque < ExternalEvent::Port >                          ports;
+    std::map < std::string, const ExternalEvent::Port* >        names;
+    boost::mutex                                                mutex;
+};
+
+PortNames& portNames()
+{
+    static PortNames* names = new PortNames();
+
+    return *names;
+}
+
+} // anonymous namespace
+
+void* ExternalEvent::operator new(std::size_t size)
+{
+    return externalEventPool().allocate(size);
+}
+
+void ExternalEvent::operator delete(void* ptr, std::size_t size)
+{
+    externalEventPool().deallocate(ptr, size);
+}
+
+const ExternalEvent::Port* ExternalEvent::internPortName(
+    const std::string& name)
+{
+    PortNames& table(portNames());
+    boost::mutex::scoped_lock lock(table.mutex);
+
+    std::map < std::string, const Port* >::iterator it =
+        table.names.lower_bound(name);
+    if (it == table.names.end() or it->first != name) {
+        table.ports.push_back(Port(name, table.ports.size()));
+        it = table.names.insert(it, std::make_pair(name,
+                                                   &table.ports.back()));
+    }
+
+    return it->second;
+}
+
 void ExternalEvent::putAttributes(const value::Map& mp)
 {
     for (value::MapValue::const_iterator it = mp.value().begin();
@@ -30,7 +30,6 @@
 
 #include <vle/DllDefines.hpp>
 #include <vle/devs/Attribute.hpp>
-#include <boost/shared_ptr.hpp>
 #include <string>
 
 namespace vle { namespace devs {
@@ -45,9 +44,47 @@ class Simulator;
 class VLE_API ExternalEvent
 {
 public:
+    /**
+     * @brief An interned port name: the name and a dense identifier used
+     * by the devs::Simulator to index its output ports. The ports of the
+     * models are interned when their simulators are built.
+     */
+    struct Port
+    {
+        Port()
+            : id(static_cast < std::size_t >(-1))
+        {}
+
+        Port(const std::string& name, std::size_t id)
+            : name(name), id(id)
+        {}
+
+        std::string name;
+        std::size_t id;
+    };
+
+    /**
+     * @brief Build an event on an output port from its name. The event
+     * keeps a copy of the name, not interned: the devs::Simulator finds
+     * the name in its own table of output ports when it routes the event.
+     * @param sourcePortName The output port.
+     */
     ExternalEvent(const std::string& sourcePortName)
         : m_target(0),
-        m_port(sourcePortName)
+        m_attributes(0),
+        m_port(&m_name),
+        m_name(sourcePortName, static_cast < std::size_t >(-1))
+    {
+    }
+
+    /**
+     * @brief Build an event on an interned output port.
+     * @param sourcePort The output port, returned by internPortName().
+     */
+    ExternalEvent(const Port* sourcePort)
+        : m_target(0),
+        m_attributes(0),
+        m_port(sourcePort)
     {
     }
 
@@ -56,22 +93,71 @@ public:
                   const std::string& targetPortName)
         : m_target(target),
         m_attributes(event.m_attributes),
-        m_port(targetPortName)
+        m_port(internPortName(targetPortName))
     {
+        if (m_attributes) {
+            ++m_attributes->count;
+        }
+    }
+
+    /**
+     * @brief Build a copy of the event for a target of the fan-out of an
+     * output port. The attributes are shared with the source event.
+     * @param event The source event.
+     * @param target The simulator which receives the event.
+     * @param targetPort The input port of the target, returned by
+     * internPortName().
+     */
+    ExternalEvent(ExternalEvent& event,
+                  Simulator* target,
+                  const Port* targetPort)
+        : m_target(target),
+        m_attributes(event.m_attributes),
+        m_port(targetPort)
+    {
+        if (m_attributes) {
+            ++m_attributes->count;
+        }
     }
 
     ~ExternalEvent()
     {
+        if (m_attributes and --m_attributes->count == 0) {
+            delete m_attributes;
+        }
     }
 
+    /**
+     * @brief The ExternalEvent are allocated in a utils::Pool.
+     */
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* ptr, std::size_t size);
+
+    /**
+     * @brief Get the unique instance of a port name. All the events on a
+     * port share the same Port and the interned ports are never released.
+     * @param name The name of the port.
+     * @return A pointer to the interned port.
+     */
+    static const Port* internPortName(const std::string& name);
+
     const std::string& getPortName() const
-    { return m_port; }
+    { return m_port->name; }
+
+    /**
+     * @brief Get the identifier of the interned port of the event.
+     * @return The identifier or -1 if the port of the event was not
+     * interned.
+     */
+    std::size_t getPortId() const
+    { return m_port->id; }
 
     Simulator* getTarget()
     { return m_target; }
 
     bool onPort(const std::string& portName) const
-    { return m_port == portName; }
+    { return &m_port->name == &portName or m_port->name == portName; }
 
     void putAttributes(const value::Map& map);
 
@@ -209,22 +295,22 @@ public:
      * @return True if the attributes lists exists, false otherwise.
      */
     bool haveAttributes() const
-    { return m_attributes.get(); }
+    { return m_attributes; }
 
     value::Map& attributes()
     {
-        if (m_attributes.get() == 0) {
-            m_attributes = boost::shared_ptr < value::Map >(new value::Map());
+        if (m_attributes == 0) {
+            m_attributes = new SharedAttributes();
         }
-        return *m_attributes;
+        return m_attributes->map;
     }
 
     const value::Map& attributes() const
     {
-        if (m_attributes.get() == 0) {
+        if (m_attributes == 0) {
             throw utils::ArgError(_("No attribute in this event"));
         }
-        return *m_attributes;
+        return m_attributes->map;
     }
 
 private:
@@ -232,9 +318,25 @@ private:
     ExternalEvent(const ExternalEvent& other);
     ExternalEvent& operator=(const ExternalEvent& other);
 
-    Simulator                        *m_target;
-    boost::shared_ptr < value::Map >  m_attributes;
-    std::string                       m_port;
+    /**
+     * @brief The attributes shared by the source event and its copies. The
+     * reference counter is not atomic: the copies of an event must be
+     * built and destroyed by the same thread.
+     */
+    struct SharedAttributes
+    {
+        SharedAttributes()
+            : count(1)
+        {}
+
+        value::Map  map;
+        std::size_t count;
+    };
+
+    Simulator          *m_target;
+    SharedAttributes   *m_attributes;
+    const Port         *m_port;
+    Port                m_name; ///< the port of an event built by name.
 };
 
 }} // namespace vle devs
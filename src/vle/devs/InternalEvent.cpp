@@ -26,7 +26,36 @@
 
 
 #include <vle/devs/InternalEvent.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/utils/Pool.hpp>
 
 namespace vle { namespace devs {
 
+namespace {
+
+utils::Pool& internalEventPool()
+{
+    static utils::Pool* pool = new utils::Pool(sizeof(InternalEvent));
+
+    return *pool;
+}
+
+} // anonymous namespace
+
+InternalEvent::InternalEvent(const Time& time, Simulator* simulator)
+    : m_simulator(simulator), m_id(simulator ? simulator->id() : 0),
+      m_time(time), m_position(0), m_isvalid(true)
+{
+}
+
+void* InternalEvent::operator new(std::size_t size)
+{
+    return internalEventPool().allocate(size);
+}
+
+void InternalEvent::operator delete(void* ptr, std::size_t size)
+{
+    internalEventPool().deallocate(ptr, size);
+}
+
 }} // namespace vle devs
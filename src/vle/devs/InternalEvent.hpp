@@ -51,10 +51,7 @@ public:
      * @param time The @e time when wake up the model.
      * @param simualtor The @e simulator associated.
      */
-    InternalEvent(const Time& time, Simulator* simulator)
-        : m_simulator(simulator), m_time(time), m_isvalid(true)
-    {
-    }
+    InternalEvent(const Time& time, Simulator* simulator);
 
     /**
      * InternalEvent descructor.
@@ -64,6 +61,13 @@ public:
     {
     }
 
+    /**
+     * The InternalEvent are allocated in a utils::Pool.
+     */
+    static void* operator new(std::size_t size);
+
+    static void operator delete(void* ptr, std::size_t size);
+
     /**
      * Get a pointer to the simulator.
      *
@@ -72,6 +76,15 @@ public:
     Simulator* getModel() const
     { return m_simulator; }
 
+    /**
+     * Get the identifier of the simulator, available after the deletion
+     * of the simulator of an invalidated event.
+     *
+     * @return The Simulator::id() of the simulator.
+     */
+    inline size_t getModelId() const
+    { return m_id; }
+
     /**
      * Get the wake up time.
      *
@@ -146,12 +159,31 @@ public:
     inline bool isValid() const
     { return m_isvalid; }
 
+    /**
+     * Get the position of this @e InternalEvent in the indexed scheduler.
+     *
+     * @return The position in the heap.
+     */
+    inline size_t position() const
+    { return m_position; }
+
+    /**
+     * Assign the position of this @e InternalEvent in the indexed
+     * scheduler.
+     *
+     * @param position The new position in the heap.
+     */
+    inline void setPosition(size_t position)
+    { m_position = position; }
+
 private:
     InternalEvent(const InternalEvent&);
     InternalEvent& operator=(const InternalEvent&);
 
     Simulator *m_simulator;     /**< A pointer to the simulator. */
+    size_t     m_id;            /**< The identifier of the simulator. */
     Time       m_time;          /**< The time to wake-up the simulator. */
+    size_t     m_position;      /**< The position in the indexed heap. */
     bool       m_isvalid;       /**< Is this InternalEvent valid? */
 };
 
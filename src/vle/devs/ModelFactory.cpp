@@ -40,26 +40,137 @@
 
 namespace vle { namespace devs {
 
+namespace {
+
+/*
+ * Replace the ports of a condition with the ports of the overlay.
+ */
+void mergeOverlay(vpz::Condition& condition, const vpz::Condition& overlay)
+{
+    for (vpz::ConditionValues::const_iterator jt =
+             overlay.conditionvalues().begin();
+         jt != overlay.conditionvalues().end(); ++jt) {
+        if (not condition.conditionvalues().count(jt->first)) {
+            condition.add(jt->first);
+        }
+
+        value::Set& values(condition.getSetValues(jt->first));
+        values.clear();
+        for (value::Set::const_iterator kt = jt->second->begin();
+             kt != jt->second->end(); ++kt) {
+            values.add(*kt ? (*kt)->clone() : 0);
+        }
+    }
+}
+
+/*
+ * Replace the ports of the conditions with the ports of the overlay.
+ */
+void mergeOverlay(vpz::Conditions& conditions,
+                  const vpz::Conditions& overlay)
+{
+    for (vpz::ConditionList::const_iterator it = overlay.begin();
+         it != overlay.end(); ++it) {
+        if (not conditions.exist(it->first)) {
+            conditions.add(it->second);
+        } else {
+            mergeOverlay(conditions.get(it->first), it->second);
+        }
+    }
+}
+
+} // anonymous namespace
+
+ModelFactory::ModelFactory(const utils::ModuleManager& modulemgr,
+                           const vpz::Dynamics& dyn,
+                           const vpz::Classes& cls,
+                           const vpz::Experiment& exp,
+                           RootCoordinator& root)
+    : mModuleMgr(modulemgr), mSharedDynamics(0), mSharedClasses(0),
+      mSharedExperiment(0), mOverlay(0), mName(exp.name()),
+      mDynamics(new vpz::Dynamics(dyn)), mClasses(new vpz::Classes(cls)),
+      mExperiment(new vpz::Experiment(exp)), mRoot(root)
+{
+    mSharedDynamics = mDynamics.get();
+    mSharedClasses = mClasses.get();
+    mSharedExperiment = mExperiment.get();
+}
+
 ModelFactory::ModelFactory(const utils::ModuleManager& modulemgr,
                            const vpz::Dynamics& dyn,
                            const vpz::Classes& cls,
                            const vpz::Experiment& exp,
+                           const vpz::Conditions& overlay,
+                           const std::string& name,
                            RootCoordinator& root)
-    : mModuleMgr(modulemgr), mDynamics(dyn), mClasses(cls), mExperiment(exp),
+    : mModuleMgr(modulemgr), mSharedDynamics(&dyn), mSharedClasses(&cls),
+      mSharedExperiment(&exp), mOverlay(&overlay), mName(name),
       mRoot(root)
 {
+    const std::string engine(
+        vpz::Experiment::defaultSimulationEngineCondName());
+
+    if (overlay.exist(engine)) {
+        mEngine.reset(new vpz::Experiment());
+        if (exp.conditions().exist(engine)) {
+            mEngine->conditions().add(exp.conditions().get(engine));
+        }
+        mergeOverlay(mEngine->conditions().get(engine), overlay.get(engine));
+    }
+}
+
+const vpz::Conditions& ModelFactory::conditions() const
+{
+    if (mExperiment) {
+        return mExperiment->conditions();
+    }
+
+    if (mOverlay->begin() == mOverlay->end()) {
+        return mSharedExperiment->conditions();
+    }
+
+    if (not mConditions) {
+        mConditions.reset(new vpz::Conditions(
+                mSharedExperiment->conditions()));
+        mergeOverlay(*mConditions, *mOverlay);
+    }
+
+    return *mConditions;
+}
+
+vpz::Dynamics& ModelFactory::dynamics()
+{
+    if (not mDynamics) {
+        mDynamics.reset(new vpz::Dynamics(*mSharedDynamics));
+    }
+
+    return *mDynamics;
+}
+
+vpz::Experiment& ModelFactory::ownExperiment()
+{
+    if (mExperiment) {
+        return *mExperiment;
+    }
+
+    mExperiment.reset(new vpz::Experiment(*mSharedExperiment));
+    mExperiment->setName(mName);
+
+    mergeOverlay(mExperiment->conditions(), *mOverlay);
+
+    return *mExperiment;
 }
 
 void ModelFactory::cleanCache()
 {
-    mDynamics.cleanNoPermanent();
-    mExperiment.cleanNoPermanent();
+    dynamics().cleanNoPermanent();
+    ownExperiment().cleanNoPermanent();
 }
 
 void ModelFactory::addPermanent(const vpz::Dynamic& dynamics)
 {
     try {
-        mDynamics.add(dynamics);
+        this->dynamics().add(dynamics);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
             "Model factory cannot add dynamics %1%: %2%")) % dynamics.name() %
@@ -70,7 +181,7 @@ void ModelFactory::addPermanent(const vpz::Dynamic& dynamics)
 void ModelFactory::addPermanent(const vpz::Condition& condition)
 {
     try {
-        vpz::Conditions& conds(mExperiment.conditions());
+        vpz::Conditions& conds(conditions());
         conds.add(condition);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
@@ -82,7 +193,7 @@ void ModelFactory::addPermanent(const vpz::Condition& condition)
 void ModelFactory::addPermanent(const vpz::Observable& observable)
 {
     try {
-        vpz::Views& views(mExperiment.views());
+        vpz::Views& views(ownExperiment().views());
         views.addObservable(observable);
     } catch(const std::exception& e) {
         throw utils::InternalError(fmt(_(
@@ -97,7 +208,8 @@ void ModelFactory::createModel(Coordinator& coordinator,
                                const std::vector < std::string >& conditions,
                                const std::string& observable)
 {
-    const vpz::Dynamic& dyn = mDynamics.get(dynamics);
+    const ModelFactory& shared(*this);
+    const vpz::Dynamic& dyn = shared.dynamics().get(dynamics);
 
     const SimulatorMap& result(coordinator.modellist());
     if (result.find(model) != result.end()) {
@@ -107,15 +219,30 @@ void ModelFactory::createModel(Coordinator& coordinator,
     }
 
     Simulator* sim = new Simulator(model);
-    coordinator.addModel(model, sim);
+    coordinator.addModel(model, sim); // assigns the dense index of sim.
 
     value::Map initValues;
     if (not conditions.empty()) {
         for (std::vector < std::string >::const_iterator it =
              conditions.begin(); it != conditions.end(); ++it) {
-	    const vpz::Condition& cnd(mExperiment.conditions().get(*it));
-	    value::MapValue vl;
-	    cnd.fillWithFirstValues(vl);
+            value::MapValue vl;
+            if (not mExperiment and mOverlay->exist(*it)) {
+                // the ports of the overlay replace the shared ports.
+                const vpz::Condition& ovl(mOverlay->get(*it));
+                if (mSharedExperiment->conditions().exist(*it)) {
+                    mSharedExperiment->conditions().get(*it)
+                        .fillWithFirstValues(vl);
+                }
+                for (vpz::ConditionValues::const_iterator jt =
+                         ovl.conditionvalues().begin();
+                     jt != ovl.conditionvalues().end(); ++jt) {
+                    vl[jt->first] = jt->second->size() > 0 ?
+                        jt->second->get(0) : 0;
+                }
+            } else {
+                shared.experiment().conditions().get(*it)
+                    .fillWithFirstValues(vl);
+            }
 
 	    for (value::MapValue::const_iterator itv = vl.begin();
 		 itv != vl.end(); ++itv) {
@@ -143,7 +270,7 @@ void ModelFactory::createModel(Coordinator& coordinator,
     initValues.value().clear();
 
     if (not observable.empty()) {
-        vpz::Observable& ob(mExperiment.views().observables().get(observable));
+        const vpz::Observable& ob(shared.observables().get(observable));
         const vpz::ObservablePortList& lst(ob.observableportlist());
 
         for (vpz::ObservablePortList::const_iterator it = lst.begin();
@@ -201,7 +328,7 @@ vpz::BaseModel* ModelFactory::createModelFromClass(Coordinator& coordinator,
                                                  const std::string& classname,
                                                  const std::string& modelname)
 {
-    vpz::Class& classe(mClasses.get(classname));
+    const vpz::Class& classe(mSharedClasses->get(classname));
     vpz::BaseModel* mdl(classe.model()->clone());
     vpz::AtomicModelVector atomicmodellist;
     vpz::BaseModel::getAtomicModelList(mdl, atomicmodellist);
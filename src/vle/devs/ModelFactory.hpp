@@ -38,6 +38,7 @@
 #include <vle/devs/ExternalEventList.hpp>
 #include <vle/utils/ModuleManager.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 
 namespace vle { namespace devs {
 
@@ -57,6 +58,9 @@ public:
     /**
      * @brief Build a new ModelFactory using specified dynamics.
      *
+     * The vpz::Dynamics, the vpz::Classes and the vpz::Experiment are
+     * copied, the sources can be freed after the construction.
+     *
      * @param sim the simulator attached to this ModelFactory.
      * @param dyn the root dynamics of vpz::Dynamics to load.
      * @param cls the vpz::classes to parse vpz::Dynamics to load.
@@ -67,48 +71,99 @@ public:
                  const vpz::Experiment& experiment,
                  RootCoordinator& root);
 
+    /**
+     * @brief Build a new ModelFactory which shares the dynamics, the
+     * classes and the experiment of a combination of an experimental
+     * frame.
+     *
+     * Nothing is copied: the ports of the @e overlay conditions are read
+     * before the ports of the shared conditions. The vpz::Dynamics and the
+     * vpz::Experiment are copied the first time an executive asks for a
+     * modifiable reference.
+     *
+     * @param dyn the shared vpz::Dynamics.
+     * @param cls the shared vpz::Classes.
+     * @param experiment the shared vpz::Experiment.
+     * @param overlay the ports of the conditions of the combination.
+     * @param name the name of the experiment of the combination.
+     *
+     * @attention @e dyn, @e cls, @e experiment and @e overlay must
+     * outlive the ModelFactory.
+     */
+    ModelFactory(const utils::ModuleManager& modulemgr,
+                 const vpz::Dynamics& dyn,
+                 const vpz::Classes& cls,
+                 const vpz::Experiment& experiment,
+                 const vpz::Conditions& overlay,
+                 const std::string& name,
+                 RootCoordinator& root);
+
     /**
      * @brief Return the reference to the list of initiale conditions for
-     * each models.
+     * each models. The ports of the overlay replace the ports of the
+     * shared conditions: the conditions, not the experiment, are copied
+     * the first time if the overlay is not empty.
      * @return A constant reference to the vpz::Conditions.
      */
-    inline const vpz::Conditions& conditions() const
-    { return mExperiment.conditions(); }
+    const vpz::Conditions& conditions() const;
 
     /**
      * @brief Return the reference to the list of dynamcis.
      * @return A constant reference to the vpz::Dynamics.
      */
     inline const vpz::Dynamics& dynamics() const
-    { return mDynamics; }
+    { return mDynamics ? *mDynamics : *mSharedDynamics; }
 
     /**
      * @brief Return the reference to the list of views.
      * @return A constant reference to the vpz::Views.
      */
     inline const vpz::Views& views() const
-    { return mExperiment.views(); }
+    { return experiment().views(); }
 
     /**
      * @brief Return the reference to the list of outputs.
      * @return A constant reference to the vpz::Outputs.
      */
     inline const vpz::Outputs& outputs() const
-    { return mExperiment.views().outputs(); }
+    { return experiment().views().outputs(); }
 
     /**
-     * @brief Return the reference to the experiment object.
+     * @brief Return the reference to the experiment object. Until an
+     * executive modifies it, the experiment is the shared one: its
+     * conditions and its name ignore the overlay, use conditions(),
+     * name() and engine().
      * @return A constant reference to the vpz::Experiment.
      */
     inline const vpz::Experiment& experiment() const
-    { return mExperiment; }
+    { return mExperiment ? *mExperiment : *mSharedExperiment; }
+
+    /**
+     * @brief Return the experiment which gives the settings of the
+     * simulation engine: begin(), duration(), scheduler(), threads(),
+     * observationQueue() and traffic(). The ports of the condition
+     * simulation_engine of the overlay replace the shared ports.
+     * @return A constant reference to the vpz::Experiment.
+     */
+    inline const vpz::Experiment& engine() const
+    {
+        return mExperiment ? *mExperiment : mEngine ? *mEngine :
+            *mSharedExperiment;
+    }
+
+    /**
+     * @brief Return the name of the experiment.
+     * @return A constant reference to the name.
+     */
+    inline const std::string& name() const
+    { return mName; }
 
     /**
      * @brief Return the reference to the observables object.
      * @return A constant reference to the vpz::Observables.
      */
     inline const vpz::Observables& observables() const
-    { return mExperiment.views().observables(); }
+    { return experiment().views().observables(); }
 
     /**
      * @brief Return the reference to the list of initiale conditions for
@@ -116,42 +171,41 @@ public:
      * @return A reference to the vpz::Conditions.
      */
     inline vpz::Conditions& conditions()
-    { return mExperiment.conditions(); }
+    { return ownExperiment().conditions(); }
 
     /**
      * @brief Return the reference to the list of dynamcis.
      * @return A constant reference to the vpz::Dynamics.
      */
-    inline vpz::Dynamics& dynamics()
-    { return mDynamics; }
+    vpz::Dynamics& dynamics();
 
     /**
      * @brief Return the reference to the list of views.
      * @return A reference to the vpz::Views.
      */
     inline vpz::Views& views()
-    { return mExperiment.views(); }
+    { return ownExperiment().views(); }
 
     /**
      * @brief Return the reference to the list of outputs.
      * @return A reference to the vpz::Outputs.
      */
     inline vpz::Outputs& outputs()
-    { return mExperiment.views().outputs(); }
+    { return ownExperiment().views().outputs(); }
 
     /**
      * @brief Return the reference to the experiment object.
      * @return A reference to the vpz::Experiment.
      */
     inline vpz::Experiment& experiment()
-    { return mExperiment; }
+    { return ownExperiment(); }
 
     /**
      * @brief Return the reference to the observables object.
      * @return A constant reference to the vpz::Observables.
      */
     inline vpz::Observables& observables()
-    { return mExperiment.views().observables(); }
+    { return ownExperiment().views().observables(); }
 
     //
     ///
@@ -232,12 +286,42 @@ private:
     const utils::ModuleManager& mModuleMgr; /**< A reference to the
                                               utils::ModuleManager. */
 
-    vpz::Dynamics           mDynamics; /**< List of available vpz::Dynamics. */
-    vpz::Classes            mClasses; /**< List of available vpz::Classes. */
-    vpz::Experiment         mExperiment; /**< A reference to the
-                                           vpz::Experiment. */
+    const vpz::Dynamics*    mSharedDynamics; /**< List of available
+                                               vpz::Dynamics. */
+    const vpz::Classes*     mSharedClasses; /**< List of available
+                                              vpz::Classes. */
+    const vpz::Experiment*  mSharedExperiment; /**< A reference to the
+                                                 vpz::Experiment. */
+    const vpz::Conditions*  mOverlay; /**< Ports read before the shared
+                                        conditions, NULL if none. */
+    std::string             mName; /**< The name of the experiment. */
+
+    /*
+     * The copies owned by the ModelFactory: built by the copying
+     * constructor or the first time an executive modifies the shared
+     * vpz::Dynamics or vpz::Experiment.
+     */
+    boost::scoped_ptr < vpz::Dynamics >           mDynamics;
+    boost::scoped_ptr < vpz::Classes >            mClasses;
+    boost::scoped_ptr < vpz::Experiment >         mExperiment;
+
+    /*
+     * The views of the shared experiment with the overlay: the conditions
+     * copied by conditions() const and the condition simulation_engine.
+     */
+    mutable boost::scoped_ptr < vpz::Conditions > mConditions;
+    boost::scoped_ptr < vpz::Experiment >         mEngine;
+
     RootCoordinator&        mRoot;
 
+    /**
+     * Copy the shared experiment and the ports of the overlay the first
+     * time it is called.
+     *
+     * @return The copy of the experiment.
+     */
+    vpz::Experiment& ownExperiment();
+
     /**
      * Try to open the plug-in and return the type of opened plugin
      * (MODULE_DYNAMICS, MODULE_DYNAMICS_WRAPPER or MODULE_EXECUTIVE).
@@ -0,0 +1,115 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/devs/ObservationCache.hpp>
+
+namespace vle { namespace devs {
+
+ObservationCache::~ObservationCache()
+{
+    for (EntryList::iterator it = m_entries.begin(); it != m_entries.end();
+         ++it) {
+        delete it->second.value;
+    }
+}
+
+ObservationCache::Entry* ObservationCache::attach(Simulator* simulator,
+                                                  const std::string& port)
+{
+    if (simulator->id() >= m_stamps.size()) {
+        m_stamps.resize(simulator->id() + 1, 0);
+    }
+
+    Entry& entry(m_entries[std::make_pair(simulator, port)]);
+    ++entry.refs;
+
+    return &entry;
+}
+
+void ObservationCache::detach(Simulator* simulator, const std::string& port)
+{
+    EntryList::iterator it = m_entries.find(std::make_pair(simulator, port));
+
+    if (it != m_entries.end() and --it->second.refs == 0) {
+        delete it->second.value;
+        m_entries.erase(it);
+    }
+}
+
+double ObservationCache::numericObservation(Entry& entry,
+                                            Simulator* simulator,
+                                            const ObservationEvent& event)
+{
+    if (not update(entry, simulator, event.getTime())) {
+        entry.number = simulator->numericObservation(event);
+        entry.done = true;
+    }
+
+    return entry.number;
+}
+
+value::Value* ObservationCache::observation(Entry& entry,
+                                            Simulator* simulator,
+                                            const ObservationEvent& event)
+{
+    if (not update(entry, simulator, event.getTime())) {
+        entry.value = simulator->observation(event);
+        entry.done = true;
+    }
+
+    // The last view takes the value: the next view computes it again.
+    if (--entry.pending == 0) {
+        value::Value* value = entry.value;
+        entry.value = 0;
+        entry.done = false;
+        return value;
+    }
+
+    return entry.value ? entry.value->clone() : 0;
+}
+
+bool ObservationCache::update(Entry& entry, Simulator* simulator,
+                              const Time& time)
+{
+    unsigned long stamp = m_stamps[simulator->id()];
+
+    if (entry.done and entry.time == time and entry.stamp == stamp) {
+        return true;
+    }
+
+    delete entry.value;
+    entry.value = 0;
+    entry.done = false;
+    entry.time = time;
+    entry.stamp = stamp;
+    entry.pending = entry.refs;
+
+    return false;
+}
+
+}} // namespace vle devs
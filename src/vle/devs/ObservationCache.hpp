@@ -0,0 +1,148 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_DEVS_OBSERVATIONCACHE_HPP
+#define VLE_DEVS_OBSERVATIONCACHE_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/devs/Time.hpp>
+#include <vle/value/Value.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vle { namespace devs {
+
+/**
+ * @brief The observations of the ports observed by several views. The
+ * first view which observes a port at a date computes the observation,
+ * the other views at the same date reuse it until a transition of the
+ * Simulator.
+ *
+ * The Entry of a port counts the views which observe it: the views get a
+ * clone of the shared value and the last one gets the value itself. A port
+ * observed by a single view is not cached.
+ */
+class VLE_API ObservationCache
+{
+public:
+    /**
+     * The observation of a port.
+     */
+    struct Entry
+    {
+        Entry()
+            : refs(0), pending(0), time(negativeInfinity), stamp(0),
+            done(false), number(0.0), value(0)
+        {}
+
+        unsigned int  refs; ///< the views which observe the port.
+        unsigned int  pending; ///< the views which have not read value.
+        Time          time; ///< the date of the observation.
+        unsigned long stamp; ///< the transitions of the Simulator.
+        bool          done;
+        double        number;
+        value::Value* value; ///< owned until the last view reads it.
+    };
+
+    ObservationCache()
+    {}
+
+    ~ObservationCache();
+
+    /**
+     * Attach a view to a port.
+     * @param simulator The observed Simulator.
+     * @param port The observed port.
+     * @return The Entry of the port, valid until the last detach.
+     */
+    Entry* attach(Simulator* simulator, const std::string& port);
+
+    /**
+     * Detach a view from a port, the Entry is deleted with the last view.
+     * @param simulator The observed Simulator.
+     * @param port The observed port.
+     */
+    void detach(Simulator* simulator, const std::string& port);
+
+    /**
+     * The state of the Simulator changed: its observations are computed
+     * again.
+     * @param simulator The Simulator after a transition.
+     */
+    inline void invalidate(Simulator* simulator)
+    {
+        if (simulator->id() < m_stamps.size()) {
+            ++m_stamps[simulator->id()];
+        }
+    }
+
+    /**
+     * Get the numeric observation of a port, computed once by date and by
+     * state of the Simulator.
+     */
+    double numericObservation(Entry& entry, Simulator* simulator,
+                              const ObservationEvent& event);
+
+    /**
+     * Get the observation of a port, computed once by date and by state
+     * of the Simulator.
+     * @return A clone of the observation, the observation itself for the
+     * last view which reads it.
+     */
+    value::Value* observation(Entry& entry, Simulator* simulator,
+                              const ObservationEvent& event);
+
+    /**
+     * Get the number of ports in the cache.
+     */
+    inline std::size_t size() const
+    { return m_entries.size(); }
+
+private:
+    ObservationCache(const ObservationCache& other);
+    ObservationCache& operator=(const ObservationCache& other);
+
+    /**
+     * Test if the observation of the Entry is the one of the Simulator at
+     * @e time, otherwise prepare the Entry for a new observation.
+     */
+    bool update(Entry& entry, Simulator* simulator, const Time& time);
+
+    typedef std::map < std::pair < Simulator*, std::string >, Entry >
+        EntryList;
+
+    EntryList                     m_entries;
+    std::vector < unsigned long > m_stamps; ///< by Simulator::id().
+};
+
+}} // namespace vle devs
+
+#endif
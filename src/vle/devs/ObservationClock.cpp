@@ -0,0 +1,104 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/devs/ObservationClock.hpp>
+#include <boost/checked_delete.hpp>
+#include <algorithm>
+
+namespace {
+
+/** The time step of a view, infinity for a FinishView. */
+inline vle::devs::Time timestep(const vle::devs::View* view)
+{
+    return view->isTimed() ?
+        static_cast < const vle::devs::TimedView* >(view)->timestep() :
+        vle::devs::infinity;
+}
+
+} // anonymous namespace
+
+namespace vle { namespace devs {
+
+ObservationClock::~ObservationClock()
+{
+    std::for_each(m_groups.begin(), m_groups.end(),
+                  boost::checked_deleter < Group >());
+}
+
+void ObservationClock::add(View* view, const Time& time)
+{
+    Time step = timestep(view);
+    std::vector < Group* >::iterator it = m_groups.begin();
+
+    while (it != m_groups.end() and not ((*it)->next == time and
+                                         (*it)->step == step)) {
+        ++it;
+    }
+
+    if (it == m_groups.end()) {
+        Group* group = new Group(time, step);
+
+        it = m_groups.begin();
+        while (it != m_groups.end() and (*it)->next <= time) {
+            ++it;
+        }
+        it = m_groups.insert(it, group);
+    }
+
+    (*it)->views.push_back(view);
+}
+
+void ObservationClock::run(const Time& time)
+{
+    // A copy: time may be the date of the first group, nextTime().
+    const Time current(time);
+
+    while (not m_groups.empty() and m_groups.front()->next == current) {
+        Group& group(*m_groups.front());
+
+        for (std::vector < View* >::iterator it = group.views.begin();
+             it != group.views.end(); ++it) {
+            (*it)->run(current);
+        }
+        group.next = group.views.front()->getNextTime(current);
+        schedule();
+    }
+}
+
+void ObservationClock::schedule()
+{
+    std::vector < Group* >::iterator it = m_groups.begin() + 1;
+
+    while (it != m_groups.end() and (*it)->next <= m_groups.front()->next) {
+        ++it;
+    }
+
+    std::rotate(m_groups.begin(), m_groups.begin() + 1, it);
+}
+
+}} // namespace vle devs
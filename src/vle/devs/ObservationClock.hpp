@@ -0,0 +1,112 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_DEVS_OBSERVATIONCLOCK_HPP
+#define VLE_DEVS_OBSERVATIONCLOCK_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/Time.hpp>
+#include <vle/devs/View.hpp>
+#include <vector>
+
+namespace vle { namespace devs {
+
+/**
+ * @brief The scheduler of the observations of the TimedView and of the
+ * FinishView. The views which share a timestep and a date are grouped and
+ * the groups are sorted by date: in steady state, no memory is allocated
+ * to schedule the observations.
+ *
+ * The views of the groups observed at the same date share the
+ * observations of their ports through their ObservationCache.
+ */
+class VLE_API ObservationClock
+{
+public:
+    ObservationClock()
+    {}
+
+    ~ObservationClock();
+
+    /**
+     * Schedule the first observation of a TimedView or of a FinishView.
+     * @param view The view to schedule.
+     * @param time The date of the first observation.
+     */
+    void add(View* view, const Time& time);
+
+    /**
+     * Get the date of the next observation.
+     * @return The date, infinity if no observation is scheduled.
+     */
+    inline const Time& nextTime() const
+    { return m_groups.empty() ? infinity : m_groups.front()->next; }
+
+    /**
+     * Observe the views scheduled at @e time and schedule their next
+     * observations.
+     * @param time The date of the observations, nextTime().
+     */
+    void run(const Time& time);
+
+    /**
+     * Get the number of groups of views.
+     * @return The number of groups.
+     */
+    inline std::size_t size() const
+    { return m_groups.size(); }
+
+private:
+    ObservationClock(const ObservationClock& other);
+    ObservationClock& operator=(const ObservationClock& other);
+
+    /**
+     * The views observed at the same dates.
+     */
+    struct Group
+    {
+        Group(const Time& next, const Time& step)
+            : next(next), step(step)
+        {}
+
+        Time next;
+        Time step; ///< infinity for the FinishView.
+        std::vector < View* > views;
+    };
+
+    /**
+     * Move the first group to its place in the sorted groups.
+     */
+    void schedule();
+
+    std::vector < Group* > m_groups; ///< sorted by date.
+};
+
+}} // namespace vle devs
+
+#endif
@@ -77,6 +77,14 @@ public:
     const Time& getTime() const
     { return m_time; }
 
+    /**
+     * @brief Assign the time of the event: the views reuse the event of
+     * an observable at each observation.
+     * @param time the new time.
+     */
+    void setTime(const Time& time)
+    { m_time = time; }
+
     void putAttributes(const value::Map& map);
 
     /**
@@ -31,7 +31,8 @@
 namespace vle { namespace devs {
 
 /**
- * Retrieves for all Views the \c vle::value::Matrix result.
+ * Retrieves for all Views the \c vle::value::ColumnMatrix result or, if
+ * the plug-in does not manage it, the \c vle::value::Matrix result.
  *
  * The \c getMatrixFromView is a private implementation function.
  *
@@ -46,7 +47,11 @@ static value::Map * getMatrixFromView(const ViewList &views)
 
     ViewList::const_iterator it = views.begin();
     while (it != views.end()) {
-        value::Matrix *matrix = it->second->matrix();
+        value::Value *matrix = it->second->columnMatrix();
+
+        if (not matrix) {
+            matrix = it->second->matrix();
+        }
 
         if (matrix) {
             if (not result) {
@@ -97,6 +102,32 @@ void RootCoordinator::load(const vpz::Vpz& io)
     m_root = io.project().model().model();
 }
 
+void RootCoordinator::load(const vpz::Vpz& io, const vpz::Conditions& overlay,
+                           const std::string& name)
+{
+    if (m_coordinator) {
+        delete m_coordinator;
+        delete m_root;
+        m_coordinator = 0;
+    }
+
+    vpz::Model model(io.project().model());
+    m_root = model.model();
+
+    m_coordinator = new Coordinator(m_modulemgr,
+                                    io.project().dynamics(),
+                                    io.project().classes(),
+                                    io.project().experiment(),
+                                    overlay, name, *this);
+
+    // The begin and the duration of the overlay replace the shared ones.
+    m_begin = m_coordinator->engine().begin();
+    m_end = m_begin + m_coordinator->engine().duration();
+    m_currentTime = m_begin;
+
+    m_coordinator->init(model, m_currentTime, m_end);
+}
+
 void RootCoordinator::init()
 {
     m_currentTime = m_begin;
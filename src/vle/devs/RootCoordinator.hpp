@@ -74,6 +74,20 @@ namespace vle { namespace devs {
          */
         void load(const vpz::Vpz& vp);
 
+        /**
+         * @brief initialiase a new Coordinator with a combination of an
+         * experimental frame and intitialise the simulation time. Only the
+         * hierarchy of models of @e vp is cloned, the dynamics, the
+         * classes and the experiment are shared and the ports of the
+         * @e overlay replace the ports of the experiment conditions.
+         * @param vp a reference to the shared structure.
+         * @param overlay the ports of the conditions of the combination.
+         * @param name the name of the experiment of the combination.
+         * @attention @e vp and @e overlay must outlive the simulation.
+         */
+        void load(const vpz::Vpz& vp, const vpz::Conditions& overlay,
+                  const std::string& name);
+
         /**
          * @brief Initialise RootCoordinator and his Coordinator: initiale time
          * is define, coordinator init function is call.
@@ -0,0 +1,598 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/devs/Scheduler.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/version.hpp>
+#include <boost/checked_delete.hpp>
+#include <algorithm>
+
+namespace {
+
+/** Compare the date of two internal events.
+ *
+ * @return true if the date of @e e1 is less than the date of @e e2.
+ */
+inline bool internalDateLess(const vle::devs::InternalEvent* e1,
+                             const vle::devs::InternalEvent* e2)
+{
+    return e1->getTime() < e2->getTime();
+}
+
+/** Compare two internal events in the order of the schedulers: by date,
+ * then by identifier of their simulator.
+ *
+ * @return true if @e e1 is popped before @e e2.
+ */
+inline bool internalBefore(const vle::devs::InternalEvent* e1,
+                           const vle::devs::InternalEvent* e2)
+{
+    return e1->getTime() < e2->getTime() or
+        (e1->getTime() == e2->getTime() and
+         e1->getModelId() < e2->getModelId());
+}
+
+/** The heap comparator of the std::*_heap functions.
+ *
+ * @return true if @e e1 is popped after @e e2.
+ */
+inline bool internalAfter(const vle::devs::InternalEvent* e1,
+                          const vle::devs::InternalEvent* e2)
+{
+    return internalBefore(e2, e1);
+}
+
+/** Order the simultaneous events by decreasing identifier of their
+ * simulator.
+ */
+inline bool internalIdGreater(const vle::devs::InternalEvent* e1,
+                              const vle::devs::InternalEvent* e2)
+{
+    return e1->getModelId() > e2->getModelId();
+}
+
+} // anonymous namespace
+
+namespace vle { namespace devs {
+
+SchedulerType defaultSchedulerType()
+{
+#ifdef VLE_HAVE_INDEXED_SCHEDULER
+    return SCHEDULER_INDEXED_HEAP;
+#else
+    return SCHEDULER_HEAP;
+#endif
+}
+
+SchedulerType schedulerTypeFromName(const std::string& name)
+{
+    if (name == "heap") {
+        return SCHEDULER_HEAP;
+    } else if (name == "indexed-heap") {
+        return SCHEDULER_INDEXED_HEAP;
+    } else if (name == "calendar") {
+        return SCHEDULER_CALENDAR;
+    }
+
+    throw utils::ArgError(fmt(_("Unknown scheduler '%1%'")) % name);
+}
+
+Scheduler* Scheduler::create(SchedulerType type, size_t sz)
+{
+    switch (type) {
+    case SCHEDULER_HEAP:
+        return new HeapScheduler(sz);
+    case SCHEDULER_INDEXED_HEAP:
+        return new IndexedHeapScheduler(sz);
+    case SCHEDULER_CALENDAR:
+        return new CalendarScheduler(sz);
+    }
+
+    throw utils::InternalError(_("Unknown scheduler type"));
+}
+
+                       /* - - - - - - - - - -*/
+
+HeapScheduler::HeapScheduler(size_t sz)
+{
+    mInternalEventList.reserve(sz);
+}
+
+HeapScheduler::~HeapScheduler()
+{
+    std::for_each(mInternalEventList.begin(),
+                  mInternalEventList.end(),
+                  boost::checked_deleter < InternalEvent >());
+}
+
+void HeapScheduler::cleanInternalEventList()
+{
+    while (not mInternalEventList.empty() and
+	   not mInternalEventList[0]->isValid()) {
+	delete mInternalEventList[0];
+        std::pop_heap(mInternalEventList.begin(), mInternalEventList.end(),
+                      internalAfter);
+        mInternalEventList.pop_back();
+    }
+}
+
+void HeapScheduler::put(InternalEvent* event)
+{
+    mInternalEventList.push_back(event);
+    std::push_heap(mInternalEventList.begin(), mInternalEventList.end(),
+                   internalAfter);
+
+    // Try to insert a new InternalEventModel into the InternalEventList
+    // (beginning of the simulation the EventTable is empty or after an infinity
+    // time advance).
+    size_t id = event->getModel()->id();
+    if (id >= mInternalEventModel.size()) {
+        mInternalEventModel.resize(id + 1, 0);
+    }
+
+    // If a InternalEventModel exist, we invalidate the associated internal
+    // events.
+    if (mInternalEventModel[id])
+        mInternalEventModel[id]->invalidate();
+
+    // We assign the newly InternalEvent.
+    mInternalEventModel[id] = event;
+}
+
+const InternalEvent* HeapScheduler::find(Simulator* sim) const
+{
+    return sim->id() < mInternalEventModel.size() ?
+        mInternalEventModel[sim->id()] : 0;
+}
+
+void HeapScheduler::erase(Simulator* sim)
+{
+    if (sim->id() < mInternalEventModel.size()) {
+        InternalEvent*& evt = mInternalEventModel[sim->id()];
+
+        if (evt) {
+            evt->invalidate();
+            evt = 0;
+        }
+    }
+}
+
+const Time& HeapScheduler::topTime()
+{
+    cleanInternalEventList();
+
+    return mInternalEventList.empty() ? infinity :
+        mInternalEventList[0]->getTime();
+}
+
+InternalEvent* HeapScheduler::pop()
+{
+    cleanInternalEventList();
+
+    if (mInternalEventList.empty())
+        return 0;
+
+    InternalEvent* evt = mInternalEventList[0];
+    std::pop_heap(mInternalEventList.begin(), mInternalEventList.end(),
+                  internalAfter);
+    mInternalEventList.pop_back();
+    mInternalEventModel[evt->getModel()->id()] = 0;
+
+    return evt;
+}
+
+                       /* - - - - - - - - - -*/
+
+IndexedHeapScheduler::IndexedHeapScheduler(size_t sz)
+{
+    m_heap.reserve(sz);
+}
+
+IndexedHeapScheduler::~IndexedHeapScheduler()
+{
+    std::for_each(m_heap.begin(), m_heap.end(),
+                  boost::checked_deleter < InternalEvent >());
+}
+
+void IndexedHeapScheduler::put(InternalEvent* event)
+{
+    Simulator* sim = event->getModel();
+    InternalEvent* old = sim->scheduledEvent();
+
+    sim->setScheduledEvent(event);
+
+    if (old) {
+        size_t position = old->position();
+        bool before = internalBefore(event, old);
+
+        delete old;
+        assign(position, event);
+
+        if (before) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+    } else {
+        m_heap.push_back(0);
+        assign(m_heap.size() - 1, event);
+        siftUp(m_heap.size() - 1);
+    }
+}
+
+const InternalEvent* IndexedHeapScheduler::find(Simulator* sim) const
+{
+    return sim->scheduledEvent();
+}
+
+void IndexedHeapScheduler::erase(Simulator* sim)
+{
+    InternalEvent* evt = sim->scheduledEvent();
+
+    if (evt) {
+        remove(evt->position());
+        sim->setScheduledEvent(0);
+        delete evt;
+    }
+}
+
+const Time& IndexedHeapScheduler::topTime()
+{
+    return m_heap.empty() ? infinity : m_heap[0]->getTime();
+}
+
+InternalEvent* IndexedHeapScheduler::pop()
+{
+    if (m_heap.empty())
+        return 0;
+
+    InternalEvent* evt = m_heap[0];
+    remove(0);
+    evt->getModel()->setScheduledEvent(0);
+
+    return evt;
+}
+
+void IndexedHeapScheduler::remove(size_t position)
+{
+    InternalEvent* last = m_heap.back();
+    m_heap.pop_back();
+
+    if (position < m_heap.size()) {
+        bool before = internalBefore(last, m_heap[position]);
+
+        assign(position, last);
+
+        if (before) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+    }
+}
+
+void IndexedHeapScheduler::siftUp(size_t position)
+{
+    InternalEvent* evt = m_heap[position];
+
+    while (position > 0) {
+        size_t parent = (position - 1) / arity;
+
+        if (not internalBefore(evt, m_heap[parent]))
+            break;
+
+        assign(position, m_heap[parent]);
+        position = parent;
+    }
+
+    assign(position, evt);
+}
+
+void IndexedHeapScheduler::siftDown(size_t position)
+{
+    InternalEvent* evt = m_heap[position];
+    const size_t sz = m_heap.size();
+
+    for (;;) {
+        size_t first = position * arity + 1;
+        if (first >= sz)
+            break;
+
+        size_t last = std::min(first + arity, sz);
+        size_t child = first;
+
+        for (size_t i = first + 1; i < last; ++i) {
+            if (internalBefore(m_heap[i], m_heap[child])) {
+                child = i;
+            }
+        }
+
+        if (not internalBefore(m_heap[child], evt))
+            break;
+
+        assign(position, m_heap[child]);
+        position = child;
+    }
+
+    assign(position, evt);
+}
+
+                       /* - - - - - - - - - -*/
+
+const size_t CalendarScheduler::minBuckets;
+const size_t CalendarScheduler::sampleSize;
+
+CalendarScheduler::CalendarScheduler(size_t /* sz */)
+    : m_buckets(minBuckets), m_width(1.0), m_current(0.0), m_size(0),
+    m_sorted(true)
+{
+}
+
+CalendarScheduler::~CalendarScheduler()
+{
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        std::for_each(m_buckets[i].begin(), m_buckets[i].end(),
+                      boost::checked_deleter < InternalEvent >());
+    }
+}
+
+void CalendarScheduler::put(InternalEvent* event)
+{
+    Simulator* sim = event->getModel();
+    InternalEvent* old = sim->scheduledEvent();
+
+    if (old) {
+        removeReady(old);
+        remove(old);
+        delete old;
+    }
+
+    sim->setScheduledEvent(event);
+    insert(event);
+
+    if (m_size > 2 * m_buckets.size()) {
+        resize(2 * m_buckets.size());
+    }
+}
+
+const InternalEvent* CalendarScheduler::find(Simulator* sim) const
+{
+    return sim->scheduledEvent();
+}
+
+void CalendarScheduler::erase(Simulator* sim)
+{
+    InternalEvent* evt = sim->scheduledEvent();
+
+    if (evt) {
+        removeReady(evt);
+        remove(evt);
+        sim->setScheduledEvent(0);
+        delete evt;
+
+        if (m_buckets.size() > minBuckets and m_size < m_buckets.size() / 2) {
+            resize(m_buckets.size() / 2);
+        }
+    }
+}
+
+const Time& CalendarScheduler::topTime()
+{
+    if (m_size == 0) {
+        return infinity;
+    }
+
+    if (m_ready.empty()) {
+        searchTop();
+    }
+
+    return m_ready.front()->getTime();
+}
+
+InternalEvent* CalendarScheduler::pop()
+{
+    if (m_size == 0) {
+        return 0;
+    }
+
+    if (m_ready.empty()) {
+        searchTop();
+    }
+
+    if (not m_sorted) {
+        std::sort(m_ready.begin(), m_ready.end(), internalIdGreater);
+        m_sorted = true;
+    }
+
+    InternalEvent* evt = m_ready.back();
+    m_ready.pop_back();
+    remove(evt);
+    evt->getModel()->setScheduledEvent(0);
+
+    if (m_buckets.size() > minBuckets and m_size < m_buckets.size() / 2) {
+        resize(m_buckets.size() / 2);
+    }
+
+    return evt;
+}
+
+void CalendarScheduler::insert(InternalEvent* event)
+{
+    double k = key(event->getTime());
+
+    if (m_size == 0 or k < m_current) {
+        m_current = k;
+    }
+
+    InternalEventList& lst = m_buckets[bucket(k)];
+    event->setPosition(lst.size());
+    lst.push_back(event);
+    ++m_size;
+
+    if (not m_ready.empty()) {
+        if (event->getTime() < m_ready.front()->getTime()) {
+            m_ready.assign(1, event);
+        } else if (event->getTime() == m_ready.front()->getTime()) {
+            m_ready.push_back(event);
+            m_sorted = false;
+        }
+    }
+}
+
+void CalendarScheduler::remove(InternalEvent* event)
+{
+    InternalEventList& lst = m_buckets[bucket(key(event->getTime()))];
+    size_t position = event->position();
+    InternalEvent* last = lst.back();
+
+    lst.pop_back();
+    if (position < lst.size()) {
+        lst[position] = last;
+        last->setPosition(position);
+    }
+    --m_size;
+}
+
+void CalendarScheduler::removeReady(InternalEvent* event)
+{
+    if (not m_ready.empty() and
+        event->getTime() == m_ready.front()->getTime()) {
+        InternalEventList::iterator it = std::find(m_ready.begin(),
+                                                   m_ready.end(), event);
+        if (it != m_ready.end()) {
+            m_ready.erase(it);
+        }
+    }
+}
+
+void CalendarScheduler::searchTop()
+{
+    m_sorted = false;
+
+    // All the events are in the virtual bucket m_current or after. Each
+    // bucket is visited once in the order of the calendar, the first events
+    // found in their virtual bucket are in the earliest interval.
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        const InternalEventList& lst = m_buckets[bucket(m_current)];
+
+        for (InternalEventList::const_iterator it = lst.begin();
+             it != lst.end(); ++it) {
+            if (key((*it)->getTime()) <= m_current) {
+                if (m_ready.empty() or
+                    (*it)->getTime() < m_ready.front()->getTime()) {
+                    m_ready.assign(1, *it);
+                } else if ((*it)->getTime() == m_ready.front()->getTime()) {
+                    m_ready.push_back(*it);
+                }
+            }
+        }
+
+        if (not m_ready.empty()) {
+            return;
+        }
+
+        m_current += 1.0;
+    }
+
+    // The next event is more than one year after the current bucket, the
+    // width is too small for this distribution of events: a new width is
+    // estimated and the most recent events are searched directly.
+    resize(m_buckets.size());
+
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        for (InternalEventList::const_iterator it = m_buckets[i].begin();
+             it != m_buckets[i].end(); ++it) {
+            if (m_ready.empty() or
+                (*it)->getTime() < m_ready.front()->getTime()) {
+                m_ready.assign(1, *it);
+            } else if ((*it)->getTime() == m_ready.front()->getTime()) {
+                m_ready.push_back(*it);
+            }
+        }
+    }
+
+    m_current = key(m_ready.front()->getTime());
+}
+
+void CalendarScheduler::resize(size_t buckets)
+{
+    InternalEventList events;
+    events.reserve(m_size);
+
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        events.insert(events.end(), m_buckets[i].begin(), m_buckets[i].end());
+    }
+
+    // Estimate the width with the average separation of the earliest
+    // events. Simultaneous events and separations greater than twice the
+    // average are not used.
+    size_t sample = std::min(events.size(), sampleSize);
+    std::partial_sort(events.begin(), events.begin() + sample, events.end(),
+                      internalDateLess);
+
+    double sum = 0.0;
+    size_t nb = 0;
+    for (size_t i = 1; i < sample; ++i) {
+        double gap = events[i]->getTime() - events[i - 1]->getTime();
+        if (gap > 0.0) {
+            sum += gap;
+            ++nb;
+        }
+    }
+
+    if (nb > 0) {
+        double average = sum / nb;
+
+        sum = 0.0;
+        nb = 0;
+        for (size_t i = 1; i < sample; ++i) {
+            double gap = events[i]->getTime() - events[i - 1]->getTime();
+            if (gap > 0.0 and gap <= 2.0 * average) {
+                sum += gap;
+                ++nb;
+            }
+        }
+
+        double width = 3.0 * sum / nb;
+        if (width > 0.0 and not isInfinity(width)) {
+            m_width = width;
+        }
+    }
+
+    m_buckets.clear();
+    m_buckets.resize(buckets);
+    m_size = 0;
+    m_ready.clear();
+
+    for (InternalEventList::iterator it = events.begin(); it != events.end();
+         ++it) {
+        insert(*it);
+    }
+}
+
+}} // namespace vle devs
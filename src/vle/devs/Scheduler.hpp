@@ -0,0 +1,394 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_SCHEDULER_HPP
+#define VLE_DEVS_SCHEDULER_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/InternalEvent.hpp>
+#include <vle/devs/Time.hpp>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace devs {
+
+class Simulator;
+
+/**
+ * Compare two internals events with devs::Time like comparator.
+ *
+ * @param e1 first event to compare.
+ * @param e2 second event to compare.
+ * @return true if devs::Time e1 is more recent than devs::Time e2.
+ */
+inline bool internalLessThan(const InternalEvent* e1,
+                             const InternalEvent* e2)
+{ return (e1->getTime() > e2->getTime()); }
+
+/**
+ * Defines the implementations available to store the @e InternalEvent of
+ * the @e EventTable.
+ */
+enum SchedulerType {
+    SCHEDULER_HEAP,             /**< Binary heap where rescheduled events
+                                 * are invalidated and freed lazily. */
+    SCHEDULER_INDEXED_HEAP,     /**< 4-ary heap indexed by Simulator where
+                                 * events are rescheduled in place. */
+    SCHEDULER_CALENDAR          /**< Calendar queue indexed by Simulator
+                                 * with O(1) amortized operations. */
+};
+
+/**
+ * Get the @e SchedulerType used by default by the @e EventTable. This
+ * type depends of the @c WITH_INDEXED_SCHEDULER build option.
+ *
+ * @return A @e SchedulerType.
+ */
+VLE_API SchedulerType defaultSchedulerType();
+
+/**
+ * Get the @e SchedulerType from its name as used in the
+ * simulation_engine condition of the @e vpz::Experiment.
+ *
+ * @param name The name of the scheduler: "heap", "indexed-heap" or
+ * "calendar".
+ *
+ * @return A @e SchedulerType.
+ * @throw utils::ArgError if the name is unknown.
+ */
+VLE_API SchedulerType schedulerTypeFromName(const std::string& name);
+
+/**
+ * @e Scheduler stores the next @e InternalEvent of each @e Simulator
+ * ordered by date. A @e Simulator owns at most one pending @e
+ * InternalEvent: putting a new @e InternalEvent for a @e Simulator
+ * replaces the previous one. The @e InternalEvent of the same date are
+ * popped in the order of @e Simulator::id() whatever the implementation,
+ * so the bags of the @e EventTable do not depend on the scheduler.
+ */
+class VLE_API Scheduler
+{
+public:
+    virtual ~Scheduler()
+    {}
+
+    /**
+     * Build a new @e Scheduler.
+     *
+     * @param type The implementation to use.
+     * @param sz The number of events to reserve.
+     *
+     * @return A new @e Scheduler to freed.
+     */
+    static Scheduler* create(SchedulerType type, size_t sz);
+
+    /**
+     * Get the implementation of this @e Scheduler.
+     *
+     * @return A @e SchedulerType.
+     */
+    virtual SchedulerType type() const = 0;
+
+    /**
+     * Put an @e InternalEvent into the scheduler. If the @e Simulator of the
+     * event already has a pending @e InternalEvent, the old one is
+     * deleted.
+     *
+     * @param event The @e InternalEvent to store, the scheduler takes the
+     * ownership.
+     */
+    virtual void put(InternalEvent* event) = 0;
+
+    /**
+     * Get the pending @e InternalEvent of the @e Simulator.
+     *
+     * @param sim The @e Simulator to search.
+     *
+     * @return The @e InternalEvent or NULL if the @e Simulator does not
+     * have pending event.
+     */
+    virtual const InternalEvent* find(Simulator* sim) const = 0;
+
+    /**
+     * Delete the pending @e InternalEvent of the @e Simulator if it
+     * exists.
+     *
+     * @param sim The @e Simulator.
+     */
+    virtual void erase(Simulator* sim) = 0;
+
+    /**
+     * Get the date of the most recent @e InternalEvent.
+     *
+     * @return A date or @e infinity if the scheduler is empty.
+     */
+    virtual const Time& topTime() = 0;
+
+    /**
+     * Remove the most recent @e InternalEvent from the scheduler.
+     *
+     * @return The @e InternalEvent to freed or NULL if the scheduler is
+     * empty.
+     */
+    virtual InternalEvent* pop() = 0;
+
+    /**
+     * Get the number of @e InternalEvent stored into the scheduler.
+     *
+     * @return The number of events, including invalidated events for
+     * lazy implementations.
+     */
+    virtual size_t size() const = 0;
+};
+
+/**
+ * @e HeapScheduler stores the @e InternalEvent into a binary heap. When a
+ * @e Simulator is rescheduled, the previous @e InternalEvent is only
+ * invalidated and is deleted when it reaches the top of the heap.
+ */
+class VLE_API HeapScheduler : public Scheduler
+{
+public:
+    HeapScheduler(size_t sz);
+
+    virtual ~HeapScheduler();
+
+    virtual SchedulerType type() const
+    { return SCHEDULER_HEAP; }
+
+    virtual void put(InternalEvent* event);
+
+    virtual const InternalEvent* find(Simulator* sim) const;
+
+    virtual void erase(Simulator* sim);
+
+    virtual const Time& topTime();
+
+    virtual InternalEvent* pop();
+
+    virtual size_t size() const
+    { return mInternalEventList.size(); }
+
+private:
+    /// pending InternalEvent indexed by Simulator::id().
+    typedef std::vector < InternalEvent* > InternalEventModel;
+
+    /**
+     * @brief delete the first invalid InternalEvent from InternalEventList.
+     */
+    void cleanInternalEventList();
+
+    /// scheduller for internal event.
+    InternalEventList mInternalEventList;
+
+    /// table to quick found event.
+    InternalEventModel mInternalEventModel;
+};
+
+/**
+ * @e IndexedHeapScheduler stores the @e InternalEvent into a 4-ary heap.
+ * Each @e InternalEvent knows its position in the heap and each @e
+ * Simulator knows its pending @e InternalEvent so rescheduling a @e
+ * Simulator is a decrease or increase key operation in place. The heap
+ * never stores more than one @e InternalEvent per @e Simulator.
+ */
+class VLE_API IndexedHeapScheduler : public Scheduler
+{
+public:
+    IndexedHeapScheduler(size_t sz);
+
+    virtual ~IndexedHeapScheduler();
+
+    virtual SchedulerType type() const
+    { return SCHEDULER_INDEXED_HEAP; }
+
+    virtual void put(InternalEvent* event);
+
+    virtual const InternalEvent* find(Simulator* sim) const;
+
+    virtual void erase(Simulator* sim);
+
+    virtual const Time& topTime();
+
+    virtual InternalEvent* pop();
+
+    virtual size_t size() const
+    { return m_heap.size(); }
+
+private:
+    /// number of children of a node of the heap.
+    static const size_t arity = 4;
+
+    /**
+     * Remove the @e InternalEvent at the specified position of the heap.
+     *
+     * @param position The position of the event to remove.
+     */
+    void remove(size_t position);
+
+    /**
+     * Move the @e InternalEvent at the specified position to the root of
+     * the heap while it is older than its parent.
+     */
+    void siftUp(size_t position);
+
+    /**
+     * Move the @e InternalEvent at the specified position to the leafs of
+     * the heap while it is more recent than one of its children.
+     */
+    void siftDown(size_t position);
+
+    /**
+     * Store the @e InternalEvent at the specified position and update its
+     * index.
+     */
+    inline void assign(size_t position, InternalEvent* event)
+    {
+        m_heap[position] = event;
+        event->setPosition(position);
+    }
+
+    InternalEventList m_heap;
+};
+
+/**
+ * @e CalendarScheduler stores the @e InternalEvent into a calendar queue
+ * (R. Brown, 1988): an array of buckets where each bucket stores the
+ * events of a time interval of length @e width modulo the length of the
+ * calendar. The number of buckets follows the number of events and the
+ * width is estimated from the separation of the earliest events so put,
+ * erase and pop are O(1) amortized. Like the @e IndexedHeapScheduler, each
+ * @e Simulator knows its pending @e InternalEvent and the scheduler never
+ * stores more than one @e InternalEvent per @e Simulator.
+ *
+ * The @e topTime is always the exact minimum date: all the events with the
+ * same date are popped one after another by the @e EventTable to build the
+ * same @e CompleteEventBagModel than with the heaps.
+ */
+class VLE_API CalendarScheduler : public Scheduler
+{
+public:
+    CalendarScheduler(size_t sz);
+
+    virtual ~CalendarScheduler();
+
+    virtual SchedulerType type() const
+    { return SCHEDULER_CALENDAR; }
+
+    virtual void put(InternalEvent* event);
+
+    virtual const InternalEvent* find(Simulator* sim) const;
+
+    virtual void erase(Simulator* sim);
+
+    virtual const Time& topTime();
+
+    virtual InternalEvent* pop();
+
+    virtual size_t size() const
+    { return m_size; }
+
+    /**
+     * Get the number of buckets of the calendar.
+     *
+     * @return The number of buckets, a power of two.
+     */
+    size_t buckets() const
+    { return m_buckets.size(); }
+
+    /**
+     * Get the length of the time interval of a bucket.
+     *
+     * @return The width of a bucket.
+     */
+    double width() const
+    { return m_width; }
+
+private:
+    /// minimal number of buckets of the calendar.
+    static const size_t minBuckets = 16;
+
+    /// number of events used to estimate the width of a bucket.
+    static const size_t sampleSize = 25;
+
+    /**
+     * Compute the index of the virtual bucket of a date ie. the index of
+     * the interval of length @e width which contains the date.
+     */
+    inline double key(const Time& time) const
+    { return std::floor(time / m_width); }
+
+    /**
+     * Compute the bucket of a virtual bucket.
+     */
+    inline size_t bucket(double key) const
+    {
+        double r = std::fmod(key, (double)m_buckets.size());
+        return (size_t)(r < 0.0 ? r + m_buckets.size() : r);
+    }
+
+    /**
+     * Store the @e InternalEvent in its bucket.
+     */
+    void insert(InternalEvent* event);
+
+    /**
+     * Remove the @e InternalEvent from its bucket.
+     */
+    void remove(InternalEvent* event);
+
+    /**
+     * Remove the @e InternalEvent from the most recent events if it is
+     * one of them.
+     */
+    void removeReady(InternalEvent* event);
+
+    /**
+     * Search the most recent @e InternalEvent from the current virtual
+     * bucket and fill @e m_ready.
+     */
+    void searchTop();
+
+    /**
+     * Change the number of buckets and estimate a new width, then all the
+     * events are dispatched in the new buckets.
+     */
+    void resize(size_t buckets);
+
+    std::vector < InternalEventList > m_buckets;
+    double m_width;   ///< the time interval of a bucket.
+    double m_current; ///< virtual bucket of the search, <= to all events.
+    size_t m_size;
+    InternalEventList m_ready; ///< cache of the most recent events.
+    bool m_sorted; ///< m_ready is sorted by decreasing Simulator::id().
+};
+
+}} // namespace vle devs
+
+#endif
@@ -29,19 +29,33 @@
 #include <vle/devs/Dynamics.hpp>
 #include <vle/devs/Time.hpp>
 #include <vle/vpz/AtomicModel.hpp>
+#include <algorithm>
 
 namespace vle { namespace devs {
 
 Simulator::Simulator(vpz::AtomicModel* atomic) :
     m_dynamics(0),
-    m_atomicModel(atomic)
+    m_atomicModel(atomic),
+    m_scheduledEvent(0),
+    m_bag(0),
+    m_id(0)
 {
     if (not atomic) {
         throw utils::InternalError(_(
             "Simulator is not connected to an atomic model."));
     }
+
+    const vpz::ConnectionList& outputs(atomic->getOutputPortList());
+
+    m_outputs.reserve(outputs.size());
+    for (vpz::ConnectionList::const_iterator it = outputs.begin();
+         it != outputs.end(); ++it) {
+        addOutputPort(it->first);
+    }
 }
 
+const Simulator::size_type Simulator::NO_PORT;
+
 Simulator::~Simulator()
 {
     delete m_dynamics;
@@ -54,71 +68,129 @@ void Simulator::clear()
     m_atomicModel = 0;
 }
 
+void Simulator::removeEventView(View* view)
+{
+    std::vector < View* >::iterator it = std::find(m_eventViews.begin(),
+                                                   m_eventViews.end(), view);
+
+    if (it != m_eventViews.end()) {
+        m_eventViews.erase(it);
+    }
+}
+
+Simulator::size_type Simulator::outputPortId(const std::string& port)
+{
+    for (size_type i = 0, e = m_outputs.size(); i != e; ++i) {
+        if (m_outputs[i].name == port) {
+            return i;
+        }
+    }
+
+    return addOutputPort(port);
+}
+
+Simulator::size_type Simulator::addOutputPort(const std::string& port)
+{
+    m_outputs.push_back(OutputPort(port));
+
+    size_type id = m_outputs.back().port->id;
+    if (id >= m_portIndex.size()) {
+        m_portIndex.resize(id + 1, NO_PORT);
+    }
+    m_portIndex[id] = m_outputs.size() - 1;
+
+    return m_outputs.size() - 1;
+}
+
 void
 Simulator::updateSimulatorTargets(
         const std::string& port,
-        std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
+        const std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
 {
-    mTargets.erase(port);
+    OutputPort& output(m_outputs[outputPortId(port)]);
+
+    output.targets.clear();
+    output.updated = false;
 
     vpz::ModelPortList result;
     m_atomicModel->getAtomicModelsTarget(port, result);
 
-    if (result.begin() == result.end()) {
-        mTargets.insert(value_type(port, TargetSimulator(
-                   (Simulator*)0, std::string())));
-    } else {
-        for (vpz::ModelPortList::iterator it = result.begin(); it !=
-                result.end(); ++it) {
+    for (vpz::ModelPortList::iterator it = result.begin(); it !=
+         result.end(); ++it) {
 
-            std::map < vpz::AtomicModel*, devs::Simulator* >::iterator target;
+        std::map < vpz::AtomicModel*, devs::Simulator* >::const_iterator
             target = simulators.find(
-                    reinterpret_cast < vpz::AtomicModel*>(it->first));
-
-            if (target == simulators.end()) {
-                mTargets.erase(port);
-                break;
-            } else {
-                mTargets.insert(std::make_pair(port, TargetSimulator(
-                            target->second, it->second)));
-            }
+                reinterpret_cast < vpz::AtomicModel*>(it->first));
+
+        if (target == simulators.end()) {
+            output.targets.clear();
+            return;
         }
+
+        output.targets.push_back(TargetSimulator(
+                target->second, ExternalEvent::internPortName(it->second)));
     }
+
+    output.updated = true;
 }
 
-std::pair < Simulator::iterator, Simulator::iterator >
+std::pair < Simulator::const_iterator, Simulator::const_iterator >
 Simulator::targets(
-    const std::string& port,
-    std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
+    size_type port,
+    const std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
 {
-    std::pair < iterator, iterator > x = mTargets.equal_range(port);
+    assert(port < m_outputs.size());
 
-    if (x.first == x.second) {
-        updateSimulatorTargets(port, simulators);
-        x = mTargets.equal_range(port);
-    } else if (x.first->second.first == 0) {
-        x = make_pair(mTargets.end(), mTargets.end());
+    if (not m_outputs[port].updated) {
+        updateSimulatorTargets(m_outputs[port].name, simulators);
     }
 
-    return x;
+    const TargetSimulatorList& lst(m_outputs[port].targets);
+
+    return std::make_pair(lst.begin(), lst.end());
 }
 
-void Simulator::removeTargetPort(const std::string& port)
+std::pair < Simulator::const_iterator, Simulator::const_iterator >
+Simulator::targets(
+    const ExternalEvent& event,
+    const std::map < vpz::AtomicModel*, devs::Simulator* >& simulators)
 {
-    iterator it = mTargets.find(port);
+    static const TargetSimulatorList empty;
+    std::size_t id = event.getPortId();
+
+    if (id < m_portIndex.size() and m_portIndex[id] != NO_PORT) {
+        return targets(m_portIndex[id], simulators);
+    }
+
+    if (id == static_cast < std::size_t >(-1)) {
+        const std::string& name(event.getPortName());
+
+        for (size_type i = 0, e = m_outputs.size(); i != e; ++i) {
+            if (m_outputs[i].name == name) {
+                return targets(i, simulators);
+            }
+        }
 
-    if (it != mTargets.end()) {
-        mTargets.erase(it);
+        return std::make_pair(empty.begin(), empty.end());
     }
+
+    return targets(event.getPortName(), simulators);
+}
+
+void Simulator::removeTargetPort(const std::string& port)
+{
+    OutputPort& output(m_outputs[outputPortId(port)]);
+
+    output.targets.clear();
+    output.updated = false;
 }
 
 void Simulator::addTargetPort(const std::string& port)
 {
-    assert(mTargets.find(port) == mTargets.end());
+    OutputPort& output(m_outputs[outputPortId(port)]);
 
-    mTargets.insert(value_type(port,
-                               TargetSimulator((Simulator*)0,
-                                               std::string())));
+    output.targets.clear();
+    output.updated = true;
 }
 
 void Simulator::addDynamics(Dynamics* dynamics)
@@ -223,4 +295,15 @@ value::Value* Simulator::observation(const ObservationEvent& event) const
     return m_dynamics->observation(event);
 }
 
+Dynamics::ObservationType Simulator::observationType(
+    const std::string& port) const
+{
+    return m_dynamics->observationType(port);
+}
+
+double Simulator::numericObservation(const ObservationEvent& event) const
+{
+    return m_dynamics->numericObservation(event);
+}
+
 }} // namespace vle devs
@@ -32,6 +32,7 @@
 #include <vle/devs/Time.hpp>
 #include <vle/devs/InternalEvent.hpp>
 #include <vle/devs/ObservationEvent.hpp>
+#include <vle/devs/ExternalEvent.hpp>
 #include <vle/devs/ExternalEventList.hpp>
 #include <vle/devs/Dynamics.hpp>
 #include <vle/vpz/AtomicModel.hpp>
@@ -39,6 +40,7 @@
 namespace vle { namespace devs {
 
     class Dynamics;
+    class View;
 
     /**
      * @brief Represent a couple devs::AtomicModel and devs::Dynamic class to
@@ -48,14 +50,36 @@ namespace vle { namespace devs {
     class VLE_API Simulator
     {
     public:
-        typedef std::pair < Simulator*, std::string > TargetSimulator;
-        typedef std::multimap < std::string, TargetSimulator >
-            TargetSimulatorList;
+        typedef std::pair < Simulator*, const ExternalEvent::Port* >
+            TargetSimulator;
+        typedef std::vector < TargetSimulator > TargetSimulatorList;
         typedef TargetSimulatorList::const_iterator const_iterator;
         typedef TargetSimulatorList::iterator iterator;
         typedef TargetSimulatorList::size_type size_type;
         typedef TargetSimulatorList::value_type value_type;
 
+        /**
+         * @brief An output port of the Simulator: its name interned when
+         * the Simulator is built and the contiguous list of the simulators
+         * connected to it with their interned input port (see
+         * ExternalEvent::internPortName). The list is only valid if
+         * @c updated is true.
+         */
+        struct OutputPort
+        {
+            OutputPort(const std::string& name)
+                : name(name), port(ExternalEvent::internPortName(name)),
+                updated(false)
+            {}
+
+            std::string                 name;
+            const ExternalEvent::Port  *port;
+            TargetSimulatorList         targets;
+            bool                        updated;
+        };
+
+        typedef std::vector < OutputPort > OutputPortList;
+
         /**
          * @brief Build a new devs::Simulator with an empty devs::Dynamics, a
          * null last time but a vpz::AtomicModel node.
@@ -99,6 +123,24 @@ namespace vle { namespace devs {
         inline vpz::AtomicModel* getStructure() const
         { return m_atomicModel; }
 
+        /**
+         * @brief Get the dense index of this Simulator in its
+         * devs::Coordinator. The index is assigned when the Simulator is
+         * added to the devs::Coordinator and can be reused by another
+         * Simulator after the deletion of this one.
+         * @return An index in [0, number of simulators[.
+         */
+        inline size_t id() const
+        { return m_id; }
+
+        /**
+         * @brief Assign the dense index of this Simulator. Only used by the
+         * devs::Coordinator.
+         * @param id The index.
+         */
+        inline void setId(size_t id)
+        { m_id = id; }
+
         /**
          * @brief Delete the dynamics and erase reference to the AtomicModel.
          */
@@ -111,9 +153,99 @@ namespace vle { namespace devs {
         inline const Dynamics* dynamics() const
         { return m_dynamics; }
 
+        /**
+         * @brief Get the pending InternalEvent of this Simulator stored in
+         * the devs::IndexedHeapScheduler or the devs::CalendarScheduler.
+         * @return A pointer to the InternalEvent or NULL.
+         */
+        inline InternalEvent* scheduledEvent() const
+        { return m_scheduledEvent; }
+
+        /**
+         * @brief Assign the pending InternalEvent of this Simulator. Only
+         * used by the devs::IndexedHeapScheduler and the
+         * devs::CalendarScheduler.
+         * @param event The InternalEvent or NULL.
+         */
+        inline void setScheduledEvent(InternalEvent* event)
+        { m_scheduledEvent = event; }
+
+        /**
+         * @brief Get the position of the bag of this Simulator in the
+         * devs::CompleteEventBagModel of the current step.
+         * @return The position plus one or 0 if the Simulator has no bag.
+         */
+        inline size_t bag() const
+        { return m_bag; }
+
+        /**
+         * @brief Assign the position of the bag of this Simulator. Only
+         * used by the devs::CompleteEventBagModel.
+         * @param bag The position plus one or 0.
+         */
+        inline void setBag(size_t bag)
+        { m_bag = bag; }
+
+        /**
+         * @brief Get the event views which observe this Simulator: they are
+         * run after each transition of the Simulator.
+         * @return The event views, empty if the Simulator is not observed
+         * by an event view.
+         */
+        inline const std::vector < View* >& eventViews() const
+        { return m_eventViews; }
+
+        /**
+         * @brief Attach an event view to this Simulator. Only used by
+         * devs::View::addObservable.
+         * @param view The event view.
+         */
+        inline void addEventView(View* view)
+        { m_eventViews.push_back(view); }
+
+        /**
+         * @brief Detach an event view from this Simulator. Only used by
+         * devs::View::removeObservable.
+         * @param view The event view.
+         */
+        void removeEventView(View* view);
+
 
                              /*-*-*-*-*-*-*-*-*-*/
 
+        /**
+         * @brief Get the index of the output port in the routing table of
+         * the Simulator. If the port is unknown, a new index is assigned.
+         * @param port The name of the output port.
+         * @return The index of the output port.
+         */
+        size_type outputPortId(const std::string& port);
+
+        /**
+         * @brief Get the name of the output port from its index.
+         * @param id The index of the output port.
+         * @return The name of the output port.
+         */
+        const std::string& outputPortName(size_type id) const
+        { return m_outputs[id].name; }
+
+        /**
+         * @brief Get the interned output port from its index. The
+         * dynamics use it to build their events without lock (see
+         * ExternalEvent::ExternalEvent(const ExternalEvent::Port*)).
+         * @param id The index of the output port.
+         * @return The interned output port.
+         */
+        const ExternalEvent::Port* outputPort(size_type id) const
+        { return m_outputs[id].port; }
+
+        /**
+         * @brief Get the number of output ports in the routing table.
+         * @return The number of output ports.
+         */
+        size_type outputPortNumber() const
+        { return m_outputs.size(); }
+
         /**
          * @brief Call this function to browse the model's structure (atomic
          * and coupled models) to find all devs::Simulator connected to the
@@ -123,7 +255,21 @@ namespace vle { namespace devs {
          */
         void updateSimulatorTargets(
             const std::string& port,
-            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators);
+            const std::map < vpz::AtomicModel*, devs::Simulator* >&
+            simulators);
+
+        /**
+         * @brief Get two iterators (begin, end) on TargetSimulator. The list
+         * is built the first time the port is used, then it is only rebuilt
+         * by the updateSimulatorTargets() function.
+         * @param port The index of the output port.
+         * @param simulators list of available simulators.
+         * @return Two iterators.
+         */
+        std::pair < const_iterator, const_iterator > targets(
+            size_type port,
+            const std::map < vpz::AtomicModel*, devs::Simulator* >&
+            simulators);
 
         /**
          * @brief Get two iterators (begin, end) on TargetSimulator.
@@ -131,20 +277,39 @@ namespace vle { namespace devs {
          * @param simulators list of available simulators.
          * @return Two iterators.
          */
-        std::pair < iterator, iterator > targets(
+        std::pair < const_iterator, const_iterator > targets(
             const std::string& port,
-            std::map < vpz::AtomicModel*, devs::Simulator* >& simulators);
+            const std::map < vpz::AtomicModel*, devs::Simulator* >&
+            simulators)
+        { return targets(outputPortId(port), simulators); }
 
         /**
-         * @brief Add an empty target port.
-         * @param port Name of the port.
+         * @brief Get two iterators (begin, end) on the TargetSimulator of
+         * the output port of an event. The interned port of the event is
+         * an index in the table of the output ports: the name is only
+         * searched if the port is interned by another model. The name of
+         * an event built by name is searched in the output ports of the
+         * Simulator: an unknown port has no target.
+         * @param event The event to route.
+         * @param simulators list of available simulators.
+         * @return Two iterators.
          */
-        void removeTargetPort(const std::string& port);
+        std::pair < const_iterator, const_iterator > targets(
+            const ExternalEvent& event,
+            const std::map < vpz::AtomicModel*, devs::Simulator* >&
+            simulators);
 
         /**
-         * @brief Remove a target port.
+         * @brief Remove a target port. The index of the port is kept but its
+         * target list will be rebuilt on the next use.
          * @param port Name of the port to remove.
          */
+        void removeTargetPort(const std::string& port);
+
+        /**
+         * @brief Add an empty target port.
+         * @param port Name of the port.
+         */
         void addTargetPort(const std::string& port);
 
                              /*-*-*-*-*-*-*-*-*-*/
@@ -174,13 +339,34 @@ namespace vle { namespace devs {
 
         value::Value* observation(const ObservationEvent& event) const;
 
+        Dynamics::ObservationType observationType(
+            const std::string& port) const;
+
+        double numericObservation(const ObservationEvent& event) const;
+
     private:
-        TargetSimulatorList mTargets;
+        static const size_type NO_PORT = static_cast < size_type >(-1);
+
+        OutputPortList      m_outputs;
+
+        /**
+         * The index of the output ports by the identifier of their
+         * ExternalEvent::Port, NO_PORT for the ports of the other models.
+         * Its size is the greatest identifier of the output ports plus one:
+         * small since the ports share their names across the models.
+         */
+        std::vector < size_type > m_portIndex;
         Dynamics*           m_dynamics;
         vpz::AtomicModel*   m_atomicModel;
         std::string         m_parents;
+        InternalEvent*      m_scheduledEvent;
+        size_t              m_bag;
+        size_t              m_id;
+        std::vector < View* > m_eventViews; ///< the observing event views.
 
 	InternalEvent* buildInternalEvent(const Time& currentTime);
+
+        size_type addOutputPort(const std::string& port);
     };
 
 }} // namespace vle devs
@@ -31,9 +31,284 @@
 #include <vle/utils/Path.hpp>
 #include <vle/utils/Algo.hpp>
 #include <vle/version.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
 
 namespace vle { namespace devs {
 
+/*
+ * The devs::StreamWriter::Queue source: a bounded ring of records written
+ * by the simulation thread and read by the thread which calls the
+ * plug-in. The indexes of the ring are atomic, the mutex is taken only to
+ * wait when the ring is empty or full.
+ */
+
+class StreamWriter::Queue
+{
+public:
+    enum RecordType { NEW_OBSERVABLE, NEW_COLUMN, DEL_OBSERVABLE, VALUE,
+        VALUES, VALUE_BATCH };
+
+    struct Record
+    {
+        Record()
+            : type(VALUE), time(0.0), value(0), column(0)
+        {}
+
+        RecordType             type;
+        std::string            simulator;
+        std::string            parent;
+        std::string            port;
+        std::string            view;
+        devs::Time             time;
+        value::Value*          value;
+        std::size_t            column;
+        std::vector < double > row;
+        std::vector < value::Value* > values;
+    };
+
+    Queue(const oov::PluginPtr& plugin, std::size_t capacity)
+        : m_plugin(plugin), m_records(capacity), m_head(0), m_tail(0),
+        m_consumerWaiting(false), m_producerWaiting(false), m_stop(false),
+        m_failed(false)
+    {
+        m_statistics.capacity = capacity;
+        m_thread = boost::thread(boost::bind(&Queue::consume, this));
+    }
+
+    /**
+     * Stop the thread, the records not sent to the plug-in are deleted.
+     */
+    ~Queue()
+    {
+        stop();
+
+        for (std::size_t i = m_tail; i != m_head; ++i) {
+            Record& record(m_records[i % m_records.size()]);
+            delete record.value;
+            clearValues(record);
+        }
+    }
+
+    /**
+     * Get the next free record, wait for the thread if the ring is full.
+     */
+    Record& reserve()
+    {
+        std::size_t head = m_head.load(boost::memory_order_relaxed);
+
+        if (head - m_tail.load(boost::memory_order_acquire) ==
+            m_records.size()) {
+            boost::posix_time::ptime start(
+                boost::posix_time::microsec_clock::universal_time());
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_producerWaiting.store(true);
+                while (head - m_tail.load() == m_records.size() and
+                       not m_failed) {
+                    m_producerCondition.wait(lock);
+                }
+                m_producerWaiting.store(false);
+            }
+            m_statistics.stalls++;
+            m_statistics.stallTime +=
+                (boost::posix_time::microsec_clock::universal_time() -
+                 start).total_microseconds() / 1e6;
+        }
+
+        checkFailure();
+        return m_records[head % m_records.size()];
+    }
+
+    /**
+     * Publish the record returned by reserve() to the thread.
+     */
+    void push()
+    {
+        std::size_t head = m_head.load(boost::memory_order_relaxed) + 1;
+        std::size_t depth = head - m_tail.load(boost::memory_order_relaxed);
+
+        m_head.store(head);
+        m_statistics.records++;
+        if (depth > m_statistics.depth) {
+            m_statistics.depth = depth;
+        }
+
+        if (m_consumerWaiting.load()) {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_consumerCondition.notify_one();
+        }
+    }
+
+    /**
+     * Wait until the thread sends all the records to the plug-in.
+     */
+    void flush()
+    {
+        std::size_t head = m_head.load(boost::memory_order_relaxed);
+
+        if (m_tail.load(boost::memory_order_acquire) != head) {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_producerWaiting.store(true);
+            while (m_tail.load() != head and not m_failed) {
+                m_producerCondition.wait(lock);
+            }
+            m_producerWaiting.store(false);
+        }
+
+        checkFailure();
+    }
+
+    /**
+     * Stop and join the thread.
+     */
+    void stop()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_stop = true;
+            m_consumerCondition.notify_one();
+        }
+        m_thread.join();
+    }
+
+    const QueueStatistics& statistics() const
+    { return m_statistics; }
+
+private:
+    oov::PluginPtr             m_plugin;
+    std::vector < Record >     m_records;
+    boost::atomic < std::size_t > m_head;
+    boost::atomic < std::size_t > m_tail;
+    boost::atomic < bool >     m_consumerWaiting;
+    boost::atomic < bool >     m_producerWaiting;
+    boost::mutex               m_mutex;
+    boost::condition_variable  m_consumerCondition;
+    boost::condition_variable  m_producerCondition;
+    boost::thread              m_thread;
+    bool                       m_stop;
+    boost::atomic < bool >     m_failed;
+    std::string                m_error;
+    QueueStatistics            m_statistics;
+
+    void checkFailure()
+    {
+        if (m_failed.load()) {
+            boost::mutex::scoped_lock lock(m_mutex);
+            throw utils::InternalError(fmt(
+                    _("Oov: the plug-in fails in the observation "
+                      "queue: %1%")) % m_error);
+        }
+    }
+
+    /**
+     * The thread function: send the records to the plug-in until stop().
+     * After a failure of the plug-in, the records are deleted.
+     */
+    void consume()
+    {
+        bool failed = false;
+
+        for (;;) {
+            std::size_t tail = m_tail.load(boost::memory_order_relaxed);
+
+            if (tail == m_head.load(boost::memory_order_acquire)) {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_consumerWaiting.store(true);
+                while (tail == m_head.load() and not m_stop) {
+                    m_consumerCondition.wait(lock);
+                }
+                m_consumerWaiting.store(false);
+
+                if (tail == m_head.load()) {
+                    return;
+                }
+            }
+
+            Record& record(m_records[tail % m_records.size()]);
+            value::Value* value = record.value;
+            record.value = 0;
+
+            if (failed) {
+                delete value;
+                clearValues(record);
+            } else {
+                try {
+                    send(record, value);
+                } catch (const std::exception& e) {
+                    boost::mutex::scoped_lock lock(m_mutex);
+                    m_error = e.what();
+                    m_failed.store(true);
+                    failed = true;
+                    m_producerCondition.notify_one();
+                }
+                // The plug-in owns the values of the batch.
+                std::fill(record.values.begin(), record.values.end(),
+                          static_cast < value::Value* >(0));
+            }
+
+            m_tail.store(tail + 1);
+            if (m_producerWaiting.load()) {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_producerCondition.notify_one();
+            }
+        }
+    }
+
+    void clearValues(Record& record)
+    {
+        for (std::size_t i = 0; i < record.values.size(); ++i) {
+            delete record.values[i];
+            record.values[i] = 0;
+        }
+    }
+
+    void send(Record& record, value::Value* value)
+    {
+        switch (record.type) {
+        case NEW_OBSERVABLE:
+            m_plugin->onNewObservable(record.simulator, record.parent,
+                                      record.port, record.view,
+                                      record.time);
+            break;
+        case NEW_COLUMN:
+            m_plugin->onNewColumn(record.simulator, record.parent,
+                                  record.port, record.view, record.time,
+                                  record.column);
+            break;
+        case DEL_OBSERVABLE:
+            m_plugin->onDelObservable(record.simulator, record.parent,
+                                      record.port, record.view,
+                                      record.time);
+            break;
+        case VALUE:
+            m_plugin->onValue(record.simulator, record.parent, record.port,
+                              record.view, record.time, value);
+            break;
+        case VALUES:
+            m_plugin->onValues(record.view, record.time, &record.row[0],
+                               record.row.size());
+            break;
+        case VALUE_BATCH:
+            m_plugin->onValueBatch(record.view, record.time,
+                                   &record.values[0], record.values.size());
+            break;
+        }
+    }
+};
+
+/*
+ * The devs::StreamWriter source.
+ */
+
+StreamWriter::~StreamWriter()
+{
+    delete m_queue;
+}
+
 oov::PluginPtr StreamWriter::plugin()
 {
     if (not m_plugin) {
@@ -42,6 +317,10 @@ oov::PluginPtr StreamWriter::plugin()
               "may be the StreamWriter::open() function was nether called."));
     }
 
+    if (m_queue) {
+        m_queue->flush();
+    }
+
     return m_plugin;
 }
 
@@ -54,28 +333,112 @@ void StreamWriter::open(const std::string& pluginname,
 {
     void *symbol = 0;
 
-    try {
-        symbol = m_modulemgr.get(package, pluginname, utils::MODULE_OOV);
-        oov::OovPluginSlot fct(utils::functionCast < oov::OovPluginSlot>(symbol));
-        oov::PluginPtr ptr(fct(location));
-        m_plugin = ptr;
-    } catch(const std::exception& e) {
-        throw utils::InternalError(
-            fmt(_("Oov: Can not open the plug-in `%1%': %2%")) % pluginname %
-            e.what());
+    if (oov::Plugin* builtin = oov::buildBuiltinPlugin(package, pluginname,
+                                                       location)) {
+        m_plugin = oov::PluginPtr(builtin);
+    } else {
+        try {
+            symbol = m_modulemgr.get(package, pluginname, utils::MODULE_OOV);
+            oov::OovPluginSlot fct(
+                utils::functionCast < oov::OovPluginSlot>(symbol));
+            oov::PluginPtr ptr(fct(location));
+            m_plugin = ptr;
+        } catch(const std::exception& e) {
+            throw utils::InternalError(
+                fmt(_("Oov: Can not open the plug-in `%1%': %2%")) %
+                pluginname % e.what());
+        }
     }
 
     plugin()->onParameter(pluginname, location, file, parameters, time);
 }
 
+void StreamWriter::open(oov::PluginPtr plugin,
+                        const std::string& file,
+                        value::Value* parameters,
+                        const devs::Time& time)
+{
+    m_plugin = plugin;
+
+    this->plugin()->onParameter(plugin->name(), plugin->location(), file,
+                                parameters, time);
+}
+
+void StreamWriter::setQueue(std::size_t capacity)
+{
+    delete m_queue;
+    m_queue = 0;
+    m_statistics = QueueStatistics();
+
+    if (capacity > 0) {
+        m_queue = new Queue(plugin(), capacity);
+    }
+}
+
+bool StreamWriter::isQueued() const
+{
+    return m_queue or m_statistics.capacity > 0;
+}
+
 void StreamWriter::processNewObservable(Simulator* simulator,
                                         const std::string& portname,
                                         const devs::Time& time,
                                         const std::string& view)
 {
-    plugin()->onNewObservable(simulator->getName(),
-                              simulator->getParent(),
-                              portname, view, time);
+    if (m_queue) {
+        Queue::Record& record(m_queue->reserve());
+        record.type = Queue::NEW_OBSERVABLE;
+        record.simulator.assign(simulator->getName());
+        record.parent.assign(simulator->getParent());
+        record.port.assign(portname);
+        record.view.assign(view);
+        record.time = time;
+        m_queue->push();
+    } else {
+        plugin()->onNewObservable(simulator->getName(),
+                                  simulator->getParent(),
+                                  portname, view, time);
+    }
+}
+
+bool StreamWriter::acceptValues()
+{
+    if (not m_plugin) {
+        plugin();
+    }
+
+    return m_plugin->acceptValues();
+}
+
+bool StreamWriter::acceptValueBatch()
+{
+    if (not m_plugin) {
+        plugin();
+    }
+
+    return m_plugin->acceptValueBatch();
+}
+
+void StreamWriter::processNewColumn(Simulator* simulator,
+                                    const std::string& portname,
+                                    const devs::Time& time,
+                                    const std::string& view,
+                                    std::size_t column)
+{
+    if (m_queue) {
+        Queue::Record& record(m_queue->reserve());
+        record.type = Queue::NEW_COLUMN;
+        record.simulator.assign(simulator->getName());
+        record.parent.assign(simulator->getParent());
+        record.port.assign(portname);
+        record.view.assign(view);
+        record.time = time;
+        record.column = column;
+        m_queue->push();
+    } else {
+        plugin()->onNewColumn(simulator->getName(), simulator->getParent(),
+                              portname, view, time, column);
+    }
 }
 
 void StreamWriter::processRemoveObservable(Simulator* simulator,
@@ -83,9 +446,20 @@ void StreamWriter::processRemoveObservable(Simulator* simulator,
                                            const devs::Time& time,
                                            const std::string& view)
 {
-    plugin()->onDelObservable(simulator->getName(),
-                              simulator->getParent(),
-                              portname, view, time);
+    if (m_queue) {
+        Queue::Record& record(m_queue->reserve());
+        record.type = Queue::DEL_OBSERVABLE;
+        record.simulator.assign(simulator->getName());
+        record.parent.assign(simulator->getParent());
+        record.port.assign(portname);
+        record.view.assign(view);
+        record.time = time;
+        m_queue->push();
+    } else {
+        plugin()->onDelObservable(simulator->getName(),
+                                  simulator->getParent(),
+                                  portname, view, time);
+    }
 }
 
 void StreamWriter::process(Simulator* simulator,
@@ -94,6 +468,32 @@ void StreamWriter::process(Simulator* simulator,
                            const std::string& view,
                            value::Value* val)
 {
+    if (m_queue) {
+        Queue::Record* record;
+
+        try {
+            record = &m_queue->reserve();
+        } catch (...) {
+            delete val;
+            throw;
+        }
+
+        record->type = Queue::VALUE;
+        if (simulator) {
+            record->simulator.assign(simulator->getName());
+            record->parent.assign(simulator->getParent());
+        } else {
+            record->simulator.clear();
+            record->parent.clear();
+        }
+        record->port.assign(portname);
+        record->view.assign(view);
+        record->time = time;
+        record->value = val;
+        m_queue->push();
+        return;
+    }
+
     std::string name, parent;
 
     if (simulator) {
@@ -104,13 +504,87 @@ void StreamWriter::process(Simulator* simulator,
     plugin()->onValue(name, parent, portname, view, time, val);
 }
 
+void StreamWriter::processValues(const devs::Time& time,
+                                 const std::string& view,
+                                 const std::vector < double >& row)
+{
+    if (m_queue) {
+        Queue::Record& record(m_queue->reserve());
+        record.type = Queue::VALUES;
+        record.view.assign(view);
+        record.time = time;
+        record.row.assign(row.begin(), row.end());
+        m_queue->push();
+    } else {
+        plugin()->onValues(view, time, &row[0], row.size());
+    }
+}
+
+void StreamWriter::processValueBatch(const devs::Time& time,
+                                     const std::string& view,
+                                     std::vector < value::Value* >& values)
+{
+    Queue::Record* record = 0;
+    oov::Plugin* target = 0;
+
+    try {
+        if (m_queue) {
+            record = &m_queue->reserve();
+        } else {
+            target = plugin().get();
+        }
+    } catch (...) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            delete values[i];
+            values[i] = 0;
+        }
+        throw;
+    }
+
+    if (record) {
+        record->type = Queue::VALUE_BATCH;
+        record->view.assign(view);
+        record->time = time;
+        record->values.assign(values.begin(), values.end());
+        m_queue->push();
+    } else {
+        // The plug-in owns the values, even if it fails.
+        try {
+            target->onValueBatch(view, time, &values[0], values.size());
+        } catch (...) {
+            std::fill(values.begin(), values.end(),
+                      static_cast < value::Value* >(0));
+            throw;
+        }
+    }
+
+    std::fill(values.begin(), values.end(), static_cast < value::Value* >(0));
+}
+
 void StreamWriter::close(const devs::Time& time)
 {
+    if (m_queue) {
+        try {
+            m_queue->flush();
+        } catch (...) {
+            delete m_queue;
+            m_queue = 0;
+            throw;
+        }
+        m_statistics = m_queue->statistics();
+        delete m_queue;
+        m_queue = 0;
+    }
+
     plugin()->close(time);
 }
 
 value::Matrix * StreamWriter::matrix() const
 {
+    if (m_queue) {
+        m_queue->flush();
+    }
+
     if (m_plugin) {
         return m_plugin->matrix();
     }
@@ -118,4 +592,17 @@ value::Matrix * StreamWriter::matrix() const
     return NULL;
 }
 
+value::ColumnMatrix * StreamWriter::columnMatrix() const
+{
+    if (m_queue) {
+        m_queue->flush();
+    }
+
+    if (m_plugin) {
+        return m_plugin->columnMatrix();
+    }
+
+    return NULL;
+}
+
 }} // namespace vle devs
@@ -50,15 +50,29 @@ class Observable;
 class VLE_API StreamWriter
 {
 public:
-    StreamWriter(const utils::ModuleManager& modulemgr)
-        : m_view(0), m_modulemgr(modulemgr)
+    /**
+     * @brief The statistics of the observation queue of the StreamWriter.
+     */
+    struct QueueStatistics
     {
-    }
+        QueueStatistics()
+            : capacity(0), records(0), depth(0), stalls(0), stallTime(0.0)
+        {}
+
+        std::size_t   capacity;  ///< the number of records of the queue.
+        unsigned long records;   ///< the number of records pushed.
+        std::size_t   depth;     ///< the maximal number of records queued.
+        unsigned long stalls;    ///< the number of waits on a full queue.
+        double        stallTime; ///< the time of these waits in seconds.
+    };
 
-    ~StreamWriter()
+    StreamWriter(const utils::ModuleManager& modulemgr)
+        : m_view(0), m_modulemgr(modulemgr), m_queue(0)
     {
     }
 
+    ~StreamWriter();
+
     ///
     ////
     ///
@@ -79,11 +93,75 @@ public:
               value::Value* parameters,
               const devs::Time& time);
 
+    /**
+     * @brief Initialise the StreamWriter with a plug-in already built.
+     * @param plugin the plug-in.
+     * @param file name of the file.
+     * @param parameters the value attached to the plug-in.
+     * @param time the date when the plug-in was opened.
+     */
+    void open(oov::PluginPtr plugin,
+              const std::string& file,
+              value::Value* parameters,
+              const devs::Time& time);
+
+    /**
+     * @brief Send the observations to the plug-in from a thread. The
+     * simulation thread pushes the observations into a queue of @e
+     * capacity records and waits only when the queue is full. The
+     * thread is stopped by close().
+     * @param capacity the number of records of the queue, 0 to call the
+     * plug-in from the simulation thread.
+     * @throw utils::InternalError if the plug-in is not opened.
+     */
+    void setQueue(std::size_t capacity);
+
+    /**
+     * @brief Test if the observations are sent from a thread.
+     * @return true if setQueue() starts a queue.
+     */
+    bool isQueued() const;
+
+    /**
+     * @brief Get the statistics of the observation queue, complete after
+     * close().
+     * @return The statistics, null if the StreamWriter has no queue.
+     */
+    const QueueStatistics& queueStatistics() const
+    { return m_statistics; }
+
     void processNewObservable(Simulator* simulator,
                               const std::string& portname,
                               const devs::Time& time,
                               const std::string& view);
 
+    /**
+     * @brief Test if the plug-in receives the numeric observations by
+     * rows.
+     * @return true if the plug-in accepts the rows of processValues().
+     */
+    bool acceptValues();
+
+    /**
+     * @brief Test if the plug-in receives all the observations of a view
+     * at a date with one call.
+     * @return true if the plug-in accepts the batches of
+     * processValueBatch().
+     */
+    bool acceptValueBatch();
+
+    /**
+     * @brief Attach an observable to the rows or to the batches of the
+     * view.
+     * @param column the cell of the observable in the rows or in the
+     * batches.
+     */
+    void processNewColumn(Simulator* simulator,
+                          const std::string& portname,
+                          const devs::Time& time,
+                          const std::string& view,
+                          std::size_t column);
+
     void processRemoveObservable(Simulator* simulator,
                                  const std::string& portname,
                                  const devs::Time& time,
@@ -100,7 +178,27 @@ public:
                  value::Value* value);
 
     /**
-     * Close the output stream.
+     * @brief Write the row of the numeric observations of the view.
+     * @param row the observations, copied if the StreamWriter has a
+     * queue.
+     */
+    void processValues(const devs::Time& time,
+                       const std::string& view,
+                       const std::vector < double >& row);
+
+    /**
+     * @brief Write the observations of the view at a date.
+     * @param values the observations by column, NULL for a cell without
+     * observation. The values are given to the plug-in and the cells are
+     * set to NULL.
+     */
+    void processValueBatch(const devs::Time& time,
+                           const std::string& view,
+                           std::vector < value::Value* >& values);
+
+    /**
+     * Close the output stream: the records of the queue are sent to the
+     * plug-in before.
      * @return A reference to the oov::Plugin if the plugin is serializable.
      */
     void close(const devs::Time& time);
@@ -117,6 +215,18 @@ public:
      */
     value::Matrix * matrix() const;
 
+    /**
+     * Return a pointer to the \c value::ColumnMatrix.
+     *
+     * If the plug-in does not manage \c value::ColumnMatrix, this
+     * function returns NULL otherwise, this function return the \c
+     * value::ColumnMatrix manager by the plug-in.
+     *
+     * @attention You are in charge of freeing the value::ColumnMatrix
+     * after the end of the simulation.
+     */
+    value::ColumnMatrix * columnMatrix() const;
+
     ///
     ////
     ///
@@ -138,15 +248,25 @@ public:
     const utils::ModuleManager& getModuleManager() const
     { return m_modulemgr; }
 
+    /**
+     * @brief Get the plug-in, after it receives the records of the queue.
+     * @return The plug-in.
+     * @throw utils::InternalError if the plug-in is not opened or fails
+     * in the thread of the queue.
+     */
     oov::PluginPtr plugin();
 
 private:
     StreamWriter(const StreamWriter& other);
     StreamWriter& operator=(const StreamWriter& other);
 
+    class Queue;
+
     devs::View*                 m_view;
     const utils::ModuleManager& m_modulemgr;
     oov::PluginPtr              m_plugin;
+    Queue*                      m_queue;
+    QueueStatistics             m_statistics;
 };
 
 }} // namespace vle devs
@@ -0,0 +1,522 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/devs/TimeWarp.hpp>
+#include <vle/devs/details/LogicalProcess.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/thread/barrier.hpp>
+#include <cassert>
+#include <deque>
+
+namespace vle { namespace devs {
+
+namespace {
+
+using details::VTime;
+using details::MessageKey;
+
+/*
+ * A message between models. An anti-message has no event and cancels the
+ * message with the same key.
+ */
+struct Message : details::Message
+{
+    Message()
+        : anti(false)
+    {}
+
+    bool anti;
+};
+
+/*
+ * The state of a model before a transition.
+ */
+struct Snapshot
+{
+    Snapshot(std::size_t model, value::Value* state, const VTime& next)
+        : model(model), state(state), next(next)
+    {}
+
+    std::size_t   model;
+    value::Value* state;
+    VTime         next;
+};
+
+/*
+ * A message sent by a step: the logical process of the target and the key
+ * of the message.
+ */
+struct Sent
+{
+    Sent(std::size_t process, const MessageKey& key)
+        : process(process), key(key)
+    {}
+
+    std::size_t process;
+    MessageKey  key;
+};
+
+/*
+ * A bag processed by a logical process and what is needed to undo it.
+ */
+struct Step
+{
+    VTime                     date;
+    std::vector < Snapshot >  states;
+    std::vector < Message >   processed;
+    std::vector < Sent >      sent;
+};
+
+} // anonymous namespace
+
+/*
+ * The devs::TimeWarp::Pimpl source: the simulators shared by the logical
+ * processes and the synchronization of the GVT computation.
+ */
+
+class TimeWarp::Pimpl : public details::Engine < Message >
+{
+public:
+    class LogicalProcess;
+
+    Pimpl(const vpz::AtomicModelVector& models,
+          const DynamicsFactory& factory)
+        : details::Engine < Message >("TimeWarp", models, factory),
+        m_barrier(0), m_round(0), m_interval(64)
+    {}
+
+    void addRound(std::size_t sent)
+    {
+        boost::mutex::scoped_lock lock(m_roundMutex);
+        m_round += sent;
+    }
+
+    std::size_t round()
+    {
+        boost::mutex::scoped_lock lock(m_roundMutex);
+        return m_round;
+    }
+
+    void resetRound()
+    {
+        boost::mutex::scoped_lock lock(m_roundMutex);
+        m_round = 0;
+    }
+
+    std::vector < VTime >                            m_minimums;
+    boost::barrier*                                  m_barrier;
+    boost::mutex                                     m_roundMutex;
+    std::size_t                                      m_round;
+    std::size_t                                      m_interval;
+};
+
+/*
+ * A logical process: the history of its steps and the rollback.
+ */
+
+class TimeWarp::Pimpl::LogicalProcess
+    : public details::LogicalProcess < Pimpl >
+{
+public:
+    LogicalProcess(Pimpl& engine, std::size_t index)
+        : details::LogicalProcess < Pimpl >(engine, index), m_sent(0),
+        m_failed(false)
+    {}
+
+    ~LogicalProcess()
+    {
+        while (not m_steps.empty()) {
+            release(m_steps.front());
+            m_steps.pop_front();
+        }
+    }
+
+    /**
+     * The thread function: run the steps and take part to the GVT
+     * computation until the GVT reaches the end of the simulation.
+     */
+    void simulate()
+    {
+        for (;;) {
+            if (not m_failed) {
+                try {
+                    for (std::size_t i = 0; i < m_engine.m_interval; ++i) {
+                        drain();
+                        VTime date(nextDate());
+                        if (not (date.time < m_engine.m_end)) {
+                            break;
+                        }
+                        step(date);
+                    }
+                } catch (const std::exception& e) {
+                    abort(e.what());
+                }
+            }
+
+            bool failed;
+            VTime gvt(computeGvt(failed));
+            if (not (gvt.time < m_engine.m_end) or failed) {
+                break;
+            }
+            fossilCollection(gvt);
+        }
+    }
+
+    /**
+     * Count the steps kept at the end of the simulation.
+     */
+    void commit()
+    {
+        for (std::deque < Step >::const_iterator it = m_steps.begin();
+             it != m_steps.end(); ++it) {
+            m_statistics.committed += it->states.size();
+        }
+    }
+
+    TimeWarp::Statistics m_statistics;
+
+private:
+    std::deque < Step >        m_steps;
+    std::vector < Message >    m_received;
+    std::size_t                m_sent;
+    bool                       m_failed;
+
+    void abort(const std::string& error)
+    {
+        m_failed = true;
+        m_engine.fail(error);
+    }
+
+    /**
+     * Run the bag of the date and save the state of the models before
+     * their transition.
+     */
+    void step(const VTime& date)
+    {
+        m_steps.push_back(Step());
+        Step& current(m_steps.back());
+        current.date = date;
+
+        collect(date, current.processed);
+
+        std::vector < Message >::const_iterator msg =
+            current.processed.begin();
+
+        for (std::vector < std::size_t >::const_iterator it =
+             m_affected.begin(); it != m_affected.end(); ++it) {
+            std::size_t model = *it;
+            Simulator* sim = m_engine.m_simulators[model];
+            bool internal = m_engine.m_next[model] == date;
+
+            value::Value* state = m_engine.m_dynamics[model]->saveState();
+            if (not state) {
+                throw utils::ModellingError(fmt(
+                        _("TimeWarp: the model '%1%' does not save its "
+                          "state")) % sim->getName());
+            }
+            current.states.push_back(
+                Snapshot(model, state, m_engine.m_next[model]));
+
+            externals(model, msg, current.processed.end());
+
+            if (internal) {
+                m_outputs.clear();
+                sim->output(date.time, m_outputs);
+                route(model, date);
+            }
+
+            transition(model, date, internal);
+            m_statistics.processed++;
+        }
+    }
+
+    /**
+     * Post the events for the other processes and keep the keys of all
+     * the messages of the step to cancel them on rollback.
+     */
+    void send(std::size_t process, const Message& msg)
+    {
+        if (process != m_index) {
+            m_engine.post(process, msg);
+            m_sent++;
+        }
+        m_steps.back().sent.push_back(Sent(process, msg.key));
+    }
+
+    /**
+     * Undo the steps at or after the date.
+     */
+    void rollback(const VTime& date)
+    {
+        bool undone = false;
+
+        while (not m_steps.empty() and not (m_steps.back().date < date)) {
+            undo(m_steps.back());
+            m_steps.pop_back();
+            undone = true;
+        }
+
+        if (undone) {
+            m_statistics.rollbacks++;
+        }
+    }
+
+    void undo(Step& current)
+    {
+        for (std::vector < Snapshot >::reverse_iterator it =
+             current.states.rbegin(); it != current.states.rend(); ++it) {
+            m_engine.m_dynamics[it->model]->restoreState(*it->state);
+            delete it->state;
+            it->state = 0;
+            reschedule(it->model, it->next);
+        }
+
+        for (std::vector < Message >::const_iterator it =
+             current.processed.begin(); it != current.processed.end();
+             ++it) {
+            m_pending.insert(std::make_pair(it->key, *it));
+        }
+        current.processed.clear();
+
+        for (std::vector < Sent >::const_iterator it = current.sent.begin();
+             it != current.sent.end(); ++it) {
+            if (it->process == m_index) {
+                PendingList::iterator msg = m_pending.find(it->key);
+                assert(msg != m_pending.end());
+                delete msg->second.event;
+                m_pending.erase(msg);
+            } else {
+                Message anti;
+                anti.key = it->key;
+                anti.anti = true;
+                m_engine.post(it->process, anti);
+                m_sent++;
+                m_statistics.antimessages++;
+            }
+        }
+        current.sent.clear();
+    }
+
+    /**
+     * Release the saved states and the processed events of a committed
+     * step.
+     */
+    void release(Step& current)
+    {
+        for (std::vector < Snapshot >::iterator it = current.states.begin();
+             it != current.states.end(); ++it) {
+            delete it->state;
+        }
+        for (std::vector < Message >::iterator it =
+             current.processed.begin(); it != current.processed.end();
+             ++it) {
+            delete it->event;
+        }
+    }
+
+    /**
+     * Insert the received messages: a message in the past rolls back the
+     * steps, an anti-message removes its message.
+     */
+    void drain()
+    {
+        m_received.clear();
+        m_engine.receive(m_index, m_received, false);
+
+        for (std::vector < Message >::iterator it = m_received.begin();
+             it != m_received.end(); ++it) {
+            if (m_failed) {
+                delete it->event;
+                continue;
+            }
+
+            if (it->anti) {
+                PendingList::iterator msg = m_pending.find(it->key);
+                if (msg == m_pending.end()) {
+                    rollback(it->key.date);
+                    msg = m_pending.find(it->key);
+                }
+                assert(msg != m_pending.end());
+                delete msg->second.event;
+                m_pending.erase(msg);
+            } else {
+                if (not m_steps.empty() and
+                    not (m_steps.back().date < it->key.date)) {
+                    rollback(it->key.date);
+                }
+                m_pending.insert(std::make_pair(it->key, *it));
+            }
+        }
+        m_received.clear();
+    }
+
+    /**
+     * The synchronous GVT computation: the logical processes receive the
+     * messages until no message is sent, then the GVT is the minimum of
+     * the dates of their next steps. The state shared by the processes
+     * is read between the second and the third barriers, where no process
+     * can update it.
+     */
+    VTime computeGvt(bool& failed)
+    {
+        for (;;) {
+            m_engine.m_barrier->wait();
+
+            m_sent = 0;
+            if (not m_failed) {
+                try {
+                    drain();
+                } catch (const std::exception& e) {
+                    abort(e.what());
+                }
+            } else {
+                drain();
+            }
+            m_engine.addRound(m_sent);
+            m_sent = 0;
+
+            m_engine.m_barrier->wait();
+            bool again = m_engine.round() > 0;
+            failed = m_engine.failed();
+            m_engine.m_barrier->wait();
+
+            if (m_index == 0) {
+                m_engine.resetRound();
+            }
+            if (not again) {
+                break;
+            }
+        }
+
+        m_engine.m_minimums[m_index] = nextDate();
+        m_engine.m_barrier->wait();
+
+        VTime gvt;
+        for (std::size_t i = 0, e = m_engine.m_minimums.size(); i != e; ++i) {
+            if (m_engine.m_minimums[i] < gvt) {
+                gvt = m_engine.m_minimums[i];
+            }
+        }
+
+        if (m_index == 0) {
+            m_statistics.gvt++;
+        }
+        return gvt;
+    }
+
+    /**
+     * Release the steps before the GVT: they cannot be rolled back.
+     */
+    void fossilCollection(const VTime& gvt)
+    {
+        while (not m_steps.empty() and m_steps.front().date < gvt) {
+            m_statistics.committed += m_steps.front().states.size();
+            release(m_steps.front());
+            m_steps.pop_front();
+        }
+    }
+};
+
+/*
+ * The devs::TimeWarp source.
+ */
+
+TimeWarp::TimeWarp(vpz::CoupledModel* top, const DynamicsFactory& factory,
+                   std::size_t processes)
+    : mImpl(0), m_processes(processes), m_interval(64)
+{
+    if (processes == 0) {
+        throw utils::ArgError(_("TimeWarp: at least one process"));
+    }
+
+    vpz::BaseModel::getAtomicModelList(top, m_models);
+    mImpl = new Pimpl(m_models, factory);
+    details::defaultPartition(m_models.size(), processes, m_partition);
+}
+
+TimeWarp::~TimeWarp()
+{
+    delete mImpl;
+}
+
+void TimeWarp::setPartition(const std::vector < std::size_t >& partition)
+{
+    details::checkPartition("TimeWarp", m_models, partition, m_processes);
+    m_partition = partition;
+}
+
+Dynamics* TimeWarp::dynamics(const vpz::AtomicModel* model) const
+{
+    return mImpl->dynamics(model);
+}
+
+void TimeWarp::run(const Time& begin, const Time& duration)
+{
+    typedef Pimpl::LogicalProcess LogicalProcess;
+
+    Pimpl& engine(*mImpl);
+    details::Processes < Pimpl, LogicalProcess > processes(engine);
+
+    engine.reset(m_partition, begin + duration);
+    engine.m_minimums.assign(m_processes, VTime());
+    engine.m_interval = m_interval;
+    engine.m_round = 0;
+    engine.openInboxes(m_processes);
+    m_statistics = Statistics();
+
+    for (std::size_t i = 0; i < m_processes; ++i) {
+        processes.push_back(new LogicalProcess(engine, i));
+    }
+
+    engine.init(begin, processes);
+
+    boost::barrier barrier(m_processes);
+    engine.m_barrier = &barrier;
+    try {
+        engine.simulate(processes);
+    } catch (...) {
+        engine.m_barrier = 0;
+        throw;
+    }
+    engine.m_barrier = 0;
+
+    for (std::size_t i = 0; i < m_processes; ++i) {
+        processes[i]->commit();
+        const Statistics& stats(processes[i]->m_statistics);
+        m_statistics.committed += stats.committed;
+        m_statistics.processed += stats.processed;
+        m_statistics.rollbacks += stats.rollbacks;
+        m_statistics.antimessages += stats.antimessages;
+        m_statistics.gvt += stats.gvt;
+    }
+
+    engine.finish();
+}
+
+}} // namespace vle devs
@@ -0,0 +1,182 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_TIMEWARP_HPP
+#define VLE_DEVS_TIMEWARP_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/Time.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <boost/function.hpp>
+#include <vector>
+
+namespace vle { namespace devs {
+
+class Dynamics;
+
+/**
+ * @brief An optimistic (Time Warp) simulation engine. The atomic models of
+ * a coupled model are split into logical processes, each one runs in its
+ * own thread with its own event list and exchanges timestamped external
+ * events with the other processes.
+ *
+ * A process runs its events without waiting for the other processes. When
+ * it receives an event in its past (a straggler), it rolls back the
+ * transitions with the states saved by Dynamics::saveState() and sends
+ * anti-messages to cancel the events sent by these transitions. The global
+ * virtual time (GVT), the date before which no rollback can occur, is
+ * computed periodically to release the saved states.
+ *
+ * The date of an event is the simulation time and the number of the bag
+ * at this time: the engine produces the same transitions as the
+ * devs::Coordinator. The external events of a bag are ordered by sender,
+ * not in the order of the Coordinator: the models must not depend on the
+ * order of the events of a bag. Executives and views are not supported.
+ *
+ * The engine is only available from the C++ API: the simulation engine
+ * condition of the vpz and the command line of vle do not select it.
+ *
+ * @code
+ * vle::devs::TimeWarp engine(top, factory, 4);
+ * engine.run(0.0, 100.0);
+ * @endcode
+ */
+class VLE_API TimeWarp
+{
+public:
+    /**
+     * @brief Build the Dynamics of an atomic model. The Dynamics must be
+     * thread-safe and support the state saving.
+     */
+    typedef boost::function < Dynamics* (const vpz::AtomicModel&) >
+        DynamicsFactory;
+
+    /**
+     * @brief Counters of the last run().
+     */
+    struct Statistics
+    {
+        Statistics()
+            : committed(0), processed(0), rollbacks(0), antimessages(0),
+            gvt(0)
+        {}
+
+        unsigned long committed; /**< transitions kept in the result. */
+        unsigned long processed; /**< transitions including rolled back. */
+        unsigned long rollbacks; /**< number of rollbacks. */
+        unsigned long antimessages; /**< number of anti-messages sent. */
+        unsigned long gvt; /**< number of GVT computations. */
+    };
+
+    /**
+     * @brief Build the simulators of all the atomic models of the coupled
+     * model. The models are split into @e processes blocks of consecutive
+     * models in the order of vpz::BaseModel::getAtomicModelList.
+     * @param top The coupled model to simulate.
+     * @param factory The builder of the Dynamics.
+     * @param processes The number of logical processes.
+     * @throw utils::ArgError if processes is 0.
+     */
+    TimeWarp(vpz::CoupledModel* top, const DynamicsFactory& factory,
+             std::size_t processes);
+
+    /**
+     * @brief Delete the simulators and the Dynamics.
+     */
+    ~TimeWarp();
+
+    /**
+     * @brief Get the atomic models in the order used by the partition.
+     * @return The list of the atomic models.
+     */
+    const vpz::AtomicModelVector& models() const
+    { return m_models; }
+
+    /**
+     * @brief Assign the logical process of each atomic model.
+     * @param partition The process of each model of models().
+     * @throw utils::ArgError if the size of partition is not the number
+     * of models or if a process is greater than the number of processes.
+     */
+    void setPartition(const std::vector < std::size_t >& partition);
+
+    /**
+     * @brief Get the logical process of each atomic model.
+     * @return The process of each model of models().
+     */
+    const std::vector < std::size_t >& partition() const
+    { return m_partition; }
+
+    /**
+     * @brief Assign the number of bags run by a process between two GVT
+     * computations.
+     * @param steps The number of bags, at least 1.
+     */
+    void setGvtInterval(std::size_t steps)
+    { m_interval = steps ? steps : 1; }
+
+    /**
+     * @brief Initialize the models at the date @e begin and run all the
+     * bags before @e begin + @e duration.
+     * @param begin The date of the beginning of the simulation.
+     * @param duration The duration of the simulation.
+     * @throw utils::ModellingError if a model fails or does not support
+     * the state saving.
+     */
+    void run(const Time& begin, const Time& duration);
+
+    /**
+     * @brief Get the Dynamics of an atomic model, for example to read the
+     * final state of the model after run().
+     * @param model The atomic model.
+     * @return The Dynamics or 0 if the model is unknown.
+     */
+    Dynamics* dynamics(const vpz::AtomicModel* model) const;
+
+    /**
+     * @brief Get the counters of the last run().
+     * @return The counters.
+     */
+    const Statistics& statistics() const
+    { return m_statistics; }
+
+private:
+    TimeWarp(const TimeWarp& other);
+    TimeWarp& operator=(const TimeWarp& other);
+
+    class Pimpl;
+    Pimpl*                     mImpl;
+    vpz::AtomicModelVector     m_models;
+    std::vector < std::size_t > m_partition;
+    std::size_t                m_processes;
+    std::size_t                m_interval;
+    Statistics                 m_statistics;
+};
+
+}} // namespace vle devs
+
+#endif
@@ -27,11 +27,47 @@
 
 #include <vle/devs/View.hpp>
 #include <vle/devs/Simulator.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/Trace.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+/** Compare the simulators of two observables by index. */
+inline bool observableLessThan(const vle::devs::ObservableList::value_type& a,
+                               const vle::devs::ObservableList::value_type& b)
+{
+    return a.first->id() < b.first->id();
+}
+
+} // anonymous namespace
 
 namespace vle { namespace devs {
 
 View::~View()
 {
+    for (std::vector < Observation >::iterator it = m_observations.begin();
+         it != m_observations.end(); ++it) {
+        delete it->event;
+    }
+
+    if (m_cache) {
+        for (ObservableList::iterator it = m_observableList.begin();
+             it != m_observableList.end(); ++it) {
+            m_cache->detach(it->first, it->second);
+        }
+    }
+
+    // The values of an observation interrupted by an exception.
+    for (size_t i = 0; i < m_batch.size(); ++i) {
+        delete m_batch[i];
+    }
+
     delete m_stream;
 }
 
@@ -42,43 +78,159 @@ void View::addObservable(Simulator* model,
     assert(model);
 
     if (not exist(model, portname)) {
-        m_observableList.insert(value_type(model, portname));
-        m_stream->processNewObservable(model, portname, currenttime,
-                                       getName());
+        value_type obs(model, portname);
+        iterator it = std::upper_bound(m_observableList.begin(),
+                                       m_observableList.end(), obs,
+                                       observableLessThan);
+        Observation observation(
+            new ObservationEvent(currenttime, model, getName(), portname),
+            model->observationType(portname), -1, false);
+
+        // The type of the aggregates replaces the type of the port.
+        Dynamics::ObservationType emitted = observation.type;
+        switch (m_aggregation) {
+        case vpz::View::AGGREGATE_NONE:
+            break;
+        case vpz::View::AGGREGATE_COUNT:
+            emitted = Dynamics::OBSERVATION_INTEGER;
+            break;
+        case vpz::View::AGGREGATE_SAMPLE:
+            emitted = Dynamics::OBSERVATION_VALUE;
+            break;
+        default:
+            emitted = Dynamics::OBSERVATION_DOUBLE;
+            break;
+        }
+
+        observation.inRow = emitted != Dynamics::OBSERVATION_VALUE
+            and m_stream->acceptValues();
+
+        // The row and the batch share the columns: a column is a cell of
+        // both and has a value in one of them only.
+        if (observation.inRow or m_stream->acceptValueBatch()) {
+            observation.column = m_row.size();
+            m_row.push_back(std::numeric_limits < double >::quiet_NaN());
+            m_batch.push_back(0);
+            if (observation.inRow) {
+                ++m_rowCells;
+            } else {
+                ++m_batchCells;
+            }
+        }
+
+        if (m_aggregation != vpz::View::AGGREGATE_NONE) {
+            m_accumulators.insert(
+                m_accumulators.begin() + (it - m_observableList.begin()),
+                Accumulator(m_aggregation, m_samples, m_quantile));
+        }
+        if (m_cache) {
+            observation.entry = m_cache->attach(model, portname);
+        }
+        m_observations.insert(m_observations.begin() +
+                              (it - m_observableList.begin()), observation);
+        m_observableList.insert(it, obs);
+
+        if (model->id() >= m_observed.size()) {
+            m_observed.resize(model->id() + 1, 0);
+        }
+        if (m_observed[model->id()]++ == 0 and isEvent()) {
+            model->addEventView(this);
+        }
+
+        if (observation.column >= 0) {
+            m_stream->processNewColumn(model, portname, currenttime,
+                                       getName(), observation.column);
+        } else {
+            m_stream->processNewObservable(model, portname, currenttime,
+                                           getName());
+        }
     }
 }
 
 void View::finish(const Time& time)
 {
+    if (m_windowCount > 0) {
+        emit(m_windowTime);
+    }
+
     m_stream->close(time);
+
+    if (m_stream->isQueued()) {
+        const StreamWriter::QueueStatistics& stats(
+            m_stream->queueStatistics());
+
+        TraceAlways(fmt(_("View %1%: %2% observations queued, depth %3% "
+                          "of %4%, %5% stalls during %6% s")) % getName() %
+                    stats.records % stats.depth % stats.capacity %
+                    stats.stalls % stats.stallTime);
+    }
 }
 
 void View::removeObservable(Simulator* sim)
 {
     assert(sim);
 
-    std::pair < ObservableList::iterator, ObservableList::iterator > result;
-    ObservableList::iterator it;
+    if (exist(sim)) {
+        std::pair < iterator, iterator > result;
+        iterator it;
 
-    result = m_observableList.equal_range(sim);
-    for (it = result.first; it != result.second; ++it) {
-        m_stream->processRemoveObservable(it->first, it->second, 0.0,
-                                          getName());
-    }
+        result = std::equal_range(m_observableList.begin(),
+                                  m_observableList.end(),
+                                  value_type(sim, std::string()),
+                                  observableLessThan);
+        std::vector < Observation >::iterator first =
+            m_observations.begin() + (result.first - m_observableList.begin());
+        std::vector < Observation >::iterator last =
+            m_observations.begin() + (result.second - m_observableList.begin());
+
+        for (it = result.first; it != result.second; ++it) {
+            m_stream->processRemoveObservable(it->first, it->second, 0.0,
+                                              getName());
+            if (m_cache) {
+                m_cache->detach(it->first, it->second);
+            }
+        }
 
-    m_observableList.erase(result.first, result.second);
+        // The cells of the observables stay in the row and in the batch,
+        // without value.
+        for (std::vector < Observation >::iterator jt = first; jt != last;
+             ++jt) {
+            if (jt->column >= 0) {
+                m_row[jt->column] =
+                    std::numeric_limits < double >::quiet_NaN();
+            }
+            delete jt->event;
+        }
+
+        if (m_aggregation != vpz::View::AGGREGATE_NONE) {
+            m_accumulators.erase(
+                m_accumulators.begin() + (first - m_observations.begin()),
+                m_accumulators.begin() + (last - m_observations.begin()));
+        }
+        m_observations.erase(first, last);
+        m_observableList.erase(result.first, result.second);
+        m_observed[sim->id()] = 0;
+
+        if (isEvent()) {
+            sim->removeEventView(this);
+        }
+    }
 }
 
 bool View::exist(Simulator* simulator, const std::string& portname) const
 {
-    std::pair < ObservableList::const_iterator,
-                ObservableList::const_iterator > result;
-    ObservableList::const_iterator it;
+    if (exist(simulator)) {
+        std::pair < const_iterator, const_iterator > result;
+        const_iterator it;
 
-    result = m_observableList.equal_range(simulator);
-    for (it = result.first; it != result.second; ++it) {
-        if (it->second == portname) {
-            return true;
+        result = std::equal_range(m_observableList.begin(),
+                                  m_observableList.end(),
+                                  value_type(simulator, std::string()),
+                                  observableLessThan);
+        for (it = result.first; it != result.second; ++it) {
+            if (it->second == portname) {
+                return true;
+            }
         }
     }
     return false;
@@ -86,23 +238,169 @@ bool View::exist(Simulator* simulator, const std::string& portname) const
 
 bool View::exist(Simulator* simulator) const
 {
-    return m_observableList.count(simulator) > 0;
+    return simulator->id() < m_observed.size() and
+        m_observed[simulator->id()] > 0;
+}
+
+void View::setAggregation(const vpz::View& view)
+{
+    assert(m_observableList.empty());
+
+    m_aggregation = view.aggregation();
+    m_window = view.window();
+    m_samples = view.samples();
+    m_quantile = view.quantile();
+}
+
+void View::setCache(ObservationCache* cache)
+{
+    assert(m_observableList.empty());
+
+    m_cache = cache;
 }
 
 void View::run(const Time& time)
 {
-    if (not m_observableList.empty()) {
+    if (m_aggregation != vpz::View::AGGREGATE_NONE) {
+        accumulate(time);
+
+        if (++m_windowCount >= m_window) {
+            emit(time);
+        }
+    } else if (not m_observableList.empty()) {
+        std::vector < Observation >::const_iterator jt =
+            m_observations.begin();
+
         for (ObservableList::iterator it = m_observableList.begin();
-             it != m_observableList.end(); ++it) {
-            ObservationEvent event(time, it->first, getName(), it->second);
-            value::Value* val = it->first->observation(event);
-            m_stream->process(it->first, it->second, time, getName(), val);
+             it != m_observableList.end(); ++it, ++jt) {
+            jt->event->setTime(time);
+
+            if (jt->inRow) {
+                m_row[jt->column] = numericObservation(it->first, *jt);
+            } else if (jt->column >= 0) {
+                m_batch[jt->column] = observation(it->first, *jt);
+            } else {
+                m_stream->process(it->first, it->second, time, getName(),
+                                  observation(it->first, *jt));
+            }
         }
+
+        processCells(time);
     } else {
         m_stream->process(0, std::string(), time, getName(), 0);
     }
 }
 
+void View::accumulate(const Time& time)
+{
+    std::vector < Observation >::const_iterator jt = m_observations.begin();
+    std::vector < Accumulator >::iterator kt = m_accumulators.begin();
+
+    for (ObservableList::iterator it = m_observableList.begin();
+         it != m_observableList.end(); ++it, ++jt, ++kt) {
+        jt->event->setTime(time);
+
+        if (jt->type != Dynamics::OBSERVATION_VALUE) {
+            kt->add(numericObservation(it->first, *jt), m_rand);
+        } else {
+            boost::scoped_ptr < value::Value > value(
+                observation(it->first, *jt));
+
+            if (not value) {
+                continue;
+            }
+
+            switch (value->getType()) {
+            case value::Value::DOUBLE:
+                kt->add(value->toDouble().value(), m_rand);
+                break;
+            case value::Value::INTEGER:
+                kt->add(value->toInteger().value(), m_rand);
+                break;
+            case value::Value::BOOLEAN:
+                kt->add(value->toBoolean().value() ? 1.0 : 0.0, m_rand);
+                break;
+            default:
+                throw utils::ModellingError(
+                    fmt(_("View %1%: the observation of the port %2% of "
+                          "%3% is not a number and cannot be aggregated")) %
+                    getName() % it->second % it->first->getName());
+            }
+        }
+    }
+
+    m_windowTime = time;
+}
+
+void View::emit(const Time& time)
+{
+    m_windowCount = 0;
+
+    if (m_observableList.empty()) {
+        m_stream->process(0, std::string(), time, getName(), 0);
+        return;
+    }
+
+    std::vector < Observation >::const_iterator jt = m_observations.begin();
+    std::vector < Accumulator >::iterator kt = m_accumulators.begin();
+
+    for (ObservableList::iterator it = m_observableList.begin();
+         it != m_observableList.end(); ++it, ++jt, ++kt) {
+        if (jt->inRow) {
+            m_row[jt->column] = kt->scalar();
+        } else if (jt->column >= 0) {
+            m_batch[jt->column] = kt->value();
+        } else {
+            m_stream->process(it->first, it->second, time, getName(),
+                              kt->value());
+        }
+        kt->clear();
+    }
+
+    processCells(time);
+}
+
+void View::processCells(const Time& time)
+{
+    if (m_rowCells > 0) {
+        m_stream->processValues(time, getName(), m_row);
+    }
+
+    if (m_batchCells > 0) {
+        m_stream->processValueBatch(time, getName(), m_batch);
+    }
+}
+
+double View::numericObservation(Simulator* simulator,
+                                const Observation& observation) const
+{
+    if (observation.entry and observation.entry->refs > 1) {
+        return m_cache->numericObservation(*observation.entry, simulator,
+                                           *observation.event);
+    }
+
+    return simulator->numericObservation(*observation.event);
+}
+
+value::Value* View::observation(Simulator* simulator,
+                                 const Observation& observation) const
+{
+    switch (observation.type) {
+    case Dynamics::OBSERVATION_DOUBLE:
+        return new value::Double(numericObservation(simulator, observation));
+    case Dynamics::OBSERVATION_INTEGER:
+        return new value::Integer(
+            static_cast < int32_t >(
+                numericObservation(simulator, observation)));
+    default:
+        if (observation.entry and observation.entry->refs > 1) {
+            return m_cache->observation(*observation.entry, simulator,
+                                        *observation.event);
+        }
+        return simulator->observation(*observation.event);
+    }
+}
+
 value::Matrix * View::matrix() const
 {
     if (m_stream->plugin()) {
@@ -112,4 +410,13 @@ value::Matrix * View::matrix() const
     return NULL;
 }
 
+value::ColumnMatrix * View::columnMatrix() const
+{
+    if (m_stream->plugin()) {
+        return m_stream->plugin()->columnMatrix();
+    }
+
+    return NULL;
+}
+
 }} // namespace vle devs
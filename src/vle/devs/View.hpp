@@ -29,11 +29,17 @@
 #define VLE_DEVS_VIEW_HPP 1
 
 #include <vle/DllDefines.hpp>
+#include <vle/devs/Aggregation.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/ObservationCache.hpp>
+#include <vle/devs/ObservationEvent.hpp>
 #include <vle/devs/StreamWriter.hpp>
 #include <vle/devs/Time.hpp>
+#include <vle/value/ColumnMatrix.hpp>
 #include <vle/value/Matrix.hpp>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace vle { namespace devs {
 
@@ -41,7 +47,11 @@ class Simulator;
 class StreamWriter;
 class View;
 
-typedef std::multimap < Simulator*, std::string > ObservableList;
+/**
+ * The observable ports of a View sorted by Simulator::id() then by order of
+ * insertion.
+ */
+typedef std::vector < std::pair < Simulator*, std::string > > ObservableList;
 typedef std::map < std::string, View* > ViewList;
 
 /**
@@ -57,7 +67,10 @@ public:
     typedef ObservableList::value_type value_type;
 
     View(const std::string& name, StreamWriter* stream)
-        : m_name(name), m_stream(stream), m_size(0)
+        : m_cache(0), m_rowCells(0), m_batchCells(0),
+        m_aggregation(vpz::View::AGGREGATE_NONE), m_window(1),
+        m_samples(10), m_quantile(0.5), m_windowCount(0), m_windowTime(0.0),
+        m_rand(1), m_name(name), m_stream(stream), m_size(0)
     {}
 
     virtual ~View();
@@ -68,6 +81,19 @@ public:
 
     void finish(const Time& time);
 
+    /**
+     * Assign the aggregation of the vpz::View to the View: the observations
+     * of each port are aggregated by windows of vpz::View::window()
+     * observations and only the aggregates are sent to the plug-in. The
+     * partial window is sent by finish(). To call before the first
+     * addObservable.
+     * @param view The definition of the View.
+     */
+    void setAggregation(const vpz::View& view);
+
+    inline vpz::View::Aggregation aggregation() const
+    { return m_aggregation; }
+
     virtual bool isEvent() const
     { return false; }
 
@@ -122,6 +148,14 @@ public:
     inline StreamWriter * getStream() const
     { return m_stream; }
 
+    /**
+     * Share the observations of the ports with the other views of the
+     * cache. To call before the first addObservable.
+     * @param cache The cache of the Coordinator, NULL to observe the ports
+     * directly.
+     */
+    void setCache(ObservationCache* cache);
+
     /**
      * Return a pointer to the \c value::Matrix.
      *
@@ -134,8 +168,83 @@ public:
      */
     value::Matrix * matrix() const;
 
+    /**
+     * Return a pointer to the \c value::ColumnMatrix.
+     *
+     * If the plug-in does not manage \c value::ColumnMatrix, this
+     * function returns NULL otherwise, this function return the \c
+     * value::ColumnMatrix manager by the plug-in.
+     *
+     * @attention You are in charge of freeing the value::ColumnMatrix
+     * after the end of the simulation.
+     */
+    value::ColumnMatrix * columnMatrix() const;
+
 protected:
+    /**
+     * How an observable is observed: the type of its port and, for a
+     * plug-in which accepts rows or batches, its column. The cell of a
+     * numeric port is in the row if the plug-in accepts rows, otherwise
+     * in the batch.
+     */
+    struct Observation
+    {
+        Observation(ObservationEvent* event, Dynamics::ObservationType type,
+                    long column, bool inRow)
+            : event(event), type(type), column(column), inRow(inRow),
+            entry(0)
+        {}
+
+        ObservationEvent*         event; ///< reused at each observation.
+        Dynamics::ObservationType type;
+        long                      column; ///< -1 without row and batch.
+        bool                      inRow; ///< the cell is in m_row.
+        ObservationCache::Entry*  entry; ///< NULL without cache.
+    };
+
+    /**
+     * Get the numeric observation of a port.
+     */
+    double numericObservation(Simulator* simulator,
+                              const Observation& observation) const;
+
+    /**
+     * Get the observation of a port which is not in the row.
+     */
+    value::Value* observation(Simulator* simulator,
+                              const Observation& observation) const;
+
+    /**
+     * Add the observations of the ports to the windows of the aggregation.
+     */
+    void accumulate(const Time& time);
+
+    /**
+     * Send the aggregates of the windows and start new windows.
+     */
+    void emit(const Time& time);
+
+    /**
+     * Send the row and the batch.
+     */
+    void processCells(const Time& time);
+
+    ObservationCache*   m_cache;
     ObservableList      m_observableList;
+    std::vector < Observation > m_observations; ///< by observable.
+    std::vector < double > m_row; ///< the numeric observations.
+    std::vector < value::Value* > m_batch; ///< the other observations.
+    size_t              m_rowCells; ///< the columns of the row.
+    size_t              m_batchCells; ///< the columns of the batch.
+    vpz::View::Aggregation m_aggregation;
+    unsigned int        m_window; ///< observations of a window.
+    unsigned int        m_samples;
+    double              m_quantile;
+    unsigned int        m_windowCount; ///< observations of the window.
+    Time                m_windowTime; ///< last observation of the window.
+    utils::Rand         m_rand; ///< the reservoir sampling.
+    std::vector < Accumulator > m_accumulators; ///< by observable.
+    std::vector < size_t > m_observed; ///< observable ports by simulator id.
     std::string         m_name;
     StreamWriter*       m_stream;
     size_t              m_size;
@@ -164,6 +273,9 @@ public:
         return current + mTimestep;
     }
 
+    inline const Time& timestep() const
+    { return mTimestep; }
+
 private:
     Time mTimestep;
 };
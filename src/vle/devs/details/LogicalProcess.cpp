@@ -0,0 +1,172 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/devs/details/LogicalProcess.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+
+namespace vle { namespace devs { namespace details {
+
+void defaultPartition(std::size_t models, std::size_t processes,
+                      std::vector < std::size_t >& partition)
+{
+    partition.resize(models);
+    for (std::size_t i = 0; i != models; ++i) {
+        partition[i] = i * processes / models;
+    }
+}
+
+void checkPartition(const std::string& engine,
+                    const vpz::AtomicModelVector& models,
+                    const std::vector < std::size_t >& partition,
+                    std::size_t processes)
+{
+    if (partition.size() != models.size()) {
+        throw utils::ArgError(fmt(
+                _("%1%: partition of %2% models for %3% models")) %
+            engine % partition.size() % models.size());
+    }
+
+    for (std::size_t i = 0, e = partition.size(); i != e; ++i) {
+        if (partition[i] >= processes) {
+            throw utils::ArgError(fmt(
+                    _("%1%: process %2% of model '%3%' is not in "
+                      "[0, %4%[")) % engine % partition[i] %
+                models[i]->getName() % processes);
+        }
+    }
+}
+
+/*
+ * The devs::details::Models source.
+ */
+
+Models::Models(const std::string& engine,
+               const vpz::AtomicModelVector& models,
+               const DynamicsFactory& factory)
+    : m_end(0.0), m_failed(false)
+{
+    m_simulators.reserve(models.size());
+    m_dynamics.reserve(models.size());
+
+    try {
+        for (std::size_t i = 0, e = models.size(); i != e; ++i) {
+            Simulator* sim = new Simulator(models[i]);
+            m_simulators.push_back(sim);
+            sim->setId(i);
+            m_map[models[i]] = sim;
+
+            Dynamics* dyn = factory(*models[i]);
+            if (not dyn) {
+                throw utils::ArgError(fmt(
+                        _("%1%: no dynamics for the model '%2%'")) %
+                    engine % models[i]->getName());
+            }
+            sim->addDynamics(dyn);
+            m_dynamics.push_back(dyn);
+        }
+
+        /* The routing tables are built before the threads start. */
+        for (std::size_t i = 0, e = models.size(); i != e; ++i) {
+            for (Simulator::size_type p = 0;
+                 p < m_simulators[i]->outputPortNumber(); ++p) {
+                m_simulators[i]->targets(p, m_map);
+            }
+        }
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+Models::~Models()
+{
+    clear();
+}
+
+Dynamics* Models::dynamics(const vpz::AtomicModel* model) const
+{
+    std::map < vpz::AtomicModel*, Simulator* >::const_iterator it =
+        m_map.find(const_cast < vpz::AtomicModel* >(model));
+
+    return it == m_map.end() ? 0 : m_dynamics[it->second->id()];
+}
+
+void Models::reset(const std::vector < std::size_t >& partition,
+                   const Time& end)
+{
+    m_partition = partition;
+    m_next.assign(m_simulators.size(), VTime());
+    m_end = end;
+    m_failed = false;
+    m_error.clear();
+}
+
+void Models::finish()
+{
+    for (std::size_t i = 0, e = m_simulators.size(); i != e; ++i) {
+        m_simulators[i]->finish();
+    }
+}
+
+bool Models::setFailed(const std::string& error)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_failed) {
+        return false;
+    }
+    m_failed = true;
+    m_error = error;
+    return true;
+}
+
+bool Models::failed()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_failed;
+}
+
+void Models::clear()
+{
+    for (std::size_t i = 0, e = m_simulators.size(); i != e; ++i) {
+        delete m_simulators[i];
+    }
+    m_simulators.clear();
+    m_dynamics.clear();
+    m_map.clear();
+}
+
+void Models::throwIfFailed()
+{
+    if (m_failed) {
+        throw utils::ModellingError(m_error);
+    }
+}
+
+}}} // namespace vle devs details
@@ -0,0 +1,601 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_DETAILS_LOGICALPROCESS_HPP
+#define VLE_DEVS_DETAILS_LOGICALPROCESS_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/devs/ExternalEvent.hpp>
+#include <vle/devs/ExternalEventList.hpp>
+#include <vle/devs/InternalEvent.hpp>
+#include <vle/devs/Time.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace vle { namespace devs {
+
+class Dynamics;
+
+/*
+ * The logical processes shared by the parallel engines devs::TimeWarp and
+ * devs::ChandyMisra: the simulators of the models, the inboxes of the
+ * processes, their event lists and the transitions of a bag.
+ */
+
+namespace details {
+
+typedef boost::function < Dynamics* (const vpz::AtomicModel&) >
+    DynamicsFactory;
+
+/**
+ * @brief The date of an event: the simulation time and the number of the
+ * bag at this time. An output at (t, k) is received at (t, k + 1), an
+ * internal event with a null time advance runs at (t, k + 1).
+ */
+struct VTime
+{
+    VTime()
+        : time(infinity), bag(0)
+    {}
+
+    VTime(const Time& time, std::size_t bag)
+        : time(time), bag(bag)
+    {}
+
+    bool operator<(const VTime& other) const
+    {
+        return time < other.time or (time == other.time and
+                                     bag < other.bag);
+    }
+
+    bool operator==(const VTime& other) const
+    { return time == other.time and bag == other.bag; }
+
+    Time        time;
+    std::size_t bag;
+};
+
+/**
+ * @brief The identifier of a message and the order of the events of a
+ * bag: its date, the model which sends it and a number unique in the
+ * logical process of the sender.
+ */
+struct MessageKey
+{
+    MessageKey()
+        : sender(0), id(0)
+    {}
+
+    MessageKey(const VTime& date, std::size_t sender, unsigned long id)
+        : date(date), sender(sender), id(id)
+    {}
+
+    bool operator<(const MessageKey& other) const
+    {
+        if (date < other.date) {
+            return true;
+        }
+        if (other.date < date) {
+            return false;
+        }
+        return sender < other.sender or (sender == other.sender and
+                                         id < other.id);
+    }
+
+    VTime         date;
+    std::size_t   sender;
+    unsigned long id;
+};
+
+/**
+ * @brief A message between logical processes: the event of a model sent
+ * by a process. The engines add their own fields.
+ */
+struct Message
+{
+    Message()
+        : process(0), target(0), event(0)
+    {}
+
+    MessageKey     key;
+    std::size_t    process;
+    std::size_t    target;
+    ExternalEvent* event;
+};
+
+struct LessTarget
+{
+    bool operator()(const Message& a, const Message& b) const
+    { return a.target < b.target; }
+};
+
+typedef std::set < std::pair < VTime, std::size_t > > Schedule;
+
+/**
+ * @brief Build the default partition: blocks of consecutive models of the
+ * same size.
+ * @param models the number of models.
+ * @param processes the number of logical processes.
+ * @param partition the logical process of each model.
+ */
+VLE_LOCAL void defaultPartition(std::size_t models, std::size_t processes,
+                                std::vector < std::size_t >& partition);
+
+/**
+ * @brief Check a partition of the models into logical processes.
+ * @param engine the name of the engine, used in the errors.
+ * @param models the models.
+ * @param partition the logical process of each model.
+ * @param processes the number of logical processes.
+ * @throw utils::ArgError if the partition has not a process in [0,
+ * processes[ for each model.
+ */
+VLE_LOCAL void checkPartition(const std::string& engine,
+                              const vpz::AtomicModelVector& models,
+                              const std::vector < std::size_t >& partition,
+                              std::size_t processes);
+
+/**
+ * @brief The simulators and the dynamics of the models shared by the
+ * logical processes, and the first error of the processes.
+ */
+class VLE_LOCAL Models
+{
+public:
+    /**
+     * @brief Build the simulators and their routing tables before the
+     * threads start.
+     * @param engine the name of the engine, used in the errors.
+     * @param models the models.
+     * @param factory the builder of the dynamics of the models.
+     * @throw utils::ArgError if the factory returns no dynamics.
+     */
+    Models(const std::string& engine, const vpz::AtomicModelVector& models,
+           const DynamicsFactory& factory);
+
+    ~Models();
+
+    /**
+     * @brief The dynamics of a model.
+     * @return the dynamics or null if the model is not simulated.
+     */
+    Dynamics* dynamics(const vpz::AtomicModel* model) const;
+
+    /**
+     * @brief Reset the state of the run: the models have no next date and
+     * no error is set.
+     */
+    void reset(const std::vector < std::size_t >& partition,
+               const Time& end);
+
+    /**
+     * @brief Call the init function of the models and schedule them into
+     * their logical process.
+     */
+    template < typename LogicalProcess >
+    void init(const Time& begin, std::vector < LogicalProcess* >& processes)
+    {
+        for (std::size_t i = 0, e = m_simulators.size(); i != e; ++i) {
+            InternalEvent* event = m_simulators[i]->init(begin);
+            if (event) {
+                processes[m_partition[i]]->addModel(
+                    i, VTime(event->getTime(), 0));
+                delete event;
+            }
+        }
+    }
+
+    /**
+     * @brief Run the simulate function of the logical processes, the first
+     * in the calling thread.
+     * @throw utils::ModellingError with the first error of the processes.
+     */
+    template < typename LogicalProcess >
+    void simulate(std::vector < LogicalProcess* >& processes)
+    {
+        boost::thread_group threads;
+        for (std::size_t i = 1; i < processes.size(); ++i) {
+            threads.create_thread(boost::bind(&LogicalProcess::simulate,
+                                              processes[i]));
+        }
+        processes[0]->simulate();
+        threads.join_all();
+
+        throwIfFailed();
+    }
+
+    /**
+     * @brief Call the finish function of the models.
+     */
+    void finish();
+
+    /**
+     * @brief Store the first error of the logical processes.
+     * @return true if it is the first error.
+     */
+    bool setFailed(const std::string& error);
+
+    bool failed();
+
+    std::vector < Simulator* >                       m_simulators;
+    std::vector < Dynamics* >                        m_dynamics;
+    std::map < vpz::AtomicModel*, Simulator* >       m_map;
+    std::vector < std::size_t >                      m_partition;
+    std::vector < VTime >                            m_next;
+    Time                                             m_end;
+
+private:
+    Models(const Models& other);
+    Models& operator=(const Models& other);
+
+    void clear();
+    void throwIfFailed();
+
+    boost::mutex                                     m_mutex;
+    bool                                             m_failed;
+    std::string                                      m_error;
+};
+
+/**
+ * @brief The models and the inboxes of the logical processes of an
+ * engine.
+ */
+template < typename MessageT >
+class Engine : public Models
+{
+public:
+    typedef MessageT Message;
+
+    Engine(const std::string& engine, const vpz::AtomicModelVector& models,
+           const DynamicsFactory& factory)
+        : Models(engine, models, factory)
+    {}
+
+    ~Engine()
+    {
+        clearInboxes();
+    }
+
+    /**
+     * @brief Build an empty inbox for each logical process.
+     */
+    void openInboxes(std::size_t processes)
+    {
+        clearInboxes();
+        for (std::size_t i = 0; i < processes; ++i) {
+            m_inboxes.push_back(new Inbox());
+        }
+    }
+
+    /**
+     * @brief Delete the inboxes and the messages not received.
+     */
+    void clearInboxes()
+    {
+        for (std::size_t i = 0, e = m_inboxes.size(); i != e; ++i) {
+            for (typename std::vector < MessageT >::iterator it =
+                 m_inboxes[i]->messages.begin();
+                 it != m_inboxes[i]->messages.end(); ++it) {
+                delete it->event;
+            }
+            delete m_inboxes[i];
+        }
+        m_inboxes.clear();
+    }
+
+    /**
+     * @brief Push a message into the inbox of a logical process and wake
+     * it up.
+     */
+    void post(std::size_t process, const MessageT& msg)
+    {
+        Inbox& inbox(*m_inboxes[process]);
+        boost::mutex::scoped_lock lock(inbox.mutex);
+        inbox.messages.push_back(msg);
+        inbox.condition.notify_one();
+    }
+
+    /**
+     * @brief Take all the messages of the inbox of a logical process. If
+     * @e wait is true, wait for a message or a failure.
+     */
+    void receive(std::size_t process, std::vector < MessageT >& messages,
+                 bool wait)
+    {
+        Inbox& inbox(*m_inboxes[process]);
+        boost::mutex::scoped_lock lock(inbox.mutex);
+
+        while (wait and inbox.messages.empty() and not failed()) {
+            inbox.condition.wait(lock);
+        }
+        messages.swap(inbox.messages);
+    }
+
+    /**
+     * @brief Store the first error and wake up all the logical processes.
+     */
+    void fail(const std::string& error)
+    {
+        if (not setFailed(error)) {
+            return;
+        }
+
+        for (std::size_t i = 0, e = m_inboxes.size(); i != e; ++i) {
+            boost::mutex::scoped_lock lock(m_inboxes[i]->mutex);
+            m_inboxes[i]->condition.notify_all();
+        }
+    }
+
+private:
+    struct Inbox
+    {
+        boost::mutex              mutex;
+        boost::condition_variable condition;
+        std::vector < MessageT >  messages;
+    };
+
+    std::vector < Inbox* > m_inboxes;
+};
+
+/**
+ * @brief The logical processes of a run: they are deleted with the
+ * messages of the inboxes at the end of the run.
+ */
+template < typename EngineT, typename LogicalProcess >
+class Processes : public std::vector < LogicalProcess* >
+{
+public:
+    explicit Processes(EngineT& engine)
+        : m_engine(engine)
+    {}
+
+    ~Processes()
+    {
+        for (std::size_t i = 0; i < this->size(); ++i) {
+            delete (*this)[i];
+        }
+        m_engine.clearInboxes();
+    }
+
+private:
+    EngineT& m_engine;
+};
+
+/**
+ * @brief A logical process: the event list of a block of models, the
+ * messages not processed and the transitions of the bags. The engine
+ * decides what is done with the messages sent to the models.
+ */
+template < typename EngineT >
+class LogicalProcess
+{
+public:
+    typedef typename EngineT::Message Message;
+    typedef std::map < MessageKey, Message > PendingList;
+
+    LogicalProcess(EngineT& engine, std::size_t index)
+        : m_engine(engine), m_index(index), m_ids(0)
+    {}
+
+    virtual ~LogicalProcess()
+    {
+        for (typename PendingList::iterator it = m_pending.begin();
+             it != m_pending.end(); ++it) {
+            delete it->second.event;
+        }
+    }
+
+    void addModel(std::size_t model, const VTime& next)
+    {
+        m_engine.m_next[model] = next;
+        if (not isInfinity(next.time)) {
+            m_schedule.insert(std::make_pair(next, model));
+        }
+    }
+
+protected:
+    EngineT&                   m_engine;
+    std::size_t                m_index;
+    Schedule                   m_schedule;
+    PendingList                m_pending;
+    std::vector < std::size_t > m_affected;
+    ExternalEventList          m_outputs;
+    ExternalEventList          m_externals;
+    unsigned long              m_ids;
+
+    /**
+     * @brief Called by route() for each message sent by a model, after a
+     * message of this process is inserted into the pending list.
+     * @param process the logical process of the target.
+     * @param msg the message, its event is a copy of the output if the
+     * target is in another process.
+     */
+    virtual void send(std::size_t process, const Message& msg) = 0;
+
+    VTime nextDate() const
+    {
+        VTime result;
+
+        if (not m_schedule.empty()) {
+            result = m_schedule.begin()->first;
+        }
+        if (not m_pending.empty() and
+            m_pending.begin()->first.date < result) {
+            result = m_pending.begin()->first.date;
+        }
+        return result;
+    }
+
+    void reschedule(std::size_t model, const VTime& next)
+    {
+        VTime& current(m_engine.m_next[model]);
+
+        if (not isInfinity(current.time)) {
+            m_schedule.erase(std::make_pair(current, model));
+        }
+        current = next;
+        if (not isInfinity(next.time)) {
+            m_schedule.insert(std::make_pair(next, model));
+        }
+    }
+
+    /**
+     * @brief Take the bag of the date: the affected models are the
+     * imminent models and the models which receive a message at this date,
+     * the messages are sorted by target.
+     */
+    void collect(const VTime& date, std::vector < Message >& processed)
+    {
+        m_affected.clear();
+        for (Schedule::const_iterator it = m_schedule.begin();
+             it != m_schedule.end() and it->first == date; ++it) {
+            m_affected.push_back(it->second);
+        }
+
+        while (not m_pending.empty() and
+               m_pending.begin()->first.date == date) {
+            processed.push_back(m_pending.begin()->second);
+            m_affected.push_back(m_pending.begin()->second.target);
+            m_pending.erase(m_pending.begin());
+        }
+
+        std::sort(m_affected.begin(), m_affected.end());
+        m_affected.erase(std::unique(m_affected.begin(), m_affected.end()),
+                         m_affected.end());
+        std::stable_sort(processed.begin(), processed.end(), LessTarget());
+    }
+
+    /**
+     * @brief Fill the external events of a model with the events of the
+     * messages of the bag sorted by target.
+     */
+    void externals(std::size_t model,
+                   typename std::vector < Message >::const_iterator& msg,
+                   typename std::vector < Message >::const_iterator end)
+    {
+        m_externals.clear();
+        for (; msg != end and msg->target == model; ++msg) {
+            m_externals.push_back(msg->event);
+        }
+    }
+
+    /**
+     * @brief Run the transition of a model at the date with its external
+     * events and reschedule it.
+     */
+    void transition(std::size_t model, const VTime& date, bool internal)
+    {
+        Simulator* sim = m_engine.m_simulators[model];
+        InternalEvent event(date.time, sim);
+        InternalEvent* next;
+
+        if (internal and not m_externals.empty()) {
+            next = sim->confluentTransitions(event, m_externals);
+        } else if (internal) {
+            next = sim->internalTransition(event);
+        } else {
+            next = sim->externalTransition(m_externals, date.time);
+        }
+
+        if (next) {
+            reschedule(model, next->getTime() == date.time ?
+                       VTime(date.time, date.bag + 1) :
+                       VTime(next->getTime(), 0));
+            delete next;
+        } else {
+            reschedule(model, VTime());
+        }
+    }
+
+    /**
+     * @brief Send the outputs of a model to their targets: the events of
+     * the targets in this logical process share the attributes of the
+     * output, the other targets receive a copy.
+     */
+    void route(std::size_t model, const VTime& date)
+    {
+        Simulator* sim = m_engine.m_simulators[model];
+        VTime received(date.time, date.bag + 1);
+        ExternalEventList::iterator it = m_outputs.begin();
+
+        try {
+            for (; it != m_outputs.end(); ++it) {
+                std::pair < Simulator::const_iterator,
+                    Simulator::const_iterator > targets =
+                        sim->targets(**it, m_engine.m_map);
+
+                for (Simulator::const_iterator jt = targets.first;
+                     jt != targets.second; ++jt) {
+                    Message msg;
+                    msg.key = MessageKey(received, model, ++m_ids);
+                    msg.process = m_index;
+                    msg.target = jt->first->id();
+
+                    std::size_t process = m_engine.m_partition[msg.target];
+                    if (process == m_index) {
+                        msg.event = new ExternalEvent(**it, jt->first,
+                                                      jt->second);
+                        m_pending.insert(std::make_pair(msg.key, msg));
+                    } else {
+                        msg.event = new ExternalEvent(jt->second);
+                        if ((*it)->haveAttributes()) {
+                            msg.event->putAttributes(
+                                (*it)->getAttributes());
+                        }
+                    }
+                    send(process, msg);
+                }
+                delete *it;
+            }
+        } catch (...) {
+            for (; it != m_outputs.end(); ++it) {
+                delete *it;
+            }
+            m_outputs.clear();
+            throw;
+        }
+        m_outputs.clear();
+    }
+
+private:
+    LogicalProcess(const LogicalProcess& other);
+    LogicalProcess& operator=(const LogicalProcess& other);
+};
+
+} // namespace details
+
+}} // namespace vle devs
+
+#endif
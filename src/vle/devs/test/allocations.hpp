@@ -0,0 +1,60 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_TEST_ALLOCATIONS_HPP
+#define VLE_DEVS_TEST_ALLOCATIONS_HPP
+
+#include <cstdlib>
+#include <new>
+
+/*
+ * Count the memory allocations of the process when the counting flag is
+ * set. The global operator new and delete are replaced: the header must be
+ * included by one source file of a test program only.
+ */
+static bool counting = false;
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    if (counting) {
+        ++allocations;
+    }
+
+    void* p = std::malloc(size ? size : 1);
+    if (not p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+#endif
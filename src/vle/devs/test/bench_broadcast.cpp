@@ -0,0 +1,95 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the number of external events per second on a 1-to-N broadcast
+ * model: a Broadcaster sends an event each time unit to all the Receiver
+ * models, with and without attributes.
+ *
+ * Usage: bench_broadcast [receivers] [duration]
+ */
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/timer.hpp>
+#include <iostream>
+#include "broadcast.hpp"
+
+using namespace vle;
+
+static void bench(const char* name, bool attribute, int receivers,
+                  double duration)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    long received = 0;
+    double elapsed;
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildBroadcast(coord, top, packages, receivers, attribute,
+                                &received);
+
+        boost::timer timer;
+        while (coord.getNextTime() < duration) {
+            coord.run();
+        }
+        elapsed = timer.elapsed();
+    }
+
+    std::cout << name << ": " << elapsed << " s, " << received
+              << " events (" << (elapsed > 0 ? received / elapsed : 0.0)
+              << " events/s)\n";
+
+    delete top;
+}
+
+int main(int argc, char* argv[])
+{
+    int receivers = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 10000;
+    double duration = argc > 2 ? boost::lexical_cast < double >(argv[2])
+        : 500.0;
+
+    std::cout << "1 to " << receivers << " broadcast until " << duration
+              << "\n";
+
+    bench("without attribute", false, receivers, duration);
+    bench("with attribute   ", true, receivers, duration);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the devs::ChandyMisra engine on a grid of Cell models with a
+ * lookahead, partitioned by the vpz::Partitioner, for 1, 2, 4 and 8
+ * logical processes, and the devs::Coordinator on the same grid.
+ *
+ * Usage: bench_chandymisra [size] [duration] [lookahead]
+ */
+
+#include <vle/devs/ChandyMisra.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Partitioner.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include "cell.hpp"
+
+using namespace vle;
+
+static double elapsed(const boost::posix_time::ptime& start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+        .total_microseconds() / 1e6;
+}
+
+static double benchCoordinator(int size, double duration, double lookahead)
+{
+    vletest::CellStates states;
+    boost::posix_time::ptime start(
+        boost::posix_time::microsec_clock::universal_time());
+
+    vletest::runCoordinator(size, size, duration, lookahead, states);
+
+    double seconds = elapsed(start);
+    std::cout << "coordinator: " << seconds << " s\n";
+    return seconds;
+}
+
+static void benchChandyMisra(int size, double duration, double lookahead,
+                             std::size_t processes, double reference)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, size, size);
+
+    {
+        devs::ChandyMisra engine(top,
+                                 vletest::CellFactory(packages, lookahead),
+                                 processes);
+        vpz::Partitioner partitioner(top);
+        engine.setPartition(partitioner.partition(processes));
+
+        boost::posix_time::ptime start(
+            boost::posix_time::microsec_clock::universal_time());
+        engine.run(0.0, duration);
+        double seconds = elapsed(start);
+
+        const devs::ChandyMisra::Statistics& stats(engine.statistics());
+        std::cout << "chandy-misra " << processes << ": " << seconds
+                  << " s (speedup " << (seconds > 0 ? reference / seconds
+                                        : 0.0) << "), "
+                  << stats.transitions << " transitions, "
+                  << stats.messages << " messages, "
+                  << stats.nulls << " null messages, "
+                  << stats.blocks << " blocks\n";
+    }
+
+    delete top;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 64;
+    double duration = argc > 2 ? boost::lexical_cast < double >(argv[2])
+        : 100.0;
+    double lookahead = argc > 3 ? boost::lexical_cast < double >(argv[3])
+        : 0.5;
+
+    std::cout << size << "x" << size << " cells until " << duration
+              << " with a lookahead of " << lookahead << "\n";
+
+    double reference = benchCoordinator(size, duration, lookahead);
+    for (std::size_t processes = 1; processes <= 8; processes *= 2) {
+        benchChandyMisra(size, duration, lookahead, processes, reference);
+    }
+
+    return 0;
+}
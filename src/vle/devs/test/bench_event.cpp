@@ -0,0 +1,123 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the construction and the destruction of the external events on
+ * an output port built by name and built on an interned port, with one or
+ * many threads, against a copy of the port name in an event allocated by
+ * the system allocator.
+ *
+ * Usage: bench_event [events] [threads]
+ */
+
+#include <vle/devs/ExternalEvent.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace vle;
+
+/*
+ * An event which copies the name of its port in a string.
+ */
+struct NamedEvent
+{
+    NamedEvent(const std::string& port)
+        : target(0), attributes(0), port(port)
+    {}
+
+    void*       target;
+    void*       attributes;
+    std::string port;
+};
+
+static const std::string portName("out");
+
+static void byString(int events)
+{
+    for (int i = 0; i < events; ++i) {
+        NamedEvent* event = new NamedEvent(portName);
+        delete event;
+    }
+}
+
+static void byName(int events)
+{
+    for (int i = 0; i < events; ++i) {
+        devs::ExternalEvent* event = new devs::ExternalEvent(portName);
+        delete event;
+    }
+}
+
+static void byPort(int events)
+{
+    const devs::ExternalEvent::Port* port =
+        devs::ExternalEvent::internPortName(portName);
+
+    for (int i = 0; i < events; ++i) {
+        devs::ExternalEvent* event = new devs::ExternalEvent(port);
+        delete event;
+    }
+}
+
+static void bench(const char* name, void (*function)(int), int events,
+                  int threads)
+{
+    boost::posix_time::ptime start(
+        boost::posix_time::microsec_clock::universal_time());
+
+    boost::thread_group group;
+    for (int i = 0; i < threads; ++i) {
+        group.create_thread(boost::bind(function, events));
+    }
+    group.join_all();
+
+    double seconds = (boost::posix_time::microsec_clock::universal_time()
+                      - start).total_microseconds() / 1e6;
+
+    std::cout << name << " (" << threads << " threads): " << seconds
+              << " s, " << threads * (events / seconds) / 1e6
+              << " M events/s\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int events = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 5000000;
+    int threads = argc > 2 ? boost::lexical_cast < int >(argv[2]) : 4;
+
+    for (int i = 1; i <= threads; i *= 2) {
+        bench("std::string", byString, events, i);
+        bench("ExternalEvent(name)", byName, events, i);
+        bench("ExternalEvent(port)", byPort, events, i);
+    }
+
+    return 0;
+}
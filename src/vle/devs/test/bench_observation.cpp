@@ -0,0 +1,192 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the observations of a timed view with many observables: one
+ * call of the output plug-in by observable (oov::Plugin::onValue) or one
+ * call by date (oov::Plugin::onValueBatch).
+ *
+ * Usage: bench_observation [observables] [steps]
+ */
+
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/devs/StreamWriter.hpp>
+#include <vle/devs/View.hpp>
+#include <vle/oov/Plugin.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/value/Double.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include <vector>
+
+using namespace vle;
+
+class State : public devs::Dynamics
+{
+public:
+    State(const devs::DynamicsInit& init, const devs::InitEventList& events)
+        : devs::Dynamics(init, events)
+    {}
+
+    virtual value::Value* observation(
+        const devs::ObservationEvent& event) const
+    { return new value::Double(event.getTime()); }
+};
+
+/*
+ * Sum the observations received by onValue() or, if @e batch, by
+ * onValueBatch().
+ */
+class Sum : public oov::Plugin
+{
+public:
+    Sum(bool batch)
+        : oov::Plugin("sum"), m_batch(batch), m_sum(0.0)
+    {}
+
+    virtual void onParameter(const std::string& /* plugin */,
+                             const std::string& /* location */,
+                             const std::string& /* file */,
+                             value::Value* parameters,
+                             const double& /* time */)
+    { delete parameters; }
+
+    virtual void onNewObservable(const std::string& /* simulator */,
+                                 const std::string& /* parent */,
+                                 const std::string& /* port */,
+                                 const std::string& /* view */,
+                                 const double& /* time */)
+    {}
+
+    virtual void onDelObservable(const std::string& /* simulator */,
+                                 const std::string& /* parent */,
+                                 const std::string& /* port */,
+                                 const std::string& /* view */,
+                                 const double& /* time */)
+    {}
+
+    virtual void onValue(const std::string& /* simulator */,
+                         const std::string& /* parent */,
+                         const std::string& /* port */,
+                         const std::string& /* view */,
+                         const double& /* time */,
+                         value::Value* value)
+    {
+        if (value) {
+            m_sum += value->toDouble().value();
+            delete value;
+        }
+    }
+
+    virtual bool acceptValueBatch() const
+    { return m_batch; }
+
+    virtual void onValueBatch(const std::string& /* view */,
+                              const double& /* time */,
+                              value::Value** values,
+                              std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (values[i]) {
+                m_sum += values[i]->toDouble().value();
+                delete values[i];
+            }
+        }
+    }
+
+    virtual void close(const double& /* time */)
+    {}
+
+    double sum() const
+    { return m_sum; }
+
+private:
+    bool   m_batch;
+    double m_sum;
+};
+
+static void bench(int observables, int steps, bool batch)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    std::vector < devs::Simulator* > simulators;
+
+    for (int i = 0; i < observables; ++i) {
+        vpz::AtomicModel* atom = top.addAtomicModel(
+            "model_" + boost::lexical_cast < std::string >(i));
+        simulators.push_back(new devs::Simulator(atom));
+        simulators.back()->setId(i);
+        simulators.back()->addDynamics(
+            new State(devs::DynamicsInit(*atom, packages.get("bench")),
+                      devs::InitEventList()));
+    }
+
+    Sum* sum = new Sum(batch);
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(sum), "exp_view", 0, 0.0);
+
+    {
+        devs::TimedView view("view", stream, 1.0);
+        for (int i = 0; i < observables; ++i) {
+            view.addObservable(simulators[i], "state", 0.0);
+        }
+
+        boost::posix_time::ptime start(
+            boost::posix_time::microsec_clock::universal_time());
+        for (int i = 0; i < steps; ++i) {
+            view.run(i);
+        }
+        double seconds = (boost::posix_time::microsec_clock::universal_time()
+                          - start).total_microseconds() / 1e6;
+
+        std::cout << (batch ? "onValueBatch: " : "onValue: ") << seconds
+                  << " s, " << observables * (steps / seconds) / 1e6
+                  << " M observations/s (sum " << sum->sum() << ")\n";
+        view.finish(steps);
+    }
+
+    for (int i = 0; i < observables; ++i) {
+        delete simulators[i];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int observables = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 5000;
+    int steps = argc > 2 ? boost::lexical_cast < int >(argv[2]) : 200;
+
+    bench(observables, steps, false);
+    bench(observables, steps, true);
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Compare the devs::HeapScheduler, the devs::IndexedHeapScheduler and the
+ * devs::CalendarScheduler on a coupled model of PingPong pairs. Each
+ * external event reschedules the timeout of the receiver.
+ *
+ * Usage: bench_scheduler [pairs] [duration]
+ */
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/timer.hpp>
+#include <iostream>
+#include "pingpong.hpp"
+
+using namespace vle;
+
+static void bench(const char* name, devs::SchedulerType type, int pairs,
+                  double duration)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    std::vector < std::vector < double > > traces;
+    size_t bags = 0, maxevents = 0;
+    double elapsed;
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        coord.eventtable().setSchedulerType(type);
+        vletest::buildPingPong(coord, top, packages, pairs, traces);
+
+        boost::timer timer;
+        while (coord.getNextTime() < duration) {
+            coord.run();
+            maxevents = std::max(maxevents,
+                                 coord.eventtable().getEventNumber());
+            ++bags;
+        }
+        elapsed = timer.elapsed();
+    }
+
+    size_t transitions = 0;
+    for (size_t i = 0; i < traces.size(); ++i) {
+        transitions += traces[i].size();
+    }
+
+    std::cout << name << ": " << elapsed << " s, " << bags << " bags, "
+              << transitions << " transitions ("
+              << (elapsed > 0 ? transitions / elapsed : 0.0)
+              << " transitions/s), max events in table: " << maxevents
+              << "\n";
+
+    delete top;
+}
+
+int main(int argc, char* argv[])
+{
+    int pairs = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 1000;
+    double duration = argc > 2 ? boost::lexical_cast < double >(argv[2])
+        : 1000.0;
+
+    std::cout << pairs << " PingPong pairs until " << duration << "\n";
+
+    bench("heap        ", devs::SCHEDULER_HEAP, pairs, duration);
+    bench("indexed heap", devs::SCHEDULER_INDEXED_HEAP, pairs, duration);
+    bench("calendar    ", devs::SCHEDULER_CALENDAR, pairs, duration);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the devs::TimeWarp engine on a grid of Cell models partitioned
+ * by rows, for 1, 2, 4 and 8 logical processes, and the devs::Coordinator
+ * on the same grid.
+ *
+ * The grid is built by vletest::buildGrid and not by the
+ * translator::MatrixTranslator: the translator needs a running
+ * devs::Executive and the dynamics of a package, while the engine takes a
+ * coupled model and a DynamicsFactory. The grid of buildGrid is a torus of
+ * Moore neighbourhoods connected on the "out" and "in" ports, without
+ * border cells.
+ *
+ * Usage: bench_timewarp [size] [duration]
+ */
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/devs/TimeWarp.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <iostream>
+#include "cell.hpp"
+
+using namespace vle;
+
+static double elapsed(const boost::posix_time::ptime& start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+        .total_microseconds() / 1e6;
+}
+
+static void benchCoordinator(int size, double duration)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, size, size);
+
+    vpz::AtomicModelVector atoms;
+    vpz::BaseModel::getAtomicModelList(top, atoms);
+    double seconds;
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::CellFactory factory(packages);
+
+        for (size_t i = 0; i < atoms.size(); ++i) {
+            devs::Simulator* sim = new devs::Simulator(atoms[i]);
+            coord.addModel(atoms[i], sim);
+            sim->addDynamics(factory(*atoms[i]));
+
+            devs::InternalEvent* evt = sim->init(0.0);
+            if (evt) {
+                coord.eventtable().putInternalEvent(evt);
+            }
+        }
+
+        boost::posix_time::ptime start(
+            boost::posix_time::microsec_clock::universal_time());
+        while (coord.getNextTime() < duration) {
+            coord.run();
+        }
+        seconds = elapsed(start);
+    }
+
+    std::cout << "coordinator: " << seconds << " s\n";
+
+    delete top;
+}
+
+static void benchTimeWarp(int size, double duration, std::size_t processes)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, size, size);
+
+    {
+        devs::TimeWarp engine(top, vletest::CellFactory(packages),
+                              processes);
+
+        std::vector < std::size_t > partition(engine.models().size());
+        for (size_t i = 0; i < partition.size(); ++i) {
+            const std::string& name(engine.models()[i]->getName());
+            int row = boost::lexical_cast < int >(
+                name.substr(1, name.find('_') - 1));
+            partition[i] = row * processes / size;
+        }
+        engine.setPartition(partition);
+
+        boost::posix_time::ptime start(
+            boost::posix_time::microsec_clock::universal_time());
+        engine.run(0.0, duration);
+        double seconds = elapsed(start);
+
+        const devs::TimeWarp::Statistics& stats(engine.statistics());
+        std::cout << "timewarp " << processes << ": " << seconds << " s, "
+                  << stats.committed << " transitions ("
+                  << (seconds > 0 ? stats.committed / seconds : 0.0)
+                  << " /s), " << stats.processed << " processed, "
+                  << stats.rollbacks << " rollbacks, "
+                  << stats.antimessages << " anti-messages, "
+                  << stats.gvt << " gvt\n";
+    }
+
+    delete top;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 64;
+    double duration = argc > 2 ? boost::lexical_cast < double >(argv[2])
+        : 100.0;
+
+    std::cout << size << "x" << size << " cells until " << duration << "\n";
+
+    benchCoordinator(size, duration);
+    for (std::size_t processes = 1; processes <= 8; processes *= 2) {
+        benchTimeWarp(size, duration, processes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_TEST_BROADCAST_HPP
+#define VLE_DEVS_TEST_BROADCAST_HPP
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vector>
+
+namespace vletest {
+
+/**
+ * A Broadcaster sends an event on its output port each time unit. If
+ * @e attribute is true, the event carries a double attribute.
+ */
+class Broadcaster : public vle::devs::Dynamics
+{
+public:
+    Broadcaster(const vle::devs::DynamicsInit& init,
+                const vle::devs::InitEventList& events,
+                bool attribute)
+        : vle::devs::Dynamics(init, events), m_attribute(attribute),
+          m_nb(0)
+    {}
+
+    virtual ~Broadcaster()
+    {}
+
+    virtual vle::devs::Time init(const vle::devs::Time& /* time */)
+    { return 1.0; }
+
+    virtual void output(const vle::devs::Time& /* time */,
+                        vle::devs::ExternalEventList& output) const
+    {
+        vle::devs::ExternalEvent* evt = new vle::devs::ExternalEvent("out");
+        if (m_attribute) {
+            evt << vle::devs::attribute("value", (double)m_nb);
+        }
+        output.push_back(evt);
+    }
+
+    virtual vle::devs::Time timeAdvance() const
+    { return 1.0; }
+
+    virtual void internalTransition(const vle::devs::Time& /* time */)
+    { ++m_nb; }
+
+private:
+    bool m_attribute;
+    long m_nb;
+};
+
+/**
+ * A Receiver counts the events received on its input port.
+ */
+class Receiver : public vle::devs::Dynamics
+{
+public:
+    Receiver(const vle::devs::DynamicsInit& init,
+             const vle::devs::InitEventList& events,
+             long* received)
+        : vle::devs::Dynamics(init, events), m_received(received)
+    {}
+
+    virtual ~Receiver()
+    {}
+
+    virtual void externalTransition(const vle::devs::ExternalEventList& e,
+                                    const vle::devs::Time& /* time */)
+    { *m_received += e.size(); }
+
+private:
+    long* m_received;
+};
+
+/**
+ * Build a Broadcaster connected to @e receivers Receiver models into the
+ * @e top coupled model and attach the simulators to the coordinator. The
+ * Receiver models are connected through the input port of a coupled
+ * model to exercise the routing table.
+ */
+inline void buildBroadcast(vle::devs::Coordinator& coord,
+                           vle::vpz::CoupledModel* top,
+                           vle::utils::PackageTable& packages,
+                           int receivers,
+                           bool attribute,
+                           long* received)
+{
+    vle::vpz::CoupledModel* cells = top->addCoupledModel("cells");
+    cells->addInputPort("in");
+
+    vle::vpz::AtomicModel* source = top->addAtomicModel("source");
+    source->addOutputPort("out");
+    top->addInternalConnection("source", "out", "cells", "in");
+
+    vle::devs::Simulator* sim = new vle::devs::Simulator(source);
+    coord.addModel(source, sim);
+    sim->addDynamics(new Broadcaster(
+            vle::devs::DynamicsInit(*source, packages.get("test")),
+            vle::devs::InitEventList(), attribute));
+    coord.eventtable().putInternalEvent(sim->init(0.0));
+
+    for (int i = 0; i < receivers; ++i) {
+        std::string name("cell" + boost::lexical_cast < std::string >(i));
+
+        vle::vpz::AtomicModel* atom = cells->addAtomicModel(name);
+        atom->addInputPort("in");
+        cells->addInputConnection("in", name, "in");
+
+        sim = new vle::devs::Simulator(atom);
+        coord.addModel(atom, sim);
+        sim->addDynamics(new Receiver(
+                vle::devs::DynamicsInit(*atom, packages.get("test")),
+                vle::devs::InitEventList(), received));
+
+        vle::devs::InternalEvent* evt = sim->init(0.0);
+        if (evt) {
+            coord.eventtable().putInternalEvent(evt);
+        }
+    }
+}
+
+} // namespace vletest
+
+#endif
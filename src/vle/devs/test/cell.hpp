@@ -0,0 +1,290 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_TEST_CELL_HPP
+#define VLE_DEVS_TEST_CELL_HPP
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Set.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+
+namespace vletest {
+
+/**
+ * A Cell model of a grid: at each internal transition it sends its value
+ * to its neighbours, at each external transition it mixes the sum of the
+ * received values into its value. The sum does not depend on the order of
+ * the events of a bag. The time advance depends on the value and is null
+ * for one value in five to produce several bags at the same time. The
+ * checksum summarizes the transitions of the cell. A Cell saves its state
+ * to be simulated by the devs::TimeWarp engine.
+ *
+ * With a positive lookahead, the time advance is at least the lookahead
+ * and the Cell can be simulated by the devs::ChandyMisra engine.
+ */
+class Cell : public vle::devs::Dynamics
+{
+public:
+    Cell(const vle::devs::DynamicsInit& init,
+         const vle::devs::InitEventList& events, double lookahead = 0.0)
+        : vle::devs::Dynamics(init, events), m_value(0), m_checksum(0),
+          m_lookahead(lookahead)
+    {
+        const std::string& name(init.model().getName());
+
+        for (std::string::size_type i = 0; i < name.size(); ++i) {
+            m_value = (m_value * 31 + name[i]) % 1000;
+        }
+    }
+
+    virtual ~Cell()
+    {}
+
+    virtual vle::devs::Time init(const vle::devs::Time& /* time */)
+    { return timeAdvance(); }
+
+    virtual void output(const vle::devs::Time& /* time */,
+                        vle::devs::ExternalEventList& output) const
+    {
+        vle::devs::ExternalEvent* event =
+            new vle::devs::ExternalEvent("out");
+        event->putAttribute("value", new vle::value::Integer(m_value));
+        output.push_back(event);
+    }
+
+    virtual vle::devs::Time timeAdvance() const
+    {
+        if (m_lookahead > 0.0) {
+            return m_lookahead + (m_value % 4) * 0.5;
+        }
+        return m_value % 5 == 0 ? 0.0 : 1.0 + (m_value % 4) * 0.5;
+    }
+
+    virtual vle::devs::Time lookahead() const
+    { return m_lookahead; }
+
+    virtual bool isThreadSafe() const
+    { return true; }
+
+    virtual void internalTransition(const vle::devs::Time& time)
+    {
+        m_value = (m_value * 7 + 3) % 1000;
+        update(time);
+    }
+
+    virtual void externalTransition(
+        const vle::devs::ExternalEventList& events,
+        const vle::devs::Time& time)
+    {
+        int sum = 0;
+        for (vle::devs::ExternalEventList::const_iterator it =
+             events.begin(); it != events.end(); ++it) {
+            sum += (*it)->getIntegerAttributeValue("value");
+        }
+        m_value = (m_value * 31 + sum) % 1000;
+        update(time);
+    }
+
+    virtual vle::value::Value* saveState() const
+    {
+        vle::value::Set* state = new vle::value::Set();
+        state->add(new vle::value::Integer(m_value));
+        state->add(new vle::value::Integer(m_checksum));
+        return state;
+    }
+
+    virtual void restoreState(const vle::value::Value& state)
+    {
+        const vle::value::Set& set(state.toSet());
+        m_value = set.getInt(0);
+        m_checksum = set.getInt(1);
+    }
+
+    int value() const
+    { return m_value; }
+
+    int checksum() const
+    { return m_checksum; }
+
+private:
+    void update(const vle::devs::Time& time)
+    {
+        boost::int64_t checksum = m_checksum;
+        checksum = (checksum * 131 + m_value +
+                    static_cast < boost::int64_t >(time * 4)) % 1000003;
+        m_checksum = static_cast < int >(checksum);
+    }
+
+    int m_value;
+    int m_checksum;
+    double m_lookahead;
+};
+
+/**
+ * Get the name of the cell (@e row, @e column).
+ */
+inline std::string cellName(int row, int column)
+{
+    return "c" + boost::lexical_cast < std::string >(row) + "_" +
+        boost::lexical_cast < std::string >(column);
+}
+
+/**
+ * Build a torus of @e rows x @e columns cells into the @e top coupled
+ * model, each cell is connected to its eight neighbours.
+ */
+inline void buildGrid(vle::vpz::CoupledModel* top, int rows, int columns)
+{
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < columns; ++j) {
+            vle::vpz::AtomicModel* atom = top->addAtomicModel(
+                cellName(i, j));
+            atom->addInputPort("in");
+            atom->addOutputPort("out");
+        }
+    }
+
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < columns; ++j) {
+            for (int di = -1; di <= 1; ++di) {
+                for (int dj = -1; dj <= 1; ++dj) {
+                    if (di == 0 and dj == 0) {
+                        continue;
+                    }
+                    top->addInternalConnection(
+                        cellName(i, j), "out",
+                        cellName((i + di + rows) % rows,
+                                 (j + dj + columns) % columns), "in");
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Build the Cell of an atomic model, the DynamicsFactory of the
+ * devs::TimeWarp and devs::ChandyMisra engines in the tests.
+ */
+struct CellFactory
+{
+    CellFactory(vle::utils::PackageTable& packages, double lookahead = 0.0)
+        : packages(&packages), lookahead(lookahead)
+    {}
+
+    vle::devs::Dynamics* operator()(const vle::vpz::AtomicModel& atom) const
+    {
+        return new Cell(vle::devs::DynamicsInit(atom, packages->get("test")),
+                        vle::devs::InitEventList(), lookahead);
+    }
+
+    vle::utils::PackageTable* packages;
+    double lookahead;
+};
+
+typedef std::vector < std::pair < int, int > > CellStates;
+
+/**
+ * Run a grid of cells with the devs::Coordinator and get the value and the
+ * checksum of each cell in the order of getAtomicModelList.
+ */
+inline void runCoordinator(int rows, int columns, double duration,
+                           double lookahead, CellStates& states)
+{
+    vle::utils::ModuleManager modules;
+    vle::utils::PackageTable packages;
+    vle::vpz::Dynamics dyns;
+    vle::vpz::Classes classes;
+    vle::vpz::Experiment expe;
+    vle::devs::RootCoordinator root(modules);
+    vle::vpz::CoupledModel* top = new vle::vpz::CoupledModel("top", 0);
+    buildGrid(top, rows, columns);
+
+    vle::vpz::AtomicModelVector atoms;
+    vle::vpz::BaseModel::getAtomicModelList(top, atoms);
+    std::vector < Cell* > cells;
+
+    {
+        vle::devs::Coordinator coord(modules, dyns, classes, expe, root);
+        CellFactory factory(packages, lookahead);
+
+        for (size_t i = 0; i < atoms.size(); ++i) {
+            vle::devs::Simulator* sim = new vle::devs::Simulator(atoms[i]);
+            coord.addModel(atoms[i], sim);
+            cells.push_back(static_cast < Cell* >(factory(*atoms[i])));
+            sim->addDynamics(cells.back());
+
+            vle::devs::InternalEvent* evt = sim->init(0.0);
+            if (evt) {
+                coord.eventtable().putInternalEvent(evt);
+            }
+        }
+
+        while (coord.getNextTime() < duration) {
+            coord.run();
+        }
+
+        states.clear();
+        for (size_t i = 0; i < cells.size(); ++i) {
+            states.push_back(std::make_pair(cells[i]->value(),
+                                            cells[i]->checksum()));
+        }
+    }
+
+    delete top;
+}
+
+/**
+ * Get the value and the checksum of each cell of a parallel engine in the
+ * order of getAtomicModelList.
+ */
+template < typename Engine >
+void getStates(const Engine& engine, CellStates& states)
+{
+    states.clear();
+    for (size_t i = 0; i < engine.models().size(); ++i) {
+        const Cell* cell = static_cast < Cell* >(
+            engine.dynamics(engine.models()[i]));
+        states.push_back(std::make_pair(cell->value(), cell->checksum()));
+    }
+}
+
+} // namespace vletest
+
+#endif
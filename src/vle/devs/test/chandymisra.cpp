@@ -0,0 +1,122 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE devschandymisra_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <vle/devs/ChandyMisra.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/utils/Exception.hpp>
+#include "cell.hpp"
+
+using namespace vle;
+
+namespace {
+
+void runChandyMisra(int rows, int columns, double duration,
+                    std::size_t processes, bool interleaved,
+                    vletest::CellStates& states,
+                    devs::ChandyMisra::Statistics& stats)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, rows, columns);
+
+    {
+        devs::ChandyMisra engine(top, vletest::CellFactory(packages, 0.5),
+                                 processes);
+
+        if (interleaved) {
+            std::vector < std::size_t > partition(engine.models().size());
+            for (size_t i = 0; i < partition.size(); ++i) {
+                partition[i] = i % processes;
+            }
+            engine.setPartition(partition);
+        }
+        engine.run(0.0, duration);
+
+        vletest::getStates(engine, states);
+        stats = engine.statistics();
+    }
+
+    delete top;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_chandymisra_grid)
+{
+    vletest::CellStates serial;
+    vletest::runCoordinator(8, 8, 40.0, 0.5, serial);
+    BOOST_REQUIRE_EQUAL(serial.size(), 64u);
+
+    std::size_t processes[] = { 1, 2, 4 };
+    for (int p = 0; p < 3; ++p) {
+        for (int interleaved = 0; interleaved < 2; ++interleaved) {
+            vletest::CellStates conservative;
+            devs::ChandyMisra::Statistics stats;
+            runChandyMisra(8, 8, 40.0, processes[p], interleaved,
+                           conservative, stats);
+
+            BOOST_REQUIRE(serial == conservative);
+            BOOST_REQUIRE(stats.transitions > 0);
+            if (processes[p] == 1) {
+                BOOST_REQUIRE_EQUAL(stats.messages, 0u);
+                BOOST_REQUIRE_EQUAL(stats.nulls, 0u);
+            } else {
+                BOOST_REQUIRE(stats.messages > 0);
+                BOOST_REQUIRE(stats.nulls > 0);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_chandymisra_lookahead)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, 3, 3);
+
+    {
+        devs::ChandyMisra engine(top, vletest::CellFactory(packages), 1);
+        BOOST_REQUIRE_NO_THROW(engine.run(0.0, 10.0));
+    }
+
+    {
+        devs::ChandyMisra engine(top, vletest::CellFactory(packages), 2);
+        BOOST_REQUIRE_THROW(engine.run(0.0, 10.0), utils::ModellingError);
+    }
+
+    BOOST_REQUIRE_THROW(devs::ChandyMisra(top, vletest::CellFactory(packages),
+                                          0), utils::ArgError);
+
+    delete top;
+}
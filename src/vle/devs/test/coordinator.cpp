@@ -42,10 +42,122 @@
 #include <vle/vpz/Dynamics.hpp>
 #include <vle/vpz/Experiment.hpp>
 #include <vle/vpz/Classes.hpp>
+#include <vle/devs/Executive.hpp>
+#include <vle/devs/DynamicsDbg.hpp>
+#include <vle/devs/ModelFactory.hpp>
+#include <vle/vpz/Partitioner.hpp>
+#include <vle/value/Integer.hpp>
 #include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include "allocations.hpp"
+#include "broadcast.hpp"
+#include "cell.hpp"
+#include "pingpong.hpp"
 
 using namespace vle;
 
+namespace {
+
+/*
+ * A thread-safe model with an internal transition each time unit.
+ */
+class Clock : public devs::Dynamics
+{
+public:
+    Clock(const devs::DynamicsInit& init, const devs::InitEventList& events)
+        : devs::Dynamics(init, events), m_last(-1.0), m_nb(0)
+    {}
+
+    virtual devs::Time init(const devs::Time& /* time */)
+    { return 1.0; }
+
+    virtual devs::Time timeAdvance() const
+    { return 1.0; }
+
+    virtual bool isThreadSafe() const
+    { return true; }
+
+    virtual void internalTransition(const devs::Time& time)
+    {
+        m_last = time;
+        ++m_nb;
+    }
+
+    double m_last;
+    long m_nb;
+};
+
+/*
+ * An executive with an internal transition each time unit which checks
+ * that the Clock models were run before it in the same bag.
+ */
+class ClockExecutive : public devs::Executive
+{
+public:
+    ClockExecutive(const devs::ExecutiveInit& init,
+                   const devs::InitEventList& events,
+                   const std::vector < Clock* >& clocks)
+        : devs::Executive(init, events), m_clocks(clocks), m_nb(0)
+    {}
+
+    virtual devs::Time init(const devs::Time& /* time */)
+    { return 1.0; }
+
+    virtual devs::Time timeAdvance() const
+    { return 1.0; }
+
+    virtual void internalTransition(const devs::Time& time)
+    {
+        for (size_t i = 0; i < m_clocks.size(); ++i) {
+            if (m_clocks[i]->m_last != time) {
+                throw utils::InternalError("executive before models");
+            }
+        }
+        ++m_nb;
+    }
+
+    std::vector < Clock* > m_clocks;
+    long m_nb;
+};
+
+/*
+ * A thread-safe model which fails at its first internal transition with a
+ * vle exception or with an exception unknown by the kernel.
+ */
+class Failure : public devs::Dynamics
+{
+public:
+    Failure(const devs::DynamicsInit& init, const devs::InitEventList& events,
+            bool vle)
+        : devs::Dynamics(init, events), m_vle(vle)
+    {}
+
+    virtual devs::Time init(const devs::Time& /* time */)
+    { return 1.0; }
+
+    virtual void output(const devs::Time& /* time */,
+                        devs::ExternalEventList& output) const
+    { output.push_back(new devs::ExternalEvent("out")); }
+
+    virtual devs::Time timeAdvance() const
+    { return 1.0; }
+
+    virtual bool isThreadSafe() const
+    { return true; }
+
+    virtual void internalTransition(const devs::Time& /* time */)
+    {
+        if (m_vle) {
+            throw utils::ArgError("failure");
+        }
+        throw 42;
+    }
+
+    bool m_vle;
+};
+
+}
+
 BOOST_AUTO_TEST_CASE(test_del_coupled_model)
 {
     utils::ModuleManager modules;
@@ -65,3 +177,600 @@ BOOST_AUTO_TEST_CASE(test_del_coupled_model)
     delete depth0;
     delete simdepth2;
 }
+
+BOOST_AUTO_TEST_CASE(test_simulator_ids)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        std::vector < devs::Simulator* > sims;
+
+        for (int i = 0; i < 4; ++i) {
+            vpz::AtomicModel* atom = top->addAtomicModel(
+                "clock" + boost::lexical_cast < std::string >(i));
+            sims.push_back(new devs::Simulator(atom));
+            coord.addModel(atom, sims.back());
+            sims.back()->addDynamics(new Clock(
+                    devs::DynamicsInit(*atom, packages.get("test")),
+                    devs::InitEventList()));
+            coord.eventtable().putInternalEvent(sims.back()->init(0.0));
+
+            BOOST_REQUIRE_EQUAL(sims.back()->id(), (size_t)i);
+            BOOST_REQUIRE(coord.simulators()[i] == sims.back());
+        }
+
+        coord.delModel(top, "clock1");
+        BOOST_REQUIRE(coord.simulators()[1] == 0);
+        BOOST_REQUIRE(coord.getModel("clock1") == 0);
+
+        /* The index is reused after the deletion of the simulator at the
+         * next step. */
+        coord.run();
+
+        vpz::AtomicModel* atom = top->addAtomicModel("clock4");
+        devs::Simulator* sim = new devs::Simulator(atom);
+        coord.addModel(atom, sim);
+        BOOST_REQUIRE_EQUAL(sim->id(), (size_t)1);
+        BOOST_REQUIRE(coord.simulators()[1] == sim);
+        BOOST_REQUIRE_EQUAL(coord.simulators().size(), (size_t)4);
+        BOOST_REQUIRE(coord.getModel("clock4") == sim);
+        BOOST_REQUIRE(coord.getModel(atom) == sim);
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_model_factory_overlay)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+
+    expe.setName("plan");
+    expe.setDuration(1.0);
+    vpz::Condition cond("cond");
+    cond.add("x");
+    cond.add("y");
+    for (int i = 0; i < 3; ++i) {
+        cond.addValueToPort("x", new value::Integer(i));
+    }
+    cond.addValueToPort("y", new value::Integer(42));
+    expe.conditions().add(cond);
+
+    /* An overlay has no default condition simulation_engine. */
+    vpz::Conditions overlay;
+    overlay.conditionlist().clear();
+    overlay.add(vpz::Condition("cond")).addValueToPort(
+        "x", new value::Integer(2));
+    overlay.add(vpz::Condition(
+            vpz::Experiment::defaultSimulationEngineCondName()))
+        .addValueToPort("duration", new value::Double(5.0));
+
+    devs::ModelFactory factory(modules, dyns, classes, expe, overlay,
+                               "plan-2", root);
+    const devs::ModelFactory& shared(factory);
+
+    /* Nothing is copied until a modifiable reference is asked. */
+    BOOST_REQUIRE(&shared.experiment() == &expe);
+    BOOST_REQUIRE(&shared.dynamics() == &dyns);
+    BOOST_REQUIRE_EQUAL(shared.name(), "plan-2");
+
+    factory.dynamics().add(vpz::Dynamic("dyn"));
+    BOOST_REQUIRE(&shared.dynamics() != &dyns);
+    BOOST_REQUIRE(shared.dynamics().exist("dyn"));
+    BOOST_REQUIRE(not dyns.exist("dyn"));
+
+    /* The settings of the engine read the ports of the overlay. */
+    BOOST_REQUIRE_EQUAL(shared.engine().duration(), 5.0);
+    BOOST_REQUIRE_EQUAL(shared.engine().begin(), 0.0);
+    BOOST_REQUIRE_EQUAL(expe.duration(), 1.0);
+
+    /* The constant conditions merge the overlay without copying the
+     * experiment. */
+    const vpz::Condition& merged(shared.conditions().get("cond"));
+    BOOST_REQUIRE(&shared.experiment() == &expe);
+    BOOST_REQUIRE_EQUAL(merged.getSetValues("x").size(), 1u);
+    BOOST_REQUIRE_EQUAL(value::toInteger(merged.getSetValues("x").get(0)),
+                        2);
+    BOOST_REQUIRE_EQUAL(value::toInteger(merged.getSetValues("y").get(0)),
+                        42);
+
+    /* The copy of the experiment holds the ports of the overlay. */
+    const vpz::Condition& copy(factory.conditions().get("cond"));
+    BOOST_REQUIRE(&shared.experiment() != &expe);
+    BOOST_REQUIRE_EQUAL(shared.engine().duration(), 5.0);
+    BOOST_REQUIRE_EQUAL(shared.experiment().name(), "plan-2");
+    BOOST_REQUIRE_EQUAL(copy.getSetValues("x").size(), 1u);
+    BOOST_REQUIRE_EQUAL(value::toInteger(copy.getSetValues("x").get(0)), 2);
+    BOOST_REQUIRE_EQUAL(value::toInteger(copy.getSetValues("y").get(0)), 42);
+    BOOST_REQUIRE_EQUAL(expe.conditions().get("cond").getSetValues("x")
+                        .size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(test_simulator_targets)
+{
+    utils::ModuleManager modules;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::CoupledModel* sub = top->addCoupledModel("sub");
+
+    vpz::AtomicModel* a = top->addAtomicModel("a");
+    vpz::AtomicModel* b = top->addAtomicModel("b");
+    vpz::AtomicModel* c = sub->addAtomicModel("c");
+    a->addOutputPort("out");
+    a->addOutputPort("unused");
+    b->addInputPort("in");
+    c->addInputPort("in");
+    sub->addInputPort("in");
+    top->addInternalConnection("a", "out", "b", "in");
+    top->addInternalConnection("a", "out", "sub", "in");
+    sub->addInputConnection("in", "c", "in");
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        devs::Simulator* sa = new devs::Simulator(a);
+        devs::Simulator* sb = new devs::Simulator(b);
+        devs::Simulator* sc = new devs::Simulator(c);
+        coord.addModel(a, sa);
+        coord.addModel(b, sb);
+        coord.addModel(c, sc);
+
+        /* The output ports of the model are interned when the simulator is
+         * built. */
+        BOOST_REQUIRE_EQUAL(sa->outputPortNumber(), (size_t)2);
+        devs::Simulator::size_type out = sa->outputPortId("out");
+        BOOST_REQUIRE_EQUAL(sa->outputPortName(out), "out");
+        BOOST_REQUIRE_EQUAL(sa->outputPortId("out"), out);
+        BOOST_REQUIRE(sa->outputPort(out) ==
+                      devs::ExternalEvent::internPortName("out"));
+
+        /* An event is built on the interned port, an event built by name
+         * is not interned. */
+        {
+            devs::ExternalEvent byport(sa->outputPort(out));
+            devs::ExternalEvent byname("out");
+            devs::ExternalEvent unknown("never-interned-port");
+            BOOST_REQUIRE_EQUAL(byport.getPortId(),
+                                sa->outputPort(out)->id);
+            BOOST_REQUIRE_EQUAL(byname.getPortId(),
+                                static_cast < std::size_t >(-1));
+            BOOST_REQUIRE(byport.onPort("out"));
+            BOOST_REQUIRE(byname.onPort("out"));
+            BOOST_REQUIRE(unknown.onPort("never-interned-port"));
+            BOOST_REQUIRE_EQUAL(unknown.getPortId(),
+                                static_cast < std::size_t >(-1));
+        }
+
+        std::pair < devs::Simulator::const_iterator,
+            devs::Simulator::const_iterator > x;
+        x = sa->targets(out, coord.modellist());
+        BOOST_REQUIRE_EQUAL(x.second - x.first, 2);
+        BOOST_REQUIRE((x.first[0].first == sb and x.first[1].first == sc) or
+                      (x.first[0].first == sc and x.first[1].first == sb));
+        BOOST_REQUIRE_EQUAL(x.first[0].second->name, "in");
+        BOOST_REQUIRE(x.first[0].second == x.first[1].second);
+
+        x = sa->targets("unused", coord.modellist());
+        BOOST_REQUIRE(x.first == x.second);
+
+        /* An event is routed by the identifier of its interned port. */
+        {
+            devs::ExternalEvent event(sa->outputPort(out));
+            std::pair < devs::Simulator::const_iterator,
+                devs::Simulator::const_iterator > y;
+            y = sa->targets(event, coord.modellist());
+            BOOST_REQUIRE(y.first == sa->targets(out,
+                                                 coord.modellist()).first);
+            BOOST_REQUIRE_EQUAL(y.second - y.first, 2);
+
+            /* The name of an event built by name is searched in the
+             * output ports of the simulator. */
+            devs::ExternalEvent byname("out");
+            y = sa->targets(byname, coord.modellist());
+            BOOST_REQUIRE(y.first == sa->targets(out,
+                                                 coord.modellist()).first);
+            BOOST_REQUIRE_EQUAL(y.second - y.first, 2);
+
+            devs::ExternalEvent unknown("never-interned-port");
+            y = sa->targets(unknown, coord.modellist());
+            BOOST_REQUIRE(y.first == y.second);
+        }
+
+        /* The routing table is only rebuilt on a graph change. */
+        top->delInternalConnection("a", "out", "b", "in");
+        x = sa->targets(out, coord.modellist());
+        BOOST_REQUIRE_EQUAL(x.second - x.first, 2);
+
+        sa->updateSimulatorTargets("out", coord.modellist());
+        x = sa->targets(out, coord.modellist());
+        BOOST_REQUIRE_EQUAL(x.second - x.first, 1);
+        BOOST_REQUIRE(x.first->first == sc);
+
+        /* A new output port gets a new index and an empty target list. */
+        a->addOutputPort("new");
+        sa->addTargetPort("new");
+        BOOST_REQUIRE_EQUAL(sa->outputPortId("new"), (size_t)2);
+        x = sa->targets("new", coord.modellist());
+        BOOST_REQUIRE(x.first == x.second);
+
+        top->addInternalConnection("a", "new", "b", "in");
+        sa->updateSimulatorTargets("new", coord.modellist());
+        x = sa->targets("new", coord.modellist());
+        BOOST_REQUIRE_EQUAL(x.second - x.first, 1);
+        BOOST_REQUIRE(x.first->first == sb);
+    }
+
+    delete top;
+}
+
+static void check_bag_allocations(devs::SchedulerType type,
+                                  unsigned int threads)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::CoupledModel* sub = top->addCoupledModel("sub");
+
+    expe.setThreads(threads);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        coord.eventtable().setSchedulerType(type);
+        std::vector < Clock* > clocks;
+        std::vector < ClockExecutive* > executives;
+
+        for (int i = 0; i < 16; ++i) {
+            vpz::AtomicModel* atom = top->addAtomicModel(
+                "clock" + boost::lexical_cast < std::string >(i));
+            devs::Simulator* sim = new devs::Simulator(atom);
+            coord.addModel(atom, sim);
+            clocks.push_back(new Clock(
+                    devs::DynamicsInit(*atom, packages.get("test")),
+                    devs::InitEventList()));
+            sim->addDynamics(clocks.back());
+            coord.eventtable().putInternalEvent(sim->init(0.0));
+        }
+
+        for (int i = 0; i < 2; ++i) {
+            vpz::AtomicModel* atom = (i == 0 ? top : sub)->addAtomicModel(
+                "executive");
+            devs::Simulator* sim = new devs::Simulator(atom);
+            coord.addModel(atom, sim);
+            executives.push_back(new ClockExecutive(
+                    devs::ExecutiveInit(*atom, packages.get("test"), coord),
+                    devs::InitEventList(), clocks));
+            sim->addDynamics(executives.back());
+            coord.eventtable().putInternalEvent(sim->init(0.0));
+        }
+
+        /* The first steps fill the reused storages (bags, buckets of the
+         * calendar). */
+        while (coord.getNextTime() < 50.0) {
+            coord.run();
+        }
+
+        /* In steady state, a step does not allocate memory: the internal
+         * events are recycled by their pool. */
+        allocations = 0;
+        counting = true;
+        while (coord.getNextTime() < 150.0) {
+            coord.run();
+        }
+        counting = false;
+
+        for (size_t i = 0; i < clocks.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(clocks[i]->m_nb, 149);
+        }
+
+        BOOST_REQUIRE_EQUAL(executives[0]->m_nb, 149);
+        BOOST_REQUIRE_EQUAL(executives[1]->m_nb, 149);
+        BOOST_REQUIRE_EQUAL(allocations, (size_t)0);
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_bag_allocations)
+{
+    check_bag_allocations(devs::SCHEDULER_HEAP, 0);
+    check_bag_allocations(devs::SCHEDULER_INDEXED_HEAP, 0);
+    check_bag_allocations(devs::SCHEDULER_CALENDAR, 0);
+    check_bag_allocations(devs::SCHEDULER_INDEXED_HEAP, 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_broadcast_allocations)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    long received = 0;
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildBroadcast(coord, top, packages, 100, false, &received);
+
+        while (coord.getNextTime() < 10.0) {
+            coord.run();
+        }
+        BOOST_REQUIRE_EQUAL(received, 100 * 9);
+
+        /* The copies of the event for the receivers come from the pool of
+         * ExternalEvent and share the interned port name. */
+        allocations = 0;
+        counting = true;
+        while (coord.getNextTime() < 50.0) {
+            coord.run();
+        }
+        counting = false;
+
+        BOOST_REQUIRE_EQUAL(received, 100 * 49);
+        BOOST_REQUIRE_EQUAL(allocations, (size_t)0);
+    }
+
+    delete top;
+}
+
+static void run_pingpong(unsigned int threads,
+                         std::vector < std::vector < double > >& traces)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+
+    expe.setThreads(threads);
+    BOOST_REQUIRE_EQUAL(expe.threads(), threads);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildPingPong(coord, top, packages, 64, traces);
+
+        while (coord.getNextTime() < 200.0) {
+            coord.run();
+        }
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_bags)
+{
+    std::vector < std::vector < double > > serial, parallel2, parallel4;
+
+    run_pingpong(0, serial);
+    run_pingpong(2, parallel2);
+    run_pingpong(4, parallel4);
+
+    BOOST_REQUIRE_EQUAL(serial.size(), parallel2.size());
+    BOOST_REQUIRE_EQUAL(serial.size(), parallel4.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        BOOST_REQUIRE(not serial[i].empty());
+        BOOST_REQUIRE(serial[i] == parallel2[i]);
+        BOOST_REQUIRE(serial[i] == parallel4[i]);
+    }
+}
+
+static void run_failure(bool vle)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    std::vector < std::vector < double > > traces;
+
+    expe.setThreads(4);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildPingPong(coord, top, packages, 16, traces);
+
+        vpz::AtomicModel* atom = top->addAtomicModel("failure");
+        atom->addOutputPort("out");
+        top->addInternalConnection("failure", "out", "ping0", "in");
+
+        devs::Simulator* sim = new devs::Simulator(atom);
+        coord.addModel(atom, sim);
+        sim->addDynamics(new Failure(
+                devs::DynamicsInit(*atom, packages.get("test")),
+                devs::InitEventList(), vle));
+        coord.eventtable().putInternalEvent(sim->init(0.0));
+
+        /* The exception of the model crosses the thread pool. */
+        if (vle) {
+            BOOST_REQUIRE_THROW(while (coord.getNextTime() < 10.0) {
+                                    coord.run();
+                                }, utils::ArgError);
+        } else {
+            BOOST_REQUIRE_THROW(while (coord.getNextTime() < 10.0) {
+                                    coord.run();
+                                }, int);
+        }
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_bags_failure)
+{
+    run_failure(true);
+    run_failure(false);
+}
+
+BOOST_AUTO_TEST_CASE(test_dynamics_dbg)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::AtomicModel* atom = top->addAtomicModel("a");
+    devs::DynamicsInit init(*atom, packages.get("test"));
+    std::vector < double > trace;
+
+    /* The debug wrapper forwards the parallel properties of the model. */
+    {
+        devs::DynamicsDbg dbg(init, devs::InitEventList());
+        vletest::Cell* cell = new vletest::Cell(init, devs::InitEventList(),
+                                                2.0);
+        dbg.set(cell);
+        BOOST_REQUIRE(dbg.isThreadSafe());
+        BOOST_REQUIRE_EQUAL(dbg.lookahead(), 2.0);
+
+        int value = cell->value();
+        value::Value* state = dbg.saveState();
+        BOOST_REQUIRE(state);
+        dbg.internalTransition(1.0);
+        BOOST_REQUIRE(cell->value() != value);
+        dbg.restoreState(*state);
+        BOOST_REQUIRE_EQUAL(cell->value(), value);
+        delete state;
+    }
+
+    {
+        devs::DynamicsDbg dbg(init, devs::InitEventList());
+        dbg.set(new vletest::PingPong(init, devs::InitEventList(), true,
+                                      1.0, 100.0, &trace, false));
+        BOOST_REQUIRE(not dbg.isThreadSafe());
+        BOOST_REQUIRE(dbg.saveState() == 0);
+        BOOST_REQUIRE_EQUAL(dbg.lookahead(), 0.0);
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_traffic)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    std::vector < std::vector < double > > traces;
+    std::string filename("devscoordinator-traffic.txt");
+
+    expe.setTraffic(filename);
+    BOOST_REQUIRE_EQUAL(expe.traffic(), filename);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildPingPong(coord, top, packages, 4, traces);
+
+        while (coord.getNextTime() < 200.0) {
+            coord.run();
+        }
+        coord.finish();
+    }
+
+    /* One line per connection with the number of outputs of the source,
+     * the internal transitions of its trace. */
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::map < std::string, long > events;
+    while (std::getline(file, line)) {
+        std::string::size_type tab = line.rfind('\t');
+        BOOST_REQUIRE(tab != std::string::npos);
+        events[line.substr(0, tab)] = boost::lexical_cast < long >(
+            line.substr(tab + 1));
+    }
+    file.close();
+
+    BOOST_REQUIRE_EQUAL(events.size(), (size_t)8);
+    for (int i = 0; i < 4; ++i) {
+        vpz::AtomicModel* ping = top->findModel(
+            "ping" + boost::lexical_cast < std::string >(i))->toAtomic();
+        vpz::AtomicModel* pong = top->findModel(
+            "pong" + boost::lexical_cast < std::string >(i))->toAtomic();
+        long sent = 0;
+        for (size_t j = 0; j < traces[i * 2].size(); ++j) {
+            sent += traces[i * 2][j] > 0.0;
+        }
+        BOOST_REQUIRE(sent > 0);
+        BOOST_REQUIRE_EQUAL(events[ping->getCompleteName() + "\t" +
+                                   pong->getCompleteName()], sent);
+    }
+
+    /* The file is the traffic of the partitioner. */
+    vpz::Partitioner partitioner(top);
+    std::ifstream traffic(filename.c_str());
+    BOOST_REQUIRE_NO_THROW(partitioner.readTraffic(traffic));
+    traffic.close();
+    std::remove(filename.c_str());
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_traffic_table)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    std::string filename("devscoordinator-traffic-table.txt");
+    long received = 0;
+
+    expe.setTraffic(filename);
+
+    /* The counters of the 500 connections grow the traffic table and the
+     * counters of a deleted model are kept by its name. */
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vletest::buildBroadcast(coord, top, packages, 500, false, &received);
+
+        while (coord.getNextTime() < 10.0) {
+            coord.run();
+        }
+        coord.delModel(top->findModel("cells")->toCoupled(), "cell0");
+        coord.getModel("source")->updateSimulatorTargets(
+            "out", coord.modellist());
+        while (coord.getNextTime() < 20.0) {
+            coord.run();
+        }
+        coord.finish();
+    }
+
+    std::ifstream file(filename.c_str());
+    std::string line;
+    std::map < std::string, long > events;
+    while (std::getline(file, line)) {
+        std::string::size_type tab = line.rfind('\t');
+        BOOST_REQUIRE(tab != std::string::npos);
+        events[line.substr(0, tab)] = boost::lexical_cast < long >(
+            line.substr(tab + 1));
+    }
+    file.close();
+    std::remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(events.size(), (size_t)500);
+    BOOST_REQUIRE_EQUAL(events["top,source\ttop,cells,cell0"], 9);
+    BOOST_REQUIRE_EQUAL(events["top,source\ttop,cells,cell1"], 19);
+
+    delete top;
+}
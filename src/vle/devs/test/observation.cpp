@@ -0,0 +1,906 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE devsobservation_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <vle/devs/Aggregation.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/ObservationClock.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/devs/StreamWriter.hpp>
+#include <vle/devs/View.hpp>
+#include <vle/oov/Plugin.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Tuple.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "allocations.hpp"
+
+using namespace vle;
+
+/*
+ * Count the calls of the observation functions of the Observed models.
+ */
+static size_t observations = 0;
+
+namespace {
+
+/*
+ * A model which observes the time of the observation. The port "twice"
+ * is a numeric port of type double, the port "count" of type integer.
+ */
+class Observed : public devs::Dynamics
+{
+public:
+    Observed(const devs::DynamicsInit& init,
+             const devs::InitEventList& events)
+        : devs::Dynamics(init, events)
+    {}
+
+    virtual value::Value* observation(
+        const devs::ObservationEvent& event) const
+    {
+        ++observations;
+        return new value::Double(event.getTime());
+    }
+
+    virtual ObservationType observationType(const std::string& port) const
+    {
+        if (port == "twice") {
+            return OBSERVATION_DOUBLE;
+        } else if (port == "count") {
+            return OBSERVATION_INTEGER;
+        }
+        return OBSERVATION_VALUE;
+    }
+
+    virtual double numericObservation(
+        const devs::ObservationEvent& event) const
+    {
+        ++observations;
+        return event.onPort("twice") ? event.getTime() * 2.0 :
+            event.getTime() + 1.0;
+    }
+};
+
+/*
+ * An output plug-in which records the calls and can be slow or fail.
+ */
+class Recorder : public oov::Plugin
+{
+public:
+    Recorder(std::vector < std::string >* trace, long delay = 0,
+             int failure = -1)
+        : oov::Plugin("recorder"), m_trace(trace), m_delay(delay),
+        m_failure(failure)
+    {}
+
+    virtual void onParameter(const std::string& /* plugin */,
+                             const std::string& /* location */,
+                             const std::string& file,
+                             value::Value* parameters,
+                             const double& /* time */)
+    {
+        delete parameters;
+        m_trace->push_back("open " + file);
+    }
+
+    virtual void onNewObservable(const std::string& simulator,
+                                 const std::string& /* parent */,
+                                 const std::string& port,
+                                 const std::string& view,
+                                 const double& /* time */)
+    { m_trace->push_back("new " + simulator + " " + port + " " + view); }
+
+    virtual void onDelObservable(const std::string& simulator,
+                                 const std::string& /* parent */,
+                                 const std::string& port,
+                                 const std::string& view,
+                                 const double& /* time */)
+    { m_trace->push_back("del " + simulator + " " + port + " " + view); }
+
+    virtual void onValue(const std::string& simulator,
+                         const std::string& /* parent */,
+                         const std::string& port,
+                         const std::string& /* view */,
+                         const double& time,
+                         value::Value* value)
+    {
+        std::string line(simulator + " " + port + " " +
+                         boost::lexical_cast < std::string >(time));
+        if (value) {
+            line += " " + value->writeToString();
+            delete value;
+        }
+
+        if (m_delay) {
+            boost::this_thread::sleep(boost::posix_time::microseconds(
+                    m_delay));
+        }
+        if (static_cast < int >(m_trace->size()) == m_failure) {
+            throw std::runtime_error("disk full");
+        }
+        m_trace->push_back(line);
+    }
+
+    virtual void close(const double& time)
+    {
+        m_trace->push_back("close " +
+                           boost::lexical_cast < std::string >(time));
+    }
+
+protected:
+    std::vector < std::string >* m_trace;
+    long                         m_delay;
+    int                          m_failure;
+};
+
+/*
+ * A Recorder which accepts the rows of numeric observations.
+ */
+class RowRecorder : public Recorder
+{
+public:
+    RowRecorder(std::vector < std::string >* trace)
+        : Recorder(trace)
+    {}
+
+    virtual bool acceptValues() const
+    { return true; }
+
+    virtual void onNewColumn(const std::string& simulator,
+                             const std::string& /* parent */,
+                             const std::string& port,
+                             const std::string& view,
+                             const double& /* time */,
+                             std::size_t column)
+    {
+        m_trace->push_back("column " + simulator + " " + port + " " + view +
+                           " " + boost::lexical_cast < std::string >(
+                               column));
+    }
+
+    virtual void onValues(const std::string& /* view */,
+                          const double& time,
+                          const double* row,
+                          std::size_t size)
+    {
+        std::string line("row " + boost::lexical_cast < std::string >(time));
+        for (std::size_t i = 0; i < size; ++i) {
+            line += " " + boost::lexical_cast < std::string >(row[i]);
+        }
+        m_trace->push_back(line);
+    }
+};
+
+/*
+ * A RowRecorder which accepts the batches of observations and, optionally,
+ * the rows.
+ */
+class BatchRecorder : public RowRecorder
+{
+public:
+    BatchRecorder(std::vector < std::string >* trace, bool rows)
+        : RowRecorder(trace), m_rows(rows)
+    {}
+
+    virtual bool acceptValues() const
+    { return m_rows; }
+
+    virtual bool acceptValueBatch() const
+    { return true; }
+
+    virtual void onValueBatch(const std::string& /* view */,
+                              const double& time,
+                              value::Value** values,
+                              std::size_t size)
+    {
+        std::string line("batch " +
+                         boost::lexical_cast < std::string >(time));
+        for (std::size_t i = 0; i < size; ++i) {
+            line += " " + (values[i] ? values[i]->writeToString() : "-");
+            delete values[i];
+        }
+        m_trace->push_back(line);
+    }
+
+private:
+    bool m_rows;
+};
+
+/*
+ * A plug-in which sums the rows of numeric observations.
+ */
+class RowSum : public Recorder
+{
+public:
+    RowSum(std::vector < std::string >* trace)
+        : Recorder(trace), m_sum(0.0)
+    {}
+
+    virtual bool acceptValues() const
+    { return true; }
+
+    virtual void onValues(const std::string& /* view */,
+                          const double& /* time */,
+                          const double* row,
+                          std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            m_sum += row[i];
+        }
+    }
+
+    double m_sum;
+};
+
+/*
+ * Observe two models with a timed view during @e steps time units and
+ * get the calls of the plug-in.
+ */
+void observe(std::size_t capacity, long delay, int steps,
+             std::vector < std::string >& trace,
+             devs::StreamWriter::QueueStatistics* stats = 0)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    vpz::AtomicModel* b = top.addAtomicModel("b");
+
+    devs::Simulator sa(a);
+    devs::Simulator sb(b);
+    sa.setId(0);
+    sb.setId(1);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+    sb.addDynamics(new Observed(devs::DynamicsInit(*b, packages.get("t")),
+                                devs::InitEventList()));
+
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(new Recorder(&trace, delay)), "exp_view",
+                 0, 0.0);
+    stream->setQueue(capacity);
+
+    devs::TimedView view("view", stream, 1.0);
+    stream->setView(&view);
+    view.addObservable(&sa, "x", 0.0);
+    view.addObservable(&sb, "y", 0.0);
+
+    for (int i = 0; i < steps; ++i) {
+        view.run(i);
+        if (i == steps / 2) {
+            view.removeObservable(&sb);
+        }
+    }
+    view.finish(steps);
+
+    if (stats) {
+        *stats = stream->queueStatistics();
+    }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_observation_queue)
+{
+    std::vector < std::string > serial;
+    observe(0, 0, 100, serial);
+    BOOST_REQUIRE_EQUAL(serial.size(), 156u);
+    BOOST_REQUIRE_EQUAL(serial.front(), "open exp_view");
+    BOOST_REQUIRE_EQUAL(serial[1], "new a x view");
+    BOOST_REQUIRE_EQUAL(serial[3], "a x 0 0");
+    BOOST_REQUIRE_EQUAL(serial.back(), "close 100");
+
+    std::size_t capacities[] = { 1, 4, 1024 };
+    for (int i = 0; i < 3; ++i) {
+        std::vector < std::string > queued;
+        devs::StreamWriter::QueueStatistics stats;
+        observe(capacities[i], i == 0 ? 100 : 0, 100, queued, &stats);
+
+        BOOST_REQUIRE(serial == queued);
+        BOOST_REQUIRE_EQUAL(stats.capacity, capacities[i]);
+        BOOST_REQUIRE_EQUAL(stats.records, 154u);
+        BOOST_REQUIRE(stats.depth >= 1u);
+        BOOST_REQUIRE(stats.depth <= capacities[i]);
+    }
+
+    devs::StreamWriter::QueueStatistics stats;
+    std::vector < std::string > queued;
+    observe(0, 0, 10, queued, &stats);
+    BOOST_REQUIRE_EQUAL(stats.records, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_queue_failure)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+
+    std::vector < std::string > trace;
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(new Recorder(&trace, 0, 10)), "exp_view",
+                 0, 0.0);
+    stream->setQueue(4);
+
+    devs::TimedView view("view", stream, 1.0);
+    view.addObservable(&sa, "x", 0.0);
+
+    bool thrown = false;
+    try {
+        for (int i = 0; i < 100; ++i) {
+            view.run(i);
+        }
+        view.finish(100);
+    } catch (const utils::InternalError& /* e */) {
+        thrown = true;
+    }
+
+    BOOST_REQUIRE(thrown);
+    BOOST_REQUIRE_EQUAL(trace.size(), 10u);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_numeric)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    vpz::AtomicModel* b = top.addAtomicModel("b");
+    devs::Simulator sa(a);
+    devs::Simulator sb(b);
+    sa.setId(0);
+    sb.setId(1);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+    sb.addDynamics(new Observed(devs::DynamicsInit(*b, packages.get("t")),
+                                devs::InitEventList()));
+
+    for (int queued = 0; queued < 2; ++queued) {
+        // A plug-in without rows receives the numeric observations as
+        // values.
+        std::vector < std::string > trace;
+        {
+            devs::StreamWriter* stream = new devs::StreamWriter(modules);
+            stream->open(oov::PluginPtr(new Recorder(&trace)), "exp_view",
+                         0, 0.0);
+            stream->setQueue(queued ? 4 : 0);
+
+            devs::TimedView view("view", stream, 1.0);
+            view.addObservable(&sa, "x", 0.0);
+            view.addObservable(&sa, "twice", 0.0);
+            view.addObservable(&sa, "count", 0.0);
+            view.run(3.0);
+            view.finish(4.0);
+        }
+
+        BOOST_REQUIRE_EQUAL(trace.size(), 8u);
+        BOOST_REQUIRE_EQUAL(trace[3], "new a count view");
+        BOOST_REQUIRE_EQUAL(trace[5], "a twice 3 6");
+        BOOST_REQUIRE_EQUAL(trace[6], "a count 3 4");
+
+        // A plug-in with rows receives the numeric observations in a row,
+        // the cell of a deleted observable is NaN.
+        trace.clear();
+        {
+            devs::StreamWriter* stream = new devs::StreamWriter(modules);
+            stream->open(oov::PluginPtr(new RowRecorder(&trace)),
+                         "exp_view", 0, 0.0);
+            stream->setQueue(queued ? 4 : 0);
+
+            devs::TimedView view("view", stream, 1.0);
+            view.addObservable(&sa, "x", 0.0);
+            view.addObservable(&sa, "twice", 0.0);
+            view.addObservable(&sa, "count", 0.0);
+            view.addObservable(&sb, "twice", 0.0);
+            view.run(3.0);
+            view.removeObservable(&sa);
+            view.run(4.0);
+            view.finish(5.0);
+        }
+
+        BOOST_REQUIRE_EQUAL(trace.size(), 12u);
+        BOOST_REQUIRE_EQUAL(trace[1], "new a x view");
+        BOOST_REQUIRE_EQUAL(trace[2], "column a twice view 0");
+        BOOST_REQUIRE_EQUAL(trace[3], "column a count view 1");
+        BOOST_REQUIRE_EQUAL(trace[4], "column b twice view 2");
+        BOOST_REQUIRE_EQUAL(trace[5], "a x 3 3");
+        BOOST_REQUIRE_EQUAL(trace[6], "row 3 6 4 6");
+        BOOST_REQUIRE_EQUAL(trace[7], "del a x view");
+        BOOST_REQUIRE_EQUAL(trace[10], "row 4 nan nan 8");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_batch)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    vpz::AtomicModel* b = top.addAtomicModel("b");
+    devs::Simulator sa(a);
+    devs::Simulator sb(b);
+    sa.setId(0);
+    sb.setId(1);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+    sb.addDynamics(new Observed(devs::DynamicsInit(*b, packages.get("t")),
+                                devs::InitEventList()));
+
+    for (int queued = 0; queued < 2; ++queued) {
+        for (int rows = 0; rows < 2; ++rows) {
+            std::vector < std::string > trace;
+            {
+                devs::StreamWriter* stream = new devs::StreamWriter(modules);
+                stream->open(oov::PluginPtr(new BatchRecorder(&trace, rows)),
+                             "exp_view", 0, 0.0);
+                stream->setQueue(queued ? 4 : 0);
+
+                devs::TimedView view("view", stream, 1.0);
+                view.addObservable(&sa, "x", 0.0);
+                view.addObservable(&sa, "twice", 0.0);
+                view.addObservable(&sb, "x", 0.0);
+                view.run(3.0);
+                view.removeObservable(&sa);
+                view.run(4.0);
+                view.finish(5.0);
+            }
+
+            // The observables share the columns of the rows and of the
+            // batches, the numeric port is in the row if the plug-in
+            // accepts the rows.
+            BOOST_REQUIRE_EQUAL(trace[1], "column a x view 0");
+            BOOST_REQUIRE_EQUAL(trace[2], "column a twice view 1");
+            BOOST_REQUIRE_EQUAL(trace[3], "column b x view 2");
+
+            if (rows) {
+                BOOST_REQUIRE_EQUAL(trace.size(), 11u);
+                BOOST_REQUIRE_EQUAL(trace[4], "row 3 nan 6 nan");
+                BOOST_REQUIRE_EQUAL(trace[5], "batch 3 3 - 3");
+                BOOST_REQUIRE_EQUAL(trace[8], "row 4 nan nan nan");
+                BOOST_REQUIRE_EQUAL(trace[9], "batch 4 - - 4");
+            } else {
+                BOOST_REQUIRE_EQUAL(trace.size(), 9u);
+                BOOST_REQUIRE_EQUAL(trace[4], "batch 3 3 6 3");
+                BOOST_REQUIRE_EQUAL(trace[5], "del a x view");
+                BOOST_REQUIRE_EQUAL(trace[7], "batch 4 - - 4");
+            }
+            BOOST_REQUIRE_EQUAL(trace.back(), "close 5");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_numeric_allocations)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel(
+        "a_model_with_a_name_longer_than_the_small_strings");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+
+    std::vector < std::string > trace;
+    RowSum* sum = new RowSum(&trace);
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(sum), "exp_view", 0, 0.0);
+
+    devs::TimedView view("a_view_with_a_name_longer_than_the_small_strings",
+                         stream, 1.0);
+    view.addObservable(&sa, "twice", 0.0);
+    view.addObservable(&sa, "count", 0.0);
+
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < 100; ++i) {
+        view.run(i);
+    }
+    counting = false;
+
+    BOOST_REQUIRE_EQUAL(allocations, 0u);
+    BOOST_REQUIRE_EQUAL(sum->m_sum, 99.0 * 100.0 + 99.0 * 100.0 / 2 + 100.0);
+    view.finish(100.0);
+}
+
+/*
+ * Observe a model during ten time units with a view aggregated by windows
+ * of four observations.
+ */
+void aggregate(oov::Plugin* plugin, vpz::View::Aggregation aggregation)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+
+    vpz::View definition("view", vpz::View::TIMED, "output", 1.0);
+    definition.setAggregation(aggregation, 4);
+
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(plugin), "exp_view", 0, 0.0);
+
+    devs::TimedView view("view", stream, 1.0);
+    view.setAggregation(definition);
+    view.addObservable(&sa, "x", 0.0);
+    view.addObservable(&sa, "twice", 0.0);
+    view.addObservable(&sa, "count", 0.0);
+
+    for (int i = 0; i < 10; ++i) {
+        view.run(i);
+    }
+    view.finish(10.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_aggregation)
+{
+    // The aggregates are reals: the ports are in the rows, the last
+    // window is sent by finish.
+    std::vector < std::string > trace;
+    aggregate(new RowRecorder(&trace), vpz::View::AGGREGATE_MEAN);
+    BOOST_REQUIRE_EQUAL(trace.size(), 8u);
+    BOOST_REQUIRE_EQUAL(trace[1], "column a x view 0");
+    BOOST_REQUIRE_EQUAL(trace[4], "row 3 1.5 3 2.5");
+    BOOST_REQUIRE_EQUAL(trace[5], "row 7 5.5 11 6.5");
+    BOOST_REQUIRE_EQUAL(trace[6], "row 9 8.5 17 9.5");
+    BOOST_REQUIRE_EQUAL(trace[7], "close 10");
+
+    trace.clear();
+    aggregate(new RowRecorder(&trace), vpz::View::AGGREGATE_MAX);
+    BOOST_REQUIRE_EQUAL(trace[4], "row 3 3 6 4");
+    BOOST_REQUIRE_EQUAL(trace[6], "row 9 9 18 10");
+
+    trace.clear();
+    aggregate(new RowRecorder(&trace), vpz::View::AGGREGATE_SUM);
+    BOOST_REQUIRE_EQUAL(trace[4], "row 3 6 12 10");
+
+    // Without rows, the aggregates are values.
+    trace.clear();
+    aggregate(new Recorder(&trace), vpz::View::AGGREGATE_COUNT);
+    BOOST_REQUIRE_EQUAL(trace.size(), 14u);
+    BOOST_REQUIRE_EQUAL(trace[4], "a x 3 4");
+    BOOST_REQUIRE_EQUAL(trace[6], "a count 3 4");
+    BOOST_REQUIRE_EQUAL(trace[12], "a count 9 2");
+
+    trace.clear();
+    aggregate(new Recorder(&trace), vpz::View::AGGREGATE_MIN);
+    BOOST_REQUIRE_EQUAL(trace[7], "a x 7 4");
+    BOOST_REQUIRE_EQUAL(trace[8], "a twice 7 8");
+
+    // The samples are not in the rows.
+    trace.clear();
+    aggregate(new RowRecorder(&trace), vpz::View::AGGREGATE_SAMPLE);
+    BOOST_REQUIRE_EQUAL(trace.size(), 14u);
+    BOOST_REQUIRE_EQUAL(trace[1], "new a x view");
+    BOOST_REQUIRE_EQUAL(trace[4], "a x 3 (0,1,2,3)");
+    BOOST_REQUIRE_EQUAL(trace[12], "a count 9 (9,10)");
+}
+
+BOOST_AUTO_TEST_CASE(test_aggregation_accumulator)
+{
+    utils::Rand rand(1);
+    devs::Accumulator samples(vpz::View::AGGREGATE_SAMPLE, 10, 0.5);
+    boost::scoped_ptr < value::Value > value(samples.value());
+    BOOST_REQUIRE(not value);
+
+    // The reservoir keeps 10 observations of the window.
+    for (int i = 0; i < 1000; ++i) {
+        samples.add(i, rand);
+    }
+    value.reset(samples.value());
+    const value::TupleValue& tuple(value->toTuple().value());
+    BOOST_REQUIRE_EQUAL(tuple.size(), 10u);
+    for (std::size_t i = 0; i < tuple.size(); ++i) {
+        BOOST_REQUIRE(tuple[i] >= 0.0 and tuple[i] < 1000.0);
+        BOOST_REQUIRE_EQUAL(tuple[i], std::floor(tuple[i]));
+    }
+    BOOST_REQUIRE(*std::max_element(tuple.begin(), tuple.end()) >= 10.0);
+
+    devs::Accumulator count(vpz::View::AGGREGATE_COUNT, 10, 0.5);
+    value.reset(count.value());
+    BOOST_REQUIRE_EQUAL(value->toInteger().value(), 0);
+    count.add(1.0, rand);
+    BOOST_REQUIRE_EQUAL(count.scalar(), 1.0);
+    count.clear();
+    BOOST_REQUIRE_EQUAL(count.scalar(), 0.0);
+
+    devs::Accumulator mean(vpz::View::AGGREGATE_MEAN, 10, 0.5);
+    BOOST_REQUIRE(std::isnan(mean.scalar()));
+}
+
+BOOST_AUTO_TEST_CASE(test_aggregation_tdigest)
+{
+    devs::TDigest digest;
+    BOOST_REQUIRE(std::isnan(digest.quantile(0.5)));
+
+    utils::Rand rand(12345);
+    for (int i = 0; i < 100000; ++i) {
+        digest.add(rand.getDouble());
+    }
+
+    BOOST_REQUIRE_EQUAL(digest.size(), 100000.0);
+    BOOST_REQUIRE(digest.centroids() < 300u);
+    BOOST_REQUIRE_CLOSE(digest.quantile(0.5), 0.5, 2.0);
+    BOOST_REQUIRE_CLOSE(digest.quantile(0.9), 0.9, 1.0);
+    BOOST_REQUIRE_CLOSE(digest.quantile(0.99), 0.99, 0.2);
+    BOOST_REQUIRE_SMALL(digest.quantile(0.0001), 0.001);
+    BOOST_REQUIRE(digest.quantile(0.0) >= 0.0);
+    BOOST_REQUIRE(digest.quantile(1.0) < 1.0);
+
+    devs::Accumulator median(vpz::View::AGGREGATE_QUANTILE, 10, 0.5);
+    for (int i = 1; i <= 101; ++i) {
+        median.add(i, rand);
+    }
+    BOOST_REQUIRE_CLOSE(median.scalar(), 51.0, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_clock)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+
+    std::vector < std::string > first, second, third, last;
+    devs::ObservationCache cache;
+    {
+        devs::StreamWriter* stream = new devs::StreamWriter(modules);
+        stream->open(oov::PluginPtr(new RowRecorder(&first)), "exp_view",
+                     0, 0.0);
+        devs::TimedView v1("view", stream, 1.0);
+
+        stream = new devs::StreamWriter(modules);
+        stream->open(oov::PluginPtr(new Recorder(&second)), "exp_view",
+                     0, 0.0);
+        devs::TimedView v2("view", stream, 1.0);
+
+        stream = new devs::StreamWriter(modules);
+        stream->open(oov::PluginPtr(new Recorder(&third)), "exp_view",
+                     0, 0.0);
+        devs::TimedView v3("view", stream, 2.0);
+
+        stream = new devs::StreamWriter(modules);
+        stream->open(oov::PluginPtr(new Recorder(&last)), "exp_view",
+                     0, 0.0);
+        devs::FinishView v4("view", stream);
+
+        v1.setCache(&cache);
+        v2.setCache(&cache);
+        v3.setCache(&cache);
+        v4.setCache(&cache);
+        v1.addObservable(&sa, "x", 0.0);
+        v1.addObservable(&sa, "twice", 0.0);
+        v2.addObservable(&sa, "twice", 0.0);
+        v2.addObservable(&sa, "x", 0.0);
+        v3.addObservable(&sa, "x", 0.0);
+        v4.addObservable(&sa, "x", 0.0);
+
+        devs::ObservationClock clock;
+        clock.add(&v3, 0.0);
+        clock.add(&v4, 10.0);
+        clock.add(&v1, 0.0);
+        clock.add(&v2, 0.0);
+        BOOST_REQUIRE_EQUAL(clock.size(), 3u);
+        BOOST_REQUIRE_EQUAL(clock.nextTime(), 0.0);
+
+        // The views observe the ports once by date.
+        BOOST_REQUIRE_EQUAL(cache.size(), 2u);
+        observations = 0;
+        while (clock.nextTime() <= 10.0) {
+            clock.run(clock.nextTime());
+        }
+        BOOST_REQUIRE_EQUAL(observations, 11u * 2u);
+        BOOST_REQUIRE_EQUAL(clock.nextTime(), 11.0);
+
+        v1.finish(10.0);
+        v2.finish(10.0);
+        v3.finish(10.0);
+        v4.finish(10.0);
+    }
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+
+    BOOST_REQUIRE_EQUAL(first.size(), 1u + 2u + 11u * 2u + 1u);
+    BOOST_REQUIRE_EQUAL(first[3], "a x 0 0");
+    BOOST_REQUIRE_EQUAL(first[4], "row 0 0");
+    BOOST_REQUIRE_EQUAL(first[6], "row 1 2");
+    BOOST_REQUIRE_EQUAL(second.size(), 1u + 2u + 11u * 2u + 1u);
+    BOOST_REQUIRE_EQUAL(second[5], "a twice 1 2");
+    BOOST_REQUIRE_EQUAL(second[6], "a x 1 1");
+    BOOST_REQUIRE_EQUAL(third.size(), 1u + 1u + 6u + 1u);
+    BOOST_REQUIRE_EQUAL(third[7], "a x 10 10");
+    BOOST_REQUIRE_EQUAL(last.size(), 4u);
+    BOOST_REQUIRE_EQUAL(last[2], "a x 10 10");
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_clock_allocations)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel(
+        "a_model_with_a_name_longer_than_the_small_strings");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+
+    devs::ObservationCache cache;
+    std::vector < std::string > trace;
+    RowSum* s1 = new RowSum(&trace);
+    RowSum* s2 = new RowSum(&trace);
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(s1), "exp_view", 0, 0.0);
+    devs::TimedView v1("a_view_with_a_name_longer_than_the_small_strings",
+                       stream, 1.0);
+    stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(s2), "exp_view", 0, 0.0);
+    devs::TimedView v2("a_view_with_a_name_longer_than_the_small_strings",
+                       stream, 1.0);
+    v1.setCache(&cache);
+    v2.setCache(&cache);
+    v1.addObservable(&sa, "twice", 0.0);
+    v2.addObservable(&sa, "twice", 0.0);
+    v2.addObservable(&sa, "count", 0.0);
+
+    devs::ObservationClock clock;
+    clock.add(&v1, 0.0);
+    clock.add(&v2, 0.0);
+    clock.run(0.0);
+
+    allocations = 0;
+    observations = 0;
+    counting = true;
+    for (int i = 1; i < 100; ++i) {
+        clock.run(i);
+    }
+    counting = false;
+
+    BOOST_REQUIRE_EQUAL(allocations, 0u);
+    BOOST_REQUIRE_EQUAL(observations, 99u * 2u);
+    BOOST_REQUIRE_EQUAL(s1->m_sum, 99.0 * 100.0);
+    BOOST_REQUIRE_EQUAL(s2->m_sum, 99.0 * 100.0 + 99.0 * 100.0 / 2 + 100.0);
+    v1.finish(100.0);
+    v2.finish(100.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_cache)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    devs::Simulator sa(a);
+    sa.setId(0);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+    devs::ObservationEvent event(1.0, &sa, "view", "x");
+
+    devs::ObservationCache cache;
+    devs::ObservationCache::Entry* entry = cache.attach(&sa, "x");
+    BOOST_REQUIRE(cache.attach(&sa, "x") == entry);
+    BOOST_REQUIRE(cache.attach(&sa, "x") == entry);
+    BOOST_REQUIRE_EQUAL(entry->refs, 3u);
+
+    // The first two views get a clone, the last one gets the value.
+    observations = 0;
+    boost::scoped_ptr < value::Value > v1(cache.observation(*entry, &sa,
+                                                            event));
+    boost::scoped_ptr < value::Value > v2(cache.observation(*entry, &sa,
+                                                            event));
+    BOOST_REQUIRE(entry->value);
+    boost::scoped_ptr < value::Value > v3(cache.observation(*entry, &sa,
+                                                            event));
+    BOOST_REQUIRE(not entry->value);
+    BOOST_REQUIRE_EQUAL(observations, 1u);
+    BOOST_REQUIRE_EQUAL(v3->toDouble().value(), 1.0);
+    BOOST_REQUIRE(v1.get() != v3.get() and v2.get() != v3.get());
+
+    // A new date or a transition computes the observation again.
+    v1.reset(cache.observation(*entry, &sa, event));
+    BOOST_REQUIRE_EQUAL(observations, 2u);
+    cache.invalidate(&sa);
+    v1.reset(cache.observation(*entry, &sa, event));
+    BOOST_REQUIRE_EQUAL(observations, 3u);
+    event.setTime(2.0);
+    v1.reset(cache.observation(*entry, &sa, event));
+    BOOST_REQUIRE_EQUAL(observations, 4u);
+    BOOST_REQUIRE_EQUAL(v1->toDouble().value(), 2.0);
+
+    cache.detach(&sa, "x");
+    cache.detach(&sa, "x");
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    cache.detach(&sa, "x");
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_observation_event_views)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::CoupledModel top("top", 0);
+    vpz::AtomicModel* a = top.addAtomicModel("a");
+    vpz::AtomicModel* b = top.addAtomicModel("b");
+    devs::Simulator sa(a);
+    devs::Simulator sb(b);
+    sa.setId(0);
+    sb.setId(1);
+    sa.addDynamics(new Observed(devs::DynamicsInit(*a, packages.get("t")),
+                                devs::InitEventList()));
+    sb.addDynamics(new Observed(devs::DynamicsInit(*b, packages.get("t")),
+                                devs::InitEventList()));
+
+    std::vector < std::string > trace;
+    devs::StreamWriter* stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(new Recorder(&trace)), "exp_view", 0, 0.0);
+    devs::EventView event("event", stream);
+    stream = new devs::StreamWriter(modules);
+    stream->open(oov::PluginPtr(new Recorder(&trace)), "exp_view", 0, 0.0);
+    devs::TimedView timed("timed", stream, 1.0);
+
+    // Only the event views are attached to the simulators, once.
+    event.addObservable(&sa, "x", 0.0);
+    event.addObservable(&sa, "y", 0.0);
+    timed.addObservable(&sa, "x", 0.0);
+    timed.addObservable(&sb, "x", 0.0);
+    BOOST_REQUIRE_EQUAL(sa.eventViews().size(), 1u);
+    BOOST_REQUIRE(sa.eventViews().front() == &event);
+    BOOST_REQUIRE(sb.eventViews().empty());
+
+    event.removeObservable(&sa);
+    timed.removeObservable(&sa);
+    BOOST_REQUIRE(sa.eventViews().empty());
+    event.finish(0.0);
+    timed.finish(0.0);
+}
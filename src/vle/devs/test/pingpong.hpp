@@ -0,0 +1,145 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_DEVS_TEST_PINGPONG_HPP
+#define VLE_DEVS_TEST_PINGPONG_HPP
+
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/Dynamics.hpp>
+#include <vle/devs/Simulator.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vector>
+
+namespace vletest {
+
+/**
+ * A PingPong model sends an event on its output port at each internal
+ * transition and then waits for a long timeout. When it receives an
+ * event, it replies after a short delay: the pending timeout is
+ * rescheduled at each external event. A PingPong only modifies its own
+ * state and trace: it can declare itself thread-safe.
+ */
+class PingPong : public vle::devs::Dynamics
+{
+public:
+    PingPong(const vle::devs::DynamicsInit& init,
+             const vle::devs::InitEventList& events,
+             bool starter, double delay, double timeout,
+             std::vector < double >* trace, bool threadsafe = true)
+        : vle::devs::Dynamics(init, events), m_delay(delay),
+          m_timeout(timeout), m_sigma(starter ? delay : timeout),
+          m_trace(trace), m_threadsafe(threadsafe)
+    {}
+
+    virtual ~PingPong()
+    {}
+
+    virtual vle::devs::Time init(const vle::devs::Time& /* time */)
+    { return m_sigma; }
+
+    virtual void output(const vle::devs::Time& /* time */,
+                        vle::devs::ExternalEventList& output) const
+    { output.push_back(new vle::devs::ExternalEvent("out")); }
+
+    virtual vle::devs::Time timeAdvance() const
+    { return m_sigma; }
+
+    virtual bool isThreadSafe() const
+    { return m_threadsafe; }
+
+    virtual void internalTransition(const vle::devs::Time& time)
+    {
+        m_trace->push_back(time);
+        m_sigma = m_timeout;
+    }
+
+    virtual void externalTransition(const vle::devs::ExternalEventList& /* e */,
+                                    const vle::devs::Time& time)
+    {
+        m_trace->push_back(-time);
+        m_sigma = m_delay;
+    }
+
+private:
+    double m_delay;
+    double m_timeout;
+    double m_sigma;
+    std::vector < double >* m_trace;
+    bool m_threadsafe;
+};
+
+/**
+ * Build @e pairs couples of PingPong models connected in loop into the
+ * @e top coupled model and attach the simulators to the coordinator. The
+ * delays of the pairs overlap to produce bags of several models. One pair
+ * in five is not thread-safe.
+ */
+inline void buildPingPong(vle::devs::Coordinator& coord,
+                          vle::vpz::CoupledModel* top,
+                          vle::utils::PackageTable& packages,
+                          int pairs,
+                          std::vector < std::vector < double > >& traces)
+{
+    traces.resize(pairs * 2);
+
+    for (int i = 0; i < pairs; ++i) {
+        std::string ping("ping" + boost::lexical_cast < std::string >(i));
+        std::string pong("pong" + boost::lexical_cast < std::string >(i));
+        double delay = 1.0 + (i % 7) * 0.125;
+
+        vle::vpz::AtomicModel* a = top->addAtomicModel(ping);
+        vle::vpz::AtomicModel* b = top->addAtomicModel(pong);
+        a->addInputPort("in");
+        a->addOutputPort("out");
+        b->addInputPort("in");
+        b->addOutputPort("out");
+        top->addInternalConnection(ping, "out", pong, "in");
+        top->addInternalConnection(pong, "out", ping, "in");
+
+        vle::vpz::AtomicModel* atoms[2] = { a, b };
+        for (int j = 0; j < 2; ++j) {
+            vle::devs::Simulator* sim = new vle::devs::Simulator(atoms[j]);
+            coord.addModel(atoms[j], sim);
+            sim->addDynamics(new PingPong(
+                    vle::devs::DynamicsInit(*atoms[j], packages.get("test")),
+                    vle::devs::InitEventList(), j == 0, delay, 100.0,
+                    &traces[i * 2 + j], i % 5 != 0));
+
+            vle::devs::InternalEvent* evt = sim->init(0.0);
+            if (evt) {
+                coord.eventtable().putInternalEvent(evt);
+            }
+        }
+    }
+}
+
+} // namespace vletest
+
+#endif
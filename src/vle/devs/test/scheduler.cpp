@@ -0,0 +1,411 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE devs_scheduler_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/lexical_cast.hpp>
+#include <vle/devs/Scheduler.hpp>
+#include <vle/devs/Coordinator.hpp>
+#include <vle/devs/RootCoordinator.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamics.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <vle/vpz/Classes.hpp>
+#include <vle/utils/ModuleManager.hpp>
+#include <vle/utils/Exception.hpp>
+#include "pingpong.hpp"
+
+using namespace vle;
+
+static void check_scheduler(devs::SchedulerType type)
+{
+    vpz::CoupledModel top("top", 0);
+    std::vector < devs::Simulator* > sims;
+
+    for (int i = 0; i < 8; ++i) {
+        sims.push_back(new devs::Simulator(top.addAtomicModel(
+                    "a" + boost::lexical_cast < std::string >(i))));
+        sims.back()->setId(i);
+    }
+
+    devs::Scheduler* sch = devs::Scheduler::create(type, 16);
+    BOOST_REQUIRE_EQUAL(sch->type(), type);
+    BOOST_REQUIRE_EQUAL(sch->topTime(), devs::infinity);
+    BOOST_REQUIRE(sch->pop() == 0);
+
+    for (int i = 0; i < 8; ++i) {
+        sch->put(new devs::InternalEvent(8.0 - i, sims[i]));
+    }
+    BOOST_REQUIRE_EQUAL(sch->topTime(), 1.0);
+
+    sch->put(new devs::InternalEvent(0.5, sims[0])); /* decrease key */
+    sch->put(new devs::InternalEvent(9.0, sims[7])); /* increase key */
+    sch->erase(sims[3]);
+    BOOST_REQUIRE(sch->find(sims[3]) == 0);
+    BOOST_REQUIRE_EQUAL(sch->find(sims[0])->getTime(), 0.5);
+
+    const double expected[] = { 0.5, 2.0, 3.0, 4.0, 6.0, 7.0, 9.0 };
+    for (int i = 0; i < 7; ++i) {
+        BOOST_REQUIRE_EQUAL(sch->topTime(), expected[i]);
+        devs::InternalEvent* evt = sch->pop();
+        BOOST_REQUIRE(evt);
+        BOOST_REQUIRE_EQUAL(evt->getTime(), expected[i]);
+        BOOST_REQUIRE(sch->find(evt->getModel()) == 0);
+        delete evt;
+    }
+
+    BOOST_REQUIRE_EQUAL(sch->topTime(), devs::infinity);
+    delete sch;
+
+    for (int i = 0; i < 8; ++i) {
+        delete sims[i];
+    }
+}
+
+/*
+ * The simultaneous events are popped in the order of the identifiers of
+ * their simulators whatever the order of the puts.
+ */
+static void check_scheduler_ties(devs::SchedulerType type)
+{
+    vpz::CoupledModel top("top", 0);
+    std::vector < devs::Simulator* > sims;
+    const int order[] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+
+    for (int i = 0; i < 8; ++i) {
+        sims.push_back(new devs::Simulator(top.addAtomicModel(
+                    "a" + boost::lexical_cast < std::string >(i))));
+        sims.back()->setId(i);
+    }
+
+    devs::Scheduler* sch = devs::Scheduler::create(type, 16);
+
+    for (int i = 0; i < 8; ++i) {
+        sch->put(new devs::InternalEvent(i < 4 ? 2.0 : 1.0,
+                                         sims[order[i]]));
+    }
+    sch->put(new devs::InternalEvent(1.0, sims[order[0]]));
+    sch->erase(sims[order[5]]);
+
+    const int expected[] = { 1, 3, 4, 5, 0, 2, 7 };
+    for (int i = 0; i < 7; ++i) {
+        devs::InternalEvent* evt = sch->pop();
+        BOOST_REQUIRE(evt);
+        BOOST_REQUIRE_EQUAL(evt->getModel()->id(), (size_t)expected[i]);
+        BOOST_REQUIRE_EQUAL(evt->getTime(), i < 4 ? 1.0 : 2.0);
+        delete evt;
+    }
+    BOOST_REQUIRE(sch->pop() == 0);
+
+    delete sch;
+
+    for (int i = 0; i < 8; ++i) {
+        delete sims[i];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_heap_scheduler)
+{
+    check_scheduler(devs::SCHEDULER_HEAP);
+    check_scheduler_ties(devs::SCHEDULER_HEAP);
+}
+
+BOOST_AUTO_TEST_CASE(test_indexed_heap_scheduler)
+{
+    check_scheduler(devs::SCHEDULER_INDEXED_HEAP);
+    check_scheduler_ties(devs::SCHEDULER_INDEXED_HEAP);
+}
+
+BOOST_AUTO_TEST_CASE(test_calendar_scheduler)
+{
+    check_scheduler(devs::SCHEDULER_CALENDAR);
+    check_scheduler_ties(devs::SCHEDULER_CALENDAR);
+}
+
+static void check_scheduler_random(devs::SchedulerType type, int nb)
+{
+    vpz::CoupledModel top("top", 0);
+    std::vector < devs::Simulator* > sims;
+    std::vector < double > dates(nb, devs::infinity);
+
+    for (int i = 0; i < nb; ++i) {
+        sims.push_back(new devs::Simulator(top.addAtomicModel(
+                    "a" + boost::lexical_cast < std::string >(i))));
+        sims.back()->setId(i);
+    }
+
+    devs::Scheduler* sch = devs::Scheduler::create(type, 16);
+    unsigned int seed = 1;
+    double now = 0.0;
+
+    for (int i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        int id = (seed >> 16) % nb;
+        double date = now + ((seed >> 8) % 1000) / 8.0;
+
+        if ((seed >> 4) % 7 == 0) {
+            /* far events to test the empty years of the calendar */
+            date += 1e6;
+        }
+
+        if ((seed >> 4) % 5 == 0) {
+            sch->erase(sims[id]);
+            dates[id] = devs::infinity;
+        } else if ((seed >> 4) % 5 == 1) {
+            if (sch->topTime() != devs::infinity) {
+                devs::InternalEvent* evt = sch->pop();
+                now = evt->getTime();
+                BOOST_REQUIRE_EQUAL(now, *std::min_element(dates.begin(),
+                                                           dates.end()));
+                for (int j = 0; j < nb; ++j) {
+                    if (sims[j] == evt->getModel()) {
+                        dates[j] = devs::infinity;
+                    }
+                }
+                delete evt;
+            }
+        } else {
+            sch->put(new devs::InternalEvent(date, sims[id]));
+            dates[id] = date;
+        }
+
+        BOOST_REQUIRE_EQUAL(sch->topTime(),
+                            *std::min_element(dates.begin(), dates.end()));
+        BOOST_REQUIRE(sch->size() <= (size_t)nb);
+    }
+
+    delete sch;
+
+    for (int i = 0; i < nb; ++i) {
+        delete sims[i];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_indexed_heap_scheduler_random)
+{
+    check_scheduler_random(devs::SCHEDULER_INDEXED_HEAP, 64);
+}
+
+BOOST_AUTO_TEST_CASE(test_calendar_scheduler_random)
+{
+    check_scheduler_random(devs::SCHEDULER_CALENDAR, 64);
+    check_scheduler_random(devs::SCHEDULER_CALENDAR, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(test_scheduler_names)
+{
+    BOOST_REQUIRE_EQUAL(devs::schedulerTypeFromName("heap"),
+                        devs::SCHEDULER_HEAP);
+    BOOST_REQUIRE_EQUAL(devs::schedulerTypeFromName("indexed-heap"),
+                        devs::SCHEDULER_INDEXED_HEAP);
+    BOOST_REQUIRE_EQUAL(devs::schedulerTypeFromName("calendar"),
+                        devs::SCHEDULER_CALENDAR);
+    BOOST_REQUIRE_THROW(devs::schedulerTypeFromName("ladder"),
+                        utils::ArgError);
+
+    vpz::Experiment expe;
+    BOOST_REQUIRE_EQUAL(expe.scheduler(), "");
+    expe.setScheduler("calendar");
+    BOOST_REQUIRE_EQUAL(expe.scheduler(), "calendar");
+    expe.setScheduler("heap");
+    BOOST_REQUIRE_EQUAL(expe.scheduler(), "heap");
+    expe.setScheduler("");
+    BOOST_REQUIRE_EQUAL(expe.scheduler(), "");
+}
+
+static void run_pingpong(const std::string& scheduler,
+                         std::vector < std::vector < double > >& traces,
+                         size_t* events)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+
+    expe.setScheduler(scheduler);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        BOOST_REQUIRE_EQUAL(coord.eventtable().getSchedulerType(),
+                            devs::schedulerTypeFromName(scheduler));
+        vletest::buildPingPong(coord, top, packages, 32, traces);
+
+        *events = 0;
+        while (coord.getNextTime() < 100.0) {
+            coord.run();
+            *events = std::max(*events, coord.eventtable().getEventNumber());
+        }
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_pingpong_schedulers)
+{
+    std::vector < std::vector < double > > heap, indexed, calendar;
+    size_t heapevents, indexedevents, calendarevents;
+
+    run_pingpong("heap", heap, &heapevents);
+    run_pingpong("indexed-heap", indexed, &indexedevents);
+    run_pingpong("calendar", calendar, &calendarevents);
+
+    BOOST_REQUIRE_EQUAL(heap.size(), indexed.size());
+    BOOST_REQUIRE_EQUAL(heap.size(), calendar.size());
+    for (size_t i = 0; i < heap.size(); ++i) {
+        BOOST_REQUIRE(not heap[i].empty());
+        BOOST_REQUIRE(heap[i] == indexed[i]);
+        BOOST_REQUIRE(heap[i] == calendar[i]);
+    }
+
+    /* At most one internal event per simulator and the external events
+     * of the current bag. */
+    BOOST_REQUIRE(indexedevents <= 64 * 2);
+    BOOST_REQUIRE(calendarevents <= 64 * 2);
+    BOOST_REQUIRE(heapevents > indexedevents);
+}
+
+/*
+ * An Emitter sends an event on its output port at each time unit.
+ */
+class Emitter : public devs::Dynamics
+{
+public:
+    Emitter(const devs::DynamicsInit& init, const devs::InitEventList& events)
+        : devs::Dynamics(init, events)
+    {}
+
+    virtual devs::Time init(const devs::Time& /* time */)
+    { return 1.0; }
+
+    virtual void output(const devs::Time& /* time */,
+                        devs::ExternalEventList& output) const
+    { output.push_back(new devs::ExternalEvent("out")); }
+
+    virtual devs::Time timeAdvance() const
+    { return 1.0; }
+};
+
+/*
+ * A Collector records the input ports of the events it receives, in the
+ * order of the ExternalEventList.
+ */
+class Collector : public devs::Dynamics
+{
+public:
+    Collector(const devs::DynamicsInit& init,
+              const devs::InitEventList& events,
+              std::vector < std::string >* received)
+        : devs::Dynamics(init, events), m_received(received)
+    {}
+
+    virtual void externalTransition(const devs::ExternalEventList& events,
+                                    const devs::Time& /* time */)
+    {
+        for (devs::ExternalEventList::const_iterator it = events.begin();
+             it != events.end(); ++it) {
+            m_received->push_back((*it)->getPortName());
+        }
+    }
+
+private:
+    std::vector < std::string >* m_received;
+};
+
+static void run_fanin(const std::string& scheduler,
+                      std::vector < std::string >* received)
+{
+    utils::ModuleManager modules;
+    utils::PackageTable packages;
+    vpz::Dynamics dyns;
+    vpz::Classes classes;
+    vpz::Experiment expe;
+    devs::RootCoordinator root(modules);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+
+    expe.setScheduler(scheduler);
+
+    {
+        devs::Coordinator coord(modules, dyns, classes, expe, root);
+        vpz::AtomicModel* collector = top->addAtomicModel("collector");
+        std::vector < vpz::AtomicModel* > atoms;
+
+        for (int i = 0; i < 16; ++i) {
+            std::string name("e" + boost::lexical_cast < std::string >(i));
+            atoms.push_back(top->addAtomicModel(name));
+            atoms.back()->addOutputPort("out");
+            collector->addInputPort(name);
+            top->addInternalConnection(name, "out", "collector", name);
+        }
+        atoms.push_back(collector);
+
+        /* The simulators are initialized in a scrambled order. */
+        for (int i = 0; i < 17; ++i) {
+            vpz::AtomicModel* atom = atoms[(i * 7) % 17];
+            devs::Simulator* sim = new devs::Simulator(atom);
+            coord.addModel(atom, sim);
+            devs::DynamicsInit init(*atom, packages.get("test"));
+            if (atom == collector) {
+                sim->addDynamics(new Collector(init, devs::InitEventList(),
+                                               received));
+            } else {
+                sim->addDynamics(new Emitter(init, devs::InitEventList()));
+            }
+
+            devs::InternalEvent* evt = sim->init(0.0);
+            if (evt) {
+                coord.eventtable().putInternalEvent(evt);
+            }
+        }
+
+        while (coord.getNextTime() < 5.0) {
+            coord.run();
+        }
+    }
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_fanin_schedulers)
+{
+    std::vector < std::string > heap, indexed, calendar;
+
+    run_fanin("heap", &heap);
+    run_fanin("indexed-heap", &indexed);
+    run_fanin("calendar", &calendar);
+
+    BOOST_REQUIRE_EQUAL(heap.size(), 16u * 4u);
+    BOOST_REQUIRE(heap == indexed);
+    BOOST_REQUIRE(heap == calendar);
+}
@@ -0,0 +1,159 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE devstimewarp_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <vle/devs/TimeWarp.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/utils/PackageTable.hpp>
+#include <vle/utils/Exception.hpp>
+#include <boost/bind.hpp>
+#include "cell.hpp"
+#include "pingpong.hpp"
+
+using namespace vle;
+
+namespace {
+
+void runTimeWarp(int rows, int columns, double duration,
+                 std::size_t processes, bool interleaved,
+                 vletest::CellStates& states,
+                 devs::TimeWarp::Statistics& stats)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, rows, columns);
+
+    {
+        devs::TimeWarp engine(top, vletest::CellFactory(packages), processes);
+
+        if (interleaved) {
+            std::vector < std::size_t > partition(engine.models().size());
+            for (size_t i = 0; i < partition.size(); ++i) {
+                partition[i] = i % processes;
+            }
+            engine.setPartition(partition);
+        }
+        engine.setGvtInterval(8);
+        engine.run(0.0, duration);
+
+        vletest::getStates(engine, states);
+        stats = engine.statistics();
+    }
+
+    delete top;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_timewarp_grid)
+{
+    vletest::CellStates serial;
+    vletest::runCoordinator(8, 8, 40.0, 0.0, serial);
+    BOOST_REQUIRE_EQUAL(serial.size(), 64u);
+
+    std::size_t processes[] = { 1, 2, 4 };
+    for (int p = 0; p < 3; ++p) {
+        for (int interleaved = 0; interleaved < 2; ++interleaved) {
+            vletest::CellStates optimistic;
+            devs::TimeWarp::Statistics stats;
+            runTimeWarp(8, 8, 40.0, processes[p], interleaved, optimistic,
+                        stats);
+
+            BOOST_REQUIRE(serial == optimistic);
+            BOOST_REQUIRE(stats.committed > 0);
+            BOOST_REQUIRE(stats.processed >= stats.committed);
+            if (processes[p] == 1) {
+                BOOST_REQUIRE_EQUAL(stats.rollbacks, 0u);
+                BOOST_REQUIRE_EQUAL(stats.processed, stats.committed);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_timewarp_partition)
+{
+    utils::PackageTable packages;
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vletest::buildGrid(top, 3, 3);
+
+    {
+        devs::TimeWarp engine(top, vletest::CellFactory(packages), 2);
+        BOOST_REQUIRE_EQUAL(engine.models().size(), 9u);
+        BOOST_REQUIRE_EQUAL(engine.partition().front(), 0u);
+        BOOST_REQUIRE_EQUAL(engine.partition().back(), 1u);
+
+        std::vector < std::size_t > partition(8, 0);
+        BOOST_CHECK_THROW(engine.setPartition(partition), utils::ArgError);
+        partition.resize(9, 2);
+        BOOST_CHECK_THROW(engine.setPartition(partition), utils::ArgError);
+    }
+
+    BOOST_CHECK_THROW(devs::TimeWarp(top, vletest::CellFactory(packages), 0),
+                      utils::ArgError);
+
+    delete top;
+}
+
+namespace {
+
+devs::Dynamics* buildPingPong(utils::PackageTable* packages,
+                              std::vector < std::vector < double > >* traces,
+                              const vpz::AtomicModel& atom)
+{
+    traces->push_back(std::vector < double >());
+    return new vletest::PingPong(
+        devs::DynamicsInit(atom, packages->get("test")),
+        devs::InitEventList(), false, 1.0, 10.0, &traces->back());
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_timewarp_no_state)
+{
+    utils::PackageTable packages;
+    std::vector < std::vector < double > > traces;
+    traces.reserve(2);
+    vpz::CoupledModel* top = new vpz::CoupledModel("top", 0);
+    vpz::AtomicModel* a = top->addAtomicModel("a");
+    vpz::AtomicModel* b = top->addAtomicModel("b");
+    a->addOutputPort("out");
+    b->addInputPort("in");
+    top->addInternalConnection("a", "out", "b", "in");
+
+    {
+        devs::TimeWarp engine(top, boost::bind(buildPingPong, &packages,
+                                               &traces, _1), 2);
+        BOOST_CHECK_THROW(engine.run(0.0, 100.0), utils::ModellingError);
+    }
+
+    delete top;
+}
@@ -0,0 +1,295 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/Checkpoint.hpp>
+#include <vle/manager/ValueCodec.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace vle { namespace manager {
+
+const boost::uint64_t Checkpoint::MAGIC;
+const boost::uint32_t Checkpoint::ORDER_MARK;
+
+template < typename T >
+static bool get(std::istream& in, T *value)
+{
+    return in.read(reinterpret_cast < char* >(value), sizeof(T)).good();
+}
+
+template < typename T >
+static void put(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast < const char* >(&value), sizeof(T));
+}
+
+Checkpoint::Checkpoint(const std::string& filename,
+                       const vpz::Experiment& experiment,
+                       uint32_t size,
+                       uint32_t rank,
+                       uint32_t world,
+                       bool results)
+    : mFilename(filename), mSize(size), mRank(rank), mWorld(world),
+    mFingerprint(fingerprint(experiment.conditions()))
+{
+    try {
+        open(experiment.name(), results);
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+Checkpoint::~Checkpoint()
+{
+    clear();
+}
+
+void Checkpoint::open(const std::string& experiment, bool results)
+{
+    const std::string& filename(mFilename);
+    boost::uint64_t end = 0;
+
+    if (boost::filesystem::exists(filename)) {
+        boost::uint64_t filesize = boost::filesystem::file_size(filename);
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if (not in.is_open()) {
+            throw utils::FileError(fmt(
+                    _("Manager checkpoint: cannot read the file `%1%'")) %
+                filename);
+        }
+
+        end = readHeader(in, experiment);
+        if (end > 0) {
+            end = readRecords(in, end, filesize, results);
+        }
+
+        if (end > 0 and end < filesize) {
+            boost::filesystem::resize_file(filename, end);
+        }
+    }
+
+    if (end > 0) {
+        mFile.open(filename.c_str(), std::ios::out | std::ios::binary |
+                   std::ios::app);
+    } else {
+        mFile.open(filename.c_str(), std::ios::out | std::ios::binary |
+                   std::ios::trunc);
+        put(mFile, MAGIC);
+        put(mFile, ORDER_MARK);
+        put(mFile, mSize);
+        put(mFile, mRank);
+        put(mFile, mWorld);
+        put(mFile, mFingerprint);
+        put(mFile, static_cast < uint32_t >(experiment.size()));
+        mFile.write(experiment.data(), experiment.size());
+        mFile.flush();
+    }
+
+    if (not mFile.good()) {
+        throw utils::FileError(fmt(
+                _("Manager checkpoint: cannot write the file `%1%'")) %
+            filename);
+    }
+
+    std::sort(mCompleted.begin(), mCompleted.end());
+    mCompleted.erase(std::unique(mCompleted.begin(), mCompleted.end()),
+                     mCompleted.end());
+}
+
+void Checkpoint::clear()
+{
+    for (std::map < uint32_t, value::Map* >::iterator it = mResults.begin();
+         it != mResults.end(); ++it) {
+        delete it->second;
+    }
+    mResults.clear();
+}
+
+value::Map * Checkpoint::release(uint32_t index)
+{
+    std::map < uint32_t, value::Map* >::iterator it = mResults.find(index);
+
+    if (it == mResults.end()) {
+        return 0;
+    }
+
+    value::Map *result = it->second;
+    mResults.erase(it);
+
+    return result;
+}
+
+void Checkpoint::write(uint32_t index, const value::Map *result)
+{
+    std::string record(2 * sizeof(uint32_t), '\0');
+    encodeValue(result, &record);
+
+    uint32_t length = record.size() - 2 * sizeof(uint32_t);
+    std::memcpy(&record[0], &index, sizeof(uint32_t));
+    std::memcpy(&record[sizeof(uint32_t)], &length, sizeof(uint32_t));
+
+    boost::mutex::scoped_lock lock(mMutex);
+
+    mFile.write(record.data(), record.size());
+    mFile.flush();
+
+    if (not mFile.good()) {
+        throw utils::FileError(fmt(
+                _("Manager checkpoint: cannot write the file `%1%'")) %
+            mFilename);
+    }
+}
+
+boost::uint64_t Checkpoint::fingerprint(const vpz::Conditions& conditions)
+{
+    std::ostringstream out;
+    conditions.write(out);
+
+    const std::string& xml(out.str());
+    boost::uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (std::string::size_type i = 0; i < xml.size(); ++i) {
+        hash ^= static_cast < unsigned char >(xml[i]);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * Check the header of the file and return its size, 0 if the header is
+ * incomplete: the file is created again.
+ */
+boost::uint64_t Checkpoint::readHeader(std::istream& in,
+                                       const std::string& experiment)
+{
+    boost::uint64_t magic, fingerprint;
+    uint32_t order, size, rank, world, length;
+
+    if (not get(in, &magic)) {
+        return 0;
+    }
+
+    if (magic != MAGIC) {
+        throw utils::FileError(fmt(
+                _("Manager checkpoint: `%1%' is not a results file")) %
+            mFilename);
+    }
+
+    if (not get(in, &order) or not get(in, &size) or not get(in, &rank) or
+        not get(in, &world) or not get(in, &fingerprint) or
+        not get(in, &length)) {
+        return 0;
+    }
+
+    if (order != ORDER_MARK) {
+        throw utils::FileError(fmt(
+                _("Manager checkpoint: `%1%' was written with another byte"
+                  " order")) % mFilename);
+    }
+
+    std::string name(length, '\0');
+    if (length > 0 and not in.read(&name[0], length)) {
+        return 0;
+    }
+
+    if (size != mSize or name != experiment) {
+        throw utils::ArgError(fmt(
+                _("Manager checkpoint: `%1%' belongs to the experiment"
+                  " `%2%' of %3% combinations")) % mFilename % name % size);
+    }
+
+    if (rank != mRank or world != mWorld) {
+        throw utils::ArgError(fmt(
+                _("Manager checkpoint: `%1%' belongs to the part %2% of %3%"
+                  " of the experimental frame")) % mFilename % rank % world);
+    }
+
+    if (fingerprint != mFingerprint) {
+        throw utils::ArgError(fmt(
+                _("Manager checkpoint: `%1%' was written with other"
+                  " conditions")) % mFilename);
+    }
+
+    return sizeof(magic) + 5 * sizeof(uint32_t) + sizeof(fingerprint) +
+        length;
+}
+
+/*
+ * Read the records from @e offset and return the offset of the end of the
+ * last complete record.
+ */
+boost::uint64_t Checkpoint::readRecords(std::istream& in,
+                                        boost::uint64_t offset,
+                                        boost::uint64_t end,
+                                        bool results)
+{
+    for (;;) {
+        uint32_t index, length;
+
+        if (not get(in, &index) or not get(in, &length) or
+            index >= mSize or
+            length > end - offset - 2 * sizeof(uint32_t)) {
+            return offset;
+        }
+
+        std::string payload(length, '\0');
+        if (length > 0 and not in.read(&payload[0], length)) {
+            return offset;
+        }
+
+        if (results) {
+            value::Value *result;
+
+            try {
+                const char *begin = payload.data();
+                result = decodeValue(&begin, begin + payload.size());
+            } catch (const utils::InternalError& /*e*/) {
+                return offset;
+            }
+
+            if (result and not result->isMap()) {
+                delete result;
+                return offset;
+            }
+
+            delete mResults[index];
+            mResults[index] = static_cast < value::Map* >(result);
+        }
+
+        mCompleted.push_back(index);
+        offset += 2 * sizeof(uint32_t) + length;
+    }
+}
+
+}} // namespace vle manager
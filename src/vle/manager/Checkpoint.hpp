@@ -0,0 +1,141 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_CHECKPOINT_HPP
+#define VLE_MANAGER_CHECKPOINT_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/vpz/Experiment.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * The @c Checkpoint is the results file of an experimental frame: the
+ * results of the completed combinations are appended to the file, keyed by
+ * their index in the @c ExperimentGenerator numbering, and a new run of the
+ * experimental frame skips the combinations already in the file.
+ *
+ * The file starts with a header (the magic, the byte order mark, the number
+ * of combinations, the rank and the world of the part of the experimental
+ * frame, the fingerprint of the conditions and the name of the experiment)
+ * followed by a record by completed combination: the index, the size of
+ * the result and the result encoded by @c encodeValue. A record truncated
+ * by the end of the process which wrote it is removed when the file is
+ * opened.
+ */
+class VLE_LOCAL Checkpoint : boost::noncopyable
+{
+public:
+    static const boost::uint64_t MAGIC = 0x3230504b43454c56ULL; ///< "VLECKP02"
+    static const boost::uint32_t ORDER_MARK = 0x01020304;
+
+    /**
+     * Open the results file or create it if it does not exist.
+     *
+     * @param filename The name of the file.
+     * @param experiment The experiment of the experimental frame.
+     * @param size The number of combinations of the experimental frame.
+     * @param rank The part of the experimental frame.
+     * @param world The number of parts of the experimental frame.
+     * @param results false to skip the decoding of the results of the
+     * completed combinations.
+     *
+     * @throw utils::FileError if the file can not be read or written.
+     * @throw utils::ArgError if the file belongs to another experimental
+     * frame, another part or other conditions.
+     */
+    Checkpoint(const std::string& filename,
+               const vpz::Experiment& experiment, uint32_t size,
+               uint32_t rank, uint32_t world, bool results);
+
+    ~Checkpoint();
+
+    /**
+     * @return The sorted indices of the completed combinations.
+     */
+    const std::vector < uint32_t >& completed() const
+    { return mCompleted; }
+
+    /**
+     * Give the result of a completed combination read from the file.
+     *
+     * @return The result to freed or NULL.
+     */
+    value::Map * release(uint32_t index);
+
+    /**
+     * Append the result of a completed combination to the file. The
+     * function is called by several threads.
+     *
+     * @throw utils::FileError if the record can not be written.
+     * @throw utils::ArgError if the result can not be encoded.
+     */
+    void write(uint32_t index, const value::Map *result);
+
+    /**
+     * Compute the fingerprint of the conditions of an experimental frame:
+     * the FNV-1a hash of their XML representation.
+     *
+     * @param conditions The conditions of the experiment.
+     * @return The 64 bits hash.
+     */
+    static boost::uint64_t fingerprint(const vpz::Conditions& conditions);
+
+private:
+    void open(const std::string& experiment, bool results);
+
+    void clear();
+
+    boost::uint64_t readHeader(std::istream& in,
+                               const std::string& experiment);
+
+    boost::uint64_t readRecords(std::istream& in, boost::uint64_t offset,
+                                boost::uint64_t end, bool results);
+
+    std::string                         mFilename;
+    uint32_t                            mSize;
+    uint32_t                            mRank;
+    uint32_t                            mWorld;
+    boost::uint64_t                     mFingerprint;
+    std::ofstream                       mFile;
+    boost::mutex                        mMutex;
+    std::vector < uint32_t >            mCompleted;
+    std::map < uint32_t, value::Map* >  mResults;
+};
+
+}} // namespace vle manager
+
+#endif
@@ -146,24 +146,66 @@ public:
                  jt != cnvsrc.end(); ++jt) {
 
                 value::Set *cpy = new value::Set();
+                cpy->add(select(index, it->first, jt->first, *jt->second)
+                         .clone());
 
+                delete cnvdst[jt->first];
+                cnvdst[jt->first] = cpy;
+            }
+        }
+    }
+
+    void getOverlay(uint32_t index, vpz::Conditions *conditions)
+    {
+        const vpz::Conditions& cnds(mVpz.project().experiment().conditions());
+        conditions->conditionlist().clear();
+
+        vpz::ConditionList::const_iterator it;
+        for (it = cnds.begin(); it != cnds.end(); ++it) {
+            const vpz::ConditionValues& cnvsrc = it->second.conditionvalues();
+            vpz::Condition *dst = 0;
+
+            for (vpz::ConditionValues::const_iterator jt = cnvsrc.begin();
+                 jt != cnvsrc.end(); ++jt) {
                 if (jt->second->size() == 1) {
-                    cpy->add(jt->second->get(0)->clone());
-                } else if (jt->second->size() > 1 and jt->second->size() >
-                           index) {
-                    cpy->add(jt->second->get(index)->clone());
-                } else {
-                    throw utils::InternalError(fmt(
-                            _("ExperimentGenerator can not access to the index"
-                              " `%1%' of the condition `%2%' port `%3%' ")) %
-                        index % it->first % jt->first);
+                    continue;
                 }
 
-                delete cnvdst[jt->first];
-                cnvdst[jt->first] = cpy;
+                const value::Value& value(
+                    select(index, it->first, jt->first, *jt->second));
+
+                if (not dst) {
+                    dst = &conditions->conditionlist().insert(
+                        std::make_pair(it->first, vpz::Condition(it->first)))
+                        .first->second;
+                }
+
+                value::Set *cpy = new value::Set();
+                cpy->add(value.clone());
+                dst->conditionvalues()[jt->first] = cpy;
             }
         }
     }
+
+    /*
+     * Select the value of the index in the values of a port.
+     */
+    static const value::Value& select(uint32_t index,
+                                      const std::string& condition,
+                                      const std::string& port,
+                                      const value::Set& values)
+    {
+        if (values.size() == 1) {
+            return *values.get(0);
+        } else if (values.size() > 1 and values.size() > index) {
+            return *values.get(index);
+        }
+
+        throw utils::InternalError(fmt(
+                _("ExperimentGenerator can not access to the index"
+                  " `%1%' of the condition `%2%' port `%3%' ")) %
+            index % condition % port);
+    }
 };
 
 //
@@ -193,6 +235,12 @@ void ExperimentGenerator::get(uint32_t index, vpz::Conditions *conditions)
     mPimpl->get(index, conditions);
 }
 
+void ExperimentGenerator::getOverlay(uint32_t index,
+                                     vpz::Conditions *conditions)
+{
+    mPimpl->getOverlay(index, conditions);
+}
+
 uint32_t ExperimentGenerator::min() const
 {
     return mPimpl->mMin;
@@ -97,6 +97,18 @@ public:
      */
     void get(uint32_t index, vpz::Conditions *conditions);
 
+    /**
+     * Get the ports of the conditions which change with the index: the
+     * ports with more than one value.
+     *
+     * The @e conditions are an overlay of the conditions of the vpz, see
+     * @c manager::Simulation::run.
+     *
+     * @param[in] index The index in the experiment generator table.
+     * @param[out] conditions Conditions to fill with the changed ports.
+     */
+    void getOverlay(uint32_t index, vpz::Conditions *conditions);
+
     /**
      * The minimal index of experiences produce by the object.
      *
@@ -31,13 +31,21 @@
 #endif
 
 #include <vle/manager/Manager.hpp>
+#include <vle/manager/Checkpoint.hpp>
 #include <vle/manager/ExperimentGenerator.hpp>
 #include <vle/manager/Simulation.hpp>
+#include <vle/manager/ProcessPool.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Trace.hpp>
 #include <vle/vpz/Vpz.hpp>
 #include <vle/vpz/BaseModel.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <vector>
 
 namespace vle { namespace manager {
 
@@ -50,9 +58,8 @@ namespace vle { namespace manager {
  * @param name The base name of the experiment.
  * @param number The combination number.
  */
-static void setExperimentName(vpz::Vpz           *destination,
-                              const std::string&  name,
-                              uint32_t            number)
+static std::string experimentName(const std::string&  name,
+                                  uint32_t            number)
 {
     std::string result(name.size() + 12, '-');
 
@@ -60,11 +67,36 @@ static void setExperimentName(vpz::Vpz           *destination,
     result.replace(name.size() + 1, std::string::npos,
                    utils::to < uint32_t >(number));
 
-
-    destination->project().setInstance(number);
-    destination->project().experiment().setName(result);
+    return result;
 }
 
+/**
+ * Free the experimental frame given to the @c Manager and its model when
+ * the run ends or throws.
+ */
+class ExperimentOwner
+{
+public:
+    ExperimentOwner(vpz::Vpz *vpz)
+        : mVpz(vpz)
+    {
+    }
+
+    ~ExperimentOwner()
+    {
+        if (mVpz) {
+            delete mVpz->project().model().model();
+            delete mVpz;
+        }
+    }
+
+private:
+    ExperimentOwner(const ExperimentOwner&);
+    ExperimentOwner& operator=(const ExperimentOwner&);
+
+    vpz::Vpz *mVpz;
+};
+
 class Manager::Pimpl
 {
 public:
@@ -105,35 +137,111 @@ public:
         }
     }
 
+    /**
+     * The @c queue shares the combinations of the @c
+     * ExperimentGenerator between the @c worker threads. A @c worker
+     * claims a chunk of consecutive combinations at a time: the size of
+     * the chunks decreases with the number of remaining combinations
+     * (guided scheduling) so that the threads finish together even if
+     * the run times of the combinations differ.
+     */
+    class queue
+    {
+    public:
+        queue(const std::vector < uint32_t >& combinations,
+              uint32_t threads)
+            : mCombinations(combinations), mNext(0), mThreads(threads)
+        {
+        }
+
+        /**
+         * Claim the next chunk of combinations.
+         *
+         * @param[out] begin The position of the first combination of the
+         * chunk.
+         * @param[out] end The position after the last one.
+         *
+         * @return false if all the combinations are claimed.
+         */
+        bool claim(std::size_t *begin, std::size_t *end)
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            std::size_t size = mCombinations.size();
+
+            if (mNext >= size) {
+                return false;
+            }
+
+            std::size_t chunk = std::max(std::size_t(1),
+                                         (size - mNext) / (4 * mThreads));
+
+            *begin = mNext;
+            *end = mNext + chunk;
+            mNext = *end;
+
+            return true;
+        }
+
+        uint32_t combination(std::size_t position) const
+        {
+            return mCombinations[position];
+        }
+
+    private:
+        boost::mutex                     mMutex;
+        const std::vector < uint32_t >&  mCombinations;
+        std::size_t                      mNext;
+        uint32_t                         mThreads;
+    };
+
+    /**
+     * The @c usage of a @c worker thread: the number of combinations,
+     * the time spent to run them and the failed combinations.
+     */
+    struct usage
+    {
+        usage()
+            : combinations(0), busy(0.0)
+        {
+        }
+
+        uint32_t                         combinations;
+        double                           busy;
+        std::vector < CombinationError > failures;
+    };
+
     /**
      * The @c worker is a boost thread functor to execute threaded
-     * source code.
-     *
+     * source code. The results are stored in the slot of their
+     * combination and the errors in the @c usage of the @c worker: the
+     * @c worker threads do not share any data except the @c queue and
+     * the @c Checkpoint.
      */
     struct worker
     {
-        const vpz::Vpz       *vpz;
-        ExperimentGenerator  &expgen;
-        utils::ModuleManager &modulemgr;
-        LogOptions            mLogOption;
-        SimulationOptions     mSimulationOption;
-        uint32_t              index;
-        uint32_t              threads;
-        value::Matrix        *result;
-        Error                *error;
-
-        worker(const vpz::Vpz        *vpz,
-               ExperimentGenerator&   expgen,
-               utils::ModuleManager&  modulemgr,
-               LogOptions             logoptions,
-               SimulationOptions      simulationoptions,
-               uint32_t               index,
-               uint32_t               threads,
-               value::Matrix         *result,
-               Error                 *error)
+        const vpz::Vpz                *vpz;
+        ExperimentGenerator           &expgen;
+        utils::ModuleManager          &modulemgr;
+        LogOptions                     mLogOption;
+        SimulationOptions              mSimulationOption;
+        queue                         *combinations;
+        usage                         *stats;
+        std::vector < value::Map* >   *slots;
+        Checkpoint                    *checkpoint;
+
+        worker(const vpz::Vpz               *vpz,
+               ExperimentGenerator&          expgen,
+               utils::ModuleManager&         modulemgr,
+               LogOptions                    logoptions,
+               SimulationOptions             simulationoptions,
+               queue                        *combinations,
+               usage                        *stats,
+               std::vector < value::Map* >  *slots,
+               Checkpoint                   *checkpoint)
             : vpz(vpz), expgen(expgen), modulemgr(modulemgr),
               mLogOption(logoptions), mSimulationOption(simulationoptions),
-              index(index), threads(threads), result(result), error(error)
+              combinations(combinations), stats(stats), slots(slots),
+              checkpoint(checkpoint)
         {
         }
 
@@ -143,123 +251,289 @@ public:
 
         void operator()()
         {
-            std::string vpzname(vpz->project().experiment().name());
-
-            for (uint32_t i = expgen.min() + index; i < expgen.max();
-                 i += threads) {
-                Simulation sim(mLogOption, mSimulationOption, NULL);
-                Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
-
-                value::Map *simresult = sim.run(file, modulemgr, &err);
-
-                if (err.code) {
-                    // writeRunLog(err.message);
-
-                    if (not error->code) {
-                        error->code = -1;
-                        error->message = _("Manager failure.");
-                    }
-                } else {
-                    result->add(i, 0, simresult);
+            std::size_t begin, end;
+
+            while (combinations->claim(&begin, &end)) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    run(combinations->combination(i));
                 }
             }
         }
-    };
 
-    value::Matrix * runManagerThread(vpz::Vpz              *vpz,
-                                     utils::ModuleManager&  modulemgr,
-                                     uint32_t               threads,
-                                     uint32_t               rank,
-                                     uint32_t               world,
-                                     Error                 *error)
-    {
-        ExperimentGenerator expgen(*vpz, rank, world);
-        std::string vpzname(vpz->project().experiment().name());
-        boost::thread_group gp;
-        value::Matrix *result = new value::Matrix(expgen.size(), 1, expgen.size(), 1);
+        /**
+         * Run the simulation of the combination @e i, the task of the
+         * simulation processes.
+         */
+        value::Map * simulate(uint32_t i, Error *err)
+        {
+            Simulation sim(mLogOption, mSimulationOption, NULL);
+            vpz::Conditions overlay;
+            expgen.getOverlay(i, &overlay);
+
+            return sim.run(*vpz, overlay,
+                           experimentName(vpz->project().experiment().name(),
+                                          i),
+                           modulemgr, err);
+        }
 
-        for (uint32_t i = 0; i < threads; ++i) {
-            gp.create_thread(worker(vpz, expgen, modulemgr,
-                                    mLogOption, mSimulationOption,
-                                    i, threads, result, error));
+        void run(uint32_t i)
+        {
+            boost::posix_time::ptime start(
+                boost::posix_time::microsec_clock::universal_time());
+            Error err;
+
+            value::Map *simresult = simulate(i, &err);
+
+            double elapsed = (boost::posix_time::microsec_clock::
+                              universal_time() - start)
+                .total_microseconds() / 1e6;
+
+            stats->combinations++;
+            stats->busy += elapsed;
+
+            if (not err.code and checkpoint) {
+                try {
+                    checkpoint->write(i, simresult);
+                } catch (const std::exception& e) {
+                    err.code = -1;
+                    err.message = e.what();
+                }
+            }
+
+            if (err.code) {
+                delete simresult;
+                stats->failures.push_back(
+                    CombinationError(i, err.message, elapsed));
+            } else if (slots) {
+                (*slots)[i] = simresult;
+            } else {
+                delete simresult;
+            }
         }
+    };
 
-        gp.join_all();
+    /**
+     * Run the combinations of the experimental frame in @e processes
+     * simulation processes forked by a @c ProcessPool. The plug-ins of the
+     * dynamics are loaded before the fork to be shared by the processes.
+     * The parent writes the results into the @c Checkpoint.
+     */
+    void runProcesses(const vpz::Vpz                 *vpz,
+                      utils::ModuleManager&           modulemgr,
+                      SimulationOptions               options,
+                      uint32_t                        processes,
+                      ExperimentGenerator&            expgen,
+                      const std::vector < uint32_t >& combinations,
+                      std::vector < value::Map* >    *slots,
+                      Checkpoint                     *checkpoint,
+                      usage                          *stats)
+    {
+        const vpz::Dynamics& dynamics(vpz->project().dynamics());
+        for (vpz::Dynamics::const_iterator it = dynamics.begin();
+             it != dynamics.end(); ++it) {
+            try {
+                modulemgr.get(it->second.package(), it->second.library(),
+                              utils::MODULE_DYNAMICS);
+            } catch (const std::exception& /*e*/) {
+                // reported by the simulations of the combinations.
+            }
+        }
 
-         delete vpz->project().model().model();
-         delete vpz;
+        worker task(vpz, expgen, modulemgr, mLogOption,
+                    options & ~manager::SIMULATION_SPAWN_PROCESS,
+                    0, stats, slots, 0);
+
+        try {
+            ProcessPool pool(processes,
+                             boost::bind(&worker::simulate, &task, _1, _2));
+            pool.run(combinations, slots, &stats->failures,
+                     checkpoint ?
+                     boost::bind(&Checkpoint::write, checkpoint, _1, _2) :
+                     ProcessPool::Completion());
+
+            writeSummaryLog(fmt(_("Manager processes: %1% processes,"
+                                  " %2% restarted\n")) % processes %
+                            pool.restarts());
+        } catch (const std::exception& e) {
+            // the combinations without result or error did not end.
+            std::vector < CombinationError > ended(stats->failures);
+            std::sort(ended.begin(), ended.end());
+
+            for (std::size_t i = 0; i < combinations.size(); ++i) {
+                uint32_t index = combinations[i];
+
+                if ((not slots or not (*slots)[index]) and
+                    not std::binary_search(
+                        ended.begin(), ended.end(),
+                        CombinationError(index, std::string(), 0.0))) {
+                    stats->failures.push_back(
+                        CombinationError(index, e.what(), 0.0));
+                }
+            }
+        }
 
-         return result;
+        stats->combinations = combinations.size();
     }
 
-    value::Matrix * runManagerMono(vpz::Vpz             *vpz,
-                                   utils::ModuleManager &modulemgr,
-                                   uint32_t              rank,
-                                   uint32_t              world,
-                                   Error                *error)
+    /**
+     * Run the combinations of the experimental frame with @e threads
+     * threads (the calling thread if @e threads is 1) or @e threads
+     * processes with the @c SIMULATION_SPAWN_PROCESS option. The
+     * combinations completed in the @c Checkpoint are not run again.
+     *
+     * @param combinations The sorted indices of the combinations.
+     */
+    value::Matrix * runManager(vpz::Vpz                       *vpz,
+                               utils::ModuleManager&           modulemgr,
+                               uint32_t                        threads,
+                               ExperimentGenerator&            expgen,
+                               const std::vector < uint32_t >& combinations,
+                               Checkpoint                     *checkpoint,
+                               Error                          *error)
     {
-        Simulation sim(mLogOption, mSimulationOption, NULL);
-        ExperimentGenerator expgen(*vpz, rank, world);
-        std::string vpzname(vpz->project().experiment().name());
-        value::Matrix *result = 0;
+        std::vector < uint32_t > todo;
+        std::vector < usage > stats(threads);
+        std::vector < value::Map* > slots;
+        boost::posix_time::ptime start(
+            boost::posix_time::microsec_clock::universal_time());
 
         error->code = 0;
         error->message.clear();
+        error->combinations.clear();
 
-        if (mSimulationOption == manager::SIMULATION_NO_RETURN) {
-            for (uint32_t i = expgen.min(); i < expgen.max(); ++i) {
-                Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
+        if (not (mSimulationOption & manager::SIMULATION_NO_RETURN)) {
+            slots.resize(expgen.size(), 0);
+        }
 
-                sim.run(file, modulemgr, &err);
+        if (checkpoint) {
+            const std::vector < uint32_t >& completed(
+                checkpoint->completed());
 
-                if (err.code) {
-                    writeRunLog(err.message);
+            for (std::size_t i = 0; i < combinations.size(); ++i) {
+                uint32_t index = combinations[i];
 
-                    if (not error->code) {
-                        error->code = -1;
-                        error->message = _("Manager failure.");
-                    }
+                if (not std::binary_search(completed.begin(),
+                                           completed.end(), index)) {
+                    todo.push_back(index);
+                } else if (not slots.empty()) {
+                    slots[index] = checkpoint->release(index);
                 }
             }
+
+            writeSummaryLog(fmt(_("Manager checkpoint: %1% of %2%"
+                                  " combinations restored\n")) %
+                            (combinations.size() - todo.size()) %
+                            combinations.size());
         } else {
-            result = new value::Matrix(expgen.size(), 1, expgen.size(), 1);
+            todo = combinations;
+        }
+
+        /* The results are written into the checkpoint even if they are
+         * not returned. */
+        SimulationOptions options(mSimulationOption);
+        if (checkpoint) {
+            options &= ~manager::SIMULATION_NO_RETURN;
+        }
+
+        queue jobs(todo, threads);
 
-            for (uint32_t i = expgen.min(); i < expgen.max(); ++i) {
-                Error err;
-                vpz::Vpz *file = new vpz::Vpz(*vpz);
-                setExperimentName(file, vpzname, i);
-                expgen.get(i, &file->project().experiment().conditions());
+        if (mSimulationOption & manager::SIMULATION_SPAWN_PROCESS) {
+            runProcesses(vpz, modulemgr, options, threads, expgen, todo,
+                         slots.empty() ? 0 : &slots, checkpoint, &stats[0]);
+        } else if (threads == 1) {
+            worker(vpz, expgen, modulemgr, mLogOption, options,
+                   &jobs, &stats[0], slots.empty() ? 0 : &slots,
+                   checkpoint)();
+        } else {
+            boost::thread_group gp;
+
+            for (uint32_t i = 0; i < threads; ++i) {
+                gp.create_thread(worker(vpz, expgen, modulemgr,
+                                        mLogOption, options,
+                                        &jobs, &stats[i],
+                                        slots.empty() ? 0 : &slots,
+                                        checkpoint));
+            }
 
-                value::Map *simresult = sim.run(file, modulemgr, &err);
+            gp.join_all();
+        }
 
-                if (err.code) {
-                    writeRunLog(err.message);
+        double elapsed = (boost::posix_time::microsec_clock::universal_time()
+                          - start).total_microseconds() / 1e6;
 
-                    if (not error->code) {
-                        error->code = -1;
-                        error->message = _("Manager failure.");
-                    }
-                } else {
-                    result->add(i, 0, simresult);
+        value::Matrix *result = 0;
+        if (not (mSimulationOption & manager::SIMULATION_NO_RETURN)) {
+            result = new value::Matrix(expgen.size(), 1, expgen.size(), 1);
+
+            for (std::size_t i = 0; i < slots.size(); ++i) {
+                if (slots[i]) {
+                    result->add(i, 0, slots[i]);
                 }
             }
         }
 
-        delete vpz->project().model().model();
-        delete vpz;
+        for (uint32_t i = 0; i < threads; ++i) {
+            error->combinations.insert(error->combinations.end(),
+                                       stats[i].failures.begin(),
+                                       stats[i].failures.end());
+        }
+        std::sort(error->combinations.begin(), error->combinations.end());
+
+        for (std::size_t i = 0; i < error->combinations.size(); ++i) {
+            const CombinationError& failure(error->combinations[i]);
+
+            writeRunLog(fmt(_("Combination %1% failed after %2% s: %3%\n"))
+                        % failure.index % failure.elapsed % failure.message);
+        }
+
+        if (not error->combinations.empty()) {
+            error->code = -1;
+            error->message = (fmt(_("Manager failure: %1% of %2% "
+                                    "combinations failed.")) %
+                              error->combinations.size() %
+                              combinations.size()).str();
+        }
+
+        if (threads > 1 and
+            not (mSimulationOption & manager::SIMULATION_SPAWN_PROCESS)) {
+            for (uint32_t i = 0; i < threads; ++i) {
+                writeSummaryLog(
+                    fmt(_("Manager thread %1%: %2% combinations in %3% s"
+                          " (%4%%% of %5% s)\n")) % i %
+                    stats[i].combinations % stats[i].busy %
+                    (elapsed > 0.0 ? 100.0 * stats[i].busy / elapsed :
+                     100.0) % elapsed);
+            }
+        }
 
         return result;
     }
 
+    /**
+     * Open the results file of the experimental frame.
+     *
+     * @return The @c Checkpoint to freed or NULL without results file.
+     */
+    Checkpoint * openCheckpoint(const vpz::Vpz&             vpz,
+                                const ExperimentGenerator&  expgen,
+                                uint32_t                    rank,
+                                uint32_t                    world)
+    {
+        if (mCheckpoint.empty()) {
+            return 0;
+        }
+
+        return new Checkpoint(mCheckpoint,
+                              vpz.project().experiment(),
+                              expgen.size(), rank, world,
+                              not (mSimulationOption &
+                                   manager::SIMULATION_NO_RETURN));
+    }
+
     LogOptions            mLogOption;
     SimulationOptions     mSimulationOption;
     std::ostream         *mOutputStream;
+    std::string           mCheckpoint;
     uint32_t              mCurrentTime;
     uint32_t              mduration;
 };
@@ -276,6 +550,11 @@ Manager::~Manager()
     delete mPimpl;
 }
 
+void Manager::setCheckpoint(const std::string& filename)
+{
+    mPimpl->mCheckpoint = filename;
+}
+
 value::Matrix * Manager::run(vpz::Vpz             *exp,
                              utils::ModuleManager &modulemgr,
                              uint32_t              thread,
@@ -283,6 +562,7 @@ value::Matrix * Manager::run(vpz::Vpz             *exp,
                              uint32_t              world,
                              Error                *error)
 {
+    ExperimentOwner owner(exp);
     value::Matrix *result = 0;
 
     if (thread <= 0) {
@@ -305,13 +585,60 @@ value::Matrix * Manager::run(vpz::Vpz             *exp,
 
     mPimpl->writeSummaryLog(_("Manager started"));
 
-    if (thread > 1) {
-        result = mPimpl->runManagerThread(exp, modulemgr, thread, rank,
-                                          world, error);
-    } else {
-        result = mPimpl->runManagerMono(exp, modulemgr, rank, world, error);
+    ExperimentGenerator expgen(*exp, rank, world);
+    std::vector < uint32_t > combinations;
+
+    for (uint32_t i = expgen.min(); i < expgen.max(); ++i) {
+        combinations.push_back(i);
     }
 
+    boost::scoped_ptr < Checkpoint > checkpoint(
+        mPimpl->openCheckpoint(*exp, expgen, rank, world));
+
+    result = mPimpl->runManager(exp, modulemgr, thread, expgen,
+                                combinations, checkpoint.get(), error);
+
+    mPimpl->writeSummaryLog(_("Manager ended"));
+
+    return result;
+}
+
+value::Matrix * Manager::run(vpz::Vpz                       *exp,
+                             utils::ModuleManager           &modulemgr,
+                             uint32_t                        thread,
+                             const std::vector < uint32_t > &combinations,
+                             Error                          *error)
+{
+    ExperimentOwner owner(exp);
+    value::Matrix *result = 0;
+
+    if (thread <= 0) {
+        throw vle::utils::ArgError(
+            fmt(_("Manager error: thread must be superior to 0 (%1%)"))
+            % thread);
+    }
+
+    ExperimentGenerator expgen(*exp, 0, 1);
+    std::vector < uint32_t > sorted(combinations);
+
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    if (not sorted.empty() and sorted.back() >= expgen.size()) {
+        throw vle::utils::ArgError(
+            fmt(_("Manager error: combination %1% must be inferior"
+                  " to the size of the experimental frame (%2%)"))
+            % sorted.back() % expgen.size());
+    }
+
+    mPimpl->writeSummaryLog(_("Manager started"));
+
+    boost::scoped_ptr < Checkpoint > checkpoint(
+        mPimpl->openCheckpoint(*exp, expgen, 0, 1));
+
+    result = mPimpl->runManager(exp, modulemgr, thread, expgen, sorted,
+                                checkpoint.get(), error);
+
     mPimpl->writeSummaryLog(_("Manager ended"));
 
     return result;
@@ -42,8 +42,19 @@ namespace vle { namespace manager {
  * replicas and the columns are combination index from the @c
  * manager::ExperimentGenerator. A cell of the @c value::Matrix is a
  * @c value::Map.  The key is the name of the @c devs::View and the
- * value is a @c value::Matrix or NULL if the @c value::Matrix is
- * empty.
+ * value is a @c value::ColumnMatrix for the plug-ins which manage it
+ * (the numeric cells are stored by columns without a value::Value by
+ * cell), a @c value::Matrix or NULL if the @c value::Matrix is empty.
+ * The cell of a failed combination is NULL and the combination is
+ * reported in the @c Error::combinations list.
+ *
+ * With the @c SIMULATION_SPAWN_PROCESS option, the combinations run in
+ * simulation processes instead of threads: the plug-ins do not need to be
+ * thread-safe and the crash of a simulation fails its combination only.
+ *
+ * With a results file (see @c setCheckpoint), the results of the completed
+ * combinations are saved as they end: a run stopped before its end is
+ * resumed by running the same experimental frame with the same file.
  *
  * @attention You are in charge to freed the manager result @c
  * value::Matrix.
@@ -59,11 +70,30 @@ public:
 
     ~Manager();
 
+    /**
+     * Assign the results file of the next runs. The results of the
+     * completed combinations are appended to the file, keyed by their
+     * index in the @c manager::ExperimentGenerator, and the combinations
+     * already in the file are not run again: their results are read from
+     * the file. Each part of an experimental frame split by rank and world
+     * needs its own file: the file records the rank, the world and a
+     * fingerprint of the conditions of the experiment.
+     *
+     * @param filename The name of the file, empty to run without results
+     * file.
+     *
+     * @throw utils::FileError or utils::ArgError from the next run if
+     * the file can not be used or belongs to another experimental frame,
+     * another part or other conditions.
+     */
+    void setCheckpoint(const std::string& filename);
+
     /**
      * Run an part or a complete experimental frames with mono thread
      * or multi-thread.
      *
-     * @param exp
+     * @param exp The experimental frame, the manager takes the ownership
+     * of @e exp and of its model and frees them even if it throws.
      * @param modulemgr
      * @param thread
      * @param rank
@@ -84,6 +114,29 @@ public:
                         uint32_t              world,
                         Error                *error);
 
+    /**
+     * Run some combinations of the experimental frames, for example the
+     * failed combinations of a previous run reported in the @c
+     * Error::combinations list.
+     *
+     * @param exp The experimental frame, the manager takes the ownership
+     * of @e exp and of its model and frees them even if it throws.
+     * @param modulemgr
+     * @param thread
+     * @param combinations The indices of the combinations in the @c
+     * manager::ExperimentGenerator of the complete experimental frame.
+     *
+     * @return A @c value::Matrix to freed with a column by combination
+     * of the experimental frame, the cells of the other combinations are
+     * NULL.
+     * @throw utils::ArgError if a combination does not exist.
+     */
+    value::Matrix * run(vpz::Vpz                       *exp,
+                        utils::ModuleManager           &modulemgr,
+                        uint32_t                        thread,
+                        const std::vector < uint32_t > &combinations,
+                        Error                          *error);
+
 private:
     Manager(const Manager& other);
     Manager& operator=(const Manager& other);
@@ -0,0 +1,505 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ProcessPool.hpp>
+#include <vle/manager/ValueCodec.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <cstdio>
+#include <iostream>
+
+#ifndef _WIN32
+# include <cerrno>
+# include <csignal>
+# include <cstring>
+# include <poll.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+namespace vle { namespace manager {
+
+#ifndef _WIN32
+
+/*
+ * Read or write @e size bytes, retry on the interruptions and on the
+ * partial transfers of the pipes.
+ */
+static bool readAll(int fd, void *buffer, std::size_t size)
+{
+    char *data = static_cast < char* >(buffer);
+
+    while (size > 0) {
+        ssize_t r = ::read(fd, data, size);
+        if (r < 0 and errno == EINTR) {
+            continue;
+        } else if (r <= 0) {
+            return false;
+        }
+        data += r;
+        size -= r;
+    }
+
+    return true;
+}
+
+static bool writeAll(int fd, const void *buffer, std::size_t size)
+{
+    const char *data = static_cast < const char* >(buffer);
+
+    while (size > 0) {
+        ssize_t r = ::write(fd, data, size);
+        if (r < 0 and errno == EINTR) {
+            continue;
+        } else if (r <= 0) {
+            return false;
+        }
+        data += r;
+        size -= r;
+    }
+
+    return true;
+}
+
+/*
+ * The header of a message of a worker: the index of the combination, the
+ * error code and the size of the message, followed by the error message if
+ * the code is not zero or by the encoded result.
+ */
+struct Header
+{
+    uint32_t index;
+    int32_t  code;
+    uint32_t size;
+};
+
+class ProcessPool::Pimpl
+{
+public:
+    struct worker
+    {
+        worker()
+            : pid(-1), jobs(-1), results(-1), busy(false), index(0)
+        {
+        }
+
+        pid_t                    pid;
+        int                      jobs; /* write the indexes. */
+        int                      results; /* read the results. */
+        bool                     busy;
+        uint32_t                 index;
+        boost::posix_time::ptime start;
+    };
+
+    Pimpl(uint32_t processes, const Task& task)
+        : mTask(task), mWorkers(processes), mRestarts(0)
+    {
+    }
+
+    ~Pimpl()
+    {
+        for (std::size_t i = 0; i < mWorkers.size(); ++i) {
+            stop(i);
+        }
+    }
+
+    /**
+     * Fork the worker @e i, the child never returns.
+     */
+    void start(std::size_t i)
+    {
+        int jobs[2], results[2];
+
+        if (::pipe(jobs)) {
+            throw utils::InternalError(fmt(
+                    _("Process pool: can not create a pipe: %1%")) %
+                std::strerror(errno));
+        }
+
+        if (::pipe(results)) {
+            ::close(jobs[0]);
+            ::close(jobs[1]);
+            throw utils::InternalError(fmt(
+                    _("Process pool: can not create a pipe: %1%")) %
+                std::strerror(errno));
+        }
+
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(0);
+
+        pid_t pid = ::fork();
+
+        if (pid < 0) {
+            ::close(jobs[0]);
+            ::close(jobs[1]);
+            ::close(results[0]);
+            ::close(results[1]);
+            throw utils::InternalError(fmt(
+                    _("Process pool: can not fork a worker: %1%")) %
+                std::strerror(errno));
+        }
+
+        if (pid == 0) {
+            ::close(jobs[1]);
+            ::close(results[0]);
+
+            /* The pipes of the other workers must only be open in the
+             * parent to report their end of file. */
+            for (std::size_t j = 0; j < mWorkers.size(); ++j) {
+                if (j != i and mWorkers[j].pid > 0) {
+                    ::close(mWorkers[j].jobs);
+                    ::close(mWorkers[j].results);
+                }
+            }
+
+            serve(jobs[0], results[1]);
+        }
+
+        ::close(jobs[0]);
+        ::close(results[1]);
+
+        mWorkers[i].pid = pid;
+        mWorkers[i].jobs = jobs[1];
+        mWorkers[i].results = results[0];
+        mWorkers[i].busy = false;
+    }
+
+    /**
+     * Close the pipes of the worker @e i and wait for its end.
+     *
+     * @return The status of the worker.
+     */
+    int stop(std::size_t i)
+    {
+        worker& w(mWorkers[i]);
+        int status = 0;
+
+        if (w.pid > 0) {
+            ::close(w.jobs);
+            ::close(w.results);
+            while (::waitpid(w.pid, &status, 0) < 0 and errno == EINTR) {
+            }
+            w.pid = -1;
+        }
+
+        return status;
+    }
+
+    /**
+     * The loop of a worker: read an index, run the task and write the
+     * result until the end of file of the pipe of the indexes.
+     */
+    void serve(int in, int out)
+    {
+        uint32_t index;
+
+        while (readAll(in, &index, sizeof(index))) {
+            Error error;
+            value::Map *result = 0;
+            std::string message;
+
+            try {
+                error.code = 0;
+                result = mTask(index, &error);
+                if (not error.code) {
+                    encodeValue(result, &message);
+                }
+            } catch (const std::exception& e) {
+                error.code = -1;
+                error.message = e.what();
+            }
+            delete result;
+
+            if (error.code) {
+                message = error.message;
+            }
+
+            Header header = { index, error.code,
+                static_cast < uint32_t >(message.size()) };
+
+            if (not writeAll(out, &header, sizeof(header)) or
+                not writeAll(out, message.data(), message.size())) {
+                break;
+            }
+        }
+
+        ::_exit(0);
+    }
+
+    /**
+     * Write the index of the combination into the pipe of the worker
+     * @e i, fork it again if it died before.
+     */
+    void dispatch(std::size_t i, uint32_t index,
+                  std::vector < CombinationError > *failures)
+    {
+        worker& w(mWorkers[i]);
+
+        w.busy = true;
+        w.index = index;
+        w.start = boost::posix_time::microsec_clock::universal_time();
+
+        if (not writeAll(w.jobs, &index, sizeof(index))) {
+            /* The worker died while it was idle. */
+            w.busy = false;
+            crashed(i, failures);
+            w.busy = true;
+
+            if (not writeAll(w.jobs, &index, sizeof(index))) {
+                crashed(i, failures);
+            }
+        }
+    }
+
+    /**
+     * Read the message of the worker @e i.
+     */
+    void receive(std::size_t i, std::vector < value::Map* > *slots,
+                 std::vector < CombinationError > *failures,
+                 const Completion& completion)
+    {
+        worker& w(mWorkers[i]);
+        Header header;
+
+        if (not readAll(w.results, &header, sizeof(header))) {
+            crashed(i, failures);
+            return;
+        }
+
+        std::string message(header.size, '\0');
+        if (header.size > 0 and
+            not readAll(w.results, &message[0], header.size)) {
+            crashed(i, failures);
+            return;
+        }
+
+        w.busy = false;
+
+        if (header.code) {
+            failures->push_back(CombinationError(header.index, message,
+                                                 elapsed(w)));
+            return;
+        }
+
+        try {
+            const char *begin = message.data();
+            value::Value *result = decodeValue(&begin, begin + message.size());
+
+            if (result and not result->isMap()) {
+                delete result;
+                throw utils::InternalError(
+                    _("Process pool: the result is not a map"));
+            }
+
+            if (completion) {
+                try {
+                    completion(header.index,
+                               static_cast < value::Map* >(result));
+                } catch (...) {
+                    delete result;
+                    throw;
+                }
+            }
+
+            if (slots) {
+                (*slots)[header.index] = static_cast < value::Map* >(result);
+            } else {
+                delete result;
+            }
+        } catch (const std::exception& e) {
+            failures->push_back(CombinationError(header.index, e.what(),
+                                                 elapsed(w)));
+        }
+    }
+
+    /**
+     * Wait for the worker @e i which closed its pipe, report its
+     * combination and fork it again.
+     */
+    void crashed(std::size_t i, std::vector < CombinationError > *failures)
+    {
+        worker& w(mWorkers[i]);
+        pid_t pid = w.pid;
+        int status = stop(i);
+
+        if (w.busy) {
+            std::string message;
+
+            if (WIFSIGNALED(status)) {
+                message = (fmt(_("The simulation process %1% was killed by"
+                                 " the signal %2%")) % pid %
+                           WTERMSIG(status)).str();
+            } else {
+                message = (fmt(_("The simulation process %1% exited with"
+                                 " the code %2%")) % pid %
+                           WEXITSTATUS(status)).str();
+            }
+
+            failures->push_back(CombinationError(w.index, message,
+                                                 elapsed(w)));
+            w.busy = false;
+        }
+
+        ++mRestarts;
+        start(i);
+    }
+
+    double elapsed(const worker& w) const
+    {
+        return (boost::posix_time::microsec_clock::universal_time() -
+                w.start).total_microseconds() / 1e6;
+    }
+
+    void run(const std::vector < uint32_t >& combinations,
+             std::vector < value::Map* > *slots,
+             std::vector < CombinationError > *failures,
+             const Completion& completion)
+    {
+        /* A worker which dies closes its pipe: the writes fail with
+         * EPIPE instead of killing the parent. */
+        void (*previous)(int) = std::signal(SIGPIPE, SIG_IGN);
+        std::size_t next = 0;
+
+        try {
+            for (;;) {
+                for (std::size_t i = 0; i < mWorkers.size() and
+                         next < combinations.size(); ++i) {
+                    if (not mWorkers[i].busy) {
+                        dispatch(i, combinations[next++], failures);
+                    }
+                }
+
+                std::vector < pollfd > fds;
+                std::vector < std::size_t > busy;
+                for (std::size_t i = 0; i < mWorkers.size(); ++i) {
+                    if (mWorkers[i].busy) {
+                        pollfd fd = { mWorkers[i].results, POLLIN, 0 };
+                        fds.push_back(fd);
+                        busy.push_back(i);
+                    }
+                }
+
+                if (fds.empty()) {
+                    break;
+                }
+
+                if (::poll(&fds[0], fds.size(), -1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw utils::InternalError(fmt(
+                            _("Process pool: can not wait for the"
+                              " workers: %1%")) % std::strerror(errno));
+                }
+
+                for (std::size_t j = 0; j < fds.size(); ++j) {
+                    if (fds[j].revents) {
+                        receive(busy[j], slots, failures, completion);
+                    }
+                }
+            }
+        } catch (...) {
+            std::signal(SIGPIPE, previous);
+            throw;
+        }
+
+        std::signal(SIGPIPE, previous);
+    }
+
+    Task                  mTask;
+    std::vector < worker > mWorkers;
+    uint32_t              mRestarts;
+};
+
+ProcessPool::ProcessPool(uint32_t processes, const Task& task)
+    : mPimpl(new ProcessPool::Pimpl(processes, task))
+{
+    try {
+        for (uint32_t i = 0; i < processes; ++i) {
+            mPimpl->start(i);
+        }
+    } catch (...) {
+        delete mPimpl;
+        throw;
+    }
+}
+
+ProcessPool::~ProcessPool()
+{
+    delete mPimpl;
+}
+
+void ProcessPool::run(const std::vector < uint32_t >& combinations,
+                      std::vector < value::Map* > *slots,
+                      std::vector < CombinationError > *failures,
+                      const Completion& completion)
+{
+    mPimpl->run(combinations, slots, failures, completion);
+}
+
+uint32_t ProcessPool::restarts() const
+{
+    return mPimpl->mRestarts;
+}
+
+#else
+
+class ProcessPool::Pimpl
+{
+};
+
+ProcessPool::ProcessPool(uint32_t /* processes */, const Task& /* task */)
+    : mPimpl(0)
+{
+    throw utils::NotYetImplemented(
+        _("Process pool: SIMULATION_SPAWN_PROCESS is not available on"
+          " Win32"));
+}
+
+ProcessPool::~ProcessPool()
+{
+}
+
+void ProcessPool::run(const std::vector < uint32_t >& /* combinations */,
+                      std::vector < value::Map* > * /* slots */,
+                      std::vector < CombinationError > * /* failures */,
+                      const Completion& /* completion */)
+{
+}
+
+uint32_t ProcessPool::restarts() const
+{
+    return 0;
+}
+
+#endif
+
+}} // namespace vle manager
@@ -0,0 +1,121 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_PROCESSPOOL_HPP
+#define VLE_MANAGER_PROCESSPOOL_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/manager/Types.hpp>
+#include <vle/value/Map.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace vle { namespace manager {
+
+/**
+ * The @c ProcessPool runs the combinations of an experimental frame in
+ * worker processes forked from the calling process: the plug-ins which are
+ * not thread-safe run in parallel and a plug-in which crashes does not
+ * stop the experimental frame.
+ *
+ * The workers inherit the memory of the parent: the vpz, the @c
+ * ExperimentGenerator and the @c utils::ModuleManager with its loaded
+ * plug-ins. The parent writes the index of a combination into the pipe of
+ * an idle worker and reads back the error message or the result encoded by
+ * @c encodeValue. A worker which dies is forked again and its combination
+ * is reported as failed.
+ *
+ * @code
+ * ProcessPool pool(4, boost::bind(&simulate, _1, _2));
+ * pool.run(combinations, &slots, &failures);
+ * @endcode
+ */
+class VLE_API ProcessPool : boost::noncopyable
+{
+public:
+    /**
+     * The task run by the workers: it runs the combination of the index,
+     * assigns the error and returns the result or NULL.
+     */
+    typedef boost::function < value::Map * (uint32_t, Error*) > Task;
+
+    /**
+     * The function called by the parent with the result of each completed
+     * combination, before the result is stored in its slot. An exception
+     * fails the combination.
+     */
+    typedef boost::function < void (uint32_t, const value::Map*) >
+        Completion;
+
+    /**
+     * Fork the workers.
+     *
+     * @param processes The number of workers.
+     * @param task The task of the workers.
+     *
+     * @throw utils::InternalError if a pipe or a process can not be
+     * created.
+     * @throw utils::NotYetImplemented on Win32.
+     */
+    ProcessPool(uint32_t processes, const Task& task);
+
+    /**
+     * Close the pipes and wait for the end of the workers.
+     */
+    ~ProcessPool();
+
+    /**
+     * Run the combinations.
+     *
+     * @param combinations The indexes of the combinations.
+     * @param[out] slots The results indexed by combination, NULL to
+     * delete them.
+     * @param[out] failures The failed combinations, in the order of their
+     * end.
+     * @param completion The function called with the completed
+     * combinations, empty to ignore them.
+     */
+    void run(const std::vector < uint32_t >& combinations,
+             std::vector < value::Map* > *slots,
+             std::vector < CombinationError > *failures,
+             const Completion& completion = Completion());
+
+    /**
+     * @return The number of workers forked again since the construction.
+     */
+    uint32_t restarts() const;
+
+private:
+    class Pimpl;
+    Pimpl *mPimpl;
+};
+
+}} // namespace vle manager
+
+#endif
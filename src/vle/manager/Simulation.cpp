@@ -30,9 +30,12 @@
 #include <vle/utils/Tools.hpp>
 #include <vle/utils/Trace.hpp>
 #include <vle/devs/RootCoordinator.hpp>
+#include <vle/vpz/BaseModel.hpp>
 #include <vle/manager/Simulation.hpp>
+#include <vle/manager/ProcessPool.hpp>
 #include <boost/timer.hpp>
 #include <boost/progress.hpp>
+#include <boost/bind.hpp>
 
 namespace vle { namespace manager {
 
@@ -50,16 +53,43 @@ public:
           m_logoptions(logoptions),
           m_simulationoptions(simulationoptionts)
     {
-        if (m_simulationoptions & manager::SIMULATION_SPAWN_PROCESS)
-            TraceAlways(
-                _("Simulation: SIMULATION_SPAWN_PROCESS is not yet"
-                    " implemented"));
     }
 
     ~Pimpl()
     {
     }
 
+    /*
+     * The simulation to load: a vpz deleted once loaded or a combination
+     * of a vpz shared with the other combinations.
+     */
+    struct Source
+    {
+        const vpz::Vpz        *vpz;
+        vpz::Vpz              *owned;   /* NULL if the vpz is shared. */
+        const vpz::Conditions *overlay;
+        const std::string     *name;
+
+        void load(devs::RootCoordinator& root)
+        {
+            if (owned) {
+                root.load(*owned);
+            } else {
+                root.load(*vpz, *overlay, *name);
+            }
+        }
+
+        void clear()
+        {
+            if (owned) {
+                owned->clear();
+                delete owned;
+                owned = 0;
+            }
+            vpz = 0;
+        }
+    };
+
     template <typename T>
     void write(const T& t)
     {
@@ -70,7 +100,7 @@ public:
         }
     }
 
-    value::Map * runVerboseRun(vpz::Vpz                   *vpz,
+    value::Map * runVerboseRun(Source                      src,
                                const utils::ModuleManager &modulemgr,
                                Error                      *error)
     {
@@ -80,19 +110,19 @@ public:
         try {
             devs::RootCoordinator root(modulemgr);
 
-            const double duration = vpz->project().experiment().duration();
-            const double begin    = vpz->project().experiment().begin();
+            const vpz::Experiment& exp(src.vpz->project().experiment());
+            const double duration = exp.duration();
+            const double begin    = exp.begin();
 
-            write(fmt(_("[%1%]\n")) % vpz->filename());
+            write(fmt(_("[%1%]\n")) % src.vpz->filename());
             write(_(" - Coordinator load models ......: "));
 
-            root.load(*vpz);
+            src.load(root);
 
             write(_("ok\n"));
 
             write(_(" - Clean project file ...........: "));
-            vpz->clear();
-            delete vpz;
+            src.clear();
             write(_("ok\n"));
 
             write(_(" - Coordinator initializing .....: "));
@@ -134,7 +164,7 @@ public:
         return result;
     }
 
-    value::Map * runVerboseSummary(vpz::Vpz                   *vpz,
+    value::Map * runVerboseSummary(Source                      src,
                                    const utils::ModuleManager &modulemgr,
                                    Error                      *error)
     {
@@ -144,16 +174,15 @@ public:
         try {
             devs::RootCoordinator root(modulemgr);
 
-            write(fmt(_("[%1%]\n")) % vpz->filename());
+            write(fmt(_("[%1%]\n")) % src.vpz->filename());
             write(_(" - Coordinator load models ......: "));
 
-            root.load(*vpz);
+            src.load(root);
 
             write(_("ok\n"));
 
             write(_(" - Clean project file ...........: "));
-            vpz->clear();
-            delete vpz;
+            src.clear();
             write(_("ok\n"));
 
             write(_(" - Coordinator initializing .....: "));
@@ -185,7 +214,7 @@ public:
         return result;
     }
 
-    value::Map * runQuiet(vpz::Vpz                   *vpz,
+    value::Map * runQuiet(Source                      src,
                           const utils::ModuleManager &modulemgr,
                           Error                      *error)
     {
@@ -193,9 +222,8 @@ public:
 
         try {
             devs::RootCoordinator root(modulemgr);
-            root.load(*vpz);
-            vpz->clear();
-            delete vpz;
+            src.load(root);
+            src.clear();
 
             root.init();
             while (root.run()) {}
@@ -213,6 +241,86 @@ public:
         return result;
     }
 
+    value::Map * runLocal(Source                      src,
+                          const utils::ModuleManager &modulemgr,
+                          Error                      *error)
+    {
+        if (m_logoptions != manager::LOG_NONE) {
+            if (m_logoptions & manager::LOG_RUN and m_out) {
+                return runVerboseRun(src, modulemgr, error);
+            } else {
+                return runVerboseSummary(src, modulemgr, error);
+            }
+        }
+
+        return runQuiet(src, modulemgr, error);
+    }
+
+    /*
+     * The task of the simulation process: the output stream is flushed
+     * before the process ends.
+     */
+    value::Map * runTask(const Source               *src,
+                         const utils::ModuleManager *modulemgr,
+                         Error                      *error)
+    {
+        value::Map *result = runLocal(*src, *modulemgr, error);
+
+        if (m_out) {
+            m_out->flush();
+        }
+
+        return result;
+    }
+
+    value::Map * runSpawn(Source                      src,
+                          const utils::ModuleManager &modulemgr,
+                          Error                      *error)
+    {
+        std::vector < value::Map* > slots(1, static_cast < value::Map* >(0));
+        std::vector < CombinationError > failures;
+
+        try {
+            ProcessPool pool(1, boost::bind(&Pimpl::runTask, this, &src,
+                                            &modulemgr, _2));
+            pool.run(std::vector < uint32_t >(1, 0), &slots, &failures);
+        } catch (const std::exception& e) {
+            failures.push_back(CombinationError(0, e.what(), 0.0));
+        }
+
+        if (src.owned) {
+            delete src.owned->project().model().model();
+            src.clear();
+        }
+
+        if (not failures.empty()) {
+            error->code = -1;
+            error->message = failures.front().message;
+        }
+
+        return slots.front();
+    }
+
+    value::Map * run(Source                      src,
+                     const utils::ModuleManager &modulemgr,
+                     Error                      *error)
+    {
+        error->code = 0;
+        value::Map *result = NULL;
+
+        if (m_simulationoptions & manager::SIMULATION_SPAWN_PROCESS) {
+            result = runSpawn(src, modulemgr, error);
+        } else {
+            result = runLocal(src, modulemgr, error);
+        }
+
+        if (m_simulationoptions & manager::SIMULATION_NO_RETURN) {
+            delete result;
+            return NULL;
+        } else {
+            return result;
+        }
+    }
 };
 
 Simulation::Simulation(LogOptions         logoptions,
@@ -231,26 +339,20 @@ value::Map * Simulation::run(vpz::Vpz                   *vpz,
                              const utils::ModuleManager &modulemgr,
                              Error                      *error)
 {
-    error->code = 0;
-    value::Map *result = NULL;
+    Pimpl::Source src = { vpz, vpz, NULL, NULL };
 
-    if (mPimpl->m_logoptions != manager::LOG_NONE) {
-        if (mPimpl->m_logoptions & manager::LOG_RUN and mPimpl->m_out) {
-            result = mPimpl->runVerboseRun(vpz, modulemgr, error);
-        } else {
-            result = mPimpl->runVerboseSummary(vpz, modulemgr, error);
-        }
+    return mPimpl->run(src, modulemgr, error);
+}
 
-    } else {
-        result = mPimpl->runQuiet(vpz, modulemgr, error);
-    }
+value::Map * Simulation::run(const vpz::Vpz             &vpz,
+                             const vpz::Conditions      &overlay,
+                             const std::string          &name,
+                             const utils::ModuleManager &modulemgr,
+                             Error                      *error)
+{
+    Pimpl::Source src = { &vpz, NULL, &overlay, &name };
 
-    if (mPimpl->m_simulationoptions & manager::SIMULATION_NO_RETURN) {
-        delete result;
-        return NULL;
-    } else {
-        return result;
-    }
+    return mPimpl->run(src, modulemgr, error);
 }
 
 }}
@@ -39,8 +39,9 @@ namespace vle { namespace manager {
  * @c manager::Simulation permits to run single simulation.
  *
  * The @c manager::Simulation returns a @c value::Map. The key is the
- * name of the @c devs::View and the value is a @c value::Matrix or
- * NULL if the @c value::Matrix is empty.
+ * name of the @c devs::View and the value is a @c value::ColumnMatrix
+ * for the plug-ins which manage it, a @c value::Matrix or NULL if the @c
+ * value::Matrix is empty.
  *
  * @attention You are in charge to freed the simulation result @c
  * value::Map.
@@ -60,6 +61,23 @@ public:
                      const utils::ModuleManager &modulemgr,
                      Error                      *error);
 
+    /**
+     * Run a combination of an experimental frame without copying the @e
+     * vpz: only the hierarchy of models is cloned, the dynamics, the
+     * classes and the experiment are shared with the other combinations
+     * and copied only if an executive modifies them.
+     *
+     * @param vpz The shared vpz, it is not freed.
+     * @param overlay The ports of the conditions of the combination, they
+     * replace the ports of the experiment conditions.
+     * @param name The name of the experiment of the combination.
+     */
+    value::Map * run(const vpz::Vpz             &vpz,
+                     const vpz::Conditions      &overlay,
+                     const std::string          &name,
+                     const utils::ModuleManager &modulemgr,
+                     Error                      *error);
+
 private:
     Simulation(const Simulation &other);
     Simulation& operator=(const Simulation &other);
@@ -28,10 +28,41 @@
 #ifndef VLE_MANAGER_TYPES_HPP
 #define VLE_MANAGER_TYPES_HPP
 
+#include <vle/utils/Types.hpp>
 #include <string>
+#include <vector>
 
 namespace vle { namespace manager  {
 
+/**
+ * The @c vle::manager::CombinationError reports the failure of a
+ * combination of an experimental frame: the index of the combination in
+ * the @c vle::manager::ExperimentGenerator, the message throws by the
+ * simulation and the time spent in the simulation (in seconds).
+ */
+struct CombinationError
+{
+    CombinationError()
+        : index(0), elapsed(0.0)
+    {
+    }
+
+    CombinationError(uint32_t index, const std::string& message,
+                     double elapsed)
+        : index(index), message(message), elapsed(elapsed)
+    {
+    }
+
+    bool operator<(const CombinationError& other) const
+    {
+        return index < other.index;
+    }
+
+    uint32_t    index;
+    std::string message;
+    double      elapsed;
+};
+
 /**
  * The @c vle::manager::Error structure permits to report error.
  *
@@ -42,7 +73,9 @@ namespace vle { namespace manager  {
  *
  * The @c vle::manager::Error is a structure with an error code (an
  * integer different to 0 to indicate error) and string to store the
- * message throws by the simulation or the experimental frames.
+ * message throws by the simulation or the experimental frames. The
+ * @c vle::manager::Manager reports the failed combinations, sorted by
+ * index, in the @c combinations list to run them again.
  */
 struct Error
 {
@@ -57,16 +90,18 @@ struct Error
     }
 
     Error(const Error &error)
-    : code(error.code), message(error.message)
+    : code(error.code), message(error.message),
+      combinations(error.combinations)
     {
     }
 
     Error& operator=(const Error &other)
     {
-        Error tmp(other.code, other.message);
+        Error tmp(other);
 
         std::swap(code, tmp.code);
         std::swap(message, tmp.message);
+        combinations.swap(tmp.combinations);
 
         return *this;
     }
@@ -77,6 +112,7 @@ struct Error
 
     int code;
     std::string message;
+    std::vector < CombinationError > combinations;
 };
 
 /**
@@ -98,7 +134,8 @@ enum LogOptions {
 enum SimulationOptions {
     SIMULATION_NONE          = 0, /**< Default option. */
     SIMULATION_SPAWN_PROCESS = 1 << 0, /**< Launch the simulation in a
-                                        * subprocess.  */
+                                        * subprocess (not available on
+                                        * Win32).  */
     SIMULATION_NO_RETURN     = 1 << 1 /**< The simulation result are empty. */
 };
 
@@ -0,0 +1,381 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/manager/ValueCodec.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/ColumnMatrix.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/Matrix.hpp>
+#include <vle/value/Null.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/value/String.hpp>
+#include <vle/value/Table.hpp>
+#include <vle/value/Tuple.hpp>
+#include <vle/value/XML.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/cstdint.hpp>
+#include <cstring>
+
+namespace vle { namespace manager {
+
+/*
+ * The type of a NULL value, the other types are value::Value::type.
+ */
+static const unsigned char NULL_VALUE = 0xff;
+
+template < typename T >
+static void put(const T& x, std::string *out)
+{
+    out->append(reinterpret_cast < const char* >(&x), sizeof(T));
+}
+
+static void putString(const std::string& str, std::string *out)
+{
+    put(static_cast < boost::uint32_t >(str.size()), out);
+    out->append(str);
+}
+
+template < typename T >
+static T get(const char **begin, const char *end)
+{
+    if (static_cast < std::size_t >(end - *begin) < sizeof(T)) {
+        throw utils::InternalError(_("Value decoding: truncated buffer"));
+    }
+
+    T x;
+    std::memcpy(&x, *begin, sizeof(T));
+    *begin += sizeof(T);
+    return x;
+}
+
+static std::string getString(const char **begin, const char *end)
+{
+    boost::uint32_t size = get < boost::uint32_t >(begin, end);
+
+    if (static_cast < std::size_t >(end - *begin) < size) {
+        throw utils::InternalError(_("Value decoding: truncated buffer"));
+    }
+
+    std::string str(*begin, size);
+    *begin += size;
+    return str;
+}
+
+static void encodeColumnMatrix(const value::ColumnMatrix& matrix,
+                               std::string *out)
+{
+    put(static_cast < boost::uint32_t >(matrix.columns()), out);
+    put(static_cast < boost::uint64_t >(matrix.rows()), out);
+
+    for (value::ColumnMatrix::size_type c = 0; c < matrix.columns(); ++c) {
+        put(static_cast < unsigned char >(matrix.type(c)), out);
+        putString(matrix.name(c), out);
+
+        for (value::ColumnMatrix::size_type r = 0; r < matrix.rows(); ++r) {
+            out->push_back(matrix.isNull(c, r) ? 0 : 1);
+        }
+
+        switch (matrix.type(c)) {
+        case value::ColumnMatrix::DOUBLE_COLUMN:
+            out->append(reinterpret_cast < const char* >(matrix.doubles(c)),
+                        matrix.rows() * sizeof(double));
+            break;
+        case value::ColumnMatrix::INTEGER_COLUMN:
+            out->append(reinterpret_cast < const char* >(matrix.integers(c)),
+                        matrix.rows() * sizeof(int32_t));
+            break;
+        case value::ColumnMatrix::BOOLEAN_COLUMN:
+            for (value::ColumnMatrix::size_type r = 0; r < matrix.rows();
+                 ++r) {
+                out->push_back(matrix.isNull(c, r) ? 0 :
+                               matrix.getBoolean(c, r));
+            }
+            break;
+        }
+    }
+}
+
+void encodeValue(const value::Value *value, std::string *out)
+{
+    if (not value) {
+        out->push_back(NULL_VALUE);
+        return;
+    }
+
+    out->push_back(static_cast < unsigned char >(value->getType()));
+
+    switch (value->getType()) {
+    case value::Value::BOOLEAN:
+        out->push_back(value->toBoolean().value() ? 1 : 0);
+        break;
+    case value::Value::INTEGER:
+        put(value->toInteger().value(), out);
+        break;
+    case value::Value::DOUBLE:
+        put(value->toDouble().value(), out);
+        break;
+    case value::Value::STRING:
+        putString(value->toString().value(), out);
+        break;
+    case value::Value::XMLTYPE:
+        putString(value->toXml().value(), out);
+        break;
+    case value::Value::NIL:
+        break;
+    case value::Value::SET: {
+        const value::Set& set(value->toSet());
+        put(static_cast < boost::uint32_t >(set.size()), out);
+        for (value::Set::const_iterator it = set.begin(); it != set.end();
+             ++it) {
+            encodeValue(*it, out);
+        }
+        break;
+    }
+    case value::Value::MAP: {
+        const value::Map& map(value->toMap());
+        put(static_cast < boost::uint32_t >(map.size()), out);
+        for (value::Map::const_iterator it = map.begin(); it != map.end();
+             ++it) {
+            putString(it->first, out);
+            encodeValue(it->second, out);
+        }
+        break;
+    }
+    case value::Value::TUPLE: {
+        const value::TupleValue& tuple(value->toTuple().value());
+        put(static_cast < boost::uint32_t >(tuple.size()), out);
+        if (not tuple.empty()) {
+            out->append(reinterpret_cast < const char* >(&tuple[0]),
+                        tuple.size() * sizeof(double));
+        }
+        break;
+    }
+    case value::Value::TABLE: {
+        const value::Table& table(value->toTable());
+        put(static_cast < boost::uint32_t >(table.width()), out);
+        put(static_cast < boost::uint32_t >(table.height()), out);
+        for (value::Table::index y = 0; y < table.height(); ++y) {
+            for (value::Table::index x = 0; x < table.width(); ++x) {
+                put(table.get(x, y), out);
+            }
+        }
+        break;
+    }
+    case value::Value::MATRIX: {
+        const value::Matrix& matrix(value->toMatrix());
+        put(static_cast < boost::uint32_t >(matrix.columns()), out);
+        put(static_cast < boost::uint32_t >(matrix.rows()), out);
+        put(static_cast < boost::uint32_t >(matrix.resizeColumn()), out);
+        put(static_cast < boost::uint32_t >(matrix.resizeRow()), out);
+        for (value::Matrix::size_type c = 0; c < matrix.columns(); ++c) {
+            for (value::Matrix::size_type r = 0; r < matrix.rows(); ++r) {
+                encodeValue(matrix.get(c, r), out);
+            }
+        }
+        break;
+    }
+    case value::Value::COLUMN_MATRIX:
+        encodeColumnMatrix(value->toColumnMatrix(), out);
+        break;
+    default:
+        throw utils::ArgError(fmt(
+                _("Value encoding: the type %1% has no binary form")) %
+            value->getType());
+    }
+}
+
+static void decodeColumnMatrix(value::ColumnMatrix *matrix,
+                               const char **begin, const char *end)
+{
+    boost::uint32_t columns = get < boost::uint32_t >(begin, end);
+    boost::uint64_t rows = get < boost::uint64_t >(begin, end);
+
+    matrix->resize(rows);
+    for (boost::uint32_t c = 0; c < columns; ++c) {
+        unsigned char type = get < unsigned char >(begin, end);
+        if (type > value::ColumnMatrix::BOOLEAN_COLUMN) {
+            throw utils::InternalError(_("Value decoding: bad column type"));
+        }
+        matrix->addColumn(static_cast < value::ColumnMatrix::ColumnType >(
+                              type), getString(begin, end));
+
+        const char *present = *begin;
+        std::size_t size = type == value::ColumnMatrix::DOUBLE_COLUMN ?
+            sizeof(double) : type == value::ColumnMatrix::INTEGER_COLUMN ?
+            sizeof(int32_t) : 1;
+        if (static_cast < boost::uint64_t >(end - *begin) <
+            rows * (size + 1)) {
+            throw utils::InternalError(_("Value decoding: truncated buffer"));
+        }
+        *begin += rows;
+
+        for (boost::uint64_t r = 0; r < rows; ++r) {
+            if (not present[r]) {
+                *begin += size;
+                continue;
+            }
+
+            switch (type) {
+            case value::ColumnMatrix::DOUBLE_COLUMN:
+                matrix->addDouble(c, r, get < double >(begin, end));
+                break;
+            case value::ColumnMatrix::INTEGER_COLUMN:
+                matrix->addInt(c, r, get < int32_t >(begin, end));
+                break;
+            default:
+                matrix->addBoolean(c, r, get < unsigned char >(begin, end));
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * Fill the container @e value, allocated by decodeValue, with the
+ * elements read from the buffer.
+ */
+static void decodeElements(value::Value *value, const char **begin,
+                           const char *end)
+{
+    switch (value->getType()) {
+    case value::Value::SET: {
+        boost::uint32_t size = get < boost::uint32_t >(begin, end);
+        for (boost::uint32_t i = 0; i < size; ++i) {
+            value->toSet().add(decodeValue(begin, end));
+        }
+        break;
+    }
+    case value::Value::MAP: {
+        boost::uint32_t size = get < boost::uint32_t >(begin, end);
+        for (boost::uint32_t i = 0; i < size; ++i) {
+            std::string key(getString(begin, end));
+            value->toMap().add(key, decodeValue(begin, end));
+        }
+        break;
+    }
+    case value::Value::TUPLE: {
+        boost::uint32_t size = get < boost::uint32_t >(begin, end);
+        for (boost::uint32_t i = 0; i < size; ++i) {
+            value->toTuple().add(get < double >(begin, end));
+        }
+        break;
+    }
+    case value::Value::TABLE: {
+        value::Table& table(value->toTable());
+        for (value::Table::index y = 0; y < table.height(); ++y) {
+            for (value::Table::index x = 0; x < table.width(); ++x) {
+                table.get(x, y) = get < double >(begin, end);
+            }
+        }
+        break;
+    }
+    case value::Value::MATRIX: {
+        value::Matrix& matrix(value->toMatrix());
+        for (value::Matrix::size_type c = 0; c < matrix.columns(); ++c) {
+            for (value::Matrix::size_type r = 0; r < matrix.rows(); ++r) {
+                value::Value *cell = decodeValue(begin, end);
+                if (cell) {
+                    matrix.add(c, r, cell);
+                }
+            }
+        }
+        break;
+    }
+    default:
+        decodeColumnMatrix(&value->toColumnMatrix(), begin, end);
+        break;
+    }
+}
+
+value::Value * decodeValue(const char **begin, const char *end)
+{
+    unsigned char type = get < unsigned char >(begin, end);
+    value::Value *result = 0;
+
+    switch (type) {
+    case NULL_VALUE:
+        return 0;
+    case value::Value::BOOLEAN:
+        return new value::Boolean(get < unsigned char >(begin, end));
+    case value::Value::INTEGER:
+        return new value::Integer(get < int32_t >(begin, end));
+    case value::Value::DOUBLE:
+        return new value::Double(get < double >(begin, end));
+    case value::Value::STRING:
+        return new value::String(getString(begin, end));
+    case value::Value::XMLTYPE:
+        return new value::Xml(getString(begin, end));
+    case value::Value::NIL:
+        return new value::Null();
+    case value::Value::SET:
+        result = new value::Set();
+        break;
+    case value::Value::MAP:
+        result = new value::Map();
+        break;
+    case value::Value::TUPLE:
+        result = new value::Tuple();
+        break;
+    case value::Value::TABLE: {
+        boost::uint32_t width = get < boost::uint32_t >(begin, end);
+        boost::uint32_t height = get < boost::uint32_t >(begin, end);
+        result = new value::Table(width, height);
+        break;
+    }
+    case value::Value::MATRIX: {
+        boost::uint32_t columns = get < boost::uint32_t >(begin, end);
+        boost::uint32_t rows = get < boost::uint32_t >(begin, end);
+        boost::uint32_t resizeColumns = get < boost::uint32_t >(begin, end);
+        boost::uint32_t resizeRows = get < boost::uint32_t >(begin, end);
+        result = new value::Matrix(columns, rows, resizeColumns,
+                                   resizeRows);
+        break;
+    }
+    case value::Value::COLUMN_MATRIX:
+        result = new value::ColumnMatrix();
+        break;
+    default:
+        throw utils::InternalError(fmt(
+                _("Value decoding: unknown type %1%")) %
+            static_cast < int >(type));
+    }
+
+    try {
+        decodeElements(result, begin, end);
+    } catch (...) {
+        delete result;
+        throw;
+    }
+
+    return result;
+}
+
+}} // namespace vle manager
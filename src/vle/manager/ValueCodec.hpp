@@ -0,0 +1,65 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_MANAGER_VALUECODEC_HPP
+#define VLE_MANAGER_VALUECODEC_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/value/Value.hpp>
+#include <string>
+
+namespace vle { namespace manager {
+
+/**
+ * Append the binary form of a value to a buffer. The numbers are written
+ * in the byte order of the host: the buffer is read by a process of the
+ * same host.
+ *
+ * @param value The value to encode, NULL is allowed.
+ * @param[out] out The buffer.
+ *
+ * @throw utils::ArgError if the value is or contains a value::User.
+ */
+VLE_LOCAL void encodeValue(const value::Value *value, std::string *out);
+
+/**
+ * Read a value written by @c encodeValue.
+ *
+ * @param[in,out] begin The position of the value, assigned to the end of
+ * the value.
+ * @param end The end of the buffer.
+ *
+ * @throw utils::InternalError if the buffer is truncated or corrupted.
+ *
+ * @return The value, NULL if a NULL value was encoded.
+ */
+VLE_LOCAL value::Value * decodeValue(const char **begin, const char *end);
+
+}} // namespace vle manager
+
+#endif
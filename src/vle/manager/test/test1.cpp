@@ -36,10 +36,27 @@
 #include <boost/lexical_cast.hpp>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
 #include <vle/vpz/Vpz.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Dynamic.hpp>
+#include <vle/value/ColumnMatrix.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Matrix.hpp>
+#include <vle/value/Set.hpp>
+#include <vle/value/String.hpp>
+#include <vle/value/Tuple.hpp>
 #include <vle/manager/Manager.hpp>
 #include <vle/manager/ExperimentGenerator.hpp>
+#include <vle/manager/ProcessPool.hpp>
+#include <csignal>
 #include <vle/vle.hpp>
+#include <boost/filesystem.hpp>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 struct F
 {
@@ -224,3 +241,383 @@ BOOST_AUTO_TEST_CASE(experimentgenerator_max_1_max_1)
     BOOST_CHECK_EQUAL(expgen1.max(), 7);
     BOOST_CHECK_EQUAL(expgen1.size(), 7);
 }
+
+/*
+ * Build an experimental frame of @e size combinations: an empty coupled
+ * model observed by a finish view and a condition with @e size values.
+ */
+static vpz::Vpz* buildPlan(int size)
+{
+    vpz::Vpz *vpz = new vpz::Vpz();
+    vpz->project().model().setModel(new vpz::CoupledModel("top", 0));
+    vpz->project().experiment().setName("plan");
+    vpz->project().experiment().setDuration(1.0);
+    vpz->project().experiment().views().addLocalStreamOutput(
+        "out", "", "columnstorage", "vle");
+    vpz->project().experiment().views().addFinishView("view", "out");
+
+    vpz::Condition cnd("cond");
+    cnd.add("x");
+    for (int i = 0; i < size; ++i) {
+        cnd.addValueToPort("x", new value::Integer(i));
+    }
+    vpz->project().experiment().conditions().add(cnd);
+
+    return vpz;
+}
+
+BOOST_AUTO_TEST_CASE(experimentgenerator_overlay)
+{
+    vpz::Vpz *vpz = buildPlan(5);
+    vpz->project().experiment().conditions().get("cond").addValueToPort(
+        "y", new value::Integer(42));
+
+    manager::ExperimentGenerator expgen(*vpz, 0, 1);
+    vpz::Conditions overlay;
+
+    for (int i = 0; i < 5; ++i) {
+        expgen.getOverlay(i, &overlay);
+
+        BOOST_REQUIRE_EQUAL(overlay.conditionlist().size(), 1u);
+        const vpz::Condition& cnd(overlay.get("cond"));
+        BOOST_REQUIRE_EQUAL(cnd.conditionvalues().size(), 1u);
+        BOOST_REQUIRE_EQUAL(cnd.getSetValues("x").size(), 1u);
+        BOOST_REQUIRE_EQUAL(value::toInteger(cnd.getSetValues("x").get(0)),
+                            i);
+    }
+
+    delete vpz->project().model().model();
+    delete vpz;
+}
+
+BOOST_AUTO_TEST_CASE(manager_thread_plan)
+{
+    utils::ModuleManager modules;
+    manager::Error error;
+    std::ostringstream out;
+    manager::Manager man(manager::LOG_SUMMARY, manager::SIMULATION_NONE,
+                         &out);
+
+    value::Matrix *result = man.run(buildPlan(37), modules, 4, 0, 1, &error);
+
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    BOOST_REQUIRE_EQUAL(result->columns(), 37u);
+    BOOST_REQUIRE_EQUAL(result->rows(), 1u);
+    for (int i = 0; i < 37; ++i) {
+        BOOST_REQUIRE(result->get(i, 0));
+        BOOST_REQUIRE(result->get(i, 0)->isMap());
+    }
+
+    // The summary reports the usage of each thread.
+    BOOST_REQUIRE(out.str().find("Manager thread 0: ") != std::string::npos);
+    BOOST_REQUIRE(out.str().find("Manager thread 3: ") != std::string::npos);
+
+    delete result;
+}
+
+BOOST_AUTO_TEST_CASE(manager_thread_plan_duration)
+{
+    utils::ModuleManager modules;
+    manager::Error error;
+    manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE, NULL);
+
+    // The overlay of each combination gives the duration of the
+    // simulation: the finish view observes the end of the simulation.
+    vpz::Vpz *vpz = buildPlan(5);
+    value::Set& duration(vpz->project().experiment().conditions().get(
+                             vpz::Experiment::defaultSimulationEngineCondName())
+                         .getSetValues("duration"));
+    duration.clear();
+    for (int i = 0; i < 5; ++i) {
+        duration.addDouble(i + 1.0);
+    }
+
+    value::Matrix *result = man.run(vpz, modules, 2, 0, 1, &error);
+
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    BOOST_REQUIRE_EQUAL(result->columns(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        BOOST_REQUIRE(result->get(i, 0));
+        const value::ColumnMatrix& view(
+            result->get(i, 0)->toMap().get("view")->toColumnMatrix());
+        BOOST_REQUIRE_EQUAL(view.getDouble(0, view.rows() - 1), i + 1.0);
+    }
+
+    delete result;
+}
+
+BOOST_AUTO_TEST_CASE(manager_thread_errors)
+{
+    utils::ModuleManager modules;
+    manager::Error error;
+    manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE, NULL);
+
+    // The dynamics of the atomic model does not exist: all the
+    // combinations fail.
+    vpz::Vpz *vpz = buildPlan(13);
+    vpz::Dynamic dyn("dyn");
+    dyn.setPackage("no_such_package");
+    dyn.setLibrary("no_such_library");
+    vpz->project().dynamics().add(dyn);
+    vpz::CoupledModel *top = vpz->project().model().model()->toCoupled();
+    top->addAtomicModel("a")->setDynamics("dyn");
+
+    value::Matrix *result = man.run(vpz, modules, 4, 0, 1, &error);
+
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE_EQUAL(error.code, -1);
+    BOOST_REQUIRE_EQUAL(error.combinations.size(), 13u);
+    for (uint32_t i = 0; i < 13; ++i) {
+        BOOST_REQUIRE_EQUAL(error.combinations[i].index, i);
+        BOOST_REQUIRE(not error.combinations[i].message.empty());
+        BOOST_REQUIRE(error.combinations[i].elapsed >= 0.0);
+        BOOST_REQUIRE(not result->get(i, 0));
+    }
+    delete result;
+
+    // Run again some combinations of a plan.
+    std::vector < uint32_t > combinations;
+    combinations.push_back(12);
+    combinations.push_back(3);
+    combinations.push_back(12);
+    combinations.push_back(7);
+
+    result = man.run(buildPlan(13), modules, 2, combinations, &error);
+
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    BOOST_REQUIRE(error.combinations.empty());
+    BOOST_REQUIRE_EQUAL(result->columns(), 13u);
+    for (uint32_t i = 0; i < 13; ++i) {
+        BOOST_REQUIRE_EQUAL(result->get(i, 0) != 0,
+                            i == 3 or i == 7 or i == 12);
+    }
+    delete result;
+
+    combinations.push_back(13);
+    BOOST_REQUIRE_THROW(man.run(buildPlan(13), modules, 2, combinations,
+                                &error), utils::ArgError);
+}
+
+/*
+ * The task of the process pool: the combination 3 kills its worker, the
+ * combination 5 fails and the others return values of several types.
+ */
+static value::Map* poolTask(uint32_t index, manager::Error *error)
+{
+    if (index == 3) {
+        std::raise(SIGKILL);
+    }
+
+    if (index == 5) {
+        error->code = -1;
+        error->message = "combination 5 fails";
+        return 0;
+    }
+
+    value::Map *result = new value::Map();
+    result->addInt("index", index);
+    result->addDouble("half", index / 2.0);
+    result->addString("name", "combination");
+    value::Set& set = result->addSet("set");
+    set.addInt(index);
+    set.add(static_cast < value::Value* >(0));
+    value::Tuple *tuple = new value::Tuple(3, 1.5);
+    result->add("tuple", tuple);
+    value::Matrix& matrix = result->addMatrix("matrix");
+    matrix.resize(2, 2);
+    matrix.add(1, 1, new value::Integer(index));
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(process_pool_crash)
+{
+    std::vector < uint32_t > combinations;
+    for (uint32_t i = 0; i < 8; ++i) {
+        combinations.push_back(i);
+    }
+    std::vector < value::Map* > slots(8, static_cast < value::Map* >(0));
+    std::vector < manager::CombinationError > failures;
+
+    manager::ProcessPool pool(3, poolTask);
+    pool.run(combinations, &slots, &failures);
+
+    BOOST_REQUIRE_EQUAL(pool.restarts(), 1u);
+    BOOST_REQUIRE_EQUAL(failures.size(), 2u);
+    for (std::size_t i = 0; i < failures.size(); ++i) {
+        if (failures[i].index == 3) {
+            BOOST_REQUIRE(failures[i].message.find("killed by the signal")
+                          != std::string::npos);
+        } else {
+            BOOST_REQUIRE_EQUAL(failures[i].index, 5u);
+            BOOST_REQUIRE_EQUAL(failures[i].message, "combination 5 fails");
+        }
+    }
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        if (i == 3 or i == 5) {
+            BOOST_REQUIRE(not slots[i]);
+            continue;
+        }
+
+        BOOST_REQUIRE(slots[i]);
+        const value::Map& map(*slots[i]);
+        BOOST_REQUIRE_EQUAL(map.getInt("index"), (int)i);
+        BOOST_REQUIRE_CLOSE(map.getDouble("half"), i / 2.0, 1e-10);
+        BOOST_REQUIRE_EQUAL(map.getString("name"), "combination");
+        BOOST_REQUIRE_EQUAL(map.getSet("set").size(), 2u);
+        BOOST_REQUIRE_EQUAL(map.getSet("set").getInt(0), (int)i);
+        BOOST_REQUIRE(not map.getSet("set").get(1));
+        BOOST_REQUIRE_EQUAL(map.get("tuple")->toTuple().size(), 3u);
+        BOOST_REQUIRE_CLOSE(map.get("tuple")->toTuple().operator[](2), 1.5,
+                            1e-10);
+        BOOST_REQUIRE_EQUAL(map.getMatrix("matrix").columns(), 2u);
+        BOOST_REQUIRE(not map.getMatrix("matrix").get(0, 0));
+        BOOST_REQUIRE_EQUAL(value::toInteger(
+                                map.getMatrix("matrix").get(1, 1)), (int)i);
+        delete slots[i];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(manager_spawn_plan)
+{
+    utils::ModuleManager modules;
+    manager::Error error;
+    manager::Manager man(manager::LOG_NONE,
+                         manager::SIMULATION_SPAWN_PROCESS, NULL);
+
+    value::Matrix *result = man.run(buildPlan(11), modules, 3, 0, 1, &error);
+
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE_EQUAL(error.code, 0);
+    BOOST_REQUIRE_EQUAL(result->columns(), 11u);
+    for (int i = 0; i < 11; ++i) {
+        BOOST_REQUIRE(result->get(i, 0));
+        BOOST_REQUIRE(result->get(i, 0)->isMap());
+    }
+    delete result;
+}
+
+/*
+ * Read the number of restored combinations in the summary log.
+ */
+static int restored(const std::string& log)
+{
+    std::string::size_type pos = log.find("Manager checkpoint: ");
+    BOOST_REQUIRE(pos != std::string::npos);
+
+    std::istringstream in(log.substr(pos + 20));
+    int result = -1;
+    in >> result;
+
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(manager_checkpoint_resume)
+{
+    const std::string filename("manager_checkpoint.dat");
+    const int size = 400;
+    utils::ModuleManager modules;
+    manager::Error error;
+
+    boost::filesystem::remove(filename);
+
+    // A first run is killed by a signal after its first results.
+    pid_t pid = ::fork();
+    BOOST_REQUIRE(pid >= 0);
+    if (pid == 0) {
+        manager::Manager man(manager::LOG_NONE,
+                             manager::SIMULATION_NO_RETURN, NULL);
+        man.setCheckpoint(filename);
+        man.run(buildPlan(size), modules, 1, 0, 1, &error);
+        _exit(EXIT_SUCCESS);
+    }
+
+    for (int i = 0; i < 10000; ++i) {
+        if (boost::filesystem::exists(filename) and
+            boost::filesystem::file_size(filename) > 1024) {
+            break;
+        }
+        ::usleep(1000);
+    }
+    ::kill(pid, SIGKILL);
+    int status;
+    BOOST_REQUIRE_EQUAL(::waitpid(pid, &status, 0), pid);
+
+    // The last record is truncated as if the signal stopped its write.
+    boost::filesystem::resize_file(
+        filename, boost::filesystem::file_size(filename) - 3);
+
+    // The resumed run simulates the missing combinations only.
+    {
+        std::ostringstream out;
+        manager::Manager man(manager::LOG_SUMMARY, manager::SIMULATION_NONE,
+                             &out);
+        man.setCheckpoint(filename);
+        value::Matrix *result = man.run(buildPlan(size), modules, 2, 0, 1,
+                                        &error);
+
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE_EQUAL(error.code, 0);
+        BOOST_REQUIRE(restored(out.str()) >= 0);
+        BOOST_REQUIRE(restored(out.str()) < size);
+        for (int i = 0; i < size; ++i) {
+            BOOST_REQUIRE(result->get(i, 0));
+            BOOST_REQUIRE(result->get(i, 0)->isMap());
+        }
+        delete result;
+    }
+
+    // All the combinations are in the file.
+    {
+        std::ostringstream out;
+        manager::Manager man(manager::LOG_SUMMARY,
+                             manager::SIMULATION_SPAWN_PROCESS, &out);
+        man.setCheckpoint(filename);
+        value::Matrix *result = man.run(buildPlan(size), modules, 2, 0, 1,
+                                        &error);
+
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE_EQUAL(error.code, 0);
+        BOOST_REQUIRE_EQUAL(restored(out.str()), size);
+        for (int i = 0; i < size; ++i) {
+            BOOST_REQUIRE(result->get(i, 0));
+            BOOST_REQUIRE(result->get(i, 0)->isMap());
+        }
+        delete result;
+    }
+
+    // The file belongs to another experimental frame.
+    {
+        manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE,
+                             NULL);
+        man.setCheckpoint(filename);
+        BOOST_REQUIRE_THROW(man.run(buildPlan(13), modules, 1, 0, 1,
+                                    &error), utils::ArgError);
+    }
+
+    // The file belongs to another part of the experimental frame.
+    {
+        manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE,
+                             NULL);
+        man.setCheckpoint(filename);
+        BOOST_REQUIRE_THROW(man.run(buildPlan(size), modules, 1, 1, 2,
+                                    &error), utils::ArgError);
+    }
+
+    // The conditions of the experimental frame are modified.
+    {
+        manager::Manager man(manager::LOG_NONE, manager::SIMULATION_NONE,
+                             NULL);
+        man.setCheckpoint(filename);
+        vpz::Vpz *vpz = buildPlan(size);
+        vpz->project().experiment().conditions().get("cond").addValueToPort(
+            "y", new value::Integer(1));
+        BOOST_REQUIRE_THROW(man.run(vpz, modules, 1, 0, 1, &error),
+                            utils::ArgError);
+    }
+
+    boost::filesystem::remove(filename);
+}
@@ -0,0 +1,447 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/oov/ColumnCodec.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <archive.h>
+#include <archive_entry.h>
+#include <algorithm>
+#include <cstring>
+
+namespace vle { namespace oov {
+
+namespace {
+
+inline uint64_t mask(unsigned bits)
+{
+    return bits == 0 ? 0 : (~static_cast < uint64_t >(0)) >> (64 - bits);
+}
+
+inline unsigned leadingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    unsigned n = 0;
+    while (not (x & (static_cast < uint64_t >(1) << 63))) {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline unsigned trailingZeros(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (not (x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline uint64_t bits(double value)
+{
+    uint64_t result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+inline double real(uint64_t value)
+{
+    double result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+/*
+ * Append bits to a buffer, the most significant bit first.
+ */
+class BitWriter
+{
+public:
+    BitWriter(std::vector < char >& out)
+        : m_out(out), m_acc(0), m_bits(0)
+    {}
+
+    void write(uint64_t value, unsigned bits)
+    {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            bits = 32;
+        }
+
+        m_acc = (m_acc << bits) | (value & mask(bits));
+        m_bits += bits;
+
+        while (m_bits >= 8) {
+            m_bits -= 8;
+            m_out.push_back(static_cast < char >(m_acc >> m_bits));
+        }
+        m_acc &= mask(m_bits);
+    }
+
+    void flush()
+    {
+        if (m_bits > 0) {
+            m_out.push_back(static_cast < char >(m_acc << (8 - m_bits)));
+            m_acc = 0;
+            m_bits = 0;
+        }
+    }
+
+private:
+    std::vector < char >& m_out;
+    uint64_t              m_acc;
+    unsigned              m_bits;
+};
+
+/*
+ * Read the bits of a BitWriter, good() is false after a read past the
+ * end of the buffer.
+ */
+class BitReader
+{
+public:
+    BitReader(const char* data, std::size_t size)
+        : m_data(reinterpret_cast < const unsigned char* >(data)),
+          m_end(m_data + size), m_acc(0), m_bits(0), m_good(true)
+    {}
+
+    uint64_t read(unsigned bits)
+    {
+        if (bits > 32) {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+
+        while (m_bits < bits) {
+            if (m_data == m_end) {
+                m_good = false;
+                return 0;
+            }
+            m_acc = (m_acc << 8) | *m_data++;
+            m_bits += 8;
+        }
+
+        m_bits -= bits;
+        uint64_t value = (m_acc >> m_bits) & mask(bits);
+        m_acc &= mask(m_bits);
+        return value;
+    }
+
+    bool good() const
+    { return m_good; }
+
+private:
+    const unsigned char* m_data;
+    const unsigned char* m_end;
+    uint64_t             m_acc;
+    unsigned             m_bits;
+    bool                 m_good;
+};
+
+inline void freeArchive(struct archive* a, bool write)
+{
+#if ARCHIVE_VERSION_NUMBER < 3001002
+    if (write) {
+        archive_write_finish(a);
+    } else {
+        archive_read_finish(a);
+    }
+#else
+    if (write) {
+        archive_write_free(a);
+    } else {
+        archive_read_free(a);
+    }
+#endif
+}
+
+int addFilter(struct archive* a, ColumnWriter::Compression compression)
+{
+    switch (compression) {
+#if ARCHIVE_VERSION_NUMBER < 3001002
+    case ColumnWriter::GZIP:
+        return archive_write_set_compression_gzip(a);
+    case ColumnWriter::BZIP2:
+        return archive_write_set_compression_bzip2(a);
+    case ColumnWriter::XZ:
+        return archive_write_set_compression_xz(a);
+#else
+    case ColumnWriter::GZIP:
+        return archive_write_add_filter_gzip(a);
+    case ColumnWriter::BZIP2:
+        return archive_write_add_filter_bzip2(a);
+    case ColumnWriter::XZ:
+        return archive_write_add_filter_xz(a);
+#endif
+#if ARCHIVE_VERSION_NUMBER >= 3003003
+    case ColumnWriter::ZSTD:
+        return archive_write_add_filter_zstd(a);
+#endif
+    default:
+        return ARCHIVE_FATAL;
+    }
+}
+
+/*
+ * Compress into a buffer of @e capacity bytes, false if the buffer is
+ * too small.
+ */
+bool compressInto(ColumnWriter::Compression compression, const char* data,
+                  std::size_t size, std::vector < char >& out,
+                  std::size_t capacity)
+{
+    struct archive* a = archive_write_new();
+    size_t used = 0;
+
+    out.resize(capacity);
+
+    if (addFilter(a, compression) != ARCHIVE_OK) {
+        freeArchive(a, true);
+        throw utils::InternalError(fmt(
+                _("Oov column: libarchive does not provide the filter %1%"))
+            % ColumnWriter::compressionName(compression));
+    }
+
+    archive_write_set_format_raw(a);
+    archive_write_set_bytes_per_block(a, 0);
+
+    bool success = archive_write_open_memory(a, &out[0], capacity,
+                                             &used) == ARCHIVE_OK;
+
+    if (success) {
+        struct archive_entry* entry = archive_entry_new();
+        archive_entry_set_filetype(entry, AE_IFREG);
+        archive_entry_set_size(entry, size);
+        success = archive_write_header(a, entry) == ARCHIVE_OK;
+        archive_entry_free(entry);
+    }
+
+    success = success and archive_write_data(a, data, size) ==
+        static_cast < ssize_t >(size);
+    success = archive_write_close(a) == ARCHIVE_OK and success;
+    freeArchive(a, true);
+
+    out.resize(success ? used : 0);
+    return success;
+}
+
+} // anonymous namespace
+
+void xorEncode(const double* values, std::size_t size, bool delta,
+               std::vector < char >& out)
+{
+    BitWriter writer(out);
+    uint64_t previous = 0, before = 0;
+    unsigned lead = 65, trail = 0;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        uint64_t value = bits(values[i]);
+        uint64_t predicted = delta ? previous + (previous - before) :
+            previous;
+        uint64_t x = value ^ predicted;
+
+        before = i == 0 ? value : previous;
+        previous = value;
+
+        if (x == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+
+        unsigned leading = std::min(leadingZeros(x), 31u);
+        unsigned trailing = trailingZeros(x);
+
+        if (leading >= lead and trailing >= trail) {
+            writer.write(2, 2);
+            writer.write(x >> trail, 64 - lead - trail);
+        } else {
+            unsigned length = 64 - leading - trailing;
+
+            writer.write(3, 2);
+            writer.write(leading, 5);
+            writer.write(length & 63, 6);
+            writer.write(x >> trailing, length);
+            lead = leading;
+            trail = trailing;
+        }
+    }
+
+    writer.flush();
+}
+
+bool xorDecode(const char* data, std::size_t size, bool delta,
+               double* values, std::size_t count)
+{
+    BitReader reader(data, size);
+    uint64_t previous = 0, before = 0;
+    unsigned lead = 65, trail = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t predicted = delta ? previous + (previous - before) :
+            previous;
+        uint64_t x = 0;
+
+        if (reader.read(1)) {
+            if (reader.read(1)) {
+                lead = reader.read(5);
+                unsigned length = reader.read(6);
+                if (length == 0) {
+                    length = 64;
+                }
+                if (lead + length > 64) {
+                    return false;
+                }
+                trail = 64 - lead - length;
+            } else if (lead > 64) {
+                return false;
+            }
+            x = reader.read(64 - lead - trail) << trail;
+        }
+
+        if (not reader.good()) {
+            return false;
+        }
+
+        uint64_t value = x ^ predicted;
+        before = i == 0 ? value : previous;
+        previous = value;
+        values[i] = real(value);
+    }
+
+    return true;
+}
+
+void varintEncode(const int64_t* values, std::size_t size,
+                  std::vector < char >& out)
+{
+    uint64_t previous = 0;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        uint64_t value = static_cast < uint64_t >(values[i]);
+        uint64_t delta = value - previous;
+        uint64_t zigzag = (delta << 1) ^ (0 - (delta >> 63));
+
+        previous = value;
+
+        while (zigzag >= 0x80) {
+            out.push_back(static_cast < char >((zigzag & 0x7f) | 0x80));
+            zigzag >>= 7;
+        }
+        out.push_back(static_cast < char >(zigzag));
+    }
+}
+
+bool varintDecode(const char* data, std::size_t size, int64_t* values,
+                  std::size_t count)
+{
+    const unsigned char* it = reinterpret_cast < const unsigned char* >(
+        data);
+    const unsigned char* end = it + size;
+    uint64_t previous = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t zigzag = 0;
+        unsigned shift = 0;
+
+        do {
+            if (it == end or shift > 63) {
+                return false;
+            }
+            zigzag |= static_cast < uint64_t >(*it & 0x7f) << shift;
+            shift += 7;
+        } while (*it++ & 0x80);
+
+        previous += (zigzag >> 1) ^ (0 - (zigzag & 1));
+        values[i] = static_cast < int64_t >(previous);
+    }
+
+    return true;
+}
+
+void compress(ColumnWriter::Compression compression, const char* data,
+              std::size_t size, std::vector < char >& out)
+{
+    // The filters expand incompressible data by a few bytes by block: the
+    // buffer is enlarged until the compressed data fit.
+    for (std::size_t capacity = size + size / 8 + 4096;
+         capacity <= 4 * size + 65536; capacity *= 2) {
+        if (compressInto(compression, data, size, out, capacity)) {
+            return;
+        }
+    }
+
+    throw utils::InternalError(fmt(
+            _("Oov column: cannot compress a chunk with %1%")) %
+        ColumnWriter::compressionName(compression));
+}
+
+bool decompress(const char* data, std::size_t size, char* out,
+                std::size_t count)
+{
+    struct archive* a = archive_read_new();
+    struct archive_entry* entry;
+
+#if ARCHIVE_VERSION_NUMBER < 3001002
+    archive_read_support_compression_all(a);
+#else
+    archive_read_support_filter_all(a);
+#endif
+    archive_read_support_format_raw(a);
+
+    bool success = archive_read_open_memory(
+        a, const_cast < char* >(data), size) == ARCHIVE_OK and
+        archive_read_next_header(a, &entry) == ARCHIVE_OK;
+
+    std::size_t done = 0;
+    while (success and done < count) {
+        ssize_t read = archive_read_data(a, out + done, count - done);
+        if (read <= 0) {
+            success = false;
+        } else {
+            done += read;
+        }
+    }
+
+    char extra;
+    success = success and archive_read_data(a, &extra, 1) == 0;
+
+    archive_read_close(a);
+    freeArchive(a, false);
+    return success;
+}
+
+}} // namespace vle oov
@@ -0,0 +1,105 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_OOV_COLUMNCODEC_HPP
+#define VLE_OOV_COLUMNCODEC_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/oov/ColumnWriter.hpp>
+#include <vle/utils/Types.hpp>
+#include <vector>
+
+namespace vle { namespace oov {
+
+/**
+ * @brief Encode doubles with the XOR compression of the Gorilla time
+ * series database: each value is XORed with a prediction and only the
+ * meaningful bits of the result are stored. The prediction is the
+ * previous value or, if @e delta is true, the extrapolation of the two
+ * previous values computed on the bit patterns (the delta of delta
+ * encoding of the regular dates). The encoding is lossless, NaN included.
+ * @param values the values to encode.
+ * @param size the number of values.
+ * @param delta true to predict by the delta of the two previous values.
+ * @param out the bytes are appended to this buffer.
+ */
+VLE_LOCAL void xorEncode(const double* values, std::size_t size, bool delta,
+                         std::vector < char >& out);
+
+/**
+ * @brief Decode the @e count doubles of a xorEncode() stream.
+ * @return false if the stream is truncated.
+ */
+VLE_LOCAL bool xorDecode(const char* data, std::size_t size, bool delta,
+                         double* values, std::size_t count);
+
+/**
+ * @brief Encode integers by the zigzag of their delta with the previous
+ * value stored as a LEB128 variable length integer.
+ * @param values the values to encode.
+ * @param size the number of values.
+ * @param out the bytes are appended to this buffer.
+ */
+VLE_LOCAL void varintEncode(const int64_t* values, std::size_t size,
+                            std::vector < char >& out);
+
+/**
+ * @brief Decode the @e count integers of a varintEncode() stream.
+ * @return false if the stream is truncated.
+ */
+VLE_LOCAL bool varintDecode(const char* data, std::size_t size,
+                            int64_t* values, std::size_t count);
+
+/**
+ * @brief Compress a buffer with a filter of the libarchive library.
+ * @param compression the filter, not ColumnWriter::NONE.
+ * @param data the buffer to compress.
+ * @param size the size of the buffer.
+ * @param out the compressed buffer.
+ * @throw utils::InternalError if libarchive fails or does not provide
+ * the filter.
+ */
+VLE_LOCAL void compress(ColumnWriter::Compression compression,
+                        const char* data, std::size_t size,
+                        std::vector < char >& out);
+
+/**
+ * @brief Decompress a buffer of compress(), the filter is detected by
+ * libarchive.
+ * @param data the compressed buffer.
+ * @param size the size of the compressed buffer.
+ * @param out the decompressed buffer of @e count bytes.
+ * @param count the size of the decompressed buffer.
+ * @return false if the buffer is corrupted or has not @e count bytes.
+ */
+VLE_LOCAL bool decompress(const char* data, std::size_t size, char* out,
+                          std::size_t count);
+
+}} // namespace vle oov
+
+#endif
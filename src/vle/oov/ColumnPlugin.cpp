@@ -0,0 +1,206 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/oov/ColumnPlugin.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+
+namespace vle { namespace oov {
+
+ColumnPlugin::ColumnPlugin(const std::string& location)
+    : Plugin(location), m_next(0), m_row(0), m_time(0.0), m_empty(true)
+{
+}
+
+ColumnPlugin::~ColumnPlugin()
+{
+}
+
+void ColumnPlugin::onNewObservable(const std::string& simulator,
+                                   const std::string& parent,
+                                   const std::string& port,
+                                   const std::string& /* view */,
+                                   const double& /* time */)
+{
+    column(simulator, parent, port);
+}
+
+void ColumnPlugin::onDelObservable(const std::string& /* simulator */,
+                                   const std::string& /* parent */,
+                                   const std::string& /* port */,
+                                   const std::string& /* view */,
+                                   const double& /* time */)
+{
+}
+
+void ColumnPlugin::onValue(const std::string& simulator,
+                           const std::string& parent,
+                           const std::string& port,
+                           const std::string& /* view */,
+                           const double& time,
+                           value::Value* value)
+{
+    std::size_t last = row(time);
+
+    if (simulator.empty() or not value) {
+        delete value;
+        return;
+    }
+
+    try {
+        std::size_t index = column(simulator, parent, port);
+
+        if (present(index, last)) {
+            last = newRow(time);
+        }
+        store(index, last, *value);
+    } catch (...) {
+        delete value;
+        throw;
+    }
+
+    delete value;
+}
+
+void ColumnPlugin::onNewColumn(const std::string& simulator,
+                               const std::string& parent,
+                               const std::string& port,
+                               const std::string& /* view */,
+                               const double& /* time */,
+                               std::size_t cell)
+{
+    if (cell >= m_cells.size()) {
+        m_cells.resize(cell + 1, 0);
+    }
+    m_cells[cell] = column(simulator, parent, port);
+}
+
+void ColumnPlugin::onValueBatch(const std::string& /* view */,
+                                const double& time,
+                                value::Value** values,
+                                std::size_t size)
+{
+    std::size_t last = row(time);
+
+    for (std::size_t i = 0; i < size and i < m_cells.size(); ++i) {
+        if (values[i] and present(m_cells[i], last)) {
+            last = newRow(time);
+            break;
+        }
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+        if (values[i]) {
+            try {
+                if (i < m_cells.size()) {
+                    store(m_cells[i], last, *values[i]);
+                }
+            } catch (...) {
+                for (std::size_t j = i; j < size; ++j) {
+                    delete values[j];
+                }
+                throw;
+            }
+            delete values[i];
+        }
+    }
+}
+
+std::size_t ColumnPlugin::column(const std::string& simulator,
+                                 const std::string& parent,
+                                 const std::string& port)
+{
+    // The views send the observables in the same order at each date: the
+    // column after the last one is tested before the dictionary.
+    if (m_next < m_keys.size()) {
+        const Key& key(m_keys[m_next]);
+        if (key.simulator == simulator and key.port == port and
+            key.parent == parent) {
+            return m_next++;
+        }
+    }
+
+    std::string name(parent + ":" + simulator + "." + port);
+    std::map < std::string, std::size_t >::iterator it =
+        m_index.find(name);
+
+    if (it != m_index.end()) {
+        m_next = it->second + 1;
+        return it->second;
+    }
+
+    std::size_t index = m_names.size();
+    appendColumn(name);
+    m_index[name] = index;
+    m_names.push_back(name);
+    m_keys.push_back(Key());
+    m_keys.back().simulator = simulator;
+    m_keys.back().parent = parent;
+    m_keys.back().port = port;
+    m_next = index + 1;
+
+    return index;
+}
+
+std::size_t ColumnPlugin::row(const double& time)
+{
+    if (m_empty or m_time != time) {
+        return newRow(time);
+    }
+
+    return m_row;
+}
+
+std::size_t ColumnPlugin::newRow(const double& time)
+{
+    m_row = appendRow(time);
+    m_time = time;
+    m_empty = false;
+
+    return m_row;
+}
+
+void ColumnPlugin::store(std::size_t column, std::size_t row,
+                         const value::Value& value)
+{
+    if (value.isDouble()) {
+        storeDouble(column, row, value.toDouble().value());
+    } else if (value.isInteger()) {
+        storeInteger(column, row, value.toInteger().value());
+    } else if (value.isBoolean()) {
+        storeBoolean(column, row, value.toBoolean().value());
+    } else {
+        throw utils::ArgError(fmt(
+                _("Oov %1%: the value of %2% is not a number")) % name() %
+            m_names[column]);
+    }
+}
+
+}} // namespace vle oov
@@ -0,0 +1,208 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_OOV_COLUMNPLUGIN_HPP
+#define VLE_OOV_COLUMNPLUGIN_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/oov/Plugin.hpp>
+#include <vle/utils/Types.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vle { namespace oov {
+
+/**
+ * @brief The base of the output plug-ins which store the numeric
+ * observations of a view in columns: the oov::ColumnStorage and the
+ * oov::ColumnWriter.
+ *
+ * A column is an observable port (parent:simulator.port), a row stores
+ * the observations of a date. A cell is never overwritten: an observation
+ * of a column which already has a value at the date of the last row
+ * starts a new row with the same time.
+ *
+ * The ColumnPlugin finds the columns, the rows and checks the values, the
+ * derived class stores the cells with the virtual functions
+ * appendColumn(), appendRow(), present() and the store functions.
+ */
+class VLE_API ColumnPlugin : public Plugin
+{
+public:
+    ColumnPlugin(const std::string& location);
+
+    virtual ~ColumnPlugin();
+
+    virtual void onNewObservable(const std::string& simulator,
+                                 const std::string& parent,
+                                 const std::string& port,
+                                 const std::string& view,
+                                 const double& time);
+
+    virtual void onDelObservable(const std::string& simulator,
+                                 const std::string& parent,
+                                 const std::string& port,
+                                 const std::string& view,
+                                 const double& time);
+
+    /**
+     * @brief Store the value in the row of the time.
+     * @throw utils::ArgError if the value is not a value::Double,
+     * value::Integer or value::Boolean.
+     */
+    virtual void onValue(const std::string& simulator,
+                         const std::string& parent,
+                         const std::string& port,
+                         const std::string& view,
+                         const double& time,
+                         value::Value* value);
+
+    /**
+     * @brief The ColumnPlugin receives the numeric observations by rows.
+     * @return true.
+     */
+    virtual bool acceptValues() const
+    { return true; }
+
+    /**
+     * @brief The ColumnPlugin receives the other observations by batches.
+     * @return true.
+     */
+    virtual bool acceptValueBatch() const
+    { return true; }
+
+    virtual void onNewColumn(const std::string& simulator,
+                             const std::string& parent,
+                             const std::string& port,
+                             const std::string& view,
+                             const double& time,
+                             std::size_t column);
+
+    /**
+     * @brief Store the batch of observations in the row of the time, the
+     * NULL cells are missing values.
+     * @throw utils::ArgError if a value is not a value::Double,
+     * value::Integer or value::Boolean.
+     */
+    virtual void onValueBatch(const std::string& view,
+                              const double& time,
+                              value::Value** values,
+                              std::size_t size);
+
+protected:
+    /**
+     * @brief Get the names (parent:simulator.port) of the columns.
+     */
+    const std::vector < std::string >& names() const
+    { return m_names; }
+
+    /**
+     * @brief Get the column of each cell of the rows of onValues() and
+     * onValueBatch().
+     */
+    const std::vector < std::size_t >& cells() const
+    { return m_cells; }
+
+    /**
+     * @brief Get the index of the column of an observable port, the column
+     * is appended if it does not exist.
+     */
+    std::size_t column(const std::string& simulator,
+                       const std::string& parent,
+                       const std::string& port);
+
+    /**
+     * @brief Get the last row if its time is the time, append a row
+     * otherwise.
+     */
+    std::size_t row(const double& time);
+
+    /**
+     * @brief Append a row.
+     */
+    std::size_t newRow(const double& time);
+
+    /**
+     * @brief Store a value::Double, value::Integer or value::Boolean.
+     * @throw utils::ArgError if the value is not a number.
+     */
+    void store(std::size_t column, std::size_t row,
+               const value::Value& value);
+
+private:
+    ColumnPlugin(const ColumnPlugin& other);
+    ColumnPlugin& operator=(const ColumnPlugin& other);
+
+    /**
+     * @brief Append an empty column of the size of the current rows.
+     */
+    virtual void appendColumn(const std::string& name) = 0;
+
+    /**
+     * @brief Append an empty row.
+     * @return The index of the new row.
+     */
+    virtual std::size_t appendRow(const double& time) = 0;
+
+    /**
+     * @brief Check if the cell of a column in a row has a value.
+     */
+    virtual bool present(std::size_t column, std::size_t row) const = 0;
+
+    virtual void storeDouble(std::size_t column, std::size_t row,
+                             double value) = 0;
+
+    virtual void storeInteger(std::size_t column, std::size_t row,
+                              int32_t value) = 0;
+
+    virtual void storeBoolean(std::size_t column, std::size_t row,
+                              bool value) = 0;
+
+    /**
+     * The observable port of a column.
+     */
+    struct Key
+    {
+        std::string simulator;
+        std::string parent;
+        std::string port;
+    };
+
+    std::map < std::string, std::size_t > m_index;
+    std::vector < std::string >       m_names;
+    std::vector < Key >               m_keys;
+    std::vector < std::size_t >       m_cells; ///< the columns of the rows.
+    std::size_t                       m_next; ///< the column after the last.
+    std::size_t                       m_row; ///< the last row.
+    double                            m_time; ///< the time of the last row.
+    bool                              m_empty; ///< no row.
+};
+
+}} // namespace vle oov
+
+#endif
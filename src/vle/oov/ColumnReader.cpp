@@ -0,0 +1,552 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/oov/ColumnReader.hpp>
+#include <vle/oov/ColumnCodec.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace vle { namespace oov {
+
+/*
+ * The oov::ColumnReader::Pimpl source: the mapped file and the pointers
+ * to the chunks.
+ */
+
+class ColumnReader::Pimpl
+{
+public:
+    /**
+     * A bound of a column in a chunk: an int64 for an INTEGER column since
+     * the version 3, a double otherwise.
+     */
+    union Bound
+    {
+        double  real;
+        int64_t integer;
+    };
+
+    /**
+     * The header of a column in a chunk.
+     */
+    struct ColumnHeader
+    {
+        uint32_t type;
+        uint32_t count;
+        Bound    min;
+        Bound    max;
+    };
+
+    /**
+     * A chunk: the streams of the times and of the columns are stored at
+     * the offsets of the decompressed data, the decoded streams are kept
+     * until release().
+     */
+    struct Chunk
+    {
+        std::size_t                         rows;
+        std::vector < const ColumnHeader* > columns;
+        std::vector < uint64_t >            offsets;
+        const char*                         stored;
+        uint64_t                            storedSize;
+        uint64_t                            size;
+        std::vector < char >                streams;
+        std::vector < std::vector < char > > decoded;
+    };
+
+    Pimpl(const std::string& filename)
+        : m_filename(filename), m_rows(0), m_version(ColumnWriter::VERSION),
+        m_encoding(ColumnWriter::PLAIN), m_compression(ColumnWriter::NONE)
+    {
+        try {
+            boost::interprocess::file_mapping file(
+                filename.c_str(), boost::interprocess::read_only);
+            boost::interprocess::mapped_region region(
+                file, boost::interprocess::read_only);
+            m_region.swap(region);
+        } catch (const std::exception& e) {
+            throw utils::FileError(fmt(
+                    _("ColumnReader: cannot map the file `%1%': %2%")) %
+                filename % e.what());
+        }
+
+        m_begin = static_cast < const char* >(m_region.get_address());
+        m_size = m_region.get_size();
+
+        if (m_size < 40 or word(0) != ColumnWriter::MAGIC) {
+            error(_("not a column file"));
+        }
+
+        uint32_t version, order, encoding, compression;
+        std::memcpy(&version, m_begin + 8, sizeof(version));
+        std::memcpy(&order, m_begin + 12, sizeof(order));
+        std::memcpy(&encoding, m_begin + 16, sizeof(encoding));
+        std::memcpy(&compression, m_begin + 20, sizeof(compression));
+        if (order != ColumnWriter::ORDER_MARK) {
+            error(_("bad byte order"));
+        }
+        if (version != 2 and version != ColumnWriter::VERSION) {
+            error(_("unknown version"));
+        }
+        m_version = version;
+        if (encoding > ColumnWriter::GORILLA or
+            compression > ColumnWriter::ZSTD) {
+            error(_("unknown encoding or compression"));
+        }
+        m_encoding = static_cast < ColumnWriter::Encoding >(encoding);
+        m_compression = static_cast < ColumnWriter::Compression >(
+            compression);
+        if (word(m_size - 8) != ColumnWriter::MAGIC_END) {
+            error(_("incomplete file"));
+        }
+
+        readFooter(word(m_size - 16));
+    }
+
+    const std::string& name(std::size_t column) const
+    {
+        checkColumn(column);
+        return m_names[column];
+    }
+
+    const Chunk& chunk(std::size_t chunk) const
+    {
+        if (chunk >= m_chunks.size()) {
+            throw utils::ArgError(fmt(
+                    _("ColumnReader: no chunk %1% in `%2%'")) % chunk %
+                m_filename);
+        }
+        return m_chunks[chunk];
+    }
+
+    /**
+     * Get a stream of a chunk, the times for the @e index 0 and the cells
+     * of the column @e index - 1 otherwise. The chunk is decompressed and
+     * the stream decoded on the first access.
+     */
+    const char* stream(std::size_t chunk, std::size_t index, bool integers)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        Chunk& c(m_chunks[chunk]);
+        const char* streams = c.stored;
+
+        if (m_compression != ColumnWriter::NONE) {
+            if (c.streams.empty() and c.size > 0) {
+                c.streams.resize(c.size);
+                if (not decompress(c.stored, c.storedSize, &c.streams[0],
+                                   c.size)) {
+                    c.streams.clear();
+                    error(_("corrupted chunk"));
+                }
+            }
+            streams = c.streams.empty() ? 0 : &c.streams[0];
+        }
+
+        if (m_encoding == ColumnWriter::PLAIN) {
+            return streams + c.offsets[index];
+        }
+
+        if (c.decoded.empty()) {
+            c.decoded.resize(c.offsets.size() - 1);
+        }
+
+        std::vector < char >& decoded(c.decoded[index]);
+        if (decoded.empty() and c.rows > 0) {
+            decoded.resize(c.rows * 8);
+
+            const char* data = streams + c.offsets[index];
+            std::size_t size = c.offsets[index + 1] - c.offsets[index];
+            bool success = integers ?
+                varintDecode(data, size,
+                             reinterpret_cast < int64_t* >(&decoded[0]),
+                             c.rows) :
+                xorDecode(data, size, index == 0,
+                          reinterpret_cast < double* >(&decoded[0]),
+                          c.rows);
+
+            if (not success) {
+                decoded.clear();
+                error(_("corrupted chunk"));
+            }
+        }
+
+        return decoded.empty() ? 0 : &decoded[0];
+    }
+
+    void release(std::size_t chunk)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        Chunk& c(m_chunks[chunk]);
+        std::vector < char >().swap(c.streams);
+        std::vector < std::vector < char > >().swap(c.decoded);
+    }
+
+    /**
+     * Get the header of a column in a chunk, 0 if the column is created
+     * after the chunk.
+     */
+    const ColumnHeader* header(std::size_t chunk, std::size_t column) const
+    {
+        const Chunk& c(this->chunk(chunk));
+        checkColumn(column);
+
+        return column < c.columns.size() ? c.columns[column] : 0;
+    }
+
+    void checkColumn(std::size_t column) const
+    {
+        if (column >= m_names.size()) {
+            throw utils::ArgError(fmt(
+                    _("ColumnReader: no column %1% in `%2%'")) % column %
+                m_filename);
+        }
+    }
+
+    std::string                           m_filename;
+    boost::interprocess::mapped_region    m_region;
+    const char*                           m_begin;
+    std::size_t                           m_size;
+    std::size_t                           m_rows;
+    uint32_t                              m_version;
+    std::vector < Chunk >                 m_chunks;
+    std::vector < std::string >           m_names;
+    std::map < std::string, std::size_t > m_index;
+    ColumnWriter::Encoding                m_encoding;
+    ColumnWriter::Compression             m_compression;
+    boost::mutex                          m_mutex; ///< the decoded streams.
+
+private:
+    void error(const std::string& message) const
+    {
+        throw utils::FileError(fmt(_("ColumnReader: `%1%': %2%")) %
+                               m_filename % message);
+    }
+
+    uint64_t word(uint64_t offset) const
+    {
+        if (offset % 8 != 0 or offset > m_size - 8) {
+            error(_("bad offset"));
+        }
+        return *reinterpret_cast < const uint64_t* >(m_begin + offset);
+    }
+
+    /**
+     * Check that @e size bytes are available at @e offset.
+     */
+    void check(uint64_t offset, uint64_t size) const
+    {
+        if (offset > m_size or size > m_size - offset) {
+            error(_("truncated file"));
+        }
+    }
+
+    /**
+     * Check that @e number elements of @e size bytes are available at @e
+     * offset, @e number is read from the file and can overflow the size of
+     * the elements.
+     */
+    void check(uint64_t offset, uint64_t number, uint64_t size) const
+    {
+        if (offset > m_size or number > (m_size - offset) / size) {
+            error(_("truncated file"));
+        }
+    }
+
+    void readFooter(uint64_t offset)
+    {
+        uint64_t chunks = word(offset);
+        check(offset + 8, chunks, 8);
+        m_chunks.resize(chunks);
+
+        for (uint64_t i = 0; i < chunks; ++i) {
+            readChunk(m_chunks[i], word(offset + 8 + i * 8));
+            m_rows += m_chunks[i].rows;
+        }
+
+        offset += 8 + chunks * 8;
+        uint64_t columns = word(offset);
+        offset += 8;
+
+        for (uint64_t i = 0; i < columns; ++i) {
+            uint64_t length = word(offset);
+            check(offset + 8, length);
+
+            m_names.push_back(std::string(m_begin + offset + 8, length));
+            m_index[m_names.back()] = i;
+            offset += 8 + (length + 7) / 8 * 8;
+        }
+
+        for (std::size_t i = 0; i < m_chunks.size(); ++i) {
+            if (m_chunks[i].columns.size() > m_names.size()) {
+                error(_("bad number of columns"));
+            }
+        }
+    }
+
+    void readChunk(Chunk& chunk, uint64_t offset)
+    {
+        uint64_t rows = word(offset);
+        uint64_t columns = word(offset + 8);
+
+        if (rows > std::numeric_limits < std::size_t >::max() / 8) {
+            error(_("bad number of rows"));
+        }
+
+        chunk.rows = rows;
+        offset += 32;
+        check(offset, columns, sizeof(ColumnHeader));
+
+        for (uint64_t i = 0; i < columns; ++i) {
+            chunk.columns.push_back(
+                reinterpret_cast < const ColumnHeader* >(m_begin + offset));
+            offset += sizeof(ColumnHeader);
+        }
+
+        check(offset, columns + 1, 8);
+        chunk.offsets.push_back(0);
+        for (uint64_t i = 0; i <= columns; ++i) {
+            uint64_t size = word(offset);
+            if (m_encoding == ColumnWriter::PLAIN and
+                (size % 8 != 0 or size / 8 != rows)) {
+                error(_("bad size of stream"));
+            }
+            chunk.offsets.push_back(chunk.offsets.back() + size);
+            offset += 8;
+        }
+
+        chunk.size = word(offset);
+        chunk.storedSize = word(offset + 8);
+        offset += 16;
+        check(offset, chunk.storedSize);
+        chunk.stored = m_begin + offset;
+
+        if (chunk.offsets.back() != chunk.size or
+            (m_compression == ColumnWriter::NONE and
+             chunk.storedSize != chunk.size)) {
+            error(_("bad size of chunk"));
+        }
+    }
+};
+
+/*
+ * The oov::ColumnReader source.
+ */
+
+ColumnReader::ColumnReader(const std::string& filename)
+    : mImpl(new Pimpl(filename))
+{
+}
+
+ColumnReader::~ColumnReader()
+{
+    delete mImpl;
+}
+
+std::size_t ColumnReader::columns() const
+{
+    return mImpl->m_names.size();
+}
+
+const std::string& ColumnReader::name(std::size_t column) const
+{
+    return mImpl->name(column);
+}
+
+std::size_t ColumnReader::column(const std::string& name) const
+{
+    std::map < std::string, std::size_t >::const_iterator it =
+        mImpl->m_index.find(name);
+
+    if (it == mImpl->m_index.end()) {
+        throw utils::ArgError(fmt(
+                _("ColumnReader: no column `%1%' in `%2%'")) % name %
+            mImpl->m_filename);
+    }
+    return it->second;
+}
+
+std::size_t ColumnReader::rows() const
+{
+    return mImpl->m_rows;
+}
+
+std::size_t ColumnReader::chunks() const
+{
+    return mImpl->m_chunks.size();
+}
+
+std::size_t ColumnReader::rows(std::size_t chunk) const
+{
+    return mImpl->chunk(chunk).rows;
+}
+
+const double* ColumnReader::times(std::size_t chunk) const
+{
+    mImpl->chunk(chunk);
+
+    return reinterpret_cast < const double* >(
+        mImpl->stream(chunk, 0, false));
+}
+
+ColumnWriter::Type ColumnReader::type(std::size_t chunk,
+                                      std::size_t column) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    return header and header->type == ColumnWriter::INTEGER ?
+        ColumnWriter::INTEGER : ColumnWriter::DOUBLE;
+}
+
+std::size_t ColumnReader::count(std::size_t chunk, std::size_t column) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    return header ? header->count : 0;
+}
+
+bool ColumnReader::range(std::size_t chunk, std::size_t column, double* min,
+                         double* max) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    if (not header or header->count == 0) {
+        return false;
+    }
+
+    if (header->type == ColumnWriter::INTEGER and mImpl->m_version > 2) {
+        *min = static_cast < double >(header->min.integer);
+        *max = static_cast < double >(header->max.integer);
+    } else {
+        *min = header->min.real;
+        *max = header->max.real;
+    }
+    return true;
+}
+
+bool ColumnReader::range(std::size_t chunk, std::size_t column,
+                         int64_t* min, int64_t* max) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    if (not header or header->count == 0 or
+        header->type != ColumnWriter::INTEGER) {
+        return false;
+    }
+
+    if (mImpl->m_version > 2) {
+        *min = header->min.integer;
+        *max = header->max.integer;
+    } else {
+        *min = static_cast < int64_t >(header->min.real);
+        *max = static_cast < int64_t >(header->max.real);
+    }
+    return true;
+}
+
+const double* ColumnReader::doubles(std::size_t chunk,
+                                    std::size_t column) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    if (not header or header->type != ColumnWriter::DOUBLE) {
+        return 0;
+    }
+    return reinterpret_cast < const double* >(
+        mImpl->stream(chunk, column + 1, false));
+}
+
+const int64_t* ColumnReader::integers(std::size_t chunk,
+                                      std::size_t column) const
+{
+    const Pimpl::ColumnHeader* header = mImpl->header(chunk, column);
+
+    if (not header or header->type != ColumnWriter::INTEGER) {
+        return 0;
+    }
+    return reinterpret_cast < const int64_t* >(
+        mImpl->stream(chunk, column + 1, true));
+}
+
+void ColumnReader::release(std::size_t chunk) const
+{
+    mImpl->chunk(chunk);
+    mImpl->release(chunk);
+}
+
+ColumnWriter::Encoding ColumnReader::encoding() const
+{
+    return mImpl->m_encoding;
+}
+
+ColumnWriter::Compression ColumnReader::compression() const
+{
+    return mImpl->m_compression;
+}
+
+void ColumnReader::readTimes(std::vector < double >& times) const
+{
+    times.clear();
+    times.reserve(mImpl->m_rows);
+
+    for (std::size_t c = 0; c < mImpl->m_chunks.size(); ++c) {
+        const double* values = this->times(c);
+        times.insert(times.end(), values, values + mImpl->m_chunks[c].rows);
+    }
+}
+
+void ColumnReader::readColumn(std::size_t column,
+                              std::vector < double >& values) const
+{
+    mImpl->checkColumn(column);
+    values.clear();
+    values.reserve(mImpl->m_rows);
+
+    for (std::size_t c = 0; c < mImpl->m_chunks.size(); ++c) {
+        std::size_t rows = mImpl->m_chunks[c].rows;
+
+        if (const double* reals = doubles(c, column)) {
+            values.insert(values.end(), reals, reals + rows);
+        } else if (const int64_t* ints = integers(c, column)) {
+            for (std::size_t r = 0; r < rows; ++r) {
+                values.push_back(ints[r] == ColumnWriter::MISSING ?
+                                 std::numeric_limits < double >::quiet_NaN()
+                                 : static_cast < double >(ints[r]));
+            }
+        } else {
+            values.insert(values.end(), rows,
+                          std::numeric_limits < double >::quiet_NaN());
+        }
+    }
+}
+
+}} // namespace vle oov
@@ -0,0 +1,209 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_OOV_COLUMNREADER_HPP
+#define VLE_OOV_COLUMNREADER_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/oov/ColumnWriter.hpp>
+#include <vle/utils/Types.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace oov {
+
+/**
+ * @brief Read a file of the oov::ColumnWriter plug-in. The file is mapped
+ * in memory: the times and the cells of a column in a chunk are returned
+ * as pointers into the file, without copy or parsing. A column can be
+ * scanned chunk by chunk and the chunks out of a range of values skipped
+ * with range().
+ *
+ * The chunks of a file written with the gorilla encoding or with a
+ * compression are decoded on the fly: a chunk is decompressed and a
+ * stream decoded on its first access, the decoded streams are kept until
+ * release() or the destruction of the reader. The decoding is guarded by
+ * a mutex of the reader: several threads can read the same reader, but
+ * release() invalidates the pointers returned to all the threads.
+ * @code
+ * vle::oov::ColumnReader reader("exp_view.vlec");
+ * std::size_t col = reader.column("top:model.port");
+ *
+ * for (std::size_t c = 0; c < reader.chunks(); ++c) {
+ *     double min, max;
+ *     if (reader.range(c, col, &min, &max) and max > threshold) {
+ *         const double* values = reader.doubles(c, col);
+ *         ...
+ *     }
+ * }
+ * @endcode
+ */
+class VLE_API ColumnReader
+{
+public:
+    /**
+     * @brief Map the file in memory and read its footer.
+     * @param filename the file written by the oov::ColumnWriter.
+     * @throw utils::FileError if the file cannot be mapped or is not a
+     * complete file of the oov::ColumnWriter.
+     */
+    ColumnReader(const std::string& filename);
+
+    ~ColumnReader();
+
+    /**
+     * @brief Get the number of columns, the time is not a column.
+     */
+    std::size_t columns() const;
+
+    /**
+     * @brief Get the name (parent:simulator.port) of a column.
+     * @throw utils::ArgError if the column does not exist.
+     */
+    const std::string& name(std::size_t column) const;
+
+    /**
+     * @brief Get the index of a column.
+     * @param name the name of the column (parent:simulator.port).
+     * @throw utils::ArgError if the column does not exist.
+     */
+    std::size_t column(const std::string& name) const;
+
+    /**
+     * @brief Get the number of rows of the file.
+     */
+    std::size_t rows() const;
+
+    /**
+     * @brief Get the number of chunks of the file.
+     */
+    std::size_t chunks() const;
+
+    /**
+     * @brief Get the number of rows of a chunk.
+     * @throw utils::ArgError if the chunk does not exist.
+     */
+    std::size_t rows(std::size_t chunk) const;
+
+    /**
+     * @brief Get the times of the rows of a chunk.
+     * @throw utils::ArgError if the chunk does not exist.
+     * @throw utils::FileError if the chunk is corrupted.
+     */
+    const double* times(std::size_t chunk) const;
+
+    /**
+     * @brief Get the type of a column in a chunk.
+     * @return The type, DOUBLE if the column is created after the chunk.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     */
+    ColumnWriter::Type type(std::size_t chunk, std::size_t column) const;
+
+    /**
+     * @brief Get the number of values of a column in a chunk.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     */
+    std::size_t count(std::size_t chunk, std::size_t column) const;
+
+    /**
+     * @brief Get the minimal and the maximal value of a column in a chunk.
+     * @return false if the column has no value in the chunk.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     */
+    bool range(std::size_t chunk, std::size_t column, double* min,
+               double* max) const;
+
+    /**
+     * @brief Get the exact minimal and maximal value of an INTEGER column
+     * in a chunk.
+     * @return false if the column is not INTEGER or has no value in the
+     * chunk.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     */
+    bool range(std::size_t chunk, std::size_t column, int64_t* min,
+               int64_t* max) const;
+
+    /**
+     * @brief Get the cells of a DOUBLE column in a chunk.
+     * @return The rows(chunk) cells or 0 if the column is not DOUBLE or
+     * is created after the chunk.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     * @throw utils::FileError if the chunk is corrupted.
+     */
+    const double* doubles(std::size_t chunk, std::size_t column) const;
+
+    /**
+     * @brief Get the cells of an INTEGER column in a chunk.
+     * @return The rows(chunk) cells or 0 if the column is not INTEGER.
+     * @throw utils::ArgError if the chunk or the column does not exist.
+     * @throw utils::FileError if the chunk is corrupted.
+     */
+    const int64_t* integers(std::size_t chunk, std::size_t column) const;
+
+    /**
+     * @brief Release the decoded streams of a chunk, the pointers on its
+     * times and cells are invalid if the file is encoded or compressed.
+     * @throw utils::ArgError if the chunk does not exist.
+     */
+    void release(std::size_t chunk) const;
+
+    /**
+     * @brief Get the encoding of the chunks of the file.
+     */
+    ColumnWriter::Encoding encoding() const;
+
+    /**
+     * @brief Get the compression of the chunks of the file.
+     */
+    ColumnWriter::Compression compression() const;
+
+    /**
+     * @brief Copy the times of all the rows.
+     * @param times the output vector.
+     */
+    void readTimes(std::vector < double >& times) const;
+
+    /**
+     * @brief Copy the cells of a column for all the rows, a missing value
+     * is NaN.
+     * @param column the index of the column.
+     * @param values the output vector.
+     * @throw utils::ArgError if the column does not exist.
+     */
+    void readColumn(std::size_t column, std::vector < double >& values) const;
+
+private:
+    ColumnReader(const ColumnReader& other);
+    ColumnReader& operator=(const ColumnReader& other);
+
+    class Pimpl;
+    Pimpl* mImpl;
+};
+
+}} // namespace vle oov
+
+#endif
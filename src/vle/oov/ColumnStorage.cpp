@@ -0,0 +1,151 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/oov/ColumnStorage.hpp>
+#include <vle/value/Matrix.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+
+namespace vle { namespace oov {
+
+ColumnStorage::ColumnStorage(const std::string& location)
+    : ColumnPlugin(location)
+{
+    m_matrix.addColumn(value::ColumnMatrix::DOUBLE_COLUMN, "time");
+    m_typed.push_back(true);
+}
+
+ColumnStorage::~ColumnStorage()
+{
+}
+
+value::Matrix * ColumnStorage::matrix() const
+{
+    return m_matrix.buildMatrix();
+}
+
+value::ColumnMatrix * ColumnStorage::columnMatrix() const
+{
+    return new value::ColumnMatrix(m_matrix);
+}
+
+void ColumnStorage::onParameter(const std::string& /* plugin */,
+                                const std::string& /* location */,
+                                const std::string& /* file */,
+                                value::Value* parameters,
+                                const double& /* time */)
+{
+    delete parameters;
+}
+
+void ColumnStorage::onValues(const std::string& /* view */,
+                             const double& time,
+                             const double* values,
+                             std::size_t size)
+{
+    const std::vector < std::size_t >& columns(cells());
+    std::size_t last = row(time);
+
+    for (std::size_t i = 0; i < size and i < columns.size(); ++i) {
+        if (not (boost::math::isnan)(values[i]) and
+            present(columns[i], last)) {
+            last = newRow(time);
+            break;
+        }
+    }
+
+    for (std::size_t i = 0; i < size and i < columns.size(); ++i) {
+        if (not (boost::math::isnan)(values[i])) {
+            storeDouble(columns[i], last, values[i]);
+        }
+    }
+}
+
+void ColumnStorage::close(const double& /* time */)
+{
+}
+
+void ColumnStorage::appendColumn(const std::string& name)
+{
+    m_matrix.addColumn(value::ColumnMatrix::DOUBLE_COLUMN, name);
+    m_typed.push_back(false);
+}
+
+std::size_t ColumnStorage::appendRow(const double& time)
+{
+    std::size_t rows = m_matrix.rows();
+
+    m_matrix.addRow();
+    m_matrix.addDouble(0, rows, time);
+
+    return rows;
+}
+
+bool ColumnStorage::present(std::size_t column, std::size_t row) const
+{
+    return not m_matrix.isNull(column + 1, row);
+}
+
+// The first value gives the type of the column, a double changes a column
+// of integer or of boolean into a column of double. The column 0 of the
+// matrix is the time.
+
+void ColumnStorage::storeDouble(std::size_t column, std::size_t row,
+                                double value)
+{
+    m_matrix.setType(column + 1, value::ColumnMatrix::DOUBLE_COLUMN);
+    m_typed[column + 1] = true;
+    m_matrix.addDouble(column + 1, row, value);
+}
+
+void ColumnStorage::storeInteger(std::size_t column, std::size_t row,
+                                 int32_t value)
+{
+    if (not m_typed[column + 1] or m_matrix.type(column + 1) ==
+        value::ColumnMatrix::BOOLEAN_COLUMN) {
+        m_matrix.setType(column + 1, value::ColumnMatrix::INTEGER_COLUMN);
+        m_typed[column + 1] = true;
+    }
+    m_matrix.addInt(column + 1, row, value);
+}
+
+void ColumnStorage::storeBoolean(std::size_t column, std::size_t row,
+                                 bool value)
+{
+    if (not m_typed[column + 1]) {
+        m_matrix.setType(column + 1, value::ColumnMatrix::BOOLEAN_COLUMN);
+        m_typed[column + 1] = true;
+    }
+
+    if (m_matrix.type(column + 1) == value::ColumnMatrix::BOOLEAN_COLUMN) {
+        m_matrix.addBoolean(column + 1, row, value);
+    } else {
+        m_matrix.addInt(column + 1, row, value);
+    }
+}
+
+}} // namespace vle oov
@@ -0,0 +1,118 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_OOV_COLUMNSTORAGE_HPP
+#define VLE_OOV_COLUMNSTORAGE_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/oov/ColumnPlugin.hpp>
+#include <vle/value/ColumnMatrix.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace oov {
+
+/**
+ * @brief The ColumnStorage is the output plug-in "columnstorage" provided
+ * by vle: it stores the observations of a view in memory into a
+ * value::ColumnMatrix, the result of the simulation.
+ *
+ * The first column is the time, the other columns are the observable
+ * ports (parent:simulator.port), a row stores the observations of a date.
+ * A column is a column of double if it receives a value::Double, a column
+ * of integer or of boolean if it receives only value::Integer or
+ * value::Boolean. A cell is never overwritten: an observation of a column
+ * which already has a value at this date starts a new row with the same
+ * time.
+ */
+class VLE_API ColumnStorage : public ColumnPlugin
+{
+public:
+    ColumnStorage(const std::string& location);
+
+    virtual ~ColumnStorage();
+
+    virtual std::string name() const
+    { return "columnstorage"; }
+
+    /**
+     * @brief Build the value::Matrix of the observations.
+     * @return A new value::Matrix with the names of the columns in the
+     * first row.
+     */
+    virtual value::Matrix * matrix() const;
+
+    /**
+     * @brief Copy the value::ColumnMatrix of the observations.
+     * @return A new value::ColumnMatrix.
+     */
+    virtual value::ColumnMatrix * columnMatrix() const;
+
+    virtual void onParameter(const std::string& plugin,
+                             const std::string& location,
+                             const std::string& file,
+                             value::Value* parameters,
+                             const double& time);
+
+    /**
+     * @brief Store the row of numeric observations in the row of the
+     * time, the NaN cells are null.
+     */
+    virtual void onValues(const std::string& view,
+                          const double& time,
+                          const double* row,
+                          std::size_t size);
+
+    virtual void close(const double& time);
+
+private:
+    ColumnStorage(const ColumnStorage& other);
+    ColumnStorage& operator=(const ColumnStorage& other);
+
+    value::ColumnMatrix               m_matrix;
+    std::vector < bool >              m_typed; ///< a value gives the type.
+
+    virtual void appendColumn(const std::string& name);
+
+    virtual std::size_t appendRow(const double& time);
+
+    virtual bool present(std::size_t column, std::size_t row) const;
+
+    virtual void storeDouble(std::size_t column, std::size_t row,
+                             double value);
+
+    virtual void storeInteger(std::size_t column, std::size_t row,
+                              int32_t value);
+
+    virtual void storeBoolean(std::size_t column, std::size_t row,
+                              bool value);
+};
+
+}} // namespace vle oov
+
+#endif
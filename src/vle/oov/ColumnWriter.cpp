@@ -0,0 +1,428 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/oov/ColumnWriter.hpp>
+#include <vle/oov/ColumnCodec.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/Path.hpp>
+#include <vle/utils/i18n.hpp>
+#include <vle/value/Map.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace vle { namespace oov {
+
+const uint32_t ColumnWriter::VERSION;
+const uint32_t ColumnWriter::ORDER_MARK;
+const uint64_t ColumnWriter::MAGIC;
+const uint64_t ColumnWriter::MAGIC_END;
+const int64_t ColumnWriter::MISSING;
+
+ColumnWriter::ColumnWriter(const std::string& location)
+    : ColumnPlugin(location), m_position(0), m_chunkRows(4096),
+    m_encoding(PLAIN), m_compression(NONE)
+{
+}
+
+ColumnWriter::~ColumnWriter()
+{
+}
+
+void ColumnWriter::onParameter(const std::string& /* plugin */,
+                               const std::string& location,
+                               const std::string& file,
+                               value::Value* parameters,
+                               const double& /* time */)
+{
+    if (parameters and parameters->isMap()) {
+        const value::Map& map(parameters->toMap());
+
+        if (map.exist("rows")) {
+            int rows = map.getInt("rows");
+            if (rows <= 0) {
+                delete parameters;
+                throw utils::ArgError(fmt(
+                        _("Oov column: bad number of rows by chunk %1%")) %
+                    rows);
+            }
+            m_chunkRows = rows;
+        }
+
+        try {
+            if (map.exist("encoding")) {
+                m_encoding = toEncoding(map.getString("encoding"));
+            }
+            if (map.exist("compression")) {
+                m_compression = toCompression(map.getString("compression"));
+            }
+        } catch (...) {
+            delete parameters;
+            throw;
+        }
+    }
+    delete parameters;
+
+    m_filename = location.empty() ? file + ".vlec" :
+        utils::Path::buildFilename(location, file + ".vlec");
+
+    m_file.open(m_filename.c_str(), std::ios::out | std::ios::binary |
+                std::ios::trunc);
+    if (not m_file.is_open()) {
+        throw utils::FileError(fmt(
+                _("Oov column: cannot open the file `%1%'")) % m_filename);
+    }
+
+    write(MAGIC);
+    write(VERSION);
+    write(ORDER_MARK);
+    write(static_cast < uint32_t >(m_encoding));
+    write(static_cast < uint32_t >(m_compression));
+}
+
+void ColumnWriter::onValues(const std::string& /* view */,
+                            const double& time,
+                            const double* values,
+                            std::size_t size)
+{
+    const std::vector < std::size_t >& columns(cells());
+    std::size_t last = row(time);
+
+    for (std::size_t i = 0; i < size and i < columns.size(); ++i) {
+        if (not (boost::math::isnan)(values[i]) and
+            m_columns[columns[i]].present[last]) {
+            last = newRow(time);
+            break;
+        }
+    }
+
+    for (std::size_t i = 0; i < size and i < columns.size(); ++i) {
+        if (not (boost::math::isnan)(values[i])) {
+            Column& col(m_columns[columns[i]]);
+            col.reals[last] = values[i];
+            col.present[last] = true;
+            col.doubles = true;
+        }
+    }
+}
+
+void ColumnWriter::close(const double& /* time */)
+{
+    if (not m_times.empty()) {
+        writeChunk();
+    }
+
+    uint64_t footer = m_position;
+
+    write(static_cast < uint64_t >(m_chunks.size()));
+    for (std::size_t i = 0; i < m_chunks.size(); ++i) {
+        write(m_chunks[i]);
+    }
+
+    write(static_cast < uint64_t >(names().size()));
+    for (std::size_t i = 0; i < names().size(); ++i) {
+        const std::string& name(names()[i]);
+        std::size_t padding = (8 - name.size() % 8) % 8;
+        const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        write(static_cast < uint64_t >(name.size()));
+        write(name.data(), name.size());
+        write(zeros, padding);
+    }
+
+    write(footer);
+    write(MAGIC_END);
+
+    m_file.close();
+    if (m_file.fail()) {
+        throw utils::FileError(fmt(
+                _("Oov column: cannot write the file `%1%'")) % m_filename);
+    }
+}
+
+void ColumnWriter::appendColumn(const std::string& /* name */)
+{
+    m_columns.push_back(Column());
+
+    Column& col(m_columns.back());
+    col.reals.resize(m_times.size(),
+                     std::numeric_limits < double >::quiet_NaN());
+    col.integers.resize(m_times.size(), MISSING);
+    col.present.resize(m_times.size(), false);
+}
+
+std::size_t ColumnWriter::appendRow(const double& time)
+{
+    if (m_times.size() == m_chunkRows) {
+        writeChunk();
+    }
+
+    m_times.push_back(time);
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        m_columns[i].reals.push_back(
+            std::numeric_limits < double >::quiet_NaN());
+        m_columns[i].integers.push_back(MISSING);
+        m_columns[i].present.push_back(false);
+    }
+
+    return m_times.size() - 1;
+}
+
+void ColumnWriter::storeDouble(std::size_t column, std::size_t row,
+                               double value)
+{
+    Column& col(m_columns[column]);
+
+    col.reals[row] = value;
+    col.present[row] = true;
+    col.doubles = true;
+}
+
+void ColumnWriter::storeInteger(std::size_t column, std::size_t row,
+                                int32_t value)
+{
+    Column& col(m_columns[column]);
+
+    col.integers[row] = value;
+    col.reals[row] = value;
+    col.present[row] = true;
+}
+
+void ColumnWriter::storeBoolean(std::size_t column, std::size_t row,
+                                bool value)
+{
+    storeInteger(column, row, value);
+}
+
+void ColumnWriter::writeChunk()
+{
+    std::size_t rows = m_times.size();
+
+    m_chunks.push_back(m_position);
+
+    write(static_cast < uint64_t >(rows));
+    write(static_cast < uint64_t >(m_columns.size()));
+    write(*std::min_element(m_times.begin(), m_times.end()));
+    write(*std::max_element(m_times.begin(), m_times.end()));
+
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        Column& col(m_columns[i]);
+        uint32_t count = 0;
+        double min = std::numeric_limits < double >::quiet_NaN();
+        double max = min;
+        int64_t imin = 0, imax = 0;
+
+        for (std::size_t r = 0; r < col.present.size(); ++r) {
+            if (col.present[r]) {
+                if (count == 0 or col.reals[r] < min) {
+                    min = col.reals[r];
+                }
+                if (count == 0 or col.reals[r] > max) {
+                    max = col.reals[r];
+                }
+                if (count == 0 or col.integers[r] < imin) {
+                    imin = col.integers[r];
+                }
+                if (count == 0 or col.integers[r] > imax) {
+                    imax = col.integers[r];
+                }
+                ++count;
+            }
+        }
+
+        if (count == 0) {
+            col.doubles = true;
+        }
+
+        // The statistics of an INTEGER column are exact int64, the
+        // doubles lose the precision above 2^53.
+        if (col.doubles) {
+            write(static_cast < uint32_t >(DOUBLE));
+            write(count);
+            write(min);
+            write(max);
+        } else {
+            write(static_cast < uint32_t >(INTEGER));
+            write(count);
+            write(imin);
+            write(imax);
+        }
+    }
+
+    m_sizes.clear();
+    m_streams.clear();
+    encode(&m_times[0], true);
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        if (m_columns[i].doubles) {
+            encode(&m_columns[i].reals[0], false);
+        } else {
+            encode(&m_columns[i].integers[0]);
+        }
+    }
+
+    write(&m_sizes[0], m_sizes.size() * sizeof(uint64_t));
+
+    if (m_encoding == PLAIN and m_compression == NONE) {
+        // The plain streams are written without copy.
+        uint64_t size = (m_columns.size() + 1) * rows * 8;
+
+        write(size);
+        write(size);
+        write(&m_times[0], rows * sizeof(double));
+        for (std::size_t i = 0; i < m_columns.size(); ++i) {
+            if (m_columns[i].doubles) {
+                write(&m_columns[i].reals[0], rows * sizeof(double));
+            } else {
+                write(&m_columns[i].integers[0], rows * sizeof(int64_t));
+            }
+        }
+    } else {
+        const std::vector < char >* stored = &m_streams;
+
+        if (m_compression != NONE) {
+            compress(m_compression, &m_streams[0], m_streams.size(),
+                     m_compressed);
+            stored = &m_compressed;
+        }
+
+        std::size_t padding = (8 - stored->size() % 8) % 8;
+        const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        write(static_cast < uint64_t >(m_streams.size()));
+        write(static_cast < uint64_t >(stored->size()));
+        write(&(*stored)[0], stored->size());
+        write(zeros, padding);
+    }
+
+    for (std::size_t i = 0; i < m_columns.size(); ++i) {
+        Column& col(m_columns[i]);
+        col.reals.clear();
+        col.integers.clear();
+        col.present.clear();
+        col.doubles = false;
+    }
+
+    m_times.clear();
+}
+
+void ColumnWriter::encode(const double* values, bool delta)
+{
+    std::size_t rows = m_times.size();
+
+    if (m_encoding == GORILLA) {
+        std::size_t size = m_streams.size();
+        xorEncode(values, rows, delta, m_streams);
+        m_sizes.push_back(m_streams.size() - size);
+    } else {
+        if (m_compression != NONE) {
+            const char* data = reinterpret_cast < const char* >(values);
+            m_streams.insert(m_streams.end(), data, data + rows * 8);
+        }
+        m_sizes.push_back(rows * 8);
+    }
+}
+
+void ColumnWriter::encode(const int64_t* values)
+{
+    std::size_t rows = m_times.size();
+
+    if (m_encoding == GORILLA) {
+        std::size_t size = m_streams.size();
+        varintEncode(values, rows, m_streams);
+        m_sizes.push_back(m_streams.size() - size);
+    } else {
+        if (m_compression != NONE) {
+            const char* data = reinterpret_cast < const char* >(values);
+            m_streams.insert(m_streams.end(), data, data + rows * 8);
+        }
+        m_sizes.push_back(rows * 8);
+    }
+}
+
+void ColumnWriter::write(const void* data, std::size_t size)
+{
+    m_file.write(static_cast < const char* >(data), size);
+    if (m_file.fail()) {
+        throw utils::FileError(fmt(
+                _("Oov column: cannot write the file `%1%'")) % m_filename);
+    }
+    m_position += size;
+}
+
+std::string ColumnWriter::encodingName(Encoding encoding)
+{
+    return encoding == GORILLA ? "gorilla" : "plain";
+}
+
+ColumnWriter::Encoding ColumnWriter::toEncoding(const std::string& name)
+{
+    if (name == "plain") {
+        return PLAIN;
+    } else if (name == "gorilla") {
+        return GORILLA;
+    }
+
+    throw utils::ArgError(fmt(_("Oov column: unknown encoding `%1%'")) %
+                          name);
+}
+
+std::string ColumnWriter::compressionName(Compression compression)
+{
+    switch (compression) {
+    case GZIP:
+        return "gzip";
+    case BZIP2:
+        return "bzip2";
+    case XZ:
+        return "xz";
+    case ZSTD:
+        return "zstd";
+    default:
+        return "none";
+    }
+}
+
+ColumnWriter::Compression ColumnWriter::toCompression(
+    const std::string& name)
+{
+    if (name == "none") {
+        return NONE;
+    } else if (name == "gzip") {
+        return GZIP;
+    } else if (name == "bzip2") {
+        return BZIP2;
+    } else if (name == "xz") {
+        return XZ;
+    } else if (name == "zstd") {
+        return ZSTD;
+    }
+
+    throw utils::ArgError(fmt(_("Oov column: unknown compression `%1%'")) %
+                          name);
+}
+
+}} // namespace vle oov
@@ -0,0 +1,240 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_OOV_COLUMNWRITER_HPP
+#define VLE_OOV_COLUMNWRITER_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/oov/ColumnPlugin.hpp>
+#include <vle/utils/Types.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace vle { namespace oov {
+
+/**
+ * @brief The ColumnWriter is the output plug-in "column" provided by vle:
+ * it writes the observations of a view into the binary file @e
+ * location/file.vlec, read by the oov::ColumnReader.
+ *
+ * A row of the file stores the observations of a date: the time and a
+ * cell for each observable port (parent:simulator.port). The rows are
+ * written by chunks of columns. The parameter of the plug-in, the data of
+ * the vpz::Output, can be a value::Map with:
+ * - the integer "rows": the number of rows of a chunk (4096 by default).
+ * - the string "encoding": "plain" (by default) to store the cells as
+ *   arrays or "gorilla" to store the times and the doubles with the XOR
+ *   encoding of the Gorilla database (the times are predicted by the
+ *   delta of the two previous dates) and the integers with the zigzag
+ *   varint of their delta.
+ * - the string "compression": "none" (by default), "gzip", "bzip2", "xz"
+ *   or "zstd", the libarchive filter applied on the cells of each chunk.
+ *
+ * The file stores native 8 bytes words:
+ * - header: the magic "VLECOL01", the version (uint32), the byte order
+ *   mark 0x01020304 (uint32), the encoding and the compression (uint32).
+ * - chunks: the number of rows and of columns (uint64), the minimal and
+ *   maximal times (double), for each column the type (uint32), the number
+ *   of values (uint32), the minimal and maximal values (double for a
+ *   DOUBLE column, int64 for an INTEGER column since the version 3), then the
+ *   sizes of the encoded streams of the times and of each column
+ *   (uint64[columns + 1]), the size of the streams and the size of the
+ *   stored data (uint64) and the stored data padded to 8 bytes. With the
+ *   plain encoding, the streams are the times (double[rows]) and the
+ *   cells (double or int64[rows]) of each column.
+ * - footer: the number of chunks (uint64), the offsets of the chunks
+ *   (uint64[]), the number of columns (uint64) and, for each column, the
+ *   length of its name (uint64) and the name padded to 8 bytes.
+ * - trailer: the offset of the footer (uint64) and the magic "VLECEND\0".
+ *
+ * A column is INTEGER in a chunk when all its values are value::Integer
+ * or value::Boolean, DOUBLE otherwise. A missing value is NaN in a
+ * DOUBLE column and the minimal int64 in an INTEGER column.
+ *
+ * The observations of a date are stored in one row, but a cell is never
+ * overwritten: an observation of a column which already has a value at
+ * this date starts a new row with the same time.
+ */
+class VLE_API ColumnWriter : public ColumnPlugin
+{
+public:
+    /**
+     * @brief The type of the cells of a column in a chunk.
+     */
+    enum Type { DOUBLE = 0, INTEGER = 1 };
+
+    /**
+     * @brief The encoding of the times and of the cells of the chunks.
+     */
+    enum Encoding { PLAIN = 0, GORILLA = 1 };
+
+    /**
+     * @brief The filter applied on the encoded chunks.
+     */
+    enum Compression { NONE = 0, GZIP = 1, BZIP2 = 2, XZ = 3, ZSTD = 4 };
+
+    static const uint32_t VERSION = 3;
+    static const uint32_t ORDER_MARK = 0x01020304;
+    static const uint64_t MAGIC = 0x31304c4f43454c56ULL;   ///< "VLECOL01"
+    static const uint64_t MAGIC_END = 0x00444e4543454c56ULL; ///< "VLECEND"
+    static const int64_t MISSING = -9223372036854775807LL - 1;
+
+    ColumnWriter(const std::string& location);
+
+    virtual ~ColumnWriter();
+
+    virtual std::string name() const
+    { return "column"; }
+
+    virtual void onParameter(const std::string& plugin,
+                             const std::string& location,
+                             const std::string& file,
+                             value::Value* parameters,
+                             const double& time);
+
+    /**
+     * @brief Store the row of numeric observations in the row of the
+     * time, the NaN cells are missing values.
+     */
+    virtual void onValues(const std::string& view,
+                          const double& time,
+                          const double* row,
+                          std::size_t size);
+
+    /**
+     * @brief Write the last chunk and the footer of the file.
+     */
+    virtual void close(const double& time);
+
+    /**
+     * @brief Get the name of the file written by the plug-in.
+     * @return The file name.
+     */
+    const std::string& filename() const
+    { return m_filename; }
+
+    /**
+     * @brief Get the encoding of the chunks.
+     */
+    Encoding encoding() const
+    { return m_encoding; }
+
+    /**
+     * @brief Get the compression of the chunks.
+     */
+    Compression compression() const
+    { return m_compression; }
+
+    /**
+     * @brief Get a string representation of an encoding.
+     * @return "plain" or "gorilla".
+     */
+    static std::string encodingName(Encoding encoding);
+
+    /**
+     * @brief Get the encoding of a string representation.
+     * @throw utils::ArgError if the name is unknown.
+     */
+    static Encoding toEncoding(const std::string& name);
+
+    /**
+     * @brief Get a string representation of a compression.
+     * @return "none", "gzip", "bzip2", "xz" or "zstd".
+     */
+    static std::string compressionName(Compression compression);
+
+    /**
+     * @brief Get the compression of a string representation.
+     * @throw utils::ArgError if the name is unknown.
+     */
+    static Compression toCompression(const std::string& name);
+
+private:
+    ColumnWriter(const ColumnWriter& other);
+    ColumnWriter& operator=(const ColumnWriter& other);
+
+    /**
+     * The cells of a column in the current chunk.
+     */
+    struct Column
+    {
+        Column()
+            : doubles(false)
+        {}
+
+        std::vector < double >  reals;
+        std::vector < int64_t > integers;
+        std::vector < bool >    present;
+        bool                    doubles;
+    };
+
+    std::string                       m_filename;
+    std::ofstream                     m_file;
+    uint64_t                          m_position;
+    std::size_t                       m_chunkRows;
+    Encoding                          m_encoding;
+    Compression                       m_compression;
+    std::vector < Column >            m_columns;
+    std::vector < double >            m_times;
+    std::vector < uint64_t >          m_chunks;
+    std::vector < uint64_t >          m_sizes; ///< the sizes of the streams.
+    std::vector < char >              m_streams;
+    std::vector < char >              m_compressed;
+
+    virtual void appendColumn(const std::string& name);
+
+    virtual std::size_t appendRow(const double& time);
+
+    virtual bool present(std::size_t column, std::size_t row) const
+    { return m_columns[column].present[row]; }
+
+    virtual void storeDouble(std::size_t column, std::size_t row,
+                             double value);
+
+    virtual void storeInteger(std::size_t column, std::size_t row,
+                              int32_t value);
+
+    virtual void storeBoolean(std::size_t column, std::size_t row,
+                              bool value);
+
+    void writeChunk();
+
+    void encode(const double* values, bool delta);
+
+    void encode(const int64_t* values);
+
+    void write(const void* data, std::size_t size);
+
+    template < typename T >
+    void write(const T& data)
+    { write(&data, sizeof(T)); }
+};
+
+}} // namespace vle oov
+
+#endif
@@ -26,11 +26,24 @@
 
 
 #include <vle/oov/Plugin.hpp>
-
-
+#include <vle/oov/ColumnStorage.hpp>
+#include <vle/oov/ColumnWriter.hpp>
 
 namespace vle { namespace oov {
 
-
+Plugin* buildBuiltinPlugin(const std::string& package,
+                           const std::string& plugin,
+                           const std::string& location)
+{
+    if (package.empty() or package == "vle") {
+        if (plugin == "column") {
+            return new ColumnWriter(location);
+        } else if (plugin == "columnstorage") {
+            return new ColumnStorage(location);
+        }
+    }
+
+    return 0;
+}
 
 }} // namespace vle oov
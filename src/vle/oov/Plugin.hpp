@@ -29,6 +29,7 @@
 #define VLE_OOV_PLUGIN_HPP
 
 #include <vle/DllDefines.hpp>
+#include <vle/value/ColumnMatrix.hpp>
 #include <vle/value/Matrix.hpp>
 #include <vle/version.hpp>
 #include <boost/shared_ptr.hpp>
@@ -111,6 +112,23 @@ public:
         return 0;
     }
 
+    /**
+     * Return a pointer to the \c value::ColumnMatrix.
+     *
+     * If the plug-in does not manage \c value::ColumnMatrix, this function
+     * returns NULL otherwise, this function return the \c
+     * value::ColumnMatrix manager by the plug-in. The results of a
+     * simulation use the \c value::ColumnMatrix of a plug-in before its
+     * \c value::Matrix.
+     *
+     * @attention You are in charge of freeing the value::ColumnMatrix
+     * after the end of the simulation.
+     */
+    virtual value::ColumnMatrix * columnMatrix() const
+    {
+        return 0;
+    }
+
     /**
      * Get the name of the Plugin class.
      *
@@ -178,6 +196,78 @@ public:
                          const double& time,
                          value::Value* value) = 0;
 
+    /**
+     * By default, a plugin receives the numeric observations by onValue().
+     *
+     * @return false, true if the plugin receives the numeric observations
+     * of a view by rows with onValues().
+     */
+    virtual bool acceptValues() const
+    {
+        return false;
+    }
+
+    /**
+     * By default, a plugin receives the observations by onValue(), one
+     * call by observable.
+     *
+     * @return false, true if the plugin receives all the observations of a
+     * view at a date with one call of onValueBatch().
+     */
+    virtual bool acceptValueBatch() const
+    {
+        return false;
+    }
+
+    /**
+     * Call, for a plugin which accepts the rows of values or the batches
+     * of values, when an observable is attached to a view: its
+     * observations are the cell @e column of the rows of onValues() or of
+     * the batches of onValueBatch(). The column of an observable does not
+     * change until the end of the simulation. By default, call
+     * onNewObservable().
+     */
+    virtual void onNewColumn(const std::string& simulator,
+                             const std::string& parent,
+                             const std::string& port,
+                             const std::string& view,
+                             const double& time,
+                             std::size_t /* column */)
+    {
+        onNewObservable(simulator, parent, port, view, time);
+    }
+
+    /**
+     * Call, for a plugin which accepts the rows of values, at each
+     * observation of a view with numeric observables: the cell of an
+     * observable deleted from the view is NaN. The row is valid during the
+     * call only.
+     */
+    virtual void onValues(const std::string& /* view */,
+                          const double& /* time */,
+                          const double* /* row */,
+                          std::size_t /* size */)
+    {
+    }
+
+    /**
+     * Call, for a plugin which accepts the batches of values, at each
+     * observation of a view: the cell @e column of @e values is the
+     * observation of the observable of this column. A cell is NULL for an
+     * observable deleted from the view or observed by onValues(). The
+     * plugin is in charge of deleting the values of the cells, the array
+     * is valid during the call only. By default, delete the values.
+     */
+    virtual void onValueBatch(const std::string& /* view */,
+                              const double& /* time */,
+                              value::Value** values,
+                              std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            delete values[i];
+        }
+    }
+
     /**
      * Call when the simulation is finished.
      */
@@ -214,6 +304,20 @@ typedef boost::shared_ptr < Plugin > PluginPtr;
  */
 typedef Plugin* (*OovPluginSlot)(const std::string&);
 
+/**
+ * Build an output plug-in provided by the vle library, selected by a
+ * vpz::Output without package or with the package "vle": the plug-in
+ * "column" is the oov::ColumnWriter, the plug-in "columnstorage" is the
+ * oov::ColumnStorage.
+ * @param package The package of the output.
+ * @param plugin The name of the plug-in.
+ * @param location The location of the output.
+ * @return The new plug-in or NULL if vle does not provide it.
+ */
+VLE_API Plugin* buildBuiltinPlugin(const std::string& package,
+                                   const std::string& plugin,
+                                   const std::string& location);
+
 /**
  * This typedef is used to defined the dictionnary of key view name
  * and oov::PluginPtr.
@@ -49,6 +49,11 @@ void StreamReader::initPlugin(const std::string& plugin,
 {
     void *symbol = 0;
 
+    if (Plugin* builtin = buildBuiltinPlugin(package, plugin, location)) {
+        m_plugin = PluginPtr(builtin);
+        return;
+    }
+
     try {
         symbol = modulemgr.get(package, plugin, utils::MODULE_OOV);
         OovPluginSlot fct(utils::functionCast < OovPluginSlot>(symbol));
@@ -0,0 +1,308 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Measure the write throughput of the oov::ColumnWriter and of a text
+ * writer formatted like the text plug-in of vle.output (a line per date,
+ * a column per observable separated by tabulations), then the time to
+ * scan one column with the oov::ColumnReader.
+ *
+ * The encodings and the compressions of the oov::ColumnWriter are then
+ * compared on the output of a crop model: a daily view of leaf area
+ * indexes, biomasses, temperatures and phenological stages.
+ *
+ * Usage: bench_column [rows] [columns]
+ */
+
+#include <vle/oov/ColumnReader.hpp>
+#include <vle/oov/ColumnWriter.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/utils/Exception.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace vle;
+
+namespace {
+
+/*
+ * A text plug-in: the values of a date are written when the date
+ * changes.
+ */
+class Text : public oov::Plugin
+{
+public:
+    Text()
+        : oov::Plugin(""), m_time(-1.0)
+    {}
+
+    virtual std::string name() const
+    { return "text"; }
+
+    virtual void onParameter(const std::string& /* plugin */,
+                             const std::string& /* location */,
+                             const std::string& file,
+                             value::Value* parameters,
+                             const double& /* time */)
+    {
+        delete parameters;
+        m_file.open((file + ".dat").c_str());
+        m_file << "time";
+    }
+
+    virtual void onNewObservable(const std::string& simulator,
+                                 const std::string& parent,
+                                 const std::string& port,
+                                 const std::string& /* view */,
+                                 const double& /* time */)
+    {
+        std::string name(parent + ":" + simulator + "." + port);
+        std::size_t index = m_columns.size();
+        m_columns[name] = index;
+        m_values.push_back(0);
+        m_file << "\t" << name;
+    }
+
+    virtual void onDelObservable(const std::string& /* simulator */,
+                                 const std::string& /* parent */,
+                                 const std::string& /* port */,
+                                 const std::string& /* view */,
+                                 const double& /* time */)
+    {}
+
+    virtual void onValue(const std::string& simulator,
+                         const std::string& parent,
+                         const std::string& port,
+                         const std::string& /* view */,
+                         const double& time,
+                         value::Value* value)
+    {
+        if (time != m_time) {
+            flush();
+            m_time = time;
+        }
+
+        std::size_t index = m_columns[parent + ":" + simulator + "." + port];
+        delete m_values[index];
+        m_values[index] = value;
+    }
+
+    virtual void close(const double& /* time */)
+    {
+        flush();
+        m_file << "\n";
+        m_file.close();
+    }
+
+private:
+    void flush()
+    {
+        if (m_time < 0.0) {
+            return;
+        }
+
+        m_file << "\n" << m_time;
+        for (std::size_t i = 0; i < m_values.size(); ++i) {
+            m_file << "\t";
+            if (m_values[i]) {
+                m_file << m_values[i]->writeToString();
+                delete m_values[i];
+                m_values[i] = 0;
+            }
+        }
+    }
+
+    std::ofstream                         m_file;
+    std::map < std::string, std::size_t > m_columns;
+    std::vector < value::Value* >         m_values;
+    double                                m_time;
+};
+
+double elapsed(const boost::posix_time::ptime& start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+        .total_microseconds() / 1e6;
+}
+
+double fileSize(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    return static_cast < double >(file.tellg());
+}
+
+value::Value* linear(int row, int column)
+{
+    return new value::Double(row * 0.001 + column);
+}
+
+/*
+ * A daily output of a crop model: the columns are leaf area indexes,
+ * biomasses, temperatures rounded to 0.1 degree and phenological stages
+ * of the plots, the model changes its state a day in two.
+ */
+value::Value* crop(int row, int column)
+{
+    const double pi = 3.14159265358979323846;
+    int plot = column / 4;
+    int day = (row / 2) * 2 + plot % 2;
+    int doy = day % 365;
+
+    switch (column % 4) {
+    case 0:
+        return new value::Double(
+            std::max(0.0, 6.0 * std::sin(pi * (doy - 90 - plot) / 200.0)));
+    case 1:
+        return new value::Double(
+            day / 365 * 12000.0 + 12000.0 / (1.0 + std::exp(
+                    (180.0 + plot - doy) / 20.0)));
+    case 2:
+        return new value::Double(std::floor(
+                (12.0 + 10.0 * std::sin(2.0 * pi * (doy - 110) / 365.0) +
+                 ((day * 7919 + plot * 104729) % 61 - 30) / 10.0) * 10.0 +
+                0.5) / 10.0);
+    default:
+        return new value::Integer(doy < 90 ? 0 :
+                                  std::min(9, (doy - 90) / 25));
+    }
+}
+
+void write(oov::Plugin& plugin, const std::string& file,
+           const std::string& filename, int rows, int columns,
+           value::Value* (*generate)(int, int),
+           value::Map* parameters = 0, const std::string& label = "")
+{
+    std::vector < std::string > names;
+    for (int c = 0; c < columns; ++c) {
+        names.push_back("m" + boost::lexical_cast < std::string >(c));
+    }
+
+    boost::posix_time::ptime start(
+        boost::posix_time::microsec_clock::universal_time());
+
+    plugin.onParameter("bench", "", file, parameters, 0.0);
+    for (int c = 0; c < columns; ++c) {
+        plugin.onNewObservable(names[c], "top", "x", "view", 0.0);
+    }
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            plugin.onValue(names[c], "top", "x", "view", 2451545 + r,
+                           generate(r, c));
+        }
+    }
+    plugin.close(rows);
+
+    double seconds = elapsed(start);
+    double size = fileSize(filename);
+    std::cout << (label.empty() ? plugin.name() : label) << ": "
+              << seconds << " s, "
+              << rows * static_cast < double >(columns) / seconds
+              << " values/s, " << size / 1e6 << " MB ("
+              << size / 1e6 / seconds << " MB/s)\n";
+}
+
+/*
+ * Sum the cells of a column, chunk by chunk.
+ */
+void scan(const std::string& filename, int column, const std::string& label)
+{
+    boost::posix_time::ptime start(
+        boost::posix_time::microsec_clock::universal_time());
+    oov::ColumnReader reader(filename);
+    std::size_t col = reader.column("top:m" +
+                                    boost::lexical_cast < std::string >(
+                                        column) + ".x");
+    double sum = 0.0;
+    for (std::size_t c = 0; c < reader.chunks(); ++c) {
+        const double* values = reader.doubles(c, col);
+        for (std::size_t r = 0; r < reader.rows(c); ++r) {
+            sum += values[r];
+        }
+        reader.release(c);
+    }
+    std::cout << label << ": " << elapsed(start) << " s (sum " << sum
+              << ")\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int rows = argc > 1 ? boost::lexical_cast < int >(argv[1]) : 100000;
+    int columns = argc > 2 ? boost::lexical_cast < int >(argv[2]) : 50;
+
+    std::cout << rows << " rows of " << columns << " columns\n";
+
+    {
+        Text text;
+        write(text, "bench_column", "bench_column.dat", rows, columns,
+              linear);
+    }
+    {
+        oov::ColumnWriter column("");
+        write(column, "bench_column", "bench_column.vlec", rows, columns,
+              linear);
+    }
+    scan("bench_column.vlec", columns / 2, "column scan");
+
+    std::cout << "crop model outputs:\n";
+
+    const char* encodings[] = { "plain", "gorilla" };
+    const char* compressions[] = { "none", "gzip", "bzip2", "xz", "zstd" };
+
+    for (int e = 0; e < 2; ++e) {
+        for (int c = 0; c < 5; ++c) {
+            std::string label = std::string(encodings[e]) + "+" +
+                compressions[c];
+            value::Map* parameters = new value::Map();
+            parameters->addString("encoding", encodings[e]);
+            parameters->addString("compression", compressions[c]);
+
+            try {
+                oov::ColumnWriter column("");
+                write(column, "bench_column", "bench_column.vlec", rows,
+                      columns, crop, parameters, label);
+                scan("bench_column.vlec", columns / 8 * 4 + 1,
+                     "  biomass scan");
+            } catch (const utils::InternalError& error) {
+                std::cout << label << ": " << error.what() << "\n";
+            }
+        }
+    }
+
+    std::remove("bench_column.dat");
+    std::remove("bench_column.vlec");
+
+    return 0;
+}
@@ -0,0 +1,579 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE oovcolumn_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <vle/oov/ColumnReader.hpp>
+#include <vle/oov/ColumnStorage.hpp>
+#include <vle/oov/ColumnWriter.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/value/Boolean.hpp>
+#include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
+#include <vle/value/Map.hpp>
+#include <vle/value/String.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+using namespace vle;
+
+BOOST_AUTO_TEST_CASE(test_column_write_read)
+{
+    {
+        oov::ColumnWriter writer("");
+        value::Map* parameters = new value::Map();
+        parameters->addInt("rows", 4);
+        writer.onParameter("column", "", "test_column", parameters, 0.0);
+        BOOST_REQUIRE_EQUAL(writer.filename(), "test_column.vlec");
+
+        writer.onNewObservable("a", "top", "x", "view", 0.0);
+        writer.onNewObservable("b", "top", "y", "view", 0.0);
+
+        for (int i = 0; i < 10; ++i) {
+            writer.onValue("a", "top", "x", "view", i,
+                           new value::Double(i * 0.5));
+            if (i != 3) {
+                writer.onValue("b", "top", "y", "view", i,
+                               new value::Integer(i * 10));
+            }
+            if (i == 5) {
+                writer.onNewObservable("c", "top", "z", "view", i);
+            }
+            if (i >= 6) {
+                writer.onValue("c", "top", "z", "view", i,
+                               i == 7 ? static_cast < value::Value* >(
+                                   new value::Double(2.5)) :
+                               new value::Boolean(true));
+            }
+        }
+
+        BOOST_REQUIRE_THROW(writer.onValue("a", "top", "x", "view", 10.0,
+                                           new value::String("x")),
+                            utils::ArgError);
+        writer.close(10.0);
+    }
+
+    oov::ColumnReader reader("test_column.vlec");
+    BOOST_REQUIRE_EQUAL(reader.columns(), 3u);
+    BOOST_REQUIRE_EQUAL(reader.rows(), 11u);
+    BOOST_REQUIRE_EQUAL(reader.chunks(), 3u);
+    BOOST_REQUIRE_EQUAL(reader.rows(0), 4u);
+    BOOST_REQUIRE_EQUAL(reader.rows(2), 3u);
+    BOOST_REQUIRE_EQUAL(reader.name(1), "top:b.y");
+    BOOST_REQUIRE_EQUAL(reader.column("top:c.z"), 2u);
+    BOOST_REQUIRE_THROW(reader.column("top:d.w"), utils::ArgError);
+    BOOST_REQUIRE_THROW(reader.rows(3), utils::ArgError);
+
+    BOOST_REQUIRE_EQUAL(reader.times(1)[2], 6.0);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 0), oov::ColumnWriter::DOUBLE);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 1), oov::ColumnWriter::INTEGER);
+    BOOST_REQUIRE_EQUAL(reader.doubles(1, 0)[1], 2.5);
+    BOOST_REQUIRE(reader.doubles(0, 1) == 0);
+
+    const int64_t* b = reader.integers(0, 1);
+    BOOST_REQUIRE(b);
+    BOOST_REQUIRE_EQUAL(b[2], 20);
+    BOOST_REQUIRE_EQUAL(b[3], oov::ColumnWriter::MISSING);
+    BOOST_REQUIRE_EQUAL(reader.count(0, 1), 3u);
+
+    double min, max;
+    BOOST_REQUIRE(reader.range(0, 1, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, 0.0);
+    BOOST_REQUIRE_EQUAL(max, 20.0);
+    BOOST_REQUIRE(reader.range(2, 0, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, 4.0);
+    BOOST_REQUIRE_EQUAL(max, 4.5);
+
+    // The column c is created in the second chunk, with a double in the
+    // second chunk and booleans in the third.
+    BOOST_REQUIRE(not reader.range(0, 2, &min, &max));
+    BOOST_REQUIRE_EQUAL(reader.count(1, 2), 2u);
+    BOOST_REQUIRE_EQUAL(reader.type(1, 2), oov::ColumnWriter::DOUBLE);
+    BOOST_REQUIRE_EQUAL(reader.type(2, 2), oov::ColumnWriter::INTEGER);
+
+    std::vector < double > times, values;
+    reader.readTimes(times);
+    BOOST_REQUIRE_EQUAL(times.size(), 11u);
+    BOOST_REQUIRE_EQUAL(times[10], 10.0);
+
+    reader.readColumn(2, values);
+    BOOST_REQUIRE_EQUAL(values.size(), 11u);
+    BOOST_REQUIRE((boost::math::isnan)(values[5]));
+    BOOST_REQUIRE_EQUAL(values[6], 1.0);
+    BOOST_REQUIRE_EQUAL(values[7], 2.5);
+    BOOST_REQUIRE_EQUAL(values[9], 1.0);
+    BOOST_REQUIRE((boost::math::isnan)(values[10]));
+
+    std::remove("test_column.vlec");
+}
+
+BOOST_AUTO_TEST_CASE(test_column_rows)
+{
+    {
+        oov::ColumnWriter writer("");
+        writer.onParameter("column", "", "test_column_rows", 0, 0.0);
+        BOOST_REQUIRE(writer.acceptValues());
+
+        writer.onNewObservable("a", "top", "v", "view", 0.0);
+        writer.onNewColumn("a", "top", "x", "view", 0.0, 0);
+        writer.onNewColumn("b", "top", "x", "view", 0.0, 1);
+
+        double row[2];
+        for (int i = 0; i < 5; ++i) {
+            row[0] = i;
+            row[1] = i == 2 ? std::numeric_limits < double >::quiet_NaN()
+                : -i;
+            writer.onValue("a", "top", "v", "view", i,
+                           new value::Integer(i));
+            writer.onValues("view", i, row, 2);
+        }
+        writer.close(5.0);
+    }
+
+    oov::ColumnReader reader("test_column_rows.vlec");
+    BOOST_REQUIRE_EQUAL(reader.columns(), 3u);
+    BOOST_REQUIRE_EQUAL(reader.rows(), 5u);
+    BOOST_REQUIRE_EQUAL(reader.column("top:b.x"), 2u);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 0), oov::ColumnWriter::INTEGER);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 1), oov::ColumnWriter::DOUBLE);
+    BOOST_REQUIRE_EQUAL(reader.count(0, 2), 4u);
+
+    double min, max;
+    BOOST_REQUIRE(reader.range(0, 2, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, -4.0);
+    BOOST_REQUIRE_EQUAL(max, 0.0);
+    BOOST_REQUIRE_EQUAL(reader.doubles(0, 1)[3], 3.0);
+
+    std::remove("test_column_rows.vlec");
+}
+
+BOOST_AUTO_TEST_CASE(test_column_batch)
+{
+    {
+        oov::ColumnWriter writer("");
+        writer.onParameter("column", "", "test_column_batch", 0, 0.0);
+        BOOST_REQUIRE(writer.acceptValueBatch());
+
+        writer.onNewColumn("a", "top", "x", "view", 0.0, 0);
+        writer.onNewColumn("b", "top", "x", "view", 0.0, 1);
+
+        value::Value* batch[2];
+        for (int i = 0; i < 5; ++i) {
+            batch[0] = new value::Integer(i);
+            batch[1] = i == 2 ? 0 : new value::Double(i / 2.0);
+            writer.onValueBatch("view", i, batch, 2);
+        }
+
+        batch[0] = new value::String("x");
+        batch[1] = new value::Double(1.0);
+        BOOST_REQUIRE_THROW(writer.onValueBatch("view", 5.0, batch, 2),
+                            utils::ArgError);
+        writer.close(6.0);
+    }
+
+    oov::ColumnReader reader("test_column_batch.vlec");
+    BOOST_REQUIRE_EQUAL(reader.columns(), 2u);
+    BOOST_REQUIRE_EQUAL(reader.rows(), 6u);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 0), oov::ColumnWriter::INTEGER);
+    BOOST_REQUIRE_EQUAL(reader.type(0, 1), oov::ColumnWriter::DOUBLE);
+    BOOST_REQUIRE_EQUAL(reader.count(0, 0), 5u);
+    BOOST_REQUIRE_EQUAL(reader.count(0, 1), 4u);
+    BOOST_REQUIRE_EQUAL(reader.integers(0, 0)[4], 4);
+    BOOST_REQUIRE_EQUAL(reader.doubles(0, 1)[3], 1.5);
+
+    std::remove("test_column_batch.vlec");
+}
+
+namespace {
+
+double fileSize(const std::string& filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    return static_cast < double >(file.tellg());
+}
+
+void writeCompressed(const std::string& file, const std::string& encoding,
+                     const std::string& compression)
+{
+    oov::ColumnWriter writer("");
+    value::Map* parameters = new value::Map();
+    parameters->addInt("rows", 16);
+    parameters->addString("encoding", encoding);
+    parameters->addString("compression", compression);
+    writer.onParameter("column", "", file, parameters, 0.0);
+    BOOST_REQUIRE_EQUAL(writer.encodingName(writer.encoding()), encoding);
+    BOOST_REQUIRE_EQUAL(writer.compressionName(writer.compression()),
+                        compression);
+
+    writer.onNewObservable("a", "top", "x", "view", 0.0);
+    writer.onNewObservable("a", "top", "n", "view", 0.0);
+
+    for (int i = 0; i < 50; ++i) {
+        double time = i < 30 ? i * 0.1 : 3.0 + (i - 30) * 0.25;
+
+        if (i % 7 != 3) {
+            writer.onValue("a", "top", "x", "view", time,
+                           new value::Double(std::sin(i * 0.3) * 100.0));
+        }
+        if (i % 5 != 0) {
+            writer.onValue("a", "top", "n", "view", time,
+                           new value::Integer(i % 2 ? -i * 1000003 : i));
+        }
+        if (i >= 5) {
+            writer.onValue("b", "top", "z", "view", time,
+                           new value::Boolean(i % 3 == 0));
+        }
+    }
+    writer.close(5.0);
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_column_compression)
+{
+    const char* encodings[] = { "plain", "plain", "gorilla", "gorilla" };
+    const char* compressions[] = { "none", "gzip", "none", "bzip2" };
+
+    for (int c = 0; c < 4; ++c) {
+        writeCompressed("test_column_codec", encodings[c], compressions[c]);
+        oov::ColumnReader reader("test_column_codec.vlec");
+
+        BOOST_REQUIRE_EQUAL(reader.encoding(),
+                            oov::ColumnWriter::toEncoding(encodings[c]));
+        BOOST_REQUIRE_EQUAL(reader.compression(),
+                            oov::ColumnWriter::toCompression(
+                                compressions[c]));
+        BOOST_REQUIRE_EQUAL(reader.columns(), 3u);
+        BOOST_REQUIRE_EQUAL(reader.rows(), 50u);
+        BOOST_REQUIRE_EQUAL(reader.chunks(), 4u);
+        BOOST_REQUIRE_EQUAL(reader.type(1, 1), oov::ColumnWriter::INTEGER);
+        BOOST_REQUIRE_EQUAL(reader.type(0, 0), oov::ColumnWriter::DOUBLE);
+        BOOST_REQUIRE_EQUAL(reader.integers(1, 2)[2], 1);
+
+        std::vector < double > times, x, n, z;
+        reader.readTimes(times);
+        reader.readColumn(0, x);
+        reader.readColumn(1, n);
+        reader.readColumn(2, z);
+
+        for (int i = 0; i < 50; ++i) {
+            BOOST_REQUIRE_EQUAL(times[i], i < 30 ? i * 0.1 :
+                                3.0 + (i - 30) * 0.25);
+            if (i % 7 != 3) {
+                BOOST_REQUIRE_EQUAL(x[i], std::sin(i * 0.3) * 100.0);
+            } else {
+                BOOST_REQUIRE((boost::math::isnan)(x[i]));
+            }
+            if (i % 5 != 0) {
+                BOOST_REQUIRE_EQUAL(n[i], i % 2 ? -i * 1000003.0 : i);
+            } else {
+                BOOST_REQUIRE((boost::math::isnan)(n[i]));
+            }
+            if (i >= 5) {
+                BOOST_REQUIRE_EQUAL(z[i], i % 3 == 0 ? 1.0 : 0.0);
+            } else {
+                BOOST_REQUIRE((boost::math::isnan)(z[i]));
+            }
+        }
+
+        // The released streams are decoded again.
+        double value = reader.doubles(2, 0)[1];
+        reader.release(2);
+        BOOST_REQUIRE_EQUAL(reader.doubles(2, 0)[1], value);
+        BOOST_REQUIRE_THROW(reader.release(4), utils::ArgError);
+    }
+
+    double plain = fileSize("test_column_codec.vlec");
+    writeCompressed("test_column_codec", "gorilla", "none");
+    BOOST_REQUIRE(fileSize("test_column_codec.vlec") < plain);
+    std::remove("test_column_codec.vlec");
+
+    value::Map* parameters = new value::Map();
+    parameters->addString("compression", "rar");
+    oov::ColumnWriter writer("");
+    BOOST_REQUIRE_THROW(writer.onParameter("column", "", "test_column_codec",
+                                           parameters, 0.0),
+                        utils::ArgError);
+    BOOST_REQUIRE_THROW(oov::ColumnWriter::toEncoding("delta"),
+                        utils::ArgError);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_storage)
+{
+    oov::ColumnStorage storage("");
+    storage.onParameter("columnstorage", "", "exp_view", 0, 0.0);
+    storage.onNewObservable("a", "top", "v", "view", 0.0);
+    storage.onNewColumn("a", "top", "x", "view", 0.0, 0);
+    storage.onNewColumn("b", "top", "n", "view", 0.0, 1);
+    storage.onNewColumn("b", "top", "b", "view", 0.0, 2);
+
+    double row[3];
+    value::Value* batch[3];
+    for (int i = 0; i < 5; ++i) {
+        storage.onValue("a", "top", "v", "view", i, new value::Integer(i));
+        row[0] = i == 2 ? std::numeric_limits < double >::quiet_NaN() :
+            i * 0.5;
+        row[1] = row[2] = std::numeric_limits < double >::quiet_NaN();
+        storage.onValues("view", i, row, 3);
+        batch[0] = 0;
+        batch[1] = new value::Integer(i * 10);
+        batch[2] = new value::Boolean(i % 2);
+        storage.onValueBatch("view", i, batch, 3);
+    }
+
+    batch[0] = 0;
+    batch[1] = new value::String("x");
+    batch[2] = new value::Boolean(true);
+    BOOST_REQUIRE_THROW(storage.onValueBatch("view", 5.0, batch, 3),
+                        utils::ArgError);
+    storage.close(6.0);
+
+    boost::scoped_ptr < value::ColumnMatrix > result(storage.columnMatrix());
+    BOOST_REQUIRE_EQUAL(result->columns(), 5u);
+    BOOST_REQUIRE_EQUAL(result->rows(), 6u);
+    BOOST_REQUIRE_EQUAL(result->name(0), "time");
+    BOOST_REQUIRE_EQUAL(result->name(2), "top:a.x");
+    BOOST_REQUIRE_EQUAL(result->getDouble(0, 3), 3.0);
+    BOOST_REQUIRE_EQUAL(result->type(1), value::ColumnMatrix::INTEGER_COLUMN);
+    BOOST_REQUIRE_EQUAL(result->type(2), value::ColumnMatrix::DOUBLE_COLUMN);
+    BOOST_REQUIRE_EQUAL(result->type(3), value::ColumnMatrix::INTEGER_COLUMN);
+    BOOST_REQUIRE_EQUAL(result->type(4), value::ColumnMatrix::BOOLEAN_COLUMN);
+    BOOST_REQUIRE(result->isNull(2, 2));
+    BOOST_REQUIRE_EQUAL(result->count(2), 4u);
+    BOOST_REQUIRE_EQUAL(result->sum(2), 4.0);
+    BOOST_REQUIRE_EQUAL(result->sum(3), 100.0);
+    BOOST_REQUIRE_EQUAL(result->count(4), 5u);
+
+    boost::scoped_ptr < value::Matrix > matrix(storage.matrix());
+    BOOST_REQUIRE_EQUAL(matrix->rows(), 7u);
+    BOOST_REQUIRE_EQUAL(matrix->getString(3, 0), "top:b.n");
+    BOOST_REQUIRE_EQUAL(matrix->getInt(3, 5), 40);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_storage_same_time)
+{
+    oov::ColumnStorage storage("");
+    storage.onParameter("columnstorage", "", "exp_view", 0, 0.0);
+    storage.onNewColumn("a", "top", "x", "view", 0.0, 0);
+
+    // The second observation of x at 1.0 starts a new row.
+    storage.onValue("a", "top", "x", "view", 1.0, new value::Integer(1));
+    storage.onValue("a", "top", "x", "view", 1.0, new value::Integer(2));
+
+    double row[1] = { 2.5 };
+    storage.onValues("view", 1.0, row, 1);
+    storage.onValues("view", 2.0, row, 1);
+    storage.close(3.0);
+
+    boost::scoped_ptr < value::ColumnMatrix > result(storage.columnMatrix());
+    BOOST_REQUIRE_EQUAL(result->rows(), 4u);
+    BOOST_REQUIRE_EQUAL(result->getDouble(0, 1), 1.0);
+    BOOST_REQUIRE_EQUAL(result->getDouble(0, 2), 1.0);
+    BOOST_REQUIRE_EQUAL(result->getDouble(0, 3), 2.0);
+    BOOST_REQUIRE_EQUAL(result->type(1), value::ColumnMatrix::DOUBLE_COLUMN);
+    BOOST_REQUIRE_EQUAL(result->getDouble(1, 0), 1.0);
+    BOOST_REQUIRE_EQUAL(result->getDouble(1, 1), 2.0);
+    BOOST_REQUIRE_EQUAL(result->getDouble(1, 2), 2.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_builtin)
+{
+    boost::scoped_ptr < oov::Plugin > plugin(
+        oov::buildBuiltinPlugin("", "column", "."));
+    BOOST_REQUIRE(plugin);
+    BOOST_REQUIRE_EQUAL(plugin->name(), "column");
+
+    boost::scoped_ptr < oov::Plugin > storage(
+        oov::buildBuiltinPlugin("vle", "columnstorage", "."));
+    BOOST_REQUIRE(storage);
+    BOOST_REQUIRE_EQUAL(storage->name(), "columnstorage");
+
+    boost::scoped_ptr < oov::Plugin > other(
+        oov::buildBuiltinPlugin("vle.output", "column", "."));
+    BOOST_REQUIRE(not other);
+}
+
+BOOST_AUTO_TEST_CASE(test_column_bad_file)
+{
+    BOOST_REQUIRE_THROW(oov::ColumnReader("no_such_file.vlec"),
+                        utils::FileError);
+
+    {
+        std::ofstream out("test_column_bad.vlec");
+        out << "this is not a column file, this is a text file.\n";
+    }
+    BOOST_REQUIRE_THROW(oov::ColumnReader("test_column_bad.vlec"),
+                        utils::FileError);
+    std::remove("test_column_bad.vlec");
+
+    {
+        oov::ColumnWriter writer("");
+        writer.onParameter("column", "", "test_column_cut", 0, 0.0);
+        writer.onValue("a", "top", "x", "view", 0.0, new value::Double(1.0));
+        writer.close(1.0);
+    }
+    {
+        std::ifstream in("test_column_cut.vlec", std::ios::binary);
+        std::string content((std::istreambuf_iterator < char >(in)),
+                            std::istreambuf_iterator < char >());
+        std::ofstream out("test_column_cut.vlec", std::ios::binary);
+        out.write(content.data(), content.size() - 8);
+    }
+    BOOST_REQUIRE_THROW(oov::ColumnReader("test_column_cut.vlec"),
+                        utils::FileError);
+    std::remove("test_column_cut.vlec");
+}
+
+/**
+ * Replace the word at @e position, or at the offset stored by the word at
+ * @e position plus @e shift, of a column file.
+ */
+static void patchColumnFile(const std::string& filename, uint64_t position,
+                            uint64_t shift, bool indirect, uint64_t word)
+{
+    std::fstream file(filename.c_str(),
+                      std::ios::in | std::ios::out | std::ios::binary);
+
+    if (indirect) {
+        file.seekg(position);
+        file.read(reinterpret_cast < char* >(&position), sizeof(position));
+    }
+    file.seekp(position + shift);
+    file.write(reinterpret_cast < const char* >(&word), sizeof(word));
+}
+
+BOOST_AUTO_TEST_CASE(test_column_overflow)
+{
+    const uint64_t max = std::numeric_limits < uint64_t >::max();
+    const std::string filename("test_column_overflow.vlec");
+
+    for (int i = 0; i < 3; ++i) {
+        {
+            oov::ColumnWriter writer("");
+            writer.onParameter("column", "", "test_column_overflow", 0, 0.0);
+            writer.onValue("a", "top", "x", "view", 0.0,
+                           new value::Double(1.0));
+            writer.close(1.0);
+        }
+
+        uint64_t footer;
+        {
+            std::ifstream in(filename.c_str(), std::ios::binary);
+            in.seekg(-16, std::ios::end);
+            in.read(reinterpret_cast < char* >(&footer), sizeof(footer));
+        }
+
+        switch (i) {
+        case 0:
+            // The number of chunks times 8 wraps to 8.
+            patchColumnFile(filename, footer, 0, false, max / 8 + 2);
+            break;
+        case 1:
+            // The number of columns of the chunk times the 24 bytes of a
+            // column header wraps to a small size.
+            patchColumnFile(filename, footer + 8, 8, true, max / 24 + 1);
+            break;
+        case 2:
+            // The number of rows of the chunk times 8 wraps to 8.
+            patchColumnFile(filename, footer + 8, 0, true, max / 8 + 2);
+            break;
+        }
+
+        BOOST_REQUIRE_THROW(oov::ColumnReader reader(filename),
+                            utils::FileError);
+    }
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_column_same_time)
+{
+    const int32_t big = std::numeric_limits < int32_t >::max();
+
+    {
+        oov::ColumnWriter writer("");
+        writer.onParameter("column", "", "test_column_time", 0, 0.0);
+        writer.onNewObservable("a", "top", "x", "view", 0.0);
+        writer.onNewObservable("b", "top", "y", "view", 0.0);
+
+        // The second observation of a at 1.0 starts a new row.
+        writer.onValue("a", "top", "x", "view", 1.0, new value::Integer(1));
+        writer.onValue("b", "top", "y", "view", 1.0, new value::Integer(2));
+        writer.onValue("a", "top", "x", "view", 1.0, new value::Integer(3));
+
+        writer.onNewColumn("a", "top", "x", "view", 1.0, 0);
+        writer.onNewColumn("b", "top", "y", "view", 1.0, 1);
+
+        value::Value* batch[2];
+        batch[0] = 0;
+        batch[1] = new value::Integer(big);
+        writer.onValueBatch("view", 1.0, batch, 2);
+        batch[0] = new value::Integer(-big);
+        batch[1] = 0;
+        writer.onValueBatch("view", 2.0, batch, 2);
+        writer.close(3.0);
+    }
+
+    oov::ColumnReader reader("test_column_time.vlec");
+    BOOST_REQUIRE_EQUAL(reader.rows(), 3u);
+
+    const double* times = reader.times(0);
+    BOOST_REQUIRE_EQUAL(times[0], 1.0);
+    BOOST_REQUIRE_EQUAL(times[1], 1.0);
+    BOOST_REQUIRE_EQUAL(times[2], 2.0);
+
+    const int64_t* a = reader.integers(0, 0);
+    const int64_t* b = reader.integers(0, 1);
+    BOOST_REQUIRE(a and b);
+    BOOST_REQUIRE_EQUAL(a[0], 1);
+    BOOST_REQUIRE_EQUAL(a[1], 3);
+    BOOST_REQUIRE_EQUAL(a[2], -big);
+    BOOST_REQUIRE_EQUAL(b[0], 2);
+    BOOST_REQUIRE_EQUAL(b[1], big);
+
+    // The statistics of the integers are int64.
+    int64_t min, max;
+    BOOST_REQUIRE(reader.range(0, 1, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, 2);
+    BOOST_REQUIRE_EQUAL(max, big);
+    BOOST_REQUIRE(reader.range(0, 0, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, -big);
+    BOOST_REQUIRE_EQUAL(max, 3);
+
+    double dmin, dmax;
+    BOOST_REQUIRE(reader.range(0, 0, &dmin, &dmax));
+    BOOST_REQUIRE_EQUAL(dmax, 3.0);
+
+    std::remove("test_column_time.vlec");
+}
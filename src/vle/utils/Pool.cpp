@@ -0,0 +1,331 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/utils/Pool.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <vector>
+#include <cassert>
+
+namespace vle { namespace utils {
+
+namespace {
+
+/*
+ * Protect the link between the free list of a thread and its pool against
+ * the destruction of the pool. It is never released: a thread can exit
+ * during the destruction of the static objects.
+ */
+boost::mutex& cachesMutex()
+{
+    static boost::mutex* mutex = new boost::mutex();
+
+    return *mutex;
+}
+
+/*
+ * The boost::thread_specific_ptr searches the free list of a thread in a
+ * map: with GCC, the free lists of the first pools are also stored in a
+ * native thread local array indexed by the identifier of the pool.
+ */
+#if defined(__GNUC__)
+const std::size_t localCaches = 8;
+
+/*
+ * The initial-exec model avoids a call of __tls_get_addr() by access from
+ * the shared library. The array is small enough to fit in the static TLS
+ * reserved for the libraries loaded with dlopen().
+ */
+__thread void* localCache[localCaches]
+    __attribute__ ((tls_model("initial-exec")));
+#endif
+
+std::size_t poolIdentifier = 0;
+
+} // anonymous namespace
+
+/*
+ * The utils::Pool::Pimpl source.
+ */
+
+class Pool::Pimpl
+{
+public:
+    /**
+     * A free block: the first bytes of a block store the next free block.
+     */
+    struct Node
+    {
+        Node* next;
+    };
+
+    /**
+     * The free list of a thread. The pool is null if the pool is destroyed
+     * before the thread: the free list is then freed when the thread
+     * exits.
+     */
+    struct Cache
+    {
+        Cache(Pimpl* pool)
+            : head(0), size(0), pool(pool)
+        {}
+
+        Node*       head;
+        std::size_t size;
+        Pimpl*      pool;
+    };
+
+    Pimpl(std::size_t size, std::size_t blocks)
+        : m_size(size), m_blocks(blocks ? blocks : 1), m_free(0),
+        m_nbfree(0), m_cache(&Pimpl::release)
+    {
+        const std::size_t align = 2 * sizeof(void*);
+
+        {
+            boost::mutex::scoped_lock lock(cachesMutex());
+            m_id = poolIdentifier++;
+        }
+
+        if (m_size < sizeof(Node)) {
+            m_size = sizeof(Node);
+        }
+        m_size = ((m_size + align - 1) / align) * align;
+    }
+
+    /**
+     * The free lists of the other threads are detached from the pool,
+     * their blocks are lost with the slabs.
+     */
+    ~Pimpl()
+    {
+        m_cache.reset();
+        setLocal(0);
+
+        {
+            boost::mutex::scoped_lock lock(cachesMutex());
+
+            for (std::vector < Cache* >::iterator it = m_caches.begin();
+                 it != m_caches.end(); ++it) {
+                (*it)->pool = 0;
+            }
+        }
+
+        for (std::vector < void* >::iterator it = m_slabs.begin();
+             it != m_slabs.end(); ++it) {
+            ::operator delete(*it);
+        }
+    }
+
+    /**
+     * Get the free list of the thread. A free list of a destroyed pool is
+     * found if the pool is allocated at the same address: it is replaced.
+     */
+    Cache* cache()
+    {
+#if defined(__GNUC__)
+        if (m_id < localCaches) {
+            Cache* result = static_cast < Cache* >(localCache[m_id]);
+
+            if (result and result->pool == this) {
+                return result;
+            }
+        }
+#endif
+
+        Cache* result = m_cache.get();
+
+        if (not result or result->pool != this) {
+            result = new Cache(this);
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_caches.push_back(result);
+            }
+            m_cache.reset(result);
+        }
+        setLocal(result);
+
+        return result;
+    }
+
+    void setLocal(Cache* cache)
+    {
+#if defined(__GNUC__)
+        if (m_id < localCaches) {
+            localCache[m_id] = cache;
+        }
+#else
+        (void)cache;
+#endif
+    }
+
+    /**
+     * Fill the free list of the thread with the free blocks given back by
+     * the other threads or with a new slab.
+     */
+    void refill(Cache* cache)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (m_free) {
+            cache->head = m_free;
+            cache->size = m_nbfree;
+            m_free = 0;
+            m_nbfree = 0;
+        } else {
+            char* slab = static_cast < char* >(
+                ::operator new(m_size * m_blocks));
+            m_slabs.push_back(slab);
+
+            Node* head = 0;
+            for (std::size_t i = m_blocks; i > 0; --i) {
+                Node* node = reinterpret_cast < Node* >(
+                    slab + (i - 1) * m_size);
+                node->next = head;
+                head = node;
+            }
+
+            cache->head = head;
+            cache->size = m_blocks;
+        }
+    }
+
+    /**
+     * Give back the @e nb first blocks of the free list of the thread.
+     */
+    void giveback(Cache* cache, std::size_t nb)
+    {
+        assert(nb <= cache->size);
+
+        if (nb == 0) {
+            return;
+        }
+
+        Node* first = cache->head;
+        Node* last = first;
+        for (std::size_t i = 1; i < nb; ++i) {
+            last = last->next;
+        }
+
+        cache->head = last->next;
+        cache->size -= nb;
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        last->next = m_free;
+        m_free = first;
+        m_nbfree += nb;
+    }
+
+    /**
+     * Called when a thread exits or when its free list is replaced.
+     */
+    static void release(Cache* cache)
+    {
+        {
+            boost::mutex::scoped_lock lock(cachesMutex());
+
+            if (cache->pool) {
+                Pimpl* pool = cache->pool;
+
+                pool->giveback(cache, cache->size);
+
+                boost::mutex::scoped_lock poollock(pool->m_mutex);
+                pool->m_caches.erase(std::find(pool->m_caches.begin(),
+                                               pool->m_caches.end(),
+                                               cache));
+            }
+        }
+
+#if defined(__GNUC__)
+        std::replace(localCache, localCache + localCaches,
+                     static_cast < void* >(cache), static_cast < void* >(0));
+#endif
+
+        delete cache;
+    }
+
+    std::size_t                         m_id;
+    std::size_t                         m_size;
+    std::size_t                         m_blocks;
+    Node*                               m_free;
+    std::size_t                         m_nbfree;
+    std::vector < void* >               m_slabs;
+    std::vector < Cache* >              m_caches; ///< of all the threads.
+    boost::mutex                        m_mutex;
+    boost::thread_specific_ptr < Cache > m_cache;
+};
+
+Pool::Pool(std::size_t size, std::size_t blocks)
+    : m_size(size), mImpl(new Pool::Pimpl(size, blocks))
+{
+}
+
+Pool::~Pool()
+{
+    delete mImpl;
+}
+
+void* Pool::allocate()
+{
+    Pimpl::Cache* cache = mImpl->cache();
+
+    if (not cache->head) {
+        mImpl->refill(cache);
+    }
+
+    Pimpl::Node* node = cache->head;
+    cache->head = node->next;
+    --cache->size;
+
+    return node;
+}
+
+void Pool::deallocate(void* ptr)
+{
+    if (not ptr) {
+        return;
+    }
+
+    Pimpl::Cache* cache = mImpl->cache();
+    Pimpl::Node* node = static_cast < Pimpl::Node* >(ptr);
+
+    node->next = cache->head;
+    cache->head = node;
+    ++cache->size;
+
+    if (cache->size > 2 * mImpl->m_blocks) {
+        mImpl->giveback(cache, mImpl->m_blocks);
+    }
+}
+
+std::size_t Pool::slabs() const
+{
+    boost::mutex::scoped_lock lock(mImpl->m_mutex);
+
+    return mImpl->m_slabs.size();
+}
+
+}} // namespace vle utils
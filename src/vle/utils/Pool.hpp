@@ -0,0 +1,136 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_UTILS_POOL_HPP
+#define VLE_UTILS_POOL_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <cstddef>
+
+namespace vle { namespace utils {
+
+/**
+ * @brief A fixed size block allocator. The blocks are carved in large
+ * slabs and recycled through a free list: after a warmup, allocate() and
+ * deallocate() do not call the system allocator anymore.
+ *
+ * Each thread uses its own free list so the fast path does not take any
+ * lock; a block can be released by another thread than the one that
+ * allocated it. The free list of a thread is given back to the pool when
+ * the thread exits. The slabs are only released with the pool, a pool can
+ * be destroyed before the threads which use it.
+ *
+ * @code
+ * class Event
+ * {
+ * public:
+ *     static void* operator new(std::size_t size)
+ *     { return pool().allocate(size); }
+ *
+ *     static void operator delete(void* ptr, std::size_t size)
+ *     { pool().deallocate(ptr, size); }
+ * };
+ * @endcode
+ */
+class VLE_API Pool
+{
+public:
+    /**
+     * @brief Build an empty pool.
+     * @param size The size of a block in bytes.
+     * @param blocks The number of blocks per slab.
+     */
+    Pool(std::size_t size, std::size_t blocks = 1024);
+
+    /**
+     * @brief Release all the slabs. All the blocks must be released before.
+     */
+    ~Pool();
+
+    /**
+     * @brief Get a block of size() bytes.
+     * @return A pointer to the new block.
+     */
+    void* allocate();
+
+    /**
+     * @brief Get a block of @e size bytes. If @e size is greater than the
+     * block size (a derived class for example) the system allocator is
+     * used.
+     * @param size The number of bytes.
+     * @return A pointer to the new block.
+     */
+    void* allocate(std::size_t size)
+    { return size <= m_size ? allocate() : ::operator new(size); }
+
+    /**
+     * @brief Give back a block to the pool.
+     * @param ptr The block to release, can be null.
+     */
+    void deallocate(void* ptr);
+
+    /**
+     * @brief Give back a block of @e size bytes allocated by
+     * allocate(std::size_t).
+     * @param ptr The block to release, can be null.
+     * @param size The number of bytes.
+     */
+    void deallocate(void* ptr, std::size_t size)
+    {
+        if (size <= m_size) {
+            deallocate(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    /**
+     * @brief Get the size of a block.
+     * @return The size of a block in bytes.
+     */
+    std::size_t size() const
+    { return m_size; }
+
+    /**
+     * @brief Get the number of slabs allocated by the pool.
+     * @return The number of slabs.
+     */
+    std::size_t slabs() const;
+
+private:
+    Pool(const Pool& other);
+    Pool& operator=(const Pool& other);
+
+    std::size_t m_size;
+
+    class Pimpl;
+    Pimpl* mImpl;
+};
+
+}} // namespace vle utils
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/utils/ThreadPool.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace vle { namespace utils {
+
+/*
+ * The utils::ThreadPool::Pimpl source.
+ */
+
+class ThreadPool::Pimpl
+{
+public:
+    Pimpl(std::size_t threads)
+        : m_job(0), m_size(0), m_next(0), m_chunk(1), m_generation(0),
+        m_running(0), m_stop(false)
+    {
+        for (std::size_t i = 1; i < threads; ++i) {
+            m_threads.create_thread(boost::bind(&Pimpl::worker, this));
+        }
+    }
+
+    ~Pimpl()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        m_threads.join_all();
+    }
+
+    /**
+     * Call the job for the iterations of the next chunks until all the
+     * chunks are taken.
+     */
+    void work(const Job& job)
+    {
+        for (;;) {
+            std::size_t begin, end;
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                if (m_next >= m_size) {
+                    return;
+                }
+                begin = m_next;
+                end = std::min(m_size, m_next + m_chunk);
+                m_next = end;
+            }
+
+            for (std::size_t i = begin; i < end; ++i) {
+                job(i);
+            }
+        }
+    }
+
+    void worker()
+    {
+        unsigned long generation = 0;
+
+        for (;;) {
+            const Job* job;
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                while (not m_stop and generation == m_generation) {
+                    m_start.wait(lock);
+                }
+
+                if (m_stop) {
+                    return;
+                }
+
+                generation = m_generation;
+                job = m_job;
+            }
+
+            work(*job);
+
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                if (--m_running == 0) {
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+
+    void run(const Job& job, std::size_t n)
+    {
+        std::size_t threads = m_threads.size() + 1;
+
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_job = &job;
+            m_size = n;
+            m_next = 0;
+            m_chunk = std::max((std::size_t)1, n / (threads * 4));
+            m_running = m_threads.size();
+            ++m_generation;
+        }
+        m_start.notify_all();
+
+        work(job);
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        while (m_running != 0) {
+            m_done.wait(lock);
+        }
+        m_job = 0;
+    }
+
+    boost::thread_group       m_threads;
+    boost::mutex              m_mutex;
+    boost::condition_variable m_start;
+    boost::condition_variable m_done;
+    const Job*                m_job;
+    std::size_t               m_size;
+    std::size_t               m_next;
+    std::size_t               m_chunk;
+    unsigned long             m_generation;
+    std::size_t               m_running;
+    bool                      m_stop;
+};
+
+ThreadPool::ThreadPool(std::size_t threads)
+    : mImpl(new ThreadPool::Pimpl(threads))
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    delete mImpl;
+}
+
+std::size_t ThreadPool::size() const
+{
+    return mImpl->m_threads.size() + 1;
+}
+
+void ThreadPool::run(const Job& job, std::size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+
+    if (mImpl->m_threads.size() == 0 or n == 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            job(i);
+        }
+    } else {
+        mImpl->run(job, n);
+    }
+}
+
+}} // namespace vle utils
@@ -0,0 +1,93 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_UTILS_THREADPOOL_HPP
+#define VLE_UTILS_THREADPOOL_HPP 1
+
+#include <vle/DllDefines.hpp>
+#include <boost/function.hpp>
+#include <cstddef>
+
+namespace vle { namespace utils {
+
+/**
+ * @brief A pool of threads to run the iterations of a loop in parallel.
+ * The threads are started with the pool and wait for the next loop: the
+ * cost of a run() is a wake up of the threads, not their creation.
+ *
+ * @code
+ * vle::utils::ThreadPool pool(4);
+ * std::vector < double > x(1000);
+ *
+ * pool.run(boost::bind(&compute, boost::ref(x), _1), x.size());
+ * @endcode
+ */
+class VLE_API ThreadPool
+{
+public:
+    typedef boost::function < void (std::size_t) > Job;
+
+    /**
+     * @brief Start the threads of the pool.
+     * @param threads The number of threads used by run(), including the
+     * calling thread. With 0 or 1 thread, run() does not use any other
+     * thread.
+     */
+    ThreadPool(std::size_t threads);
+
+    /**
+     * @brief Stop and join the threads of the pool.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Get the number of threads used by run(), including the calling
+     * thread.
+     * @return The number of threads.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Call job(i) for each i in [0, n) using the threads of the
+     * pool and the calling thread, and wait the end of all the calls. The
+     * job must not throw exceptions.
+     * @param job The function to call.
+     * @param n The number of calls.
+     */
+    void run(const Job& job, std::size_t n);
+
+private:
+    ThreadPool(const ThreadPool& other);
+    ThreadPool& operator=(const ThreadPool& other);
+
+    class Pimpl;
+    Pimpl* mImpl;
+};
+
+}} // namespace vle utils
+
+#endif
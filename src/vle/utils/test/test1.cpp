@@ -44,13 +44,19 @@
 #include <iostream>
 #include <sstream>
 #include <numeric>
+#include <algorithm>
+#include <cstring>
 #include <vle/utils/Algo.hpp>
 #include <vle/utils/DateTime.hpp>
 #include <vle/utils/Package.hpp>
 #include <vle/utils/Path.hpp>
+#include <vle/utils/Pool.hpp>
 #include <vle/utils/Rand.hpp>
+#include <vle/utils/ThreadPool.hpp>
 #include <vle/utils/Tools.hpp>
 #include <vle/vle.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 using namespace vle;
 
@@ -432,3 +438,131 @@ BOOST_AUTO_TEST_CASE(test_format_copy)
                         "\"1\", \"2\", \"3\", \"4\", \"5\", \"6\", \"7\", "
                         "\"8\", \"9\";");
 }
+
+static void pool_worker(vle::utils::Pool* pool, std::vector < void* >* blocks)
+{
+    for (std::vector < void* >::iterator it = blocks->begin();
+         it != blocks->end(); ++it) {
+        pool->deallocate(*it);
+    }
+    blocks->clear();
+
+    for (int i = 0; i < 100; ++i) {
+        blocks->push_back(pool->allocate());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pool)
+{
+    vle::utils::Pool pool(24, 16);
+
+    BOOST_REQUIRE(pool.size() >= 24);
+    BOOST_REQUIRE_EQUAL(pool.slabs(), (std::size_t)0);
+
+    std::vector < void* > blocks;
+    for (int i = 0; i < 16; ++i) {
+        blocks.push_back(pool.allocate());
+        std::memset(blocks.back(), i, 24);
+    }
+    BOOST_REQUIRE_EQUAL(pool.slabs(), (std::size_t)1);
+
+    std::sort(blocks.begin(), blocks.end());
+    BOOST_REQUIRE(std::adjacent_find(blocks.begin(), blocks.end()) ==
+                  blocks.end());
+
+    /* The released blocks are reused before a new slab is allocated. */
+    for (int i = 0; i < 16; ++i) {
+        pool.deallocate(blocks[i]);
+    }
+    for (int i = 0; i < 16; ++i) {
+        blocks[i] = pool.allocate();
+    }
+    BOOST_REQUIRE_EQUAL(pool.slabs(), (std::size_t)1);
+
+    /* Bigger blocks are given by the system allocator. */
+    void* big = pool.allocate(100);
+    pool.deallocate(big, 100);
+    BOOST_REQUIRE_EQUAL(pool.slabs(), (std::size_t)1);
+
+    /* The blocks can be released by another thread and the free list of a
+     * thread is given back to the pool when it exits. */
+    boost::thread worker(pool_worker, &pool, &blocks);
+    worker.join();
+    BOOST_REQUIRE_EQUAL(blocks.size(), (std::size_t)100);
+
+    size_t slabs = pool.slabs();
+    for (std::vector < void* >::iterator it = blocks.begin();
+         it != blocks.end(); ++it) {
+        pool.deallocate(*it);
+    }
+    for (int i = 0; i < 100; ++i) {
+        blocks[i] = pool.allocate();
+    }
+    BOOST_REQUIRE_EQUAL(pool.slabs(), slabs);
+
+    for (std::vector < void* >::iterator it = blocks.begin();
+         it != blocks.end(); ++it) {
+        pool.deallocate(*it);
+    }
+}
+
+static void pool_outlived_worker(vle::utils::Pool** pool,
+                                 boost::barrier* barrier)
+{
+    void* block = (*pool)->allocate();
+    (*pool)->deallocate(block);
+    barrier->wait();
+
+    /* The first pool is destroyed and a new pool, maybe at the same
+     * address, replaces the free list of the thread. */
+    barrier->wait();
+    block = (*pool)->allocate();
+    std::memset(block, 0, (*pool)->size());
+    (*pool)->deallocate(block);
+}
+
+BOOST_AUTO_TEST_CASE(pool_outlived)
+{
+    vle::utils::Pool* pool = new vle::utils::Pool(24, 16);
+    boost::barrier barrier(2);
+    boost::thread worker(pool_outlived_worker, &pool, &barrier);
+
+    /* The pool is destroyed before the thread which uses it. */
+    barrier.wait();
+    delete pool;
+    pool = new vle::utils::Pool(24, 16);
+    barrier.wait();
+    worker.join();
+
+    BOOST_REQUIRE_EQUAL(pool->slabs(), (std::size_t)1);
+    delete pool;
+}
+
+static void thread_pool_job(std::vector < int >* x, std::size_t i)
+{
+    (*x)[i] += i;
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool)
+{
+    vle::utils::ThreadPool serial(1);
+    vle::utils::ThreadPool pool(4);
+
+    BOOST_REQUIRE_EQUAL(serial.size(), (std::size_t)1);
+    BOOST_REQUIRE_EQUAL(pool.size(), (std::size_t)4);
+
+    std::vector < int > x(10000, 0);
+    serial.run(boost::bind(thread_pool_job, &x, _1), x.size());
+
+    /* Each iteration is called once per run. */
+    for (int run = 0; run < 100; ++run) {
+        pool.run(boost::bind(thread_pool_job, &x, _1), x.size());
+    }
+    pool.run(boost::bind(thread_pool_job, &x, _1), 0);
+    pool.run(boost::bind(thread_pool_job, &x, _1), 1);
+
+    BOOST_REQUIRE_EQUAL(x[0], 0);
+    for (std::size_t i = 1; i < x.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(x[i], (int)(101 * i));
+    }
+}
@@ -0,0 +1,459 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <vle/value/ColumnMatrix.hpp>
+#include <vle/value/Matrix.hpp>
+#include <algorithm>
+
+namespace vle { namespace value {
+
+ColumnMatrix::ColumnMatrix(const Matrix& matrix)
+    : m_rows(0)
+{
+    // The first row is the names of the columns if its cells are strings
+    // or null.
+    bool header = false;
+    for (Matrix::size_type i = 0; i < matrix.columns() and
+         matrix.rows() > 0; ++i) {
+        const Value* cell = matrix.get(i, 0);
+
+        if (cell and cell->isString()) {
+            header = true;
+        } else if (cell and not cell->isNull()) {
+            header = false;
+            break;
+        }
+    }
+
+    size_type first = header ? 1 : 0;
+    m_rows = matrix.rows() - first;
+
+    for (Matrix::size_type i = 0; i < matrix.columns(); ++i) {
+        // The type of a column is the widest type of its cells: boolean,
+        // integer then double.
+        bool doubles = false, integers = false, booleans = false;
+
+        for (Matrix::size_type j = first; j < matrix.rows() and
+             not doubles; ++j) {
+            const Value* cell = matrix.get(i, j);
+
+            if (cell and not cell->isNull()) {
+                doubles = cell->isDouble();
+                integers = integers or cell->isInteger();
+                booleans = booleans or cell->isBoolean();
+            }
+        }
+
+        ColumnType type = doubles ? DOUBLE_COLUMN : integers ?
+            INTEGER_COLUMN : booleans ? BOOLEAN_COLUMN : DOUBLE_COLUMN;
+
+        const Value* name = header ? matrix.get(i, 0) : 0;
+        addColumn(type, name and name->isString() ?
+                  name->toString().value() : std::string());
+
+        for (Matrix::size_type j = first; j < matrix.rows(); ++j) {
+            const Value* cell = matrix.get(i, j);
+
+            if (cell and cell->isBoolean() and type != BOOLEAN_COLUMN) {
+                addInt(i, j - first, cell->toBoolean().value());
+            } else {
+                add(i, j - first, cell);
+            }
+        }
+    }
+}
+
+void ColumnMatrix::writeFile(std::ostream& out) const
+{
+    write(out, &Value::writeFile, "NA");
+}
+
+void ColumnMatrix::writeString(std::ostream& out) const
+{
+    write(out, &Value::writeString, "NA");
+}
+
+void ColumnMatrix::writeXml(std::ostream& out) const
+{
+    size_type rows = m_rows + (hasNames() ? 1 : 0);
+
+    out << "<matrix "
+        << "rows=\"" << rows << "\" "
+        << "columns=\"" << columns() << "\" "
+        << "columnmax=\"" << columns() << "\" "
+        << "rowmax=\"" << rows << "\" "
+        << "columnstep=\"" << RESIZE_STEP << "\" "
+        << "rowstep=\"" << RESIZE_STEP << "\" >";
+
+    write(out, &Value::writeXml, "<null />");
+
+    out << "</matrix>";
+}
+
+Matrix* ColumnMatrix::buildMatrix() const
+{
+    size_type first = hasNames() ? 1 : 0;
+    Matrix* matrix = new Matrix(columns(), m_rows + first, RESIZE_STEP,
+                                RESIZE_STEP);
+
+    for (size_type i = 0; i < columns(); ++i) {
+        if (first) {
+            matrix->addString(i, 0, m_columns[i].name);
+        }
+
+        for (size_type j = 0; j < m_rows; ++j) {
+            matrix->set(i, j + first, buildValue(i, j));
+        }
+    }
+
+    return matrix;
+}
+
+ColumnMatrix::size_type ColumnMatrix::addColumn(ColumnType type,
+                                                const std::string& name)
+{
+    m_columns.push_back(Column(type, name));
+
+    Column& column(m_columns.back());
+    if (type == DOUBLE_COLUMN) {
+        column.reals.resize(m_rows, 0.0);
+    } else {
+        column.integers.resize(m_rows, 0);
+    }
+    column.present.resize(m_rows, false);
+
+    return m_columns.size() - 1;
+}
+
+void ColumnMatrix::addRow()
+{
+    resize(m_rows + 1);
+}
+
+void ColumnMatrix::resize(size_type rows)
+{
+    for (std::vector < Column >::iterator it = m_columns.begin();
+         it != m_columns.end(); ++it) {
+        if (it->type == DOUBLE_COLUMN) {
+            it->reals.resize(rows, 0.0);
+        } else {
+            it->integers.resize(rows, 0);
+        }
+        it->present.resize(rows, false);
+    }
+
+    m_rows = rows;
+}
+
+void ColumnMatrix::clear()
+{
+    m_columns.clear();
+    m_rows = 0;
+}
+
+void ColumnMatrix::setType(size_type column, ColumnType type)
+{
+    Column& col(m_columns[column]);
+
+    if (col.type == type) {
+        return;
+    }
+
+    if (col.type == DOUBLE_COLUMN) {
+        col.integers.resize(m_rows);
+        for (size_type i = 0; i < m_rows; ++i) {
+            col.integers[i] = type == BOOLEAN_COLUMN ? col.reals[i] != 0.0 :
+                static_cast < int32_t >(col.reals[i]);
+        }
+        std::vector < double >().swap(col.reals);
+    } else if (type == DOUBLE_COLUMN) {
+        col.reals.assign(col.integers.begin(), col.integers.end());
+        std::vector < int32_t >().swap(col.integers);
+    } else if (type == BOOLEAN_COLUMN) {
+        for (size_type i = 0; i < m_rows; ++i) {
+            col.integers[i] = col.integers[i] != 0;
+        }
+    }
+
+    col.type = type;
+}
+
+void ColumnMatrix::addNull(size_type column, size_type row)
+{
+    Column& col(m_columns[column]);
+
+    if (col.type == DOUBLE_COLUMN) {
+        col.reals[row] = 0.0;
+    } else {
+        col.integers[row] = 0;
+    }
+    col.present[row] = false;
+}
+
+void ColumnMatrix::addDouble(size_type column, size_type row,
+                             const double& value)
+{
+    Column& col(m_columns[column]);
+
+    if (col.type != DOUBLE_COLUMN) {
+        throw utils::ArgError(fmt(
+                _("ColumnMatrix: the column %1% is not a column of double")) %
+            column);
+    }
+    col.reals[row] = value;
+    col.present[row] = true;
+}
+
+void ColumnMatrix::addInt(size_type column, size_type row,
+                          const int32_t& value)
+{
+    Column& col(m_columns[column]);
+
+    if (col.type == DOUBLE_COLUMN) {
+        col.reals[row] = value;
+    } else if (col.type == INTEGER_COLUMN) {
+        col.integers[row] = value;
+    } else {
+        throw utils::ArgError(fmt(
+                _("ColumnMatrix: the column %1% is a column of boolean")) %
+            column);
+    }
+    col.present[row] = true;
+}
+
+void ColumnMatrix::addBoolean(size_type column, size_type row, bool value)
+{
+    Column& col(m_columns[column]);
+
+    if (col.type != BOOLEAN_COLUMN) {
+        throw utils::ArgError(fmt(
+                _("ColumnMatrix: the column %1% is not a column of "
+                  "boolean")) % column);
+    }
+    col.integers[row] = value;
+    col.present[row] = true;
+}
+
+void ColumnMatrix::add(size_type column, size_type row, const Value* value)
+{
+    if (not value or value->isNull()) {
+        addNull(column, row);
+    } else if (value->isDouble()) {
+        addDouble(column, row, value->toDouble().value());
+    } else if (value->isInteger()) {
+        addInt(column, row, value->toInteger().value());
+    } else if (value->isBoolean()) {
+        addBoolean(column, row, value->toBoolean().value());
+    } else {
+        throw utils::ArgError(fmt(
+                _("ColumnMatrix: the cell (%1%, %2%) is not a number")) %
+            column % row);
+    }
+}
+
+double ColumnMatrix::getDouble(size_type column, size_type row) const
+{
+    return check(column, row, DOUBLE_COLUMN).reals[row];
+}
+
+int32_t ColumnMatrix::getInt(size_type column, size_type row) const
+{
+    return check(column, row, INTEGER_COLUMN).integers[row];
+}
+
+bool ColumnMatrix::getBoolean(size_type column, size_type row) const
+{
+    return check(column, row, BOOLEAN_COLUMN).integers[row];
+}
+
+Value* ColumnMatrix::buildValue(size_type column, size_type row) const
+{
+    const Column& col(m_columns[column]);
+
+    if (not col.present[row]) {
+        return 0;
+    }
+
+    switch (col.type) {
+    case DOUBLE_COLUMN:
+        return new Double(col.reals[row]);
+    case INTEGER_COLUMN:
+        return new Integer(col.integers[row]);
+    default:
+        return new Boolean(col.integers[row]);
+    }
+}
+
+const double* ColumnMatrix::doubles(size_type column) const
+{
+    const Column& col(m_columns[column]);
+
+    return col.reals.empty() ? 0 : &col.reals[0];
+}
+
+const int32_t* ColumnMatrix::integers(size_type column) const
+{
+    const Column& col(m_columns[column]);
+
+    return col.integers.empty() ? 0 : &col.integers[0];
+}
+
+ColumnMatrix::size_type ColumnMatrix::count(size_type column) const
+{
+    const std::vector < bool >& present(m_columns[column].present);
+
+    return std::count(present.begin(), present.end(), true);
+}
+
+double ColumnMatrix::sum(size_type column) const
+{
+    // The null cells are zero: the loops read the contiguous cells without
+    // test, the four partial sums of the doubles let the compiler
+    // vectorize the loop.
+    const Column& col(m_columns[column]);
+
+    if (col.type == DOUBLE_COLUMN) {
+        const double* cells = doubles(column);
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        size_type i = 0;
+
+        for (; i + 4 <= m_rows; i += 4) {
+            s0 += cells[i];
+            s1 += cells[i + 1];
+            s2 += cells[i + 2];
+            s3 += cells[i + 3];
+        }
+        for (; i < m_rows; ++i) {
+            s0 += cells[i];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    const int32_t* cells = integers(column);
+    int64_t result = 0;
+
+    for (size_type i = 0; i < m_rows; ++i) {
+        result += cells[i];
+    }
+    return static_cast < double >(result);
+}
+
+bool ColumnMatrix::range(size_type column, double* min, double* max) const
+{
+    const Column& col(m_columns[column]);
+    bool found = false;
+
+    for (size_type i = 0; i < m_rows; ++i) {
+        if (col.present[i]) {
+            double value = col.type == DOUBLE_COLUMN ? col.reals[i] :
+                col.integers[i];
+
+            if (not found) {
+                *min = *max = value;
+                found = true;
+            } else {
+                *min = std::min(*min, value);
+                *max = std::max(*max, value);
+            }
+        }
+    }
+
+    return found;
+}
+
+const ColumnMatrix::Column& ColumnMatrix::check(size_type column,
+                                                size_type row,
+                                                ColumnType type) const
+{
+#ifndef NDEBUG
+    if (not (column < m_columns.size() and row < m_rows)) {
+        throw utils::ArgError(_("ColumnMatrix: bad access"));
+    }
+#endif
+
+    const Column& col(m_columns[column]);
+
+    if (col.type != type) {
+        throw utils::CastError(fmt(
+                _("ColumnMatrix: bad type of the column %1%")) % column);
+    }
+
+    if (not col.present[row]) {
+        throw utils::ArgError(_("Null value"));
+    }
+
+    return col;
+}
+
+bool ColumnMatrix::hasNames() const
+{
+    for (std::vector < Column >::const_iterator it = m_columns.begin();
+         it != m_columns.end(); ++it) {
+        if (not it->name.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ColumnMatrix::write(std::ostream& out,
+                         void (Value::*function)(std::ostream&) const,
+                         const char* null) const
+{
+    if (hasNames()) {
+        for (size_type i = 0; i < columns(); ++i) {
+            String name(m_columns[i].name);
+            (name.*function)(out);
+            out << " ";
+        }
+        out << "\n";
+    }
+
+    for (size_type j = 0; j < m_rows; ++j) {
+        for (size_type i = 0; i < columns(); ++i) {
+            const Column& col(m_columns[i]);
+
+            if (not col.present[j]) {
+                out << null;
+            } else if (col.type == DOUBLE_COLUMN) {
+                Double cell(col.reals[j]);
+                (cell.*function)(out);
+            } else if (col.type == INTEGER_COLUMN) {
+                Integer cell(col.integers[j]);
+                (cell.*function)(out);
+            } else {
+                Boolean cell(col.integers[j]);
+                (cell.*function)(out);
+            }
+            out << " ";
+        }
+        out << "\n";
+    }
+}
+
+}} // namespace vle value
@@ -0,0 +1,388 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef VLE_VALUE_COLUMNMATRIX_HPP
+#define VLE_VALUE_COLUMNMATRIX_HPP 1
+
+#include <vle/value/Value.hpp>
+#include <vle/DllDefines.hpp>
+#include <string>
+#include <vector>
+
+namespace vle { namespace value {
+
+/**
+ * @brief A ColumnMatrix Value is a matrix of numbers stored by columns.
+ * Each column has a type (double, integer or boolean) and stores its cells
+ * in a contiguous std::vector with a bitmap of the null cells: a cell uses
+ * the size of its number instead of a pointer to an allocated value::Value
+ * as in the value::Matrix. A null cell stores zero and the reductions of a
+ * column (sum(), count(), range()) run over the contiguous cells.
+ *
+ * The accessors (columns(), rows(), getDouble(), addDouble(), etc.) have
+ * the semantic of the value::Matrix accessors, a ColumnMatrix converts
+ * from and to a value::Matrix with an optional header row of the column
+ * names.
+ */
+class VLE_API ColumnMatrix : public Value
+{
+public:
+    /// The type of the cells of a column.
+    enum ColumnType { DOUBLE_COLUMN, INTEGER_COLUMN, BOOLEAN_COLUMN };
+
+    typedef std::vector < double >::size_type size_type;
+
+    /// The resize steps of the value::Matrix of buildMatrix().
+    static const size_type RESIZE_STEP = 10;
+
+    /**
+     * @brief Build an empty ColumnMatrix.
+     */
+    ColumnMatrix()
+        : m_rows(0)
+    {}
+
+    /**
+     * @brief Build a ColumnMatrix from a value::Matrix of value::Double,
+     * value::Integer, value::Boolean and null cells (NULL or value::Null).
+     * If the cells of the first row are strings or null, the first row is
+     * the names of the columns. The type of a column is the widest type
+     * of its cells: a column which mixes integers and doubles is a column
+     * of double, a column which mixes booleans and integers is a column of
+     * integer.
+     * @param matrix the matrix to convert.
+     * @throw utils::ArgError if a cell is not a number.
+     */
+    explicit ColumnMatrix(const Matrix& matrix);
+
+    /**
+     * @brief Copy constructor, the columns are copied.
+     * @param value the ColumnMatrix to copy.
+     */
+    ColumnMatrix(const ColumnMatrix& value)
+        : Value(value), m_columns(value.m_columns), m_rows(value.m_rows)
+    {}
+
+    virtual ~ColumnMatrix()
+    {}
+
+    /**
+     * @brief Build an empty ColumnMatrix.
+     * @return A new ColumnMatrix.
+     */
+    static ColumnMatrix* create()
+    { return new ColumnMatrix(); }
+
+    ///
+    ////
+    ///
+
+    /**
+     * @brief Clone the ColumnMatrix.
+     * @return A new ColumnMatrix.
+     */
+    virtual Value* clone() const
+    { return new ColumnMatrix(*this); }
+
+    /**
+     * @brief Get the type of this class.
+     * @return Value::COLUMN_MATRIX.
+     */
+    virtual Value::type getType() const
+    { return Value::COLUMN_MATRIX; }
+
+    /**
+     * @brief Push the rows of the matrix space separated, the null cells
+     * are NA, as the value::Matrix of buildMatrix().
+     * @param out The output stream.
+     */
+    virtual void writeFile(std::ostream& out) const;
+
+    /**
+     * @brief Push the rows of the matrix space separated, the null cells
+     * are NA, as the value::Matrix of buildMatrix().
+     * @param out The output stream.
+     */
+    virtual void writeString(std::ostream& out) const;
+
+    /**
+     * @brief Push the XML representation of the value::Matrix of
+     * buildMatrix(): the ColumnMatrix is read as a value::Matrix.
+     * @param out The output stream.
+     */
+    virtual void writeXml(std::ostream& out) const;
+
+    ///
+    ////
+    ///
+
+    /**
+     * @brief Build the value::Matrix of the ColumnMatrix: a cell is a
+     * value::Double, a value::Integer, a value::Boolean or NULL. If a
+     * column has a name, the first row is the names of the columns.
+     * @return A new value::Matrix.
+     */
+    Matrix* buildMatrix() const;
+
+    /**
+     * @brief Add a column of null cells.
+     * @param type the type of the cells.
+     * @param name the name of the column.
+     * @return the index of the column.
+     */
+    size_type addColumn(ColumnType type, const std::string& name =
+                        std::string());
+
+    /**
+     * @brief Add a row of null cells.
+     */
+    void addRow();
+
+    /**
+     * @brief Change the number of rows, the new cells are null.
+     * @param rows the number of rows.
+     */
+    void resize(size_type rows);
+
+    /**
+     * @brief Delete the columns and the rows.
+     */
+    void clear();
+
+    size_type columns() const
+    { return m_columns.size(); }
+
+    size_type rows() const
+    { return m_rows; }
+
+    /**
+     * @brief Get the number of cells: columns() * rows().
+     */
+    size_type size() const
+    { return columns() * rows(); }
+
+    ColumnType type(size_type column) const
+    { return m_columns[column].type; }
+
+    /**
+     * @brief Change the type of a column, the cells are converted.
+     * @param column the column.
+     * @param type the new type.
+     */
+    void setType(size_type column, ColumnType type);
+
+    const std::string& name(size_type column) const
+    { return m_columns[column].name; }
+
+    void setName(size_type column, const std::string& name)
+    { m_columns[column].name = name; }
+
+    ///
+    ////
+    ///
+
+    /**
+     * @brief Test if a cell is null.
+     * @param column The column.
+     * @param row The row.
+     * @return true if the cell has no number.
+     */
+    bool isNull(size_type column, size_type row) const
+    { return not m_columns[column].present[row]; }
+
+    /**
+     * @brief Set a cell to null.
+     * @param column The column.
+     * @param row The row.
+     */
+    void addNull(size_type column, size_type row);
+
+    /**
+     * @brief Set a cell of a column of double.
+     * @param column The column.
+     * @param row The row.
+     * @param value The value of the cell.
+     * @throw utils::ArgError if the column is not a column of double.
+     */
+    void addDouble(size_type column, size_type row, const double& value);
+
+    /**
+     * @brief Set a cell of a column of integer or of double.
+     * @param column The column.
+     * @param row The row.
+     * @param value The value of the cell.
+     * @throw utils::ArgError if the column is a column of boolean.
+     */
+    void addInt(size_type column, size_type row, const int32_t& value);
+
+    /**
+     * @brief Set a cell of a column of boolean.
+     * @param column The column.
+     * @param row The row.
+     * @param value The value of the cell.
+     * @throw utils::ArgError if the column is not a column of boolean.
+     */
+    void addBoolean(size_type column, size_type row, bool value);
+
+    /**
+     * @brief Set a cell from a value::Double, a value::Integer, a
+     * value::Boolean, a value::Null or NULL.
+     * @param column The column.
+     * @param row The row.
+     * @param value The value of the cell, not deleted.
+     * @throw utils::ArgError if the value is not a number of the type of
+     * the column.
+     */
+    void add(size_type column, size_type row, const Value* value);
+
+    /**
+     * @brief Get a cell of a column of double.
+     * @param column The column.
+     * @param row The row.
+     * @return The double read from the matrix.
+     * @throw utils::ArgError if the cell is null, utils::CastError if the
+     * column is not a column of double.
+     */
+    double getDouble(size_type column, size_type row) const;
+
+    /**
+     * @brief Get a cell of a column of integer.
+     * @param column The column.
+     * @param row The row.
+     * @return The integer read from the matrix.
+     * @throw utils::ArgError if the cell is null, utils::CastError if the
+     * column is not a column of integer.
+     */
+    int32_t getInt(size_type column, size_type row) const;
+
+    /**
+     * @brief Get a cell of a column of boolean.
+     * @param column The column.
+     * @param row The row.
+     * @return The boolean read from the matrix.
+     * @throw utils::ArgError if the cell is null, utils::CastError if the
+     * column is not a column of boolean.
+     */
+    bool getBoolean(size_type column, size_type row) const;
+
+    /**
+     * @brief Build the value of a cell.
+     * @param column The column.
+     * @param row The row.
+     * @return A new value::Double, value::Integer or value::Boolean, NULL
+     * for a null cell.
+     */
+    Value* buildValue(size_type column, size_type row) const;
+
+    ///
+    ////
+    ///
+
+    /**
+     * @brief Get the cells of a column of double, zero for a null cell.
+     * @return A pointer to the rows() cells, NULL for the other columns.
+     */
+    const double* doubles(size_type column) const;
+
+    /**
+     * @brief Get the cells of a column of integer or of boolean (0 or 1),
+     * zero for a null cell.
+     * @return A pointer to the rows() cells, NULL for a column of double.
+     */
+    const int32_t* integers(size_type column) const;
+
+    /**
+     * @brief Get the number of cells of a column which are not null.
+     */
+    size_type count(size_type column) const;
+
+    /**
+     * @brief Get the sum of the cells of a column, the null cells are
+     * ignored.
+     */
+    double sum(size_type column) const;
+
+    /**
+     * @brief Get the minimum and the maximum of the cells of a column
+     * which are not null.
+     * @return false if all the cells are null.
+     */
+    bool range(size_type column, double* min, double* max) const;
+
+private:
+    ColumnMatrix& operator=(const ColumnMatrix& other);
+
+    /**
+     * The cells of a column: the numbers and the bitmap of the cells which
+     * are not null.
+     */
+    struct Column
+    {
+        Column(ColumnType type, const std::string& name)
+            : type(type), name(name)
+        {}
+
+        ColumnType              type;
+        std::string             name;
+        std::vector < double >  reals; ///< the column of double.
+        std::vector < int32_t > integers; ///< the other columns.
+        std::vector < bool >    present;
+    };
+
+    std::vector < Column > m_columns;
+    size_type              m_rows;
+
+    const Column& check(size_type column, size_type row,
+                        ColumnType type) const;
+
+    bool hasNames() const;
+
+    /**
+     * Write the header row and the cells with @e function of the values,
+     * a null cell is @e null.
+     */
+    void write(std::ostream& out,
+               void (Value::*function)(std::ostream&) const,
+               const char* null) const;
+};
+
+inline const ColumnMatrix& toColumnMatrixValue(const Value& value)
+{ return value.toColumnMatrix(); }
+
+inline const ColumnMatrix* toColumnMatrixValue(const Value* value)
+{ return value ? &value->toColumnMatrix() : 0; }
+
+inline ColumnMatrix& toColumnMatrixValue(Value& value)
+{ return value.toColumnMatrix(); }
+
+inline ColumnMatrix* toColumnMatrixValue(Value* value)
+{ return value ? &value->toColumnMatrix() : 0; }
+
+}} // namespace vle value
+
+#endif
@@ -38,6 +38,7 @@
 #include <vle/value/Null.hpp>
 #include <vle/value/Matrix.hpp>
 #include <vle/value/User.hpp>
+#include <vle/value/ColumnMatrix.hpp>
 #include <sstream>
 
 namespace vle { namespace value {
@@ -159,6 +160,14 @@ const User& Value::toUser() const
     return static_cast < const User& >(*this);
 }
 
+const ColumnMatrix& Value::toColumnMatrix() const
+{
+    if (not isColumnMatrix()) {
+        throw utils::CastError(_("Value is not a column matrix"));
+    }
+    return static_cast < const ColumnMatrix& >(*this);
+}
+
 Boolean& Value::toBoolean()
 {
     if (not isBoolean()) {
@@ -255,5 +264,13 @@ User& Value::toUser()
     return static_cast < User& >(*this);
 }
 
+ColumnMatrix& Value::toColumnMatrix()
+{
+    if (not isColumnMatrix()) {
+        throw utils::CastError(_("Value is not a column matrix"));
+    }
+    return static_cast < ColumnMatrix& >(*this);
+}
+
 }} // namespace vle value
 
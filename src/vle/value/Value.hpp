@@ -48,6 +48,7 @@ namespace vle { namespace value {
     class Null;
     class Matrix;
     class User;
+    class ColumnMatrix;
 
     /**
      * @brief Virtual class to assign Value into Event object.
@@ -56,7 +57,7 @@ namespace vle { namespace value {
     {
     public:
         enum type { BOOLEAN, INTEGER, DOUBLE, STRING, SET, MAP, TUPLE, TABLE,
-            XMLTYPE, NIL, MATRIX, USER };
+            XMLTYPE, NIL, MATRIX, USER, COLUMN_MATRIX };
 
 	/**
 	 * @brief Default constructor.
@@ -180,6 +181,9 @@ namespace vle { namespace value {
         inline bool isUser() const
         { return getType() == Value::USER; }
 
+        inline bool isColumnMatrix() const
+        { return getType() == Value::COLUMN_MATRIX; }
+
         const Boolean& toBoolean() const;
         const Integer& toInteger() const;
         const Double& toDouble() const;
@@ -192,12 +196,14 @@ namespace vle { namespace value {
         const Null& toNull() const;
         const Matrix& toMatrix() const;
         const User& toUser() const;
+        const ColumnMatrix& toColumnMatrix() const;
 
         /**
-         * @brief Check if the Value is a composite value, ie., a Map, a Set or
-         * a Matrix.
+         * @brief Check if the Value is a composite value, ie., a Map, a Set, a
+         * Matrix or a ColumnMatrix.
          * @param val The Value to check.
-         * @return True if the Value is a Map, a Set or a Matrix.
+         * @return True if the Value is a Map, a Set, a Matrix or a
+         * ColumnMatrix.
          */
         inline static bool isComposite(const Value* val)
         {
@@ -205,6 +211,7 @@ namespace vle { namespace value {
             case Value::MAP:
             case Value::SET:
             case Value::MATRIX:
+            case Value::COLUMN_MATRIX:
                 return true;
             default:
                 return false;
@@ -223,6 +230,7 @@ namespace vle { namespace value {
         Null& toNull();
         Matrix& toMatrix();
         User& toUser();
+        ColumnMatrix& toColumnMatrix();
 
         /**
          * @brief Stream operator for the value classes. This operator call the
@@ -273,8 +281,8 @@ namespace vle { namespace value {
     ///
 
     /**
-     * @brief A functor to find composite Value, ie., values of type Map, Set or
-     * Matrix. To use with std::find_if for instance:
+     * @brief A functor to find composite Value, ie., values of type Map, Set,
+     * Matrix or ColumnMatrix. To use with std::find_if for instance:
      * @code
      * iterator it = std::find_if(begin(), end(), IsComposite());
      * @endcode
@@ -40,6 +40,7 @@
 #include <functional>
 #include <vle/value/Value.hpp>
 #include <vle/value/Boolean.hpp>
+#include <vle/value/ColumnMatrix.hpp>
 #include <vle/value/Double.hpp>
 #include <vle/value/Integer.hpp>
 #include <vle/value/Map.hpp>
@@ -268,6 +269,102 @@ BOOST_AUTO_TEST_CASE(check_matrix)
     delete(cpy);
 }
 
+BOOST_AUTO_TEST_CASE(check_column_matrix)
+{
+    value::ColumnMatrix mx;
+    BOOST_REQUIRE_EQUAL(mx.addColumn(value::ColumnMatrix::DOUBLE_COLUMN,
+                                     "time"), 0u);
+    BOOST_REQUIRE_EQUAL(mx.addColumn(value::ColumnMatrix::INTEGER_COLUMN,
+                                     "count"), 1u);
+    BOOST_REQUIRE_EQUAL(mx.addColumn(value::ColumnMatrix::BOOLEAN_COLUMN),
+                        2u);
+
+    for (int i = 0; i < 10; ++i) {
+        mx.addRow();
+        mx.addDouble(0, i, i * 0.5);
+        if (i != 3) {
+            mx.addInt(1, i, i * 2);
+        }
+        mx.addBoolean(2, i, i % 2);
+    }
+
+    BOOST_REQUIRE_EQUAL(mx.columns(), 3u);
+    BOOST_REQUIRE_EQUAL(mx.rows(), 10u);
+    BOOST_REQUIRE_EQUAL(mx.getDouble(0, 4), 2.0);
+    BOOST_REQUIRE_EQUAL(mx.getInt(1, 4), 8);
+    BOOST_REQUIRE(mx.getBoolean(2, 5));
+    BOOST_REQUIRE(mx.isNull(1, 3));
+    BOOST_REQUIRE_THROW(mx.getInt(1, 3), utils::ArgError);
+    BOOST_REQUIRE_THROW(mx.getInt(0, 4), utils::CastError);
+    BOOST_REQUIRE_THROW(mx.addBoolean(0, 4, true), utils::ArgError);
+
+    BOOST_REQUIRE_EQUAL(mx.count(1), 9u);
+    BOOST_REQUIRE_EQUAL(mx.sum(0), 22.5);
+    BOOST_REQUIRE_EQUAL(mx.sum(1), 90.0 - 6.0);
+    BOOST_REQUIRE_EQUAL(mx.sum(2), 5.0);
+    BOOST_REQUIRE_EQUAL(mx.doubles(0)[9], 4.5);
+    BOOST_REQUIRE_EQUAL(mx.integers(1)[3], 0);
+    BOOST_REQUIRE(not mx.doubles(1));
+
+    double min, max;
+    BOOST_REQUIRE(mx.range(1, &min, &max));
+    BOOST_REQUIRE_EQUAL(min, 0.0);
+    BOOST_REQUIRE_EQUAL(max, 18.0);
+
+    // The value::Matrix of the ColumnMatrix has the names in the first row
+    // and converts back to the same ColumnMatrix.
+    value::Matrix* matrix = mx.buildMatrix();
+    BOOST_REQUIRE_EQUAL(matrix->columns(), 3u);
+    BOOST_REQUIRE_EQUAL(matrix->rows(), 11u);
+    BOOST_REQUIRE_EQUAL(matrix->getString(1, 0), "count");
+    BOOST_REQUIRE_EQUAL(matrix->getString(2, 0), "");
+    BOOST_REQUIRE_EQUAL(matrix->getInt(1, 5), 8);
+    BOOST_REQUIRE(not matrix->get(1, 4));
+    BOOST_REQUIRE_EQUAL(matrix->writeToString(), mx.writeToString());
+    BOOST_REQUIRE_EQUAL(matrix->writeToXml(), mx.writeToXml());
+
+    value::ColumnMatrix back(*matrix);
+    BOOST_REQUIRE_EQUAL(back.columns(), 3u);
+    BOOST_REQUIRE_EQUAL(back.rows(), 10u);
+    BOOST_REQUIRE_EQUAL(back.name(0), "time");
+    BOOST_REQUIRE_EQUAL(back.type(1), value::ColumnMatrix::INTEGER_COLUMN);
+    BOOST_REQUIRE_EQUAL(back.type(2), value::ColumnMatrix::BOOLEAN_COLUMN);
+    BOOST_REQUIRE_EQUAL(back.writeToString(), mx.writeToString());
+    delete matrix;
+
+    matrix = value::Matrix::create(2, 2, 1, 1);
+    matrix->addDouble(0, 0, 1.0);
+    matrix->addString(0, 1, "x");
+    BOOST_REQUIRE_THROW(value::ColumnMatrix bad(*matrix), utils::ArgError);
+    delete matrix;
+
+    // A column of integers and doubles is a column of double.
+    matrix = value::Matrix::create(1, 3, 1, 1);
+    matrix->addString(0, 0, "mixed");
+    matrix->addInt(0, 1, 3);
+    matrix->addDouble(0, 2, 0.5);
+    value::ColumnMatrix mixed(*matrix);
+    BOOST_REQUIRE_EQUAL(mixed.type(0), value::ColumnMatrix::DOUBLE_COLUMN);
+    BOOST_REQUIRE_EQUAL(mixed.getDouble(0, 0), 3.0);
+    BOOST_REQUIRE_EQUAL(mixed.getDouble(0, 1), 0.5);
+    delete matrix;
+
+    value::Value* cpy = mx.clone();
+    BOOST_REQUIRE(cpy->isColumnMatrix());
+    BOOST_REQUIRE(not cpy->isMatrix());
+    BOOST_REQUIRE(value::Value::isComposite(cpy));
+    value::toColumnMatrixValue(*cpy).addDouble(0, 0, 10.0);
+    BOOST_REQUIRE_EQUAL(mx.getDouble(0, 0), 0.0);
+    BOOST_REQUIRE_EQUAL(cpy->toColumnMatrix().getDouble(0, 0), 10.0);
+    delete cpy;
+
+    mx.setType(0, value::ColumnMatrix::INTEGER_COLUMN);
+    BOOST_REQUIRE_EQUAL(mx.getInt(0, 5), 2);
+    mx.setType(1, value::ColumnMatrix::DOUBLE_COLUMN);
+    BOOST_REQUIRE_EQUAL(mx.getDouble(1, 5), 10.0);
+    BOOST_REQUIRE(mx.isNull(1, 3));
+}
+
 namespace test {
 
     class MyData : public vle::value::User
@@ -27,7 +27,9 @@
 
 #include <vle/vpz/Experiment.hpp>
 #include <vle/value/Double.hpp>
+#include <vle/value/Integer.hpp>
 #include <vle/value/Set.hpp>
+#include <vle/value/String.hpp>
 
 namespace vle { namespace vpz {
 
@@ -132,6 +134,147 @@ double Experiment::begin() const
     return condSim.getSetValues("begin").getDouble(0);
 }
 
+void Experiment::setScheduler(const std::string& name)
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        throw utils::ArgError(_("The simulation engine condition "
+                "does not exist"));
+    }
+    vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::iterator it = condSim.conditionvalues().find("scheduler");
+    if (it == condSim.end()) {
+        if (not name.empty()) {
+            condSim.addValueToPort("scheduler", new vle::value::String(name));
+        }
+    } else {
+        it->second->clear();
+        if (not name.empty()) {
+            it->second->add(new vle::value::String(name));
+        }
+    }
+}
+
+std::string Experiment::scheduler() const
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        return std::string();
+    }
+    const vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::const_iterator it = condSim.conditionvalues().find(
+            "scheduler");
+    if (it == condSim.end() or it->second->empty()) {
+        return std::string();
+    }
+    return it->second->getString(0);
+}
+
+void Experiment::setThreads(unsigned int threads)
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        throw utils::ArgError(_("The simulation engine condition "
+                "does not exist"));
+    }
+    vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::iterator it = condSim.conditionvalues().find("threads");
+    if (it == condSim.end()) {
+        condSim.addValueToPort("threads", new vle::value::Integer(threads));
+    } else {
+        it->second->clear();
+        it->second->add(new vle::value::Integer(threads));
+    }
+}
+
+unsigned int Experiment::threads() const
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        return 0;
+    }
+    const vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::const_iterator it = condSim.conditionvalues().find(
+            "threads");
+    if (it == condSim.end() or it->second->empty()) {
+        return 0;
+    }
+    int threads = it->second->getInt(0);
+    return threads > 0 ? threads : 0;
+}
+
+void Experiment::setObservationQueue(unsigned int capacity)
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        throw utils::ArgError(_("The simulation engine condition "
+                "does not exist"));
+    }
+    vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::iterator it = condSim.conditionvalues().find(
+            "observation-queue");
+    if (it == condSim.end()) {
+        condSim.addValueToPort("observation-queue",
+                               new vle::value::Integer(capacity));
+    } else {
+        it->second->clear();
+        it->second->add(new vle::value::Integer(capacity));
+    }
+}
+
+unsigned int Experiment::observationQueue() const
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        return 0;
+    }
+    const vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::const_iterator it = condSim.conditionvalues().find(
+            "observation-queue");
+    if (it == condSim.end() or it->second->empty()) {
+        return 0;
+    }
+    int capacity = it->second->getInt(0);
+    return capacity > 0 ? capacity : 0;
+}
+
+void Experiment::setTraffic(const std::string& filename)
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        throw utils::ArgError(_("The simulation engine condition "
+                "does not exist"));
+    }
+    vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::iterator it = condSim.conditionvalues().find("traffic");
+    if (it == condSim.end()) {
+        if (not filename.empty()) {
+            condSim.addValueToPort("traffic",
+                                   new vle::value::String(filename));
+        }
+    } else {
+        it->second->clear();
+        if (not filename.empty()) {
+            it->second->add(new vle::value::String(filename));
+        }
+    }
+}
+
+std::string Experiment::traffic() const
+{
+    if (not conditions().exist(defaultSimulationEngineCondName())) {
+        return std::string();
+    }
+    const vle::vpz::Condition& condSim = conditions().get(
+            defaultSimulationEngineCondName());
+    Condition::const_iterator it = condSim.conditionvalues().find(
+            "traffic");
+    if (it == condSim.end() or it->second->empty()) {
+        return std::string();
+    }
+    return it->second->getString(0);
+}
+
 void Experiment::cleanNoPermanent()
 {
     m_conditions.cleanNoPermanent();
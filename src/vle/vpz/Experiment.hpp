@@ -179,6 +179,83 @@ namespace vle { namespace vpz {
          */
         double begin() const;
 
+        /**
+         * @brief Assign the scheduler used by the devs::EventTable to store
+         * the internal events. The name is stored in the port "scheduler"
+         * of the simulation engine condition.
+         * @param name The name of the scheduler: "heap", "indexed-heap",
+         * "calendar" or an empty string to use the default scheduler.
+         * @throw utils::ArgError if the simulation engine condition does
+         * not exist.
+         */
+        void setScheduler(const std::string& name);
+
+        /**
+         * @brief Get the scheduler used by the devs::EventTable.
+         * @return The name of the scheduler or an empty string if the
+         * simulation engine condition does not define a scheduler.
+         */
+        std::string scheduler() const;
+
+        /**
+         * @brief Assign the number of threads used by the devs::Coordinator
+         * to run the transitions of the thread-safe models of a bag. The
+         * number is stored in the port "threads" of the simulation engine
+         * condition.
+         * @param threads The number of threads, 0 or 1 to run the bags in
+         * the simulation thread only.
+         * @throw utils::ArgError if the simulation engine condition does
+         * not exist.
+         */
+        void setThreads(unsigned int threads);
+
+        /**
+         * @brief Get the number of threads used by the devs::Coordinator.
+         * @return The number of threads or 0 if the simulation engine
+         * condition does not define it.
+         */
+        unsigned int threads() const;
+
+        /**
+         * @brief Assign the capacity of the queue of observations of each
+         * view: the observations are sent to the output plug-ins by a
+         * thread of the view (devs::StreamWriter::setQueue). The capacity
+         * is stored in the port "observation-queue" of the simulation
+         * engine condition.
+         * @param capacity The number of observations of the queue, 0 to
+         * call the plug-ins from the simulation thread.
+         * @throw utils::ArgError if the simulation engine condition does
+         * not exist.
+         */
+        void setObservationQueue(unsigned int capacity);
+
+        /**
+         * @brief Get the capacity of the queue of observations of a view.
+         * @return The capacity or 0 if the simulation engine condition
+         * does not define it.
+         */
+        unsigned int observationQueue() const;
+
+        /**
+         * @brief Assign the file where the devs::Coordinator writes the
+         * number of events sent through each connection of the atomic
+         * models at the end of the simulation: the traffic read by the
+         * vpz::Partitioner. The name is stored in the port "traffic" of the
+         * simulation engine condition.
+         * @param filename The name of the file or an empty string to not
+         * count the events.
+         * @throw utils::ArgError if the simulation engine condition does
+         * not exist.
+         */
+        void setTraffic(const std::string& filename);
+
+        /**
+         * @brief Get the file of the traffic of the connections.
+         * @return The name of the file or an empty string if the
+         * simulation engine condition does not define it.
+         */
+        std::string traffic() const;
+
         /**
          * @brief Set the experimental design combination.
          * @param name The new name of experimental design combination.
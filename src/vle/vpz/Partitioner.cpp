@@ -0,0 +1,719 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <vle/vpz/Partitioner.hpp>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/utils/Exception.hpp>
+#include <vle/utils/Rand.hpp>
+#include <vle/utils/i18n.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace vle { namespace vpz {
+
+namespace {
+
+const std::size_t NONE = std::numeric_limits < std::size_t >::max();
+
+/*
+ * An undirected weighted graph in compressed sparse row format: the
+ * neighbours of v are adjncy[xadj[v]] to adjncy[xadj[v + 1] - 1].
+ */
+struct Graph
+{
+    std::size_t size() const
+    { return vwgt.size(); }
+
+    double total() const
+    {
+        double result = 0.0;
+        for (std::size_t i = 0; i < vwgt.size(); ++i) {
+            result += vwgt[i];
+        }
+        return result;
+    }
+
+    std::vector < std::size_t > xadj;
+    std::vector < std::size_t > adjncy;
+    std::vector < double >      adjwgt;
+    std::vector < double >      vwgt;
+};
+
+/*
+ * The seed of the random generator: the partitions of a graph are the
+ * same from one run to another.
+ */
+const utils::Rand::result_type SEED = 12345;
+
+/*
+ * Get a random index in [0, n[.
+ */
+std::size_t randomIndex(utils::Rand& random, std::size_t n)
+{
+    return static_cast < std::size_t >(
+        random.getInt(0, static_cast < int >(n) - 1));
+}
+
+/*
+ * Shuffle the vector with the Fisher-Yates algorithm and the seeded
+ * generator instead of std::random_shuffle, which uses the generator of
+ * the C library.
+ */
+void shuffle(std::vector < std::size_t >& vector, utils::Rand& random)
+{
+    for (std::size_t i = vector.size(); i > 1; --i) {
+        std::swap(vector[i - 1], vector[randomIndex(random, i)]);
+    }
+}
+
+/*
+ * Build the graph of the models from the list of the edges (a, b) with
+ * a < b.
+ */
+void buildGraph(const std::vector < double >& weights,
+                const std::map < std::pair < std::size_t, std::size_t >,
+                double >& edges, Graph& graph)
+{
+    std::size_t n = weights.size();
+    std::vector < std::size_t > degree(n, 0);
+
+    for (std::map < std::pair < std::size_t, std::size_t >, double >::
+         const_iterator it = edges.begin(); it != edges.end(); ++it) {
+        degree[it->first.first]++;
+        degree[it->first.second]++;
+    }
+
+    graph.vwgt = weights;
+    graph.xadj.assign(n + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        graph.xadj[i + 1] = graph.xadj[i] + degree[i];
+    }
+    graph.adjncy.resize(graph.xadj[n]);
+    graph.adjwgt.resize(graph.xadj[n]);
+
+    std::vector < std::size_t > pos(graph.xadj.begin(), graph.xadj.end() - 1);
+    for (std::map < std::pair < std::size_t, std::size_t >, double >::
+         const_iterator it = edges.begin(); it != edges.end(); ++it) {
+        std::size_t a = it->first.first, b = it->first.second;
+
+        graph.adjncy[pos[a]] = b;
+        graph.adjwgt[pos[a]++] = it->second;
+        graph.adjncy[pos[b]] = a;
+        graph.adjwgt[pos[b]++] = it->second;
+    }
+}
+
+/*
+ * Pair the vertices of the list which are not matched yet and whose
+ * merged weight is at most maximum. If same is true, only the consecutive
+ * vertices of the same key are paired.
+ */
+void pairVertices(const Graph& graph, double maximum,
+                  const std::vector < std::pair < std::size_t, std::size_t > >&
+                  vertices, const std::vector < std::size_t >& order,
+                  bool same, std::vector < std::size_t >& match)
+{
+    std::size_t pending = NONE;
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        std::size_t v = order[vertices[i].second];
+        if (match[v] != v) {
+            continue;
+        }
+
+        if (pending != NONE and
+            (not same or vertices[pending].first == vertices[i].first) and
+            graph.vwgt[order[vertices[pending].second]] + graph.vwgt[v] <=
+            maximum) {
+            std::size_t u = order[vertices[pending].second];
+            match[u] = v;
+            match[v] = u;
+            pending = NONE;
+        } else {
+            pending = i;
+        }
+    }
+}
+
+/*
+ * Coarsen the graph by heavy edge matching: each vertex is merged with its
+ * unmatched neighbour of heaviest edge. The vertices without unmatched
+ * neighbour, the leaves of a star or the isolated vertices, are then
+ * merged together, first the vertices of the same neighbour, while the
+ * weight of the merged vertex is at most maximum. cmap gets the coarse
+ * vertex of each vertex.
+ */
+void coarsen(const Graph& graph, double maximum, utils::Rand& random,
+             std::vector < std::size_t >& cmap, Graph& coarse)
+{
+    std::size_t n = graph.size();
+    std::vector < std::size_t > match(n, NONE);
+    std::vector < std::size_t > order(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    shuffle(order, random);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t v = order[i];
+        if (match[v] != NONE) {
+            continue;
+        }
+
+        std::size_t best = v;
+        double weight = -1.0;
+        for (std::size_t e = graph.xadj[v]; e < graph.xadj[v + 1]; ++e) {
+            std::size_t u = graph.adjncy[e];
+            if (match[u] == NONE and u != v and graph.adjwgt[e] > weight) {
+                best = u;
+                weight = graph.adjwgt[e];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    std::vector < std::pair < std::size_t, std::size_t > > alone;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t v = order[i];
+        if (match[v] == v) {
+            alone.push_back(std::make_pair(
+                    graph.xadj[v] < graph.xadj[v + 1] ?
+                    graph.adjncy[graph.xadj[v]] : NONE, i));
+        }
+    }
+    std::sort(alone.begin(), alone.end());
+    pairVertices(graph, maximum, alone, order, true, match);
+    pairVertices(graph, maximum, alone, order, false, match);
+
+    std::size_t nc = 0;
+    std::vector < std::size_t > first;
+    cmap.assign(n, NONE);
+    for (std::size_t v = 0; v < n; ++v) {
+        if (cmap[v] == NONE) {
+            cmap[v] = nc;
+            cmap[match[v]] = nc;
+            first.push_back(v);
+            nc++;
+        }
+    }
+
+    coarse.vwgt.assign(nc, 0.0);
+    coarse.xadj.assign(1, 0);
+    coarse.adjncy.clear();
+    coarse.adjwgt.clear();
+
+    std::vector < std::size_t > pos(nc, NONE);
+    for (std::size_t c = 0; c < nc; ++c) {
+        std::size_t members[2] = { first[c], match[first[c]] };
+        std::size_t begin = coarse.adjncy.size();
+
+        for (std::size_t m = 0; m < (members[0] == members[1] ? 1u : 2u);
+             ++m) {
+            std::size_t v = members[m];
+            coarse.vwgt[c] += graph.vwgt[v];
+
+            for (std::size_t e = graph.xadj[v]; e < graph.xadj[v + 1]; ++e) {
+                std::size_t u = cmap[graph.adjncy[e]];
+                if (u == c) {
+                    continue;
+                }
+                if (pos[u] == NONE) {
+                    pos[u] = coarse.adjncy.size();
+                    coarse.adjncy.push_back(u);
+                    coarse.adjwgt.push_back(graph.adjwgt[e]);
+                } else {
+                    coarse.adjwgt[pos[u]] += graph.adjwgt[e];
+                }
+            }
+        }
+
+        for (std::size_t e = begin; e < coarse.adjncy.size(); ++e) {
+            pos[coarse.adjncy[e]] = NONE;
+        }
+        coarse.xadj.push_back(coarse.adjncy.size());
+    }
+}
+
+/*
+ * A free vertex of the greedy graph growing: the vertex the most connected
+ * to the part is the greatest, then the first after the start vertex.
+ */
+struct Candidate
+{
+    Candidate(double conn, std::size_t rank, std::size_t vertex)
+        : conn(conn), rank(rank), vertex(vertex)
+    {}
+
+    bool operator<(const Candidate& other) const
+    {
+        return conn < other.conn or
+            (conn == other.conn and rank > other.rank);
+    }
+
+    double      conn;
+    std::size_t rank;
+    std::size_t vertex;
+};
+
+/*
+ * Split the graph by greedy graph growing: each part grows from a free
+ * vertex, the first one after the start vertex, by adding the free vertex
+ * the most connected to the part until it reaches the average weight of
+ * the remaining parts. The free vertices are kept in a heap where the
+ * outdated candidates are skipped.
+ */
+void growParts(const Graph& graph, std::size_t parts, std::size_t start,
+               std::vector < std::size_t >& part)
+{
+    std::size_t n = graph.size();
+    double remaining = graph.total();
+    std::size_t free = n;
+    std::vector < double > conn(n, 0.0);
+    std::vector < Candidate > heap;
+
+    part.assign(n, NONE);
+
+    for (std::size_t p = 0; p < parts and free > 0; ++p) {
+        if (p + 1 == parts) {
+            for (std::size_t v = 0; v < n; ++v) {
+                if (part[v] == NONE) {
+                    part[v] = p;
+                }
+            }
+            break;
+        }
+
+        double target = remaining / (parts - p);
+        double weight = 0.0;
+        std::fill(conn.begin(), conn.end(), 0.0);
+
+        heap.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t v = (start + i) % n;
+            if (part[v] == NONE) {
+                heap.push_back(Candidate(0.0, i, v));
+            }
+        }
+        std::make_heap(heap.begin(), heap.end());
+
+        while (free > 0) {
+            std::size_t best = heap.front().vertex;
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+            if (part[best] != NONE) {
+                continue;
+            }
+
+            double next = weight + graph.vwgt[best];
+            if (weight > 0.0 and next > target and
+                next - target > target - weight) {
+                break;
+            }
+
+            part[best] = p;
+            weight = next;
+            free--;
+            for (std::size_t e = graph.xadj[best]; e < graph.xadj[best + 1];
+                 ++e) {
+                std::size_t v = graph.adjncy[e];
+                conn[v] += graph.adjwgt[e];
+                if (part[v] == NONE) {
+                    heap.push_back(Candidate(conn[v], (v + n - start) % n,
+                                             v));
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            if (weight >= target) {
+                break;
+            }
+        }
+        remaining -= weight;
+    }
+}
+
+/*
+ * Compute the weight of the edges between the parts.
+ */
+double cutWeight(const Graph& graph, const std::vector < std::size_t >& part)
+{
+    double result = 0.0;
+
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        for (std::size_t e = graph.xadj[v]; e < graph.xadj[v + 1]; ++e) {
+            if (part[v] != part[graph.adjncy[e]]) {
+                result += graph.adjwgt[e];
+            }
+        }
+    }
+
+    return result / 2.0;
+}
+
+/*
+ * Move the vertices to the neighbour part which reduces the most the cut
+ * without overloading it. A vertex of an overloaded part moves to the
+ * best part which can receive it.
+ */
+void refine(const Graph& graph, std::size_t parts, double maximum,
+            std::vector < std::size_t >& part)
+{
+    std::size_t n = graph.size();
+    std::vector < double > load(parts, 0.0);
+    std::vector < double > conn(parts, 0.0);
+    std::vector < std::size_t > touched;
+
+    for (std::size_t v = 0; v < n; ++v) {
+        load[part[v]] += graph.vwgt[v];
+    }
+
+    for (int pass = 0; pass < 8; ++pass) {
+        std::size_t moved = 0;
+
+        for (std::size_t v = 0; v < n; ++v) {
+            std::size_t from = part[v];
+            double w = graph.vwgt[v];
+            bool overloaded = load[from] > maximum;
+
+            touched.clear();
+            for (std::size_t e = graph.xadj[v]; e < graph.xadj[v + 1]; ++e) {
+                std::size_t q = part[graph.adjncy[e]];
+                if (conn[q] == 0.0) {
+                    touched.push_back(q);
+                }
+                conn[q] += graph.adjwgt[e];
+            }
+
+            if (overloaded) {
+                std::size_t lightest = std::min_element(
+                    load.begin(), load.end()) - load.begin();
+                if (std::find(touched.begin(), touched.end(), lightest) ==
+                    touched.end()) {
+                    touched.push_back(lightest);
+                }
+            }
+
+            std::size_t best = from;
+            double gain = overloaded ? -std::numeric_limits < double >::max()
+                : 0.0;
+            for (std::size_t i = 0; i < touched.size(); ++i) {
+                std::size_t q = touched[i];
+                if (q == from or load[q] + w > maximum) {
+                    continue;
+                }
+
+                double g = conn[q] - conn[from];
+                if (g > gain or (g == gain and best != from and
+                                 load[q] < load[best]) or
+                    (g == gain and best == from and
+                     load[q] + w < load[from])) {
+                    best = q;
+                    gain = g;
+                }
+            }
+
+            for (std::size_t i = 0; i < touched.size(); ++i) {
+                conn[touched[i]] = 0.0;
+            }
+            conn[from] = 0.0;
+
+            if (best != from) {
+                part[v] = best;
+                load[from] -= w;
+                load[best] += w;
+                moved++;
+            }
+        }
+
+        if (moved == 0) {
+            break;
+        }
+    }
+}
+
+} // anonymous namespace
+
+Partitioner::Partitioner(BaseModel* model)
+{
+    if (not model) {
+        throw utils::ArgError(_("Partitioner: no model"));
+    }
+
+    BaseModel::getAtomicModelList(model, m_models);
+    m_weights.assign(m_models.size(), 1.0);
+
+    for (std::size_t i = 0; i < m_models.size(); ++i) {
+        m_indexes[m_models[i]] = i;
+        m_names[m_models[i]->getCompleteName()] = i;
+    }
+
+    for (std::size_t i = 0; i < m_models.size(); ++i) {
+        const ConnectionList& outputs(m_models[i]->getOutputPortList());
+
+        for (ConnectionList::const_iterator it = outputs.begin();
+             it != outputs.end(); ++it) {
+            ModelPortList targets;
+            m_models[i]->getAtomicModelsTarget(it->first, targets);
+
+            for (ModelPortList::const_iterator jt = targets.begin();
+                 jt != targets.end(); ++jt) {
+                boost::unordered_map < const BaseModel*, std::size_t >::
+                    const_iterator target = m_indexes.find(jt->first);
+
+                if (target != m_indexes.end() and target->second != i) {
+                    m_connections[std::make_pair(
+                            std::min(i, target->second),
+                            std::max(i, target->second))] += 1.0;
+                }
+            }
+        }
+    }
+}
+
+std::size_t Partitioner::index(const AtomicModel* model) const
+{
+    boost::unordered_map < const BaseModel*, std::size_t >::const_iterator
+        it = m_indexes.find(model);
+
+    if (it != m_indexes.end()) {
+        return it->second;
+    }
+
+    throw utils::ArgError(fmt(_("Partitioner: unknown model '%1%'")) %
+                          (model ? model->getName() : std::string()));
+}
+
+std::size_t Partitioner::index(const std::string& name) const
+{
+    std::map < std::string, std::size_t >::const_iterator it =
+        m_names.find(name);
+
+    if (it == m_names.end()) {
+        throw utils::ArgError(fmt(_("Partitioner: unknown model '%1%'")) %
+                              name);
+    }
+
+    return it->second;
+}
+
+void Partitioner::addTraffic(const AtomicModel* source,
+                             const AtomicModel* target, double events)
+{
+    std::size_t a = index(source), b = index(target);
+
+    if (a != b) {
+        m_traffic[std::make_pair(std::min(a, b), std::max(a, b))] += events;
+    }
+}
+
+void Partitioner::readTraffic(std::istream& in)
+{
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.empty() or line[0] == '#') {
+            continue;
+        }
+
+        std::string::size_type first = line.find('\t');
+        std::string::size_type second = first == std::string::npos ?
+            first : line.find('\t', first + 1);
+        if (second == std::string::npos) {
+            throw utils::ArgError(fmt(
+                    _("Partitioner: bad traffic line '%1%'")) % line);
+        }
+
+        double events;
+        try {
+            events = boost::lexical_cast < double >(line.substr(second + 1));
+        } catch (const boost::bad_lexical_cast& /* e */) {
+            throw utils::ArgError(fmt(
+                    _("Partitioner: bad traffic line '%1%'")) % line);
+        }
+
+        std::size_t a = index(line.substr(0, first));
+        std::size_t b = index(line.substr(first + 1, second - first - 1));
+        if (a != b) {
+            m_traffic[std::make_pair(std::min(a, b), std::max(a, b))] +=
+                events;
+        }
+    }
+}
+
+void Partitioner::setWeight(std::size_t model, double weight)
+{
+    if (model >= m_weights.size()) {
+        throw utils::ArgError(fmt(_("Partitioner: unknown model %1%")) %
+                              model);
+    }
+
+    m_weights[model] = weight;
+}
+
+Partitioner::Partition Partitioner::partition(std::size_t parts,
+                                              double imbalance) const
+{
+    if (parts == 0) {
+        throw utils::ArgError(_("Partitioner: at least one part"));
+    }
+
+    Partition result(m_models.size(), 0);
+    if (parts == 1 or m_models.empty()) {
+        return result;
+    }
+
+    std::vector < Graph > graphs(1);
+    std::vector < std::vector < std::size_t > > cmaps;
+    buildGraph(m_weights, m_traffic.empty() ? m_connections : m_traffic,
+               graphs[0]);
+
+    utils::Rand random(SEED);
+    std::size_t threshold = std::max < std::size_t >(parts * 20, 64);
+    double heaviest = 1.5 * graphs[0].total() / threshold;
+    while (graphs.back().size() > threshold) {
+        Graph coarse;
+        cmaps.push_back(std::vector < std::size_t >());
+        coarsen(graphs.back(), heaviest, random, cmaps.back(), coarse);
+
+        if (coarse.size() * 10 > graphs.back().size() * 9) {
+            cmaps.pop_back();
+            break;
+        }
+        graphs.push_back(coarse);
+    }
+
+    /* The coarsest graph is small: several initial partitions are built
+     * from different start vertices and the best one is kept. */
+    const Graph& coarsest(graphs.back());
+    double maximum = (1.0 + imbalance) * graphs[0].total() / parts;
+    std::vector < std::size_t > part, trial;
+    double best = 0.0;
+
+    for (std::size_t i = 0; i < 8; ++i) {
+        growParts(coarsest, parts, randomIndex(random, coarsest.size()), trial);
+        refine(coarsest, parts, maximum, trial);
+
+        double weight = cutWeight(coarsest, trial);
+        if (part.empty() or weight < best) {
+            part.swap(trial);
+            best = weight;
+        }
+    }
+
+    for (std::size_t level = cmaps.size(); level > 0; --level) {
+        const std::vector < std::size_t >& cmap(cmaps[level - 1]);
+        std::vector < std::size_t > fine(cmap.size());
+
+        for (std::size_t v = 0; v < cmap.size(); ++v) {
+            fine[v] = part[cmap[v]];
+        }
+        part.swap(fine);
+        refine(graphs[level - 1], parts, maximum, part);
+    }
+
+    result.assign(part.begin(), part.end());
+    return result;
+}
+
+double Partitioner::cut(const Partition& partition) const
+{
+    const EdgeList& edges(m_traffic.empty() ? m_connections : m_traffic);
+    double result = 0.0;
+
+    for (EdgeList::const_iterator it = edges.begin(); it != edges.end();
+         ++it) {
+        if (partition[it->first.first] != partition[it->first.second]) {
+            result += it->second;
+        }
+    }
+
+    return result;
+}
+
+std::vector < double > Partitioner::weights(const Partition& partition,
+                                            std::size_t parts) const
+{
+    std::vector < double > result(parts, 0.0);
+
+    for (std::size_t i = 0; i < partition.size(); ++i) {
+        if (partition[i] < parts) {
+            result[partition[i]] += m_weights[i];
+        }
+    }
+
+    return result;
+}
+
+void Partitioner::write(std::ostream& out, const Partition& partition) const
+{
+    for (std::size_t i = 0; i < m_models.size(); ++i) {
+        out << m_models[i]->getCompleteName() << '\t' << partition[i]
+            << '\n';
+    }
+}
+
+Partitioner::Partition Partitioner::read(std::istream& in) const
+{
+    Partition result(m_models.size(), NONE);
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.empty() or line[0] == '#') {
+            continue;
+        }
+
+        std::string::size_type tab = line.rfind('\t');
+        if (tab == std::string::npos) {
+            throw utils::ArgError(fmt(
+                    _("Partitioner: bad partition line '%1%'")) % line);
+        }
+
+        try {
+            result[index(line.substr(0, tab))] =
+                boost::lexical_cast < std::size_t >(line.substr(tab + 1));
+        } catch (const boost::bad_lexical_cast& /* e */) {
+            throw utils::ArgError(fmt(
+                    _("Partitioner: bad partition line '%1%'")) % line);
+        }
+    }
+
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        if (result[i] == NONE) {
+            throw utils::ArgError(fmt(
+                    _("Partitioner: no part for the model '%1%'")) %
+                m_models[i]->getCompleteName());
+        }
+    }
+
+    return result;
+}
+
+}} // namespace vle vpz
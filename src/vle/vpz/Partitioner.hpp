@@ -0,0 +1,177 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VLE_VPZ_PARTITIONER_HPP
+#define VLE_VPZ_PARTITIONER_HPP
+
+#include <vle/DllDefines.hpp>
+#include <vle/vpz/BaseModel.hpp>
+#include <boost/unordered_map.hpp>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <map>
+
+namespace vle { namespace vpz {
+
+    /**
+     * @brief Split the atomic models of a model into balanced parts which
+     * minimize the weight of the connections between the parts, for the
+     * parallel simulation engines (see devs::TimeWarp).
+     *
+     * The graph is the flattened graph of the connections between the
+     * atomic models: the connections through the coupled models are
+     * followed until the atomic models. The weight of an edge is the number
+     * of connections between the two models or, if a traffic is given, the
+     * number of events observed between them by an instrumentation run.
+     *
+     * The partition uses a multilevel scheme: the graph is coarsened by
+     * heavy edge matching, the coarsest graph is split by greedy graph
+     * growing and the partition is refined at each level by moving the
+     * models of the boundary.
+     *
+     * @code
+     * vle::vpz::Partitioner partitioner(vpz.project().model().model());
+     * vle::vpz::Partitioner::Partition p(partitioner.partition(4));
+     * partitioner.write(std::cout, p);
+     * @endcode
+     */
+    class VLE_API Partitioner
+    {
+    public:
+        /**
+         * @brief The part of each atomic model, in the order of models().
+         */
+        typedef std::vector < std::size_t > Partition;
+
+        /**
+         * @brief Build the graph of the atomic models of the model.
+         * @param model The atomic or coupled model to partition.
+         * @throw utils::ArgError if the model is null.
+         */
+        Partitioner(BaseModel* model);
+
+        /**
+         * @brief Get the atomic models in the order of the partitions, the
+         * order of BaseModel::getAtomicModelList.
+         * @return The list of the atomic models.
+         */
+        const AtomicModelVector& models() const
+        { return m_models; }
+
+        /**
+         * @brief Add events observed from a model to another one. The
+         * first traffic replaces the weights of the connections.
+         * @param source The model which sends the events.
+         * @param target The model which receives the events.
+         * @param events The number of events.
+         * @throw utils::ArgError if a model is not in models().
+         */
+        void addTraffic(const AtomicModel* source, const AtomicModel* target,
+                        double events);
+
+        /**
+         * @brief Read a traffic file: one line per couple of models with
+         * the complete names (BaseModel::getCompleteName) of the source
+         * and the target and the number of events, separated by tabs. The
+         * empty lines and the lines which start with a '#' are ignored.
+         * @param in The input stream.
+         * @throw utils::ArgError if a line is invalid or a model unknown.
+         */
+        void readTraffic(std::istream& in);
+
+        /**
+         * @brief Assign the weight of a model, the cost of its transitions.
+         * The default weight is 1.
+         * @param model The index of the model in models().
+         * @param weight The weight.
+         */
+        void setWeight(std::size_t model, double weight);
+
+        /**
+         * @brief Split the models into parts.
+         * @param parts The number of parts.
+         * @param imbalance The allowed imbalance: the weight of a part is
+         * at most (1 + imbalance) times the average weight, when the weights
+         * of the models allow it.
+         * @return The part of each model.
+         * @throw utils::ArgError if parts is 0.
+         */
+        Partition partition(std::size_t parts, double imbalance = 0.03) const;
+
+        /**
+         * @brief Compute the weight of the edges between the parts.
+         * @param partition A partition of the models.
+         * @return The sum of the weights of the cut edges.
+         */
+        double cut(const Partition& partition) const;
+
+        /**
+         * @brief Compute the weight of each part.
+         * @param partition A partition of the models.
+         * @param parts The number of parts.
+         * @return The sum of the weights of the models of each part.
+         */
+        std::vector < double > weights(const Partition& partition,
+                                       std::size_t parts) const;
+
+        /**
+         * @brief Write a partition: one line per model with its complete
+         * name and its part separated by a tab.
+         * @param out The output stream.
+         * @param partition The partition to write.
+         */
+        void write(std::ostream& out, const Partition& partition) const;
+
+        /**
+         * @brief Read a partition written by write(). The empty lines and
+         * the lines which start with a '#' are ignored.
+         * @param in The input stream.
+         * @return The partition.
+         * @throw utils::ArgError if a line is invalid, a model unknown or
+         * missing.
+         */
+        Partition read(std::istream& in) const;
+
+    private:
+        typedef std::map < std::pair < std::size_t, std::size_t >, double >
+            EdgeList;
+
+        std::size_t index(const AtomicModel* model) const;
+        std::size_t index(const std::string& name) const;
+
+        AtomicModelVector                      m_models;
+        boost::unordered_map < const BaseModel*, std::size_t > m_indexes;
+        std::map < std::string, std::size_t >  m_names;
+        std::vector < double >                 m_weights;
+        EdgeList                               m_connections;
+        EdgeList                               m_traffic;
+    };
+
+}} // namespace vle vpz
+
+#endif
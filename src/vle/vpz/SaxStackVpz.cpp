@@ -691,6 +691,10 @@ void SaxStackVpz::pushView(const xmlChar** att)
     const xmlChar* type = 0;
     const xmlChar* output = 0;
     const xmlChar* timestep = 0;
+    const xmlChar* aggregate = 0;
+    const xmlChar* window = 0;
+    const xmlChar* samples = 0;
+    const xmlChar* quantile = 0;
 
     for (int i = 0; att[i] != 0; i += 2) {
         if (xmlStrcmp(att[i], (const xmlChar*)"name") == 0) {
@@ -701,27 +705,49 @@ void SaxStackVpz::pushView(const xmlChar** att)
             output = att[i + 1];
         } else if (xmlStrcmp(att[i], (const xmlChar*)"timestep") == 0) {
             timestep = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"aggregate") == 0) {
+            aggregate = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"window") == 0) {
+            window = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"samples") == 0) {
+            samples = att[i + 1];
+        } else if (xmlStrcmp(att[i], (const xmlChar*)"quantile") == 0) {
+            quantile = att[i + 1];
         }
     }
 
     Views& views(m_vpz.project().experiment().views());
+    View* view;
 
     if (xmlStrcmp(type, (const xmlChar*)"timed") == 0) {
         if (not timestep) {
             throw utils::SaxParserError(
                 _("View tag does not have a timestep attribute"));
         }
-        views.addTimedView(xmlCharToString(name),
-                           xmlCharToDouble(timestep),
-                           xmlCharToString(output));
+        view = &views.addTimedView(xmlCharToString(name),
+                                   xmlCharToDouble(timestep),
+                                   xmlCharToString(output));
     } else if (xmlStrcmp(type, (const xmlChar*)"event") == 0) {
-        views.addEventView(xmlCharToString(name), xmlCharToString(output));
+        view = &views.addEventView(xmlCharToString(name),
+                                   xmlCharToString(output));
     } else if (xmlStrcmp(type, (const xmlChar*)"finish") == 0) {
-        views.addFinishView(xmlCharToString(name), xmlCharToString(output));
+        view = &views.addFinishView(xmlCharToString(name),
+                                    xmlCharToString(output));
     } else {
         throw utils::SaxParserError(fmt(
                 _("View tag does not accept type '%1%'")) % type);
     }
+
+    if (aggregate) {
+        view->setAggregation(View::toAggregation(xmlCharToString(aggregate)),
+                             window ? xmlCharToUnsignedInt(window) : 1);
+    }
+    if (samples) {
+        view->setSamples(xmlCharToUnsignedInt(samples));
+    }
+    if (quantile) {
+        view->setQuantile(xmlCharToDouble(quantile));
+    }
 }
 
 void SaxStackVpz::pushAttachedView(const xmlChar** att)
@@ -38,7 +38,11 @@ View::View(const std::string& name,
     m_name(name),
     m_type(type),
     m_output(output),
-    m_timestep(timestep)
+    m_timestep(timestep),
+    m_aggregation(AGGREGATE_NONE),
+    m_window(1),
+    m_samples(10),
+    m_quantile(0.5)
 {
     if (m_type == View::TIMED) {
         if (m_timestep <= 0.0) {
@@ -68,6 +72,17 @@ void View::write(std::ostream& out) const
         break;
     }
 
+    if (m_aggregation != AGGREGATE_NONE) {
+        out << " aggregate=\"" << aggregationName() << "\" "
+            << "window=\"" << m_window << "\"";
+
+        if (m_aggregation == AGGREGATE_SAMPLE) {
+            out << " samples=\"" << m_samples << "\"";
+        } else if (m_aggregation == AGGREGATE_QUANTILE) {
+            out << " quantile=\"" << m_quantile << "\"";
+        }
+    }
+
     if (m_data.empty()) {
         out << " />\n";
     } else {
@@ -89,11 +104,92 @@ void View::setTimestep(double time)
     m_timestep = time;
 }
 
+void View::setAggregation(Aggregation aggregation, unsigned int window)
+{
+    if (window == 0) {
+        throw utils::ArgError(fmt(
+                _("Bad aggregation window %1% for view %2%")) % window %
+            m_name);
+    }
+
+    m_aggregation = aggregation;
+    m_window = window;
+}
+
+void View::setSamples(unsigned int samples)
+{
+    if (samples == 0) {
+        throw utils::ArgError(fmt(
+                _("Bad number of samples %1% for view %2%")) % samples %
+            m_name);
+    }
+
+    m_samples = samples;
+}
+
+void View::setQuantile(double quantile)
+{
+    if (not (quantile >= 0.0 and quantile <= 1.0)) {
+        throw utils::ArgError(fmt(
+                _("Bad quantile %1% for view %2%")) % quantile % m_name);
+    }
+
+    m_quantile = quantile;
+}
+
+std::string View::aggregationName() const
+{
+    switch (m_aggregation) {
+    case AGGREGATE_MEAN:
+        return "mean";
+    case AGGREGATE_MIN:
+        return "min";
+    case AGGREGATE_MAX:
+        return "max";
+    case AGGREGATE_SUM:
+        return "sum";
+    case AGGREGATE_COUNT:
+        return "count";
+    case AGGREGATE_SAMPLE:
+        return "sample";
+    case AGGREGATE_QUANTILE:
+        return "quantile";
+    default:
+        return "none";
+    }
+}
+
+View::Aggregation View::toAggregation(const std::string& name)
+{
+    if (name == "none") {
+        return AGGREGATE_NONE;
+    } else if (name == "mean") {
+        return AGGREGATE_MEAN;
+    } else if (name == "min") {
+        return AGGREGATE_MIN;
+    } else if (name == "max") {
+        return AGGREGATE_MAX;
+    } else if (name == "sum") {
+        return AGGREGATE_SUM;
+    } else if (name == "count") {
+        return AGGREGATE_COUNT;
+    } else if (name == "sample") {
+        return AGGREGATE_SAMPLE;
+    } else if (name == "quantile") {
+        return AGGREGATE_QUANTILE;
+    }
+
+    throw utils::ArgError(fmt(_("Unknown aggregation '%1%'")) % name);
+}
+
 bool View::operator==(const View& view) const
 {
     return m_name == view.name() and m_type == view.type()
 	and m_output == view.output()
-	and m_timestep == view.timestep() and m_data == view.data();
+	and m_timestep == view.timestep() and m_data == view.data()
+        and m_aggregation == view.aggregation()
+        and m_window == view.window() and m_samples == view.samples()
+        and m_quantile == view.quantile();
 }
 
 
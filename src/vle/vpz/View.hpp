@@ -47,6 +47,15 @@ namespace vle { namespace vpz {
          */
         enum Type { TIMED, EVENT, FINISH };
 
+        /**
+         * @brief Define the aggregation of the observations of a View: the
+         * observations of each port are aggregated by windows and only the
+         * aggregates are sent to the Output.
+         */
+        enum Aggregation { AGGREGATE_NONE, AGGREGATE_MEAN, AGGREGATE_MIN,
+            AGGREGATE_MAX, AGGREGATE_SUM, AGGREGATE_COUNT, AGGREGATE_SAMPLE,
+            AGGREGATE_QUANTILE };
+
         /**
          * @brief Build a new event view with a specific name.
          * @param name The name of the View.
@@ -54,7 +63,11 @@ namespace vle { namespace vpz {
         View(const std::string& name) :
             m_name(name),
             m_type(EVENT),
-            m_timestep(0.0)
+            m_timestep(0.0),
+            m_aggregation(AGGREGATE_NONE),
+            m_window(1),
+            m_samples(10),
+            m_quantile(0.5)
         {}
 
         /**
@@ -80,6 +93,8 @@ namespace vle { namespace vpz {
          * @code
          * <view name="name" output="outout" type="event" />
          * <view name="name" output="output" type="finish" />
+         * <view name="name" output="output" type="timed" timestep="0.1"
+         *       aggregate="quantile" window="100" quantile="0.9" />
          * @endcode
          * @param out Output stream.
          */
@@ -171,6 +186,75 @@ namespace vle { namespace vpz {
         inline void setData(const std::string& data)
         { m_data = data; }
 
+        /**
+         * @brief Aggregate the observations by windows of @e window
+         * observations of the View: with a TIMED View, a window lasts @e
+         * window time steps.
+         * @param aggregation The aggregation, AGGREGATE_NONE to send all
+         * the observations.
+         * @param window The number of observations of a window.
+         * @throw utils::ArgError if window is null.
+         */
+        void setAggregation(Aggregation aggregation, unsigned int window);
+
+        /**
+         * @brief Get the aggregation of the observations.
+         * @return The aggregation, AGGREGATE_NONE by default.
+         */
+        inline Aggregation aggregation() const
+        { return m_aggregation; }
+
+        /**
+         * @brief Get the number of observations of an aggregation window.
+         * @return The number of observations, 1 by default.
+         */
+        inline unsigned int window() const
+        { return m_window; }
+
+        /**
+         * @brief Assign the number of observations kept in a window by the
+         * reservoir sampling of AGGREGATE_SAMPLE.
+         * @param samples The size of the reservoir.
+         * @throw utils::ArgError if samples is null.
+         */
+        void setSamples(unsigned int samples);
+
+        /**
+         * @brief Get the size of the reservoir of AGGREGATE_SAMPLE.
+         * @return The size, 10 by default.
+         */
+        inline unsigned int samples() const
+        { return m_samples; }
+
+        /**
+         * @brief Assign the quantile estimated by AGGREGATE_QUANTILE.
+         * @param quantile The quantile in [0, 1].
+         * @throw utils::ArgError if quantile is not in [0, 1].
+         */
+        void setQuantile(double quantile);
+
+        /**
+         * @brief Get the quantile estimated by AGGREGATE_QUANTILE.
+         * @return The quantile, 0.5 (the median) by default.
+         */
+        inline double quantile() const
+        { return m_quantile; }
+
+        /**
+         * @brief Get a string representation of the current aggregation.
+         * @return "none", "mean", "min", "max", "sum", "count", "sample"
+         * or "quantile".
+         */
+        std::string aggregationName() const;
+
+        /**
+         * @brief Get the aggregation of a string representation.
+         * @param name The string representation.
+         * @return The aggregation.
+         * @throw utils::ArgError if the name is unknown.
+         */
+        static Aggregation toAggregation(const std::string& name);
+
 	/**
 	 * @brief A operator to compare two Views
 	 * @param view The View to compare
@@ -184,6 +268,10 @@ namespace vle { namespace vpz {
         std::string     m_output;
         double          m_timestep;
         std::string     m_data;
+        Aggregation     m_aggregation;
+        unsigned int    m_window;
+        unsigned int    m_samples;
+        double          m_quantile;
     };
 
 }} // namespace vle vpz
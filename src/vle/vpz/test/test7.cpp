@@ -35,6 +35,7 @@
 #include <vle/value/Value.hpp>
 #include <vle/vpz/Vpz.hpp>
 #include <vle/vle.hpp>
+#include <sstream>
 #include <stdexcept>
 
 
@@ -84,3 +85,32 @@ BOOST_AUTO_TEST_CASE(vpz_add_output)
     BOOST_REQUIRE_THROW(views.addTimedView("view4", 0.0, "out2"),
                         utils::ArgError);
 }
+
+BOOST_AUTO_TEST_CASE(vpz_view_aggregation)
+{
+    View view("view", View::TIMED, "out", 0.5);
+    BOOST_REQUIRE_EQUAL(view.aggregation(), View::AGGREGATE_NONE);
+    BOOST_REQUIRE_EQUAL(view.aggregationName(), "none");
+
+    BOOST_REQUIRE_THROW(view.setAggregation(View::AGGREGATE_MEAN, 0),
+                        utils::ArgError);
+    BOOST_REQUIRE_THROW(view.setQuantile(1.5), utils::ArgError);
+    BOOST_REQUIRE_THROW(view.setSamples(0), utils::ArgError);
+    BOOST_REQUIRE_THROW(View::toAggregation("median"), utils::ArgError);
+
+    view.setAggregation(View::toAggregation("quantile"), 100);
+    view.setQuantile(0.9);
+    BOOST_REQUIRE_EQUAL(view.aggregation(), View::AGGREGATE_QUANTILE);
+    BOOST_REQUIRE_EQUAL(view.window(), 100u);
+
+    std::ostringstream out;
+    view.write(out);
+    BOOST_REQUIRE(out.str().find(
+            "aggregate=\"quantile\" window=\"100\" quantile=\"0.9\"") !=
+        std::string::npos);
+
+    View copy(view);
+    BOOST_REQUIRE(copy == view);
+    copy.setAggregation(View::AGGREGATE_SAMPLE, 100);
+    BOOST_REQUIRE(not (copy == view));
+}
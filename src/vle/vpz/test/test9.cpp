@@ -0,0 +1,243 @@
+/*
+ * This file is part of VLE, a framework for multi-modeling, simulation
+ * and analysis of complex dynamical systems.
+ * http://www.vle-project.org
+ *
+ * Copyright (c) 2003-2014 Gauthier Quesnel <quesnel@users.sourceforge.net>
+ * Copyright (c) 2003-2014 ULCO http://www.univ-littoral.fr
+ * Copyright (c) 2007-2014 INRA http://www.inra.fr
+ *
+ * See the AUTHORS or Authors.txt file for copyright owners and
+ * contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_AUTO_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE partitioner_test
+#include <boost/test/unit_test.hpp>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <sstream>
+#include <vle/vpz/AtomicModel.hpp>
+#include <vle/vpz/CoupledModel.hpp>
+#include <vle/vpz/Partitioner.hpp>
+#include <vle/utils/Exception.hpp>
+
+using namespace vle;
+using namespace vpz;
+
+namespace {
+
+std::string name(int i, int j)
+{
+    return "c" + boost::lexical_cast < std::string >(i) + "_" +
+        boost::lexical_cast < std::string >(j);
+}
+
+/*
+ * A torus of size x size atomic models connected to their four
+ * neighbours.
+ */
+CoupledModel* buildGrid(int size)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            AtomicModel* atom = top->addAtomicModel(name(i, j));
+            atom->addInputPort("in");
+            atom->addOutputPort("out");
+        }
+    }
+
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            top->addInternalConnection(name(i, j), "out",
+                                       name((i + 1) % size, j), "in");
+            top->addInternalConnection(name(i, j), "out",
+                                       name((i + size - 1) % size, j), "in");
+            top->addInternalConnection(name(i, j), "out",
+                                       name(i, (j + 1) % size), "in");
+            top->addInternalConnection(name(i, j), "out",
+                                       name(i, (j + size - 1) % size), "in");
+        }
+    }
+
+    return top;
+}
+
+/*
+ * size isolated atomic models and a star: a model connected to size / 4
+ * leaves.
+ */
+CoupledModel* buildIsolated(int size)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+
+    for (int i = 0; i < size; ++i) {
+        top->addAtomicModel(name(0, i));
+    }
+
+    top->addAtomicModel("hub")->addOutputPort("out");
+    for (int i = 0; i < size / 4; ++i) {
+        top->addAtomicModel(name(1, i))->addInputPort("in");
+        top->addInternalConnection("hub", "out", name(1, i), "in");
+    }
+
+    return top;
+}
+
+/*
+ * Partition the models into four parts and check the balance.
+ * @return The duration of the partition in seconds.
+ */
+double partitionIsolated(int size)
+{
+    CoupledModel* top = buildIsolated(size);
+    Partitioner partitioner(top);
+
+    boost::posix_time::ptime start(
+        boost::posix_time::microsec_clock::universal_time());
+    Partitioner::Partition p(partitioner.partition(4));
+    double seconds = (boost::posix_time::microsec_clock::universal_time()
+                      - start).total_microseconds() / 1e6;
+
+    std::vector < double > weights(partitioner.weights(p, 4));
+    double average = partitioner.models().size() / 4.0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        BOOST_REQUIRE(weights[i] <= average * 1.03 + 1.0);
+    }
+
+    delete top;
+    return seconds;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(test_partition_grid)
+{
+    CoupledModel* top = buildGrid(16);
+    Partitioner partitioner(top);
+    BOOST_REQUIRE_EQUAL(partitioner.models().size(), 256u);
+
+    Partitioner::Partition p(partitioner.partition(4));
+    BOOST_REQUIRE_EQUAL(p.size(), 256u);
+
+    std::vector < double > weights(partitioner.weights(p, 4));
+    for (std::size_t i = 0; i < 4; ++i) {
+        BOOST_REQUIRE(weights[i] >= 62.0);
+        BOOST_REQUIRE(weights[i] <= 64.0 * 1.03);
+    }
+
+    Partitioner::Partition roundrobin(256);
+    for (std::size_t i = 0; i < roundrobin.size(); ++i) {
+        roundrobin[i] = i % 4;
+    }
+
+    /* A couple of neighbours has two connections: the best partitions,
+     * four strips or four squares, cut 64 couples. */
+    BOOST_REQUIRE(partitioner.cut(p) <= 1.5 * 64 * 2);
+    BOOST_REQUIRE(partitioner.cut(p) < partitioner.cut(roundrobin) / 2);
+
+    BOOST_REQUIRE_THROW(partitioner.partition(0), utils::ArgError);
+
+    Partitioner::Partition one(partitioner.partition(1));
+    BOOST_REQUIRE_EQUAL(partitioner.cut(one), 0.0);
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_partition_isolated)
+{
+    /* The isolated models and the leaves of the star are merged by the
+     * coarsening: the duration grows almost linearly with the number of
+     * models, a quadratic growth would be 16 times longer. */
+    double small = partitionIsolated(2000);
+    double large = partitionIsolated(8000);
+
+    BOOST_REQUIRE(large < 8.0 * std::max(small, 0.01));
+}
+
+BOOST_AUTO_TEST_CASE(test_partition_hierarchy)
+{
+    CoupledModel* top = new CoupledModel("top", 0);
+    CoupledModel* left = top->addCoupledModel("left");
+    CoupledModel* right = top->addCoupledModel("right");
+    AtomicModel* a = left->addAtomicModel("a");
+    AtomicModel* b = right->addAtomicModel("b");
+    AtomicModel* c = right->addAtomicModel("c");
+
+    a->addOutputPort("out");
+    left->addOutputPort("out");
+    left->addOutputConnection("a", "out", "out");
+
+    b->addInputPort("in");
+    c->addInputPort("in");
+    right->addInputPort("in");
+    right->addInputConnection("in", "b", "in");
+    right->addInputConnection("in", "c", "in");
+
+    top->addInternalConnection("left", "out", "right", "in");
+
+    Partitioner partitioner(top);
+    BOOST_REQUIRE_EQUAL(partitioner.models().size(), 3u);
+
+    Partitioner::Partition p(3, 0);
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (partitioner.models()[i] == a) {
+            p[i] = 1;
+        }
+    }
+    BOOST_REQUIRE_EQUAL(partitioner.cut(p), 2.0);
+
+    /* The traffic replaces the connections. */
+    partitioner.addTraffic(a, b, 10.0);
+    BOOST_REQUIRE_EQUAL(partitioner.cut(p), 10.0);
+
+    std::stringstream traffic;
+    traffic << "# source\ttarget\tevents\n"
+            << "top,left,a\ttop,right,c\t5\n";
+    partitioner.readTraffic(traffic);
+    BOOST_REQUIRE_EQUAL(partitioner.cut(p), 15.0);
+
+    std::stringstream bad("top,left,a\ttop,right,d\t5\n");
+    BOOST_REQUIRE_THROW(partitioner.readTraffic(bad), utils::ArgError);
+
+    delete top;
+}
+
+BOOST_AUTO_TEST_CASE(test_partition_io)
+{
+    CoupledModel* top = buildGrid(4);
+    Partitioner partitioner(top);
+    Partitioner::Partition p(partitioner.partition(3));
+
+    std::stringstream out;
+    out << "# a comment\n";
+    partitioner.write(out, p);
+
+    std::stringstream in(out.str());
+    BOOST_REQUIRE(partitioner.read(in) == p);
+
+    std::stringstream missing("top,c0_0\t1\n");
+    BOOST_REQUIRE_THROW(partitioner.read(missing), utils::ArgError);
+
+    delete top;
+}